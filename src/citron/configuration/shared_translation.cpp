@@ -164,6 +164,16 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
            "the emulator to decompress to an intermediate format any card supports, RGBA8.\n"
            "This option recompresses RGBA8 to either the BC1 or BC3 format, saving VRAM but "
            "negatively affecting image quality."));
+    INSERT(Settings, astc_recompression_quality, tr("ASTC Recompression Quality:"),
+           tr("Balances the speed of the BC1/BC3 recompression against its image quality.\n"
+              "Fast is about twice as fast as Normal at a slight quality loss, High refines "
+              "the result further at some extra cost."));
+    INSERT(Settings, use_disk_texture_cache, tr("Use disk texture transcode cache"),
+           tr("Stores CPU decoded and recompressed ASTC textures on disk so following game boots "
+              "can read them back instead of transcoding them again."));
+    INSERT(Settings, disk_texture_cache_size, tr("Texture transcode cache size (MiB):"),
+           tr("Maximum size of each game's texture transcode cache. The least recently used "
+              "textures are removed once it is exceeded."));
     INSERT(Settings, vram_usage_mode, tr("VRAM Usage Mode:"),
            tr("Selects whether the emulator should prefer to conserve memory or make maximum usage "
               "of available video memory for performance. Has no effect on integrated graphics. "
@@ -200,6 +210,20 @@ std::unique_ptr<TranslationMap> InitializeTranslations(QWidget* parent) {
            tr("Enables asynchronous shader compilation, which may reduce shader stutter.\nThis "
               "feature "
               "is experimental."));
+    INSERT(Settings, use_pipelined_gpu, tr("Use pipelined GPU thread (Experimental)"),
+           tr("Fetches and decodes GPU command lists on a separate thread ahead of the thread "
+              "executing them.\nCan improve performance on CPUs with many cores.\nRequires "
+              "asynchronous GPU emulation."));
+    INSERT(Settings, use_draw_coalescing, tr("Coalesce draws"),
+           tr("Merges consecutive draws that share all of their state and draw adjacent "
+              "vertex or index ranges into a single host draw.\nReduces the driver overhead of "
+              "user interfaces and particles."));
+    INSERT(Settings, use_shader_value_numbering, tr("Remove redundant shader instructions"),
+           tr("Reuses the results of identical arithmetic and constant buffer reads while "
+              "translating shaders.\nApplies to shaders built after the change."));
+    INSERT(Settings, use_shader_code_motion, tr("Move loop invariant shader instructions"),
+           tr("Moves instructions computing the same value on every loop iteration out of "
+              "shader loops.\nApplies to shaders built after the change."));
     INSERT(Settings, use_fast_gpu_time, tr("Use Fast GPU Time (Hack)"),
            tr("Enables Fast GPU Time. This option will force most games to run at their highest "
               "native resolution."));
@@ -320,6 +344,12 @@ std::unique_ptr<ComboboxTranslationMap> ComboboxEnumeration(QWidget* parent) {
              PAIR(AstcRecompression, Bc1, tr("BC1 (Low quality)")),
              PAIR(AstcRecompression, Bc3, tr("BC3 (Medium quality)")),
          }});
+    translations->insert({Settings::EnumMetadata<Settings::AstcRecompressionQuality>::Index(),
+                          {
+                              PAIR(AstcRecompressionQuality, Fast, tr("Fast")),
+                              PAIR(AstcRecompressionQuality, Normal, tr("Normal")),
+                              PAIR(AstcRecompressionQuality, High, tr("High")),
+                          }});
     translations->insert({Settings::EnumMetadata<Settings::VramUsageMode>::Index(),
                           {
                               PAIR(VramUsageMode, Conservative, tr("Conservative")),
@@ -136,7 +136,11 @@ static FileSys::VirtualFile VfsDirectoryCreateFileWrapper(const FileSys::Virtual
 #include "input_common/main.h"
 #include "ui_main.h"
 #include "util/overlay_dialog.h"
+#include "video_core/buffer_cache/uniform_upload_stats.h"
+#include "video_core/engines/draw_manager.h"
+#include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/renderer_base.h"
 #include "video_core/shader_notify.h"
 #include "citron/about_dialog.h"
@@ -1052,9 +1056,24 @@ void GMainWindow::InitializeWidgets() {
     emu_frametime_label->setToolTip(
         tr("Time taken to emulate a Switch frame, not counting framelimiting or v-sync. For "
            "full-speed emulation this should be at most 16.67 ms."));
+    gpu_queue_label = new QLabel();
+    gpu_queue_label->setToolTip(
+        tr("Largest number of commands waiting for the GPU thread and how many times it had to be "
+           "woken up since the last update. A queue that stays empty with many wake-ups means the "
+           "GPU thread is starved by small submissions."));
+    merged_draws_label = new QLabel();
+    merged_draws_label->setToolTip(
+        tr("Average number of draws per frame that were merged into the previous draw since the "
+           "last update, saving one host draw each."));
+    skipped_uniforms_label = new QLabel();
+    skipped_uniforms_label->setToolTip(
+        tr("Average amount of uniform buffer data per frame that was not uploaded again since the "
+           "last update, because it was identical to the previous upload of its binding."));
+    direct_dma_label = new QLabel();
 
     for (auto& label : {shader_building_label, res_scale_label, emu_speed_label, game_fps_label,
-                        emu_frametime_label}) {
+                        emu_frametime_label, gpu_queue_label, merged_draws_label,
+                        skipped_uniforms_label, direct_dma_label}) {
         label->setVisible(false);
         label->setFrameStyle(QFrame::NoFrame);
         label->setContentsMargins(4, 0, 4, 0);
@@ -2183,6 +2202,10 @@ void GMainWindow::OnEmulationStopped() {
     emu_speed_label->setVisible(false);
     game_fps_label->setVisible(false);
     emu_frametime_label->setVisible(false);
+    gpu_queue_label->setVisible(false);
+    merged_draws_label->setVisible(false);
+    skipped_uniforms_label->setVisible(false);
+    direct_dma_label->setVisible(false);
     renderer_status_button->setEnabled(!UISettings::values.has_broken_vulkan);
 
     if (!firmware_label->text().isEmpty()) {
@@ -4418,11 +4441,47 @@ void GMainWindow::UpdateStatusBar() {
             tr("Game: %1 FPS").arg(std::round(results.average_game_fps), 0, 'f', 0));
     }
     emu_frametime_label->setText(tr("Frame: %1 ms").arg(results.frametime * 1000.0, 0, 'f', 2));
+    const auto queue_stats = system->GPU().GetAndResetQueueStats();
+    gpu_queue_label->setText(tr("GPU queue: %1 / %2 wake-ups")
+                                 .arg(queue_stats.peak_depth)
+                                 .arg(queue_stats.wakeups));
+    const auto draw_stats = system->GPU().DrawCoalescingStats().GetAndReset();
+    merged_draws_label->setText(
+        tr("Merged draws: %1/frame")
+            .arg(static_cast<double>(draw_stats.merged_draws) /
+                     static_cast<double>(std::max<u64>(draw_stats.frames, 1)),
+                 0, 'f', 0));
+    const auto uniform_stats = system->GPU().UniformUploadStats().GetAndReset();
+    skipped_uniforms_label->setText(
+        tr("Skipped uniforms: %1 KiB/frame")
+            .arg(static_cast<double>(uniform_stats.skipped_bytes) / 1024.0 /
+                     static_cast<double>(std::max<u64>(uniform_stats.frames, 1)),
+                 0, 'f', 0));
+    using CopyPath = Tegra::Engines::DmaCopyStats::CopyPath;
+    const auto dma_stats = system->GPU().DmaCopyStats().GetAndReset();
+    const u64 direct_copies = dma_stats.Copies(CopyPath::PitchToPitchDirect) +
+                              dma_stats.Copies(CopyPath::BufferSwizzleDirect);
+    const u64 staged_copies = dma_stats.Copies(CopyPath::PitchToPitchStaged) +
+                              dma_stats.Copies(CopyPath::BufferSwizzleStaged);
+    direct_dma_label->setText(
+        tr("Direct DMA copies: %1%")
+            .arg(100.0 * static_cast<double>(direct_copies) /
+                     static_cast<double>(std::max<u64>(direct_copies + staged_copies, 1)),
+                 0, 'f', 0));
+    direct_dma_label->setToolTip(
+        tr("Share of the pitch and buffer swizzle DMA copies since the last update that were "
+           "done directly between host pointers instead of through staging buffers.") +
+        QStringLiteral("\n\n") +
+        QString::fromStdString(Tegra::Engines::DmaCopyStats::FormatReport(dma_stats)));
 
     res_scale_label->setVisible(true);
     emu_speed_label->setVisible(!Settings::values.use_multi_core.GetValue());
     game_fps_label->setVisible(true);
     emu_frametime_label->setVisible(true);
+    gpu_queue_label->setVisible(true);
+    merged_draws_label->setVisible(Settings::values.use_draw_coalescing.GetValue());
+    skipped_uniforms_label->setVisible(true);
+    direct_dma_label->setVisible(true);
     firmware_label->setVisible(false);
 }
 
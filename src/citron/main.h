@@ -496,6 +496,10 @@ private:
     QLabel* emu_speed_label = nullptr;
     QLabel* game_fps_label = nullptr;
     QLabel* emu_frametime_label = nullptr;
+    QLabel* gpu_queue_label = nullptr;
+    QLabel* merged_draws_label = nullptr;
+    QLabel* skipped_uniforms_label = nullptr;
+    QLabel* direct_dma_label = nullptr;
     QLabel* tas_label = nullptr;
     QLabel* firmware_label = nullptr;
     QPushButton* gpu_accuracy_button = nullptr;
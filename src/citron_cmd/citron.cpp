@@ -11,6 +11,7 @@
 #include <fmt/ostream.h>
 
 #include "common/detached_tasks.h"
+#include "common/fs/path_util.h"
 #include "common/logging/backend.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -30,10 +31,14 @@
 #include "core/hle/service/filesystem/filesystem.h"
 #include "core/loader/loader.h"
 #include "core/telemetry_session.h"
+#include "core/tools/benchmark.h"
 #include "frontend_common/config.h"
+#include "input_common/drivers/tas_input.h"
 #include "input_common/main.h"
 #include "network/network.h"
 #include "sdl_config.h"
+#include "video_core/gpu.h"
+#include "video_core/macro/macro_profiler.h"
 #include "video_core/renderer_base.h"
 #include "citron_cmd/emu_window/emu_window_sdl2.h"
 #include "citron_cmd/emu_window/emu_window_sdl2_gl.h"
@@ -71,13 +76,22 @@ __declspec(dllexport) int AmdPowerXpressRequestHighPerformance = 1;
 static void PrintHelp(const char* argv0) {
     std::cout << "Usage: " << argv0
               << " [options] <filename>\n"
+                 "-b, --benchmark=FILE  Run without the speed limit and write the performance\n"
+                 "                      results as JSON to FILE, or to the standard output for -\n"
                  "-c, --config          Load the specified configuration file\n"
+                 "-d, --duration=SECS   Stop the benchmark after SECS seconds (default: 60)\n"
                  "-f, --fullscreen      Start in fullscreen mode\n"
+                 "-F, --frames=N        Stop the benchmark after N frames\n"
                  "-g, --game            File path of the game to load\n"
+                 "-G, --gpu-capture=N   Capture the GPU commands of N frames for citron-replay\n"
                  "-h, --help            Display this help and exit\n"
+                 "-M, --macro-profile   Profile macro execution and dump a report on exit\n"
                  "-m, --multiplayer=nick:password@address:port"
                  " Nickname, password, address and port for multiplayer\n"
+                 "-n, --null-renderer   Run without rendering anything\n"
                  "-p, --program         Pass following string as arguments to executable\n"
+                 "-R, --macro-record    Record macro code and parameters for offline validation\n"
+                 "-t, --tas=DIR         Play the TAS scripts in DIR from the first frame\n"
                  "-u, --user            Select a specific user profile from 0 to 7\n"
                  "-v, --version         Output version information and exit\n";
 }
@@ -214,6 +228,14 @@ int main(int argc, char** argv) {
 
     bool use_multiplayer = false;
     bool fullscreen = false;
+    bool profile_macros = false;
+    bool record_macros = false;
+    u16 gpu_capture_frames = 0;
+    std::optional<std::string> benchmark_path;
+    std::optional<std::chrono::seconds> benchmark_duration;
+    std::optional<std::size_t> benchmark_frames;
+    std::optional<std::string> tas_path;
+    bool null_renderer = false;
     std::string nickname{};
     std::string password{};
     std::string address{};
@@ -221,12 +243,20 @@ int main(int argc, char** argv) {
 
     static struct option long_options[] = {
         // clang-format off
+        {"benchmark", required_argument, 0, 'b'},
         {"config", required_argument, 0, 'c'},
+        {"duration", required_argument, 0, 'd'},
         {"fullscreen", no_argument, 0, 'f'},
+        {"frames", required_argument, 0, 'F'},
         {"help", no_argument, 0, 'h'},
         {"game", required_argument, 0, 'g'},
+        {"gpu-capture", required_argument, 0, 'G'},
+        {"macro-profile", no_argument, 0, 'M'},
+        {"macro-record", no_argument, 0, 'R'},
         {"multiplayer", required_argument, 0, 'm'},
+        {"null-renderer", no_argument, 0, 'n'},
         {"program", optional_argument, 0, 'p'},
+        {"tas", required_argument, 0, 't'},
         {"user", required_argument, 0, 'u'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -234,16 +264,25 @@ int main(int argc, char** argv) {
     };
 
     while (optind < argc) {
-        int arg = getopt_long(argc, argv, "g:fhvp::c:u:", long_options, &option_index);
+        int arg = getopt_long(argc, argv, "b:d:F:g:G:fhnvMRp::c:t:u:", long_options, &option_index);
         if (arg != -1) {
             switch (static_cast<char>(arg)) {
+            case 'b':
+                benchmark_path = optarg;
+                break;
             case 'c':
                 config_path = optarg;
                 break;
+            case 'd':
+                benchmark_duration = std::chrono::seconds{std::strtoul(optarg, nullptr, 0)};
+                break;
             case 'f':
                 fullscreen = true;
                 LOG_INFO(Frontend, "Starting in fullscreen mode...");
                 break;
+            case 'F':
+                benchmark_frames = std::strtoull(optarg, nullptr, 0);
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -252,6 +291,15 @@ int main(int argc, char** argv) {
                 filepath = str_arg;
                 break;
             }
+            case 'G':
+                gpu_capture_frames = static_cast<u16>(std::strtoul(optarg, nullptr, 0));
+                break;
+            case 'M':
+                profile_macros = true;
+                break;
+            case 'R':
+                record_macros = true;
+                break;
             case 'm': {
                 use_multiplayer = true;
                 const std::string str_arg(optarg);
@@ -285,10 +333,16 @@ int main(int argc, char** argv) {
                 }
                 break;
             }
+            case 'n':
+                null_renderer = true;
+                break;
             case 'p':
                 program_args = argv[optind];
                 ++optind;
                 break;
+            case 't':
+                tas_path = optarg;
+                break;
             case 'u':
                 selected_user = atoi(optarg);
                 break;
@@ -322,6 +376,35 @@ int main(int argc, char** argv) {
         Settings::values.current_user = std::clamp(*selected_user, 0, 7);
     }
 
+    if (profile_macros) {
+        Settings::values.profile_macros = true;
+    }
+
+    if (record_macros) {
+        Settings::values.record_macros = true;
+    }
+
+    if (gpu_capture_frames != 0) {
+        Settings::values.gpu_capture_frames = gpu_capture_frames;
+    }
+
+    if (null_renderer) {
+        Settings::values.renderer_backend.SetValue(Settings::RendererBackend::Null);
+    }
+
+    if (tas_path) {
+        Common::FS::SetCitronPath(Common::FS::CitronPath::TASDir, *tas_path);
+        Settings::values.tas_enable = true;
+    }
+
+    if (benchmark_path) {
+        // Measure how fast the title can run rather than the frame pacing
+        Settings::values.use_speed_limit.SetValue(false);
+        if (!benchmark_duration && !benchmark_frames) {
+            benchmark_duration = std::chrono::seconds{60};
+        }
+    }
+
 #ifdef _WIN32
     LocalFree(argv_w);
 #endif
@@ -430,7 +513,19 @@ int main(int argc, char** argv) {
             [](VideoCore::LoadCallbackStage, size_t value, size_t total) {});
     }
 
+    std::unique_ptr<Tools::Benchmark> benchmark;
+    if (benchmark_path) {
+        benchmark = std::make_unique<Tools::Benchmark>(system, *benchmark_path, benchmark_duration,
+                                                benchmark_frames);
+    }
+
     system.RegisterExitCallback([&] {
+        if (profile_macros || record_macros) {
+            system.GPU().MacroProfiler().Dump();
+        }
+        if (benchmark) {
+            benchmark->Finish();
+        }
         // Just exit right away.
         exit(0);
     });
@@ -443,8 +538,20 @@ int main(int argc, char** argv) {
     if (system.DebuggerEnabled()) {
         system.InitializeDebugger();
     }
-    while (emu_window->IsOpen()) {
-        emu_window->WaitEvent();
+    if (tas_path) {
+        input_subsystem.GetTas()->StartStop();
+    }
+    if (benchmark) {
+        benchmark->Start();
+        // Wake up regularly to check whether the benchmark is done
+        while (emu_window->IsOpen() && !benchmark->IsDone()) {
+            emu_window->WaitEvent(std::chrono::milliseconds{100});
+        }
+        benchmark->Finish();
+    } else {
+        while (emu_window->IsOpen()) {
+            emu_window->WaitEvent();
+        }
     }
     system.DetachDebugger();
     void(system.Pause());
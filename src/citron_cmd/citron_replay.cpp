@@ -0,0 +1,281 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "common/detached_tasks.h"
+#include "common/logging/backend.h"
+#include "common/logging/log.h"
+#include "common/microprofile.h"
+#include "common/nvidia_flags.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "input_common/main.h"
+#include "sdl_config.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_capture.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+#include "citron_cmd/emu_window/emu_window_sdl2_null.h"
+
+#undef _UNICODE
+#include <getopt.h>
+#ifndef _MSC_VER
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Milliseconds = std::chrono::duration<double, std::milli>;
+
+/// Column names of the engines, in the order of Tegra::EngineTimes
+constexpr std::array<const char*, Tegra::EngineTimes::PULLER + 1> ENGINE_NAMES{
+    "Compute", "3D", "2D", "DMA", "Inline", "Puller",
+};
+
+struct ReplayChannel {
+    std::shared_ptr<Tegra::Control::ChannelState> state;
+    Tegra::EngineTimes times;
+};
+
+void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options] <capture>\n"
+                 "Replays GPU captures written by citron-cmd --gpu-capture on the null\n"
+                 "renderer and reports the CPU time spent in each engine per frame.\n"
+                 "-c, --config          Load the specified configuration file\n"
+                 "-h, --help            Display this help and exit\n"
+                 "-l, --loops=N         Replay the captured frames N times\n";
+}
+
+/// Puts back the captured contents of the memory the previous loop may have written
+void RestoreCapturedMemory(const Tegra::GPUCaptureData& capture,
+                           const std::unordered_map<s32, ReplayChannel>& channels) {
+    for (const auto& [channel_id, channel] : channels) {
+        Tegra::GPUCapture::RestoreMemory(capture, channel_id, *channel.state->memory_manager);
+    }
+}
+
+ReplayChannel& CreateChannel(Core::System& system,
+                             std::unordered_map<s32, ReplayChannel>& channels,
+                             const Tegra::GPUCaptureData& capture,
+                             const Tegra::CapturedChannel& captured,
+                             PAddr& next_physical_address) {
+    Tegra::GPU& gpu = system.GPU();
+    ReplayChannel& channel = channels[captured.channel_id];
+    channel.state = gpu.AllocateChannel();
+    // Only the pushbuffers and the memory they used are captured, everything else is unmapped
+    channel.state->memory_manager = std::make_shared<Tegra::MemoryManager>(system);
+    gpu.InitAddressSpace(*channel.state->memory_manager);
+    Tegra::GPUCapture::MapMemory(capture, captured.channel_id, system.Host1x().MemoryManager(),
+                                 *channel.state->memory_manager, next_physical_address);
+    gpu.InitChannel(*channel.state, captured.program_id);
+    if (!captured.registers.empty()) {
+        channel.state->maxwell_3d->LoadCaptureState(captured);
+    }
+
+    // Bind the engines to the subchannels through the puller, as the guest did
+    Tegra::CommandList binds;
+    for (u32 subchannel = 0; subchannel < captured.bound_engines.size(); ++subchannel) {
+        if (captured.bound_engines[subchannel] == 0) {
+            continue;
+        }
+        Tegra::CommandHeader header = Tegra::BuildCommandHeader(
+            Tegra::BufferMethods::BindObject, 1, Tegra::SubmissionMode::Increasing);
+        header.subchannel.Assign(subchannel);
+        binds.prefetch_command_list.push_back(header);
+        binds.prefetch_command_list.push_back(
+            Tegra::CommandHeader{captured.bound_engines[subchannel]});
+    }
+    if (!binds.prefetch_command_list.empty()) {
+        gpu.PushGPUEntries(channel.state->bind_id, std::move(binds));
+    }
+    channel.state->dma_pusher->SetEngineTimes(&channel.times);
+    return channel;
+}
+
+Tegra::EngineTimes SumEngineTimes(const std::unordered_map<s32, ReplayChannel>& channels) {
+    Tegra::EngineTimes total;
+    for (const auto& [channel_id, channel] : channels) {
+        for (size_t engine = 0; engine < total.times.size(); ++engine) {
+            total.times[engine] += channel.times.times[engine];
+        }
+    }
+    return total;
+}
+
+void Replay(Core::System& system, const Tegra::GPUCaptureData& capture, u32 loops) {
+    std::unordered_map<s32, ReplayChannel> channels;
+    PAddr next_physical_address = 0;
+    for (const Tegra::CapturedChannel& captured : capture.channels) {
+        CreateChannel(system, channels, capture, captured, next_physical_address);
+    }
+
+    std::string header = fmt::format("{:>6}  {:>11}  {:>10}", "Frame", "Submissions", "Wall ms");
+    for (const char* name : ENGINE_NAMES) {
+        header += fmt::format("  {:>10}", fmt::format("{} ms", name));
+    }
+    std::cout << header << '\n';
+
+    Tegra::EngineTimes total_times;
+    Milliseconds total_wall{};
+    u32 num_frames = 0;
+    for (u32 loop = 0; loop < loops; ++loop) {
+        if (loop != 0) {
+            RestoreCapturedMemory(capture, channels);
+        }
+        for (const Tegra::CapturedFrame& frame : capture.frames) {
+            const Tegra::EngineTimes start_times = SumEngineTimes(channels);
+            const auto start = std::chrono::steady_clock::now();
+            for (const Tegra::CapturedSubmission& submission : frame.submissions) {
+                // Channels created during the capture start from their default state
+                const s32 channel_id = submission.channel_id;
+                auto it = channels.find(channel_id);
+                ReplayChannel& channel =
+                    it != channels.end()
+                        ? it->second
+                        : CreateChannel(system, channels, capture, {.channel_id = channel_id},
+                                        next_physical_address);
+                // Segments are concatenated, the DMA state carries over between them anyway
+                Tegra::CommandList entries;
+                for (const Tegra::CapturedSegment& segment : submission.segments) {
+                    for (const u32 word : segment.words) {
+                        entries.prefetch_command_list.push_back(Tegra::CommandHeader{word});
+                    }
+                }
+                if (!entries.prefetch_command_list.empty()) {
+                    system.GPU().PushGPUEntries(channel.state->bind_id, std::move(entries));
+                }
+            }
+            // Submissions block until they are executed in synchronous GPU mode
+            const Milliseconds wall = std::chrono::steady_clock::now() - start;
+            const Tegra::EngineTimes end_times = SumEngineTimes(channels);
+
+            std::string line =
+                fmt::format("{:>6}  {:>11}  {:>10.3f}", num_frames, frame.submissions.size(),
+                            wall.count());
+            for (size_t engine = 0; engine < end_times.times.size(); ++engine) {
+                const auto time = end_times.times[engine] - start_times.times[engine];
+                total_times.times[engine] += time;
+                line += fmt::format("  {:>10.3f}", Milliseconds(time).count());
+            }
+            std::cout << line << '\n';
+            total_wall += wall;
+            ++num_frames;
+        }
+    }
+    if (num_frames == 0) {
+        return;
+    }
+    std::string average = fmt::format("{:>6}  {:>11}  {:>10.3f}", "Avg", "",
+                                      total_wall.count() / num_frames);
+    for (const auto time : total_times.times) {
+        average += fmt::format("  {:>10.3f}", Milliseconds(time).count() / num_frames);
+    }
+    std::cout << average << std::endl;
+}
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Common::Log::Initialize();
+    Common::Log::SetColorConsoleBackendEnabled(true);
+    Common::Log::Start();
+    Common::DetachedTasks detached_tasks;
+
+    std::optional<std::string> config_path;
+    u32 loops = 1;
+
+    static struct option long_options[] = {
+        // clang-format off
+        {"config", required_argument, 0, 'c'},
+        {"help", no_argument, 0, 'h'},
+        {"loops", required_argument, 0, 'l'},
+        {0, 0, 0, 0},
+        // clang-format on
+    };
+
+    int option_index = 0;
+    int arg;
+    while ((arg = getopt_long(argc, argv, "c:hl:", long_options, &option_index)) != -1) {
+        switch (static_cast<char>(arg)) {
+        case 'c':
+            config_path = optarg;
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        case 'l':
+            loops = static_cast<u32>(std::strtoul(optarg, nullptr, 0));
+            break;
+        default:
+            PrintHelp(argv[0]);
+            return -1;
+        }
+    }
+    if (optind >= argc) {
+        PrintHelp(argv[0]);
+        return -1;
+    }
+    const std::string capture_path = argv[optind];
+
+    SdlConfig config{config_path};
+
+    Common::Log::Filter filter;
+    filter.ParseFilterString(Settings::values.log_filter.GetValue());
+    Common::Log::SetGlobalFilter(filter);
+
+    // Captures hold the pushbuffers and the memory the puller and engines read, not the shaders,
+    // descriptor tables or textures draws use, so replays can not render on a host GPU.
+    // Replays must be deterministic: execute the submissions one at a time, in order
+    Settings::values.renderer_backend.SetValue(Settings::RendererBackend::Null);
+    Settings::values.use_asynchronous_gpu_emulation.SetValue(false);
+    Settings::values.use_pipelined_gpu.SetValue(false);
+    Settings::values.gpu_capture_frames = 0;
+
+    const std::optional<Tegra::GPUCaptureData> capture = Tegra::GPUCapture::Read(capture_path);
+    if (!capture) {
+        LOG_CRITICAL(Frontend, "Failed to read the GPU capture {}", capture_path);
+        return -1;
+    }
+
+    MicroProfileOnThreadCreate("EmuThread");
+    SCOPE_EXIT {
+        MicroProfileShutdown();
+    };
+
+    Common::ConfigureNvidiaEnvironmentFlags();
+
+    Core::System system{};
+    system.Initialize();
+
+    InputCommon::InputSubsystem input_subsystem{};
+
+    system.ApplySettings();
+
+    EmuWindow_SDL2_Null emu_window{&input_subsystem, system, false};
+    if (system.InitializeGPUReplay(emu_window) != Core::SystemResultStatus::Success) {
+        LOG_CRITICAL(Frontend, "Failed to initialize VideoCore!");
+        return -1;
+    }
+    system.GPU().Start();
+
+    Replay(system, *capture, loops);
+
+    system.ShutdownGPUReplay();
+    return 0;
+}
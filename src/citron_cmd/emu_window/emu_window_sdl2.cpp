@@ -11,6 +11,7 @@
 #include "hid_core/hid_core.h"
 #include "input_common/drivers/keyboard.h"
 #include "input_common/drivers/mouse.h"
+#include "input_common/drivers/tas_input.h"
 #include "input_common/drivers/touch_screen.h"
 #include "input_common/main.h"
 #include "citron_cmd/emu_window/emu_window_sdl2.h"
@@ -167,6 +168,26 @@ void EmuWindow_SDL2::WaitEvent() {
         exit(1);
     }
 
+    HandleEvent(event);
+    UpdateTitle();
+}
+
+void EmuWindow_SDL2::WaitEvent(std::chrono::milliseconds timeout) {
+    // Called on main thread
+    SDL_Event event;
+
+    // Timeouts are reported like errors, either way there is no event to handle
+    if (SDL_WaitEventTimeout(&event, static_cast<int>(timeout.count()))) {
+        HandleEvent(event);
+    }
+    UpdateTitle();
+}
+
+void EmuWindow_SDL2::OnFrameDisplayed() {
+    input_subsystem->GetTas()->UpdateThread();
+}
+
+void EmuWindow_SDL2::HandleEvent(const SDL_Event& event) {
     switch (event.type) {
     case SDL_WINDOWEVENT:
         switch (event.window.event) {
@@ -219,7 +240,9 @@ void EmuWindow_SDL2::WaitEvent() {
     default:
         break;
     }
+}
 
+void EmuWindow_SDL2::UpdateTitle() {
     const u32 current_time = SDL_GetTicks();
     if (current_time > last_time + 2000) {
         const auto results = system.GetAndResetPerfStats();
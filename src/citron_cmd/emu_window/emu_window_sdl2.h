@@ -3,12 +3,14 @@
 
 #pragma once
 
+#include <chrono>
 #include <utility>
 
 #include "core/frontend/emu_window.h"
 #include "core/frontend/graphics_context.h"
 
 struct SDL_Window;
+union SDL_Event;
 
 namespace Core {
 class System;
@@ -33,10 +35,22 @@ public:
     /// Wait for the next event on the main thread.
     void WaitEvent();
 
+    /// Wait for the next event on the main thread, up to the given timeout.
+    void WaitEvent(std::chrono::milliseconds timeout);
+
+    /// Advances the TAS script by one frame.
+    void OnFrameDisplayed() override;
+
     // Sets the window icon from citron.bmp
     void SetWindowIcon();
 
 protected:
+    /// Dispatches an event received by WaitEvent to its handler.
+    void HandleEvent(const SDL_Event& event);
+
+    /// Called by WaitEvent to refresh the performance statistics in the window title.
+    void UpdateTitle();
+
     /// Called by WaitEvent when a key is pressed or released.
     void OnKeyEvent(int key, u8 state);
 
@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Common {
+
+/// Serializes trivially copyable values into a byte buffer in host byte order.
+class BinaryWriter {
+public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void Push(const T& value) {
+        PushBytes(std::span(reinterpret_cast<const u8*>(&value), sizeof(T)));
+    }
+
+    void PushBytes(std::span<const u8> bytes) {
+        buffer.insert(buffer.end(), bytes.begin(), bytes.end());
+    }
+
+    /// Pushes the number of elements as a u32, followed by the elements.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void PushArray(std::span<const T> values) {
+        Push(static_cast<u32>(values.size()));
+        PushBytes(std::span(reinterpret_cast<const u8*>(values.data()), values.size_bytes()));
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void Overwrite(size_t offset, const T& value) {
+        std::memcpy(buffer.data() + offset, &value, sizeof(T));
+    }
+
+    [[nodiscard]] size_t Size() const noexcept {
+        return buffer.size();
+    }
+
+    [[nodiscard]] std::vector<u8>& Buffer() noexcept {
+        return buffer;
+    }
+
+    [[nodiscard]] const std::vector<u8>& Buffer() const noexcept {
+        return buffer;
+    }
+
+private:
+    std::vector<u8> buffer;
+};
+
+/// Reads values written by BinaryWriter, every read fails instead of going past the end.
+class BinaryReader {
+public:
+    explicit BinaryReader(std::span<const u8> data_, size_t offset_ = 0)
+        : data{data_}, offset{offset_} {}
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    bool Pop(T& value) {
+        if (data.size() - offset < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    bool PopBytes(size_t size, std::span<const u8>& bytes) {
+        if (data.size() - offset < size) {
+            return false;
+        }
+        bytes = data.subspan(offset, size);
+        offset += size;
+        return true;
+    }
+
+    /// Reads an array written by PushArray.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    bool PopArray(std::vector<T>& values) {
+        u32 count{};
+        std::span<const u8> bytes;
+        if (!PopCount(count, sizeof(T)) || !PopBytes(count * sizeof(T), bytes)) {
+            return false;
+        }
+        values.resize(count);
+        std::memcpy(values.data(), bytes.data(), bytes.size());
+        return true;
+    }
+
+    /**
+     * Reads a number of elements that follow, failing when the rest of the data is too small to
+     * hold them. Checked before resizing containers, so corrupted counts can not allocate more
+     * than the data size.
+     * @param min_element_size Smallest serialized size of an element, at least one byte
+     */
+    bool PopCount(u32& count, size_t min_element_size) {
+        const size_t start = offset;
+        if (!Pop(count)) {
+            return false;
+        }
+        if ((data.size() - offset) / std::max<size_t>(min_element_size, 1) < count) {
+            offset = start;
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] size_t Offset() const noexcept {
+        return offset;
+    }
+
+    [[nodiscard]] bool IsEnd() const noexcept {
+        return offset == data.size();
+    }
+
+private:
+    std::span<const u8> data;
+    size_t offset;
+};
+
+} // namespace Common
@@ -0,0 +1,103 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/fs/file.h"
+#include "common/fs/mapped_file.h"
+#include "common/logging/log.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Common::FS {
+
+namespace {
+
+#ifdef _WIN32
+void* MapFile(const std::filesystem::path& path, size_t& size) {
+    const HANDLE file =
+        CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+                    OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return nullptr;
+    }
+    LARGE_INTEGER file_size{};
+    void* view = nullptr;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0) {
+        const HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping != nullptr) {
+            // The view keeps the mapping alive after its handle is closed
+            view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+    size = static_cast<size_t>(file_size.QuadPart);
+    return view;
+}
+
+void UnmapFile(void* view, [[maybe_unused]] size_t size) {
+    UnmapViewOfFile(view);
+}
+#else
+void* MapFile(const std::filesystem::path& path, size_t& size) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1) {
+        return nullptr;
+    }
+    struct stat status {};
+    void* view = nullptr;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+        size = static_cast<size_t>(status.st_size);
+        view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            view = nullptr;
+        }
+    }
+    // The mapping keeps a reference to the file after its descriptor is closed
+    close(fd);
+    return view;
+}
+
+void UnmapFile(void* view, size_t size) {
+    munmap(view, size);
+}
+#endif
+
+} // Anonymous namespace
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    size_t size = 0;
+    mapping = MapFile(path, size);
+    if (mapping) {
+        data = std::span(static_cast<const u8*>(mapping), size);
+        is_open = true;
+        return;
+    }
+    // Empty files cannot be mapped, and some filesystems do not support it at all
+    const IOFile file{path, FileAccessMode::Read, FileType::BinaryFile};
+    if (!file.IsOpen()) {
+        return;
+    }
+    buffer.resize(file.GetSize());
+    if (file.ReadSpan(std::span(buffer)) != buffer.size()) {
+        LOG_ERROR(Common_Filesystem, "Failed to read the file {}", PathToUTF8String(path));
+        buffer.clear();
+        return;
+    }
+    data = buffer;
+    is_open = true;
+}
+
+MappedFile::~MappedFile() {
+    if (mapping) {
+        UnmapFile(mapping, data.size());
+    }
+}
+
+} // namespace Common::FS
@@ -0,0 +1,44 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Common::FS {
+
+/**
+ * Read-only view of the contents of a file, memory mapped when the platform allows it so that
+ * only the parts that are accessed are read from the disk.
+ * When the file cannot be mapped, its contents are read into memory instead.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Returns true when the file could be opened.
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return is_open;
+    }
+
+    /// Returns the contents of the file, empty when it could not be opened.
+    [[nodiscard]] std::span<const u8> Data() const noexcept {
+        return data;
+    }
+
+private:
+    std::span<const u8> data;
+    std::vector<u8> buffer;
+    void* mapping{};
+    bool is_open{};
+};
+
+} // namespace Common::FS
@@ -62,6 +62,7 @@ SWITCHABLE(AntiAliasing, false);
 SWITCHABLE(AspectRatio, true);
 SWITCHABLE(AstcDecodeMode, true);
 SWITCHABLE(AstcRecompression, true);
+SWITCHABLE(AstcRecompressionQuality, true);
 SWITCHABLE(AudioMode, true);
 SWITCHABLE(CpuBackend, true);
 SWITCHABLE(CpuAccuracy, true);
@@ -384,6 +385,22 @@ struct Values {
                                                                   AstcRecompression::Bc3,
                                                                   "astc_recompression",
                                                                   Category::RendererAdvanced};
+    SwitchableSetting<AstcRecompressionQuality, true> astc_recompression_quality{
+        linkage,
+        AstcRecompressionQuality::Normal,
+        AstcRecompressionQuality::Fast,
+        AstcRecompressionQuality::High,
+        "astc_recompression_quality",
+        Category::RendererAdvanced};
+    SwitchableSetting<bool> use_disk_texture_cache{linkage, true, "use_disk_texture_cache",
+                                                   Category::RendererAdvanced};
+    SwitchableSetting<u16, true> disk_texture_cache_size{linkage,
+                                                         1024,
+                                                         64,
+                                                         16384,
+                                                         "disk_texture_cache_size",
+                                                         Category::RendererAdvanced,
+                                                         Specialization::Countable};
     SwitchableSetting<VramUsageMode, true> vram_usage_mode{linkage,
                                                            VramUsageMode::Conservative,
                                                            VramUsageMode::Conservative,
@@ -409,6 +426,14 @@ struct Values {
                                                   Category::RendererAdvanced};
     SwitchableSetting<bool> use_asynchronous_shaders{linkage, false, "use_asynchronous_shaders",
                                                      Category::RendererAdvanced};
+    SwitchableSetting<bool> use_pipelined_gpu{linkage, false, "use_pipelined_gpu",
+                                              Category::RendererAdvanced};
+    SwitchableSetting<bool> use_draw_coalescing{linkage, true, "use_draw_coalescing",
+                                                Category::RendererAdvanced};
+    SwitchableSetting<bool> use_shader_value_numbering{linkage, true, "use_shader_value_numbering",
+                                                       Category::RendererAdvanced};
+    SwitchableSetting<bool> use_shader_code_motion{linkage, true, "use_shader_code_motion",
+                                                   Category::RendererAdvanced};
     SwitchableSetting<bool> use_fast_gpu_time{
         linkage, true, "use_fast_gpu_time", Category::RendererAdvanced, Specialization::Default,
         true,    true};
@@ -591,6 +616,12 @@ struct Values {
                                     Category::DebuggingGraphics};
     Setting<bool> disable_macro_hle{linkage, false, "disable_macro_hle",
                                     Category::DebuggingGraphics};
+    Setting<bool> profile_macros{linkage, false, "profile_macros", Category::DebuggingGraphics,
+                                 Specialization::Default, false};
+    Setting<bool> record_macros{linkage, false, "record_macros", Category::DebuggingGraphics,
+                                Specialization::Default, false};
+    Setting<u16> gpu_capture_frames{linkage, 0, "gpu_capture_frames", Category::DebuggingGraphics,
+                                    Specialization::Default, false};
     Setting<bool> extended_logging{
         linkage, false, "extended_logging", Category::Debugging, Specialization::Default, false};
     Setting<bool> use_debug_asserts{linkage, false, "use_debug_asserts", Category::Debugging};
@@ -120,6 +120,8 @@ ENUM(AstcDecodeMode, Cpu, Gpu, CpuAsynchronous);
 
 ENUM(AstcRecompression, Uncompressed, Bc1, Bc3);
 
+ENUM(AstcRecompressionQuality, Fast, Normal, High);
+
 ENUM(VSyncMode, Immediate, Mailbox, Fifo, FifoRelaxed);
 
 ENUM(VramUsageMode, Conservative, Aggressive);
@@ -2,6 +2,9 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <memory>
+#include <utility>
+#include <zdict.h>
 #include <zstd.h>
 
 #include "common/zstd_compression.h"
@@ -46,4 +49,64 @@ std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed) {
     return decompressed;
 }
 
+std::vector<u8> TrainDictionaryZSTD(std::span<const std::vector<u8>> samples,
+                                    std::size_t max_dictionary_size) {
+    std::vector<u8> buffer;
+    std::vector<std::size_t> sample_sizes;
+    sample_sizes.reserve(samples.size());
+    for (const std::vector<u8>& sample : samples) {
+        buffer.insert(buffer.end(), sample.begin(), sample.end());
+        sample_sizes.push_back(sample.size());
+    }
+    std::vector<u8> dictionary(max_dictionary_size);
+    const std::size_t dictionary_size =
+        ZDICT_trainFromBuffer(dictionary.data(), dictionary.size(), buffer.data(),
+                              sample_sizes.data(), static_cast<unsigned>(sample_sizes.size()));
+    if (ZDICT_isError(dictionary_size)) {
+        return {};
+    }
+    dictionary.resize(dictionary_size);
+    return dictionary;
+}
+
+ZSTDDictionary::ZSTDDictionary(std::vector<u8> data_)
+    : data{std::move(data_)},
+      compression_dictionary{ZSTD_createCDict(data.data(), data.size(), ZSTD_CLEVEL_DEFAULT)},
+      decompression_dictionary{ZSTD_createDDict(data.data(), data.size())} {}
+
+ZSTDDictionary::~ZSTDDictionary() {
+    ZSTD_freeCDict(compression_dictionary);
+    ZSTD_freeDDict(decompression_dictionary);
+}
+
+std::vector<u8> ZSTDDictionary::Compress(const u8* source, std::size_t source_size) const {
+    const std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context{ZSTD_createCCtx(),
+                                                                       ZSTD_freeCCtx};
+    std::vector<u8> compressed(ZSTD_compressBound(source_size));
+    const std::size_t compressed_size =
+        ZSTD_compress_usingCDict(context.get(), compressed.data(), compressed.size(), source,
+                                 source_size, compression_dictionary);
+    if (ZSTD_isError(compressed_size)) {
+        // Compression failed
+        return {};
+    }
+    compressed.resize(compressed_size);
+    return compressed;
+}
+
+std::vector<u8> ZSTDDictionary::Decompress(std::span<const u8> compressed,
+                                           std::size_t expected_size) const {
+    const std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context{ZSTD_createDCtx(),
+                                                                       ZSTD_freeDCtx};
+    std::vector<u8> decompressed(expected_size);
+    const std::size_t decompressed_size =
+        ZSTD_decompress_usingDDict(context.get(), decompressed.data(), decompressed.size(),
+                                   compressed.data(), compressed.size(), decompression_dictionary);
+    if (ZSTD_isError(decompressed_size) || decompressed_size != expected_size) {
+        // Decompression failed
+        return {};
+    }
+    return decompressed;
+}
+
 } // namespace Common::Compression
@@ -8,6 +8,9 @@
 
 #include "common/common_types.h"
 
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
 namespace Common::Compression {
 
 /**
@@ -42,4 +45,57 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed);
 
+/**
+ * Trains a Zstandard dictionary on samples of small payloads that share most of their structure.
+ *
+ * @param samples             The uncompressed samples.
+ * @param max_dictionary_size The maximum size of the dictionary.
+ *
+ * @return the dictionary, or an empty vector when the samples are not enough to train one.
+ */
+[[nodiscard]] std::vector<u8> TrainDictionaryZSTD(std::span<const std::vector<u8>> samples,
+                                                  std::size_t max_dictionary_size);
+
+/// Zstandard dictionary digested once to compress and decompress many payloads with it.
+/// It can be used from multiple threads at the same time.
+class ZSTDDictionary {
+public:
+    explicit ZSTDDictionary(std::vector<u8> data);
+    ~ZSTDDictionary();
+
+    ZSTDDictionary(const ZSTDDictionary&) = delete;
+    ZSTDDictionary& operator=(const ZSTDDictionary&) = delete;
+
+    /// Returns the dictionary as it was trained.
+    [[nodiscard]] std::span<const u8> Data() const noexcept {
+        return data;
+    }
+
+    /**
+     * Compresses a source memory region with the dictionary at the default compression level.
+     *
+     * @param source      The uncompressed source memory region.
+     * @param source_size The size of the uncompressed source memory region.
+     *
+     * @return the compressed data.
+     */
+    [[nodiscard]] std::vector<u8> Compress(const u8* source, std::size_t source_size) const;
+
+    /**
+     * Decompresses a source memory region compressed with the dictionary.
+     *
+     * @param compressed      The compressed source memory region.
+     * @param expected_size   The size of the uncompressed data.
+     *
+     * @return the decompressed data, or an empty vector when it does not have the expected size.
+     */
+    [[nodiscard]] std::vector<u8> Decompress(std::span<const u8> compressed,
+                                             std::size_t expected_size) const;
+
+private:
+    std::vector<u8> data;
+    ZSTD_CDict_s* compression_dictionary{};
+    ZSTD_DDict_s* decompression_dictionary{};
+};
+
 } // namespace Common::Compression
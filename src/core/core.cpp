@@ -398,6 +398,29 @@ struct System::Impl {
         return status;
     }
 
+    SystemResultStatus InitializeGPUReplay(System& system, Frontend::EmuWindow& emu_window) {
+        telemetry_session = std::make_unique<Core::TelemetrySession>();
+        host1x_core = std::make_unique<Tegra::Host1x::Host1x>(system);
+        gpu_core = VideoCore::CreateGPU(emu_window, system);
+        if (!gpu_core) {
+            return SystemResultStatus::ErrorVideoCore;
+        }
+        perf_stats = std::make_unique<PerfStats>(0);
+        is_powered_on = true;
+        return SystemResultStatus::Success;
+    }
+
+    void ShutdownGPUReplay() {
+        is_powered_on = false;
+        if (gpu_core != nullptr) {
+            gpu_core->NotifyShutdown();
+        }
+        gpu_core.reset();
+        host1x_core.reset();
+        perf_stats.reset();
+        telemetry_session.reset();
+    }
+
     void ShutdownMainProcess() {
         SetShuttingDown(true);
 
@@ -637,6 +660,14 @@ SystemResultStatus System::Load(Frontend::EmuWindow& emu_window, const std::stri
     return impl->Load(*this, emu_window, filepath, params);
 }
 
+SystemResultStatus System::InitializeGPUReplay(Frontend::EmuWindow& emu_window) {
+    return impl->InitializeGPUReplay(*this, emu_window);
+}
+
+void System::ShutdownGPUReplay() {
+    impl->ShutdownGPUReplay();
+}
+
 bool System::IsPoweredOn() const {
     return impl->is_powered_on.load(std::memory_order::relaxed);
 }
@@ -211,6 +211,17 @@ public:
                                           const std::string& filepath,
                                           Service::AM::FrontendAppletParameters& params);
 
+    /**
+     * Creates the GPU without loading an application, so captured GPU command streams can be
+     * replayed headless. The GPU is released by ShutdownGPUReplay.
+     * @param emu_window Reference to the host-system window used by the renderer.
+     * @returns SystemResultStatus code, indicating if the operation succeeded.
+     */
+    [[nodiscard]] SystemResultStatus InitializeGPUReplay(Frontend::EmuWindow& emu_window);
+
+    /// Releases the GPU created by InitializeGPUReplay.
+    void ShutdownGPUReplay();
+
     /**
      * Indicates if the emulated system is powered on (all subsystems initialized and able to run an
      * application).
@@ -53,6 +53,10 @@ public:
 
     void Unmap(DAddr address, size_t size);
 
+    /// Maps device pages straight to physical memory, for tools that run the GPU without a
+    /// guest process. Every physical page must be mapped once at most.
+    void MapPhysical(DAddr address, PAddr physical_address, size_t size);
+
     void TrackContinuityImpl(DAddr address, VAddr virtual_address, size_t size, Asid asid);
     void TrackContinuity(DAddr address, VAddr virtual_address, size_t size, Asid asid) {
         std::scoped_lock lk(mapping_guard);
@@ -68,6 +68,7 @@ void PerfStats::EndSystemFrame() {
     }
     accumulated_frametime += frame_time;
     system_frames += 1;
+    total_system_frames += 1;
 
     previous_frame_length = frame_end - previous_frame_end;
     previous_frame_end = frame_end;
@@ -89,6 +90,28 @@ double PerfStats::GetMeanFrametime() const {
     return sum / static_cast<double>(current_index - IgnoreFrames);
 }
 
+std::size_t PerfStats::GetFrameCount() const {
+    std::scoped_lock lock{object_mutex};
+
+    return current_index;
+}
+
+u64 PerfStats::GetSystemFrameCount() const {
+    std::scoped_lock lock{object_mutex};
+
+    return total_system_frames;
+}
+
+std::vector<double> PerfStats::GetFrameTimes(std::size_t first_frame) const {
+    std::scoped_lock lock{object_mutex};
+
+    const std::size_t first = std::max(first_frame, IgnoreFrames);
+    if (first >= current_index) {
+        return {};
+    }
+    return {perf_history.begin() + first, perf_history.begin() + current_index};
+}
+
 PerfStatsResults PerfStats::GetAndResetStats(microseconds current_system_time_us) {
     std::scoped_lock lock{object_mutex};
 
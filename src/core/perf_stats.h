@@ -8,6 +8,7 @@
 #include <chrono>
 #include <cstddef>
 #include <mutex>
+#include <vector>
 #include "common/common_types.h"
 
 namespace Core {
@@ -45,6 +46,17 @@ public:
      */
     double GetMeanFrametime() const;
 
+    /// Returns the number of system frames in the frame time history, which stops growing once
+    /// the history is full.
+    std::size_t GetFrameCount() const;
+
+    /// Returns the number of system frames presented since the creation of the statistics.
+    u64 GetSystemFrameCount() const;
+
+    /// Returns the system frame times in milliseconds from the given frame, skipping the frames
+    /// spent booting.
+    std::vector<double> GetFrameTimes(std::size_t first_frame) const;
+
     /**
      * Gets the ratio between walltime and the emulated time of the previous system frame. This is
      * useful for scaling inputs or outputs moving between the two time domains.
@@ -71,6 +83,8 @@ private:
     Clock::duration accumulated_frametime = Clock::duration::zero();
     /// Cumulative number of system frames (LCD VBlanks) presented since last reset
     u32 system_frames = 0;
+    /// Number of system frames presented since creation, never reset
+    u64 total_system_frames = 0;
     /// Cumulative number of game frames (GSP frame submissions) since last reset
     std::atomic<u32> game_frames = 0;
 
@@ -0,0 +1,271 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <utility>
+
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include "common/fs/file.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/k_process.h"
+#include "core/perf_stats.h"
+#include "core/tools/benchmark.h"
+#include "video_core/gpu.h"
+#include "video_core/shader_notify.h"
+
+#ifdef _WIN32
+#include <windows.h>
+
+#include <psapi.h>
+#include <tlhelp32.h>
+
+#include "common/string_util.h"
+#else
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace Tools {
+namespace {
+
+using namespace nlohmann;
+
+#if defined(_WIN32)
+std::chrono::nanoseconds FileTimeToNanoseconds(const FILETIME& time) {
+    // FILETIME counts intervals of 100 nanoseconds
+    const u64 intervals = (static_cast<u64>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    return std::chrono::nanoseconds{intervals * 100};
+}
+
+std::vector<ThreadTime> GetThreadTimes() {
+    std::vector<ThreadTime> threads;
+    const HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return threads;
+    }
+    const DWORD process_id = GetCurrentProcessId();
+    THREADENTRY32 entry{.dwSize = sizeof(THREADENTRY32)};
+    for (BOOL found = Thread32First(snapshot, &entry); found;
+         found = Thread32Next(snapshot, &entry)) {
+        if (entry.th32OwnerProcessID != process_id) {
+            continue;
+        }
+        const HANDLE thread = OpenThread(THREAD_QUERY_LIMITED_INFORMATION, FALSE,
+                                         entry.th32ThreadID);
+        if (thread == nullptr) {
+            continue;
+        }
+        FILETIME creation_time, exit_time, kernel_time, user_time;
+        if (::GetThreadTimes(thread, &creation_time, &exit_time, &kernel_time, &user_time)) {
+            ThreadTime& time = threads.emplace_back();
+            time.id = entry.th32ThreadID;
+            time.cpu_time =
+                FileTimeToNanoseconds(kernel_time) + FileTimeToNanoseconds(user_time);
+            PWSTR description = nullptr;
+            if (SUCCEEDED(GetThreadDescription(thread, &description))) {
+                time.name = Common::UTF16ToUTF8(description);
+                LocalFree(description);
+            }
+        }
+        CloseHandle(thread);
+    }
+    CloseHandle(snapshot);
+    return threads;
+}
+
+u64 GetPeakResidentSetSize() {
+    PROCESS_MEMORY_COUNTERS counters{};
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
+    }
+    return counters.PeakWorkingSetSize;
+}
+#else
+#if defined(__linux__)
+std::vector<ThreadTime> GetThreadTimes() {
+    std::vector<ThreadTime> threads;
+    const long ticks_per_second = sysconf(_SC_CLK_TCK);
+    std::error_code ec;
+    for (const auto& task : std::filesystem::directory_iterator{"/proc/self/task", ec}) {
+        const std::string stat = Common::FS::ReadStringFromFile(
+            task.path() / "stat", Common::FS::FileType::TextFile);
+        // The thread name may contain spaces and parentheses, the fields start after the last
+        // parenthesis with the state, which is the third field
+        const std::size_t fields_begin = stat.rfind(')');
+        if (fields_begin == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields{stat.substr(fields_begin + 1)};
+        std::string field;
+        // utime and stime are the 14th and 15th fields
+        for (int index = 3; index < 14; ++index) {
+            fields >> field;
+        }
+        u64 user_ticks{};
+        u64 system_ticks{};
+        if (!(fields >> user_ticks >> system_ticks)) {
+            continue;
+        }
+        std::string name = Common::FS::ReadStringFromFile(task.path() / "comm",
+                                                          Common::FS::FileType::TextFile);
+        if (!name.empty() && name.back() == '\n') {
+            name.pop_back();
+        }
+        ThreadTime& time = threads.emplace_back();
+        time.id = std::strtoull(task.path().filename().c_str(), nullptr, 10);
+        time.name = std::move(name);
+        time.cpu_time = std::chrono::nanoseconds{(user_ticks + system_ticks) * 1'000'000'000 /
+                                                 static_cast<u64>(ticks_per_second)};
+    }
+    return threads;
+}
+#else
+std::vector<ThreadTime> GetThreadTimes() {
+    // There is no portable way to enumerate the threads of the process
+    return {};
+}
+#endif
+
+u64 GetPeakResidentSetSize() {
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<u64>(usage.ru_maxrss);
+#else
+    // Reported in kilobytes everywhere else
+    return static_cast<u64>(usage.ru_maxrss) * 1024;
+#endif
+}
+#endif
+
+double Seconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration<double>(time).count();
+}
+
+/// Returns the given percentile of sorted samples, using the nearest rank.
+double Percentile(const std::vector<double>& sorted, double percentile) {
+    const double rank = std::ceil(percentile / 100.0 * static_cast<double>(sorted.size()));
+    const std::size_t index = static_cast<std::size_t>(std::max(rank, 1.0)) - 1;
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+json FrameTimeStatistics(std::vector<double> frame_times) {
+    if (frame_times.empty()) {
+        return json::object();
+    }
+    std::ranges::sort(frame_times);
+    const double sum = std::accumulate(frame_times.begin(), frame_times.end(), 0.0);
+    return {
+        {"mean", sum / static_cast<double>(frame_times.size())},
+        {"min", frame_times.front()},
+        {"p50", Percentile(frame_times, 50.0)},
+        {"p90", Percentile(frame_times, 90.0)},
+        {"p99", Percentile(frame_times, 99.0)},
+        {"max", frame_times.back()},
+    };
+}
+
+json ThreadStatistics(const std::vector<ThreadTime>& start_threads,
+                      const std::vector<ThreadTime>& end_threads) {
+    json threads = json::array();
+    for (const ThreadTime& thread : end_threads) {
+        // Threads created during the run started from zero
+        std::chrono::nanoseconds cpu_time = thread.cpu_time;
+        const auto it = std::ranges::find(start_threads, thread.id, &ThreadTime::id);
+        if (it != start_threads.end()) {
+            cpu_time -= it->cpu_time;
+        }
+        threads.push_back({
+            {"id", thread.id},
+            {"name", thread.name},
+            {"cpu_time_s", Seconds(cpu_time)},
+        });
+    }
+    return threads;
+}
+
+} // Anonymous namespace
+
+Benchmark::Benchmark(Core::System& system_, std::string output_path_,
+                     std::optional<std::chrono::seconds> duration_,
+                     std::optional<std::size_t> num_frames_)
+    : system{system_}, output_path{std::move(output_path_)}, duration{duration_},
+      num_frames{num_frames_} {}
+
+Benchmark::~Benchmark() = default;
+
+void Benchmark::Start() {
+    start_time = std::chrono::steady_clock::now();
+    start_emulated_time = system.CoreTiming().GetGlobalTimeUs();
+    start_frame = system.GetPerfStats().GetSystemFrameCount();
+    start_history_frame = system.GetPerfStats().GetFrameCount();
+    start_shaders = system.GPU().ShaderNotify().ShadersCompleted();
+    start_threads = GetThreadTimes();
+}
+
+bool Benchmark::IsDone() const {
+    if (duration && std::chrono::steady_clock::now() - start_time >= *duration) {
+        return true;
+    }
+    // The frame time history stops growing after an hour, count the frames presented instead
+    return num_frames && system.GetPerfStats().GetSystemFrameCount() - start_frame >= *num_frames;
+}
+
+void Benchmark::Finish() {
+    if (is_finished.exchange(true)) {
+        return;
+    }
+    const auto wall_time = std::chrono::steady_clock::now() - start_time;
+    const auto emulated_time = system.CoreTiming().GetGlobalTimeUs() - start_emulated_time;
+    const u64 frames = system.GetPerfStats().GetSystemFrameCount() - start_frame;
+    const Kernel::KProcess* const process = system.ApplicationProcess();
+    const std::vector<ThreadTime> end_threads = GetThreadTimes();
+    const double wall_seconds = Seconds(wall_time);
+
+    const json results{
+        {"title_id", fmt::format("{:016X}", process ? process->GetProgramId() : 0)},
+        {"renderer", Settings::values.renderer_backend.Canonicalize()},
+        {"duration_s", wall_seconds},
+        {"frames", frames},
+        {"fps", wall_seconds > 0.0 ? static_cast<double>(frames) / wall_seconds : 0.0},
+        {"emulation_speed", wall_seconds > 0.0 ? Seconds(emulated_time) / wall_seconds : 0.0},
+        {"frame_time_ms",
+         FrameTimeStatistics(system.GetPerfStats().GetFrameTimes(start_history_frame))},
+        {"threads", ThreadStatistics(start_threads, end_threads)},
+        {"shaders_compiled", system.GPU().ShaderNotify().ShadersCompleted() - start_shaders},
+        {"peak_rss_bytes", GetPeakResidentSetSize()},
+    };
+
+    if (output_path == "-") {
+        std::cout << std::setw(4) << results << std::endl;
+        return;
+    }
+    const std::filesystem::path path{output_path};
+    std::ofstream file;
+    Common::FS::OpenFileStream(file, path, std::ios_base::out | std::ios_base::trunc);
+    if (!file) {
+        LOG_ERROR(Frontend, "Failed to open {} to write the benchmark results",
+                  Common::FS::PathToUTF8String(path));
+        return;
+    }
+    file << std::setw(4) << results << std::endl;
+    LOG_INFO(Frontend, "Wrote the benchmark results to {}", Common::FS::PathToUTF8String(path));
+}
+
+} // namespace Tools
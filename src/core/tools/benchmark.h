@@ -0,0 +1,72 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Core {
+class System;
+}
+
+namespace Tools {
+
+/// CPU time consumed by a host thread, identified by its id and name.
+struct ThreadTime {
+    u64 id{};
+    std::string name;
+    std::chrono::nanoseconds cpu_time{};
+};
+
+/**
+ * Measures a run of the emulated title and writes the results as JSON: the system frame time
+ * distribution, the emulation speed, the CPU time of each host thread, the number of pipelines
+ * built and the peak resident set size of the process.
+ *
+ * Measurements start when Start is called, so loading and booting the title is not included.
+ */
+class Benchmark {
+public:
+    /**
+     * @param system_        System running the title
+     * @param output_path_   File the results are written to, "-" for the standard output
+     * @param duration_      Wall time to run for, if any
+     * @param num_frames_    Number of system frames to run for, if any
+     */
+    explicit Benchmark(Core::System& system_, std::string output_path_,
+                       std::optional<std::chrono::seconds> duration_,
+                       std::optional<std::size_t> num_frames_);
+    ~Benchmark();
+
+    /// Takes the initial measurements, called once the title is running.
+    void Start();
+
+    /// Returns true once the duration or the number of frames has been reached.
+    [[nodiscard]] bool IsDone() const;
+
+    /// Takes the final measurements and writes the results, only the first call has an effect.
+    void Finish();
+
+private:
+    Core::System& system;
+    std::string output_path;
+    std::optional<std::chrono::seconds> duration;
+    std::optional<std::size_t> num_frames;
+
+    std::atomic_bool is_finished{};
+    std::chrono::steady_clock::time_point start_time;
+    std::chrono::microseconds start_emulated_time{};
+    u64 start_frame{};
+    std::size_t start_history_frame{};
+    int start_shaders{};
+    std::vector<ThreadTime> start_threads;
+};
+
+} // namespace Tools
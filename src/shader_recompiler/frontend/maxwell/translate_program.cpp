@@ -304,6 +304,12 @@ IR::Program TranslateProgram(ObjectPool<IR::Inst>& inst_pool, ObjectPool<IR::Blo
     if (Settings::values.resolution_info.active) {
         Optimization::RescalingPass(program);
     }
+    if (Settings::values.use_shader_code_motion.GetValue()) {
+        Optimization::LoopInvariantCodeMotionPass(program);
+    }
+    if (Settings::values.use_shader_value_numbering.GetValue()) {
+        Optimization::GlobalValueNumberingPass(program);
+    }
     Optimization::DeadCodeEliminationPass(program);
     if (Settings::values.renderer_debug) {
         Optimization::VerificationPass(program);
@@ -0,0 +1,506 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+#include "common/bit_cast.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/value.h"
+#include "shader_recompiler/ir_opt/passes.h"
+
+namespace Shader::Optimization {
+namespace {
+std::atomic<u64> num_shaders;
+std::atomic<u64> num_instructions_before;
+std::atomic<u64> num_instructions_after;
+
+/// Opcode, flags and resolved arguments of an instruction, equal for redundant instructions
+struct Expression {
+    IR::Opcode opcode{};
+    u32 flags{};
+    size_t num_args{};
+    std::array<IR::Value, 5> args{};
+
+    bool operator==(const Expression& other) const {
+        return opcode == other.opcode && flags == other.flags && num_args == other.num_args &&
+               std::equal(args.begin(), args.begin() + num_args, other.args.begin());
+    }
+};
+
+size_t HashValue(const IR::Value& value) {
+    if (!value.IsImmediate()) {
+        return std::hash<const IR::Inst*>{}(value.InstRecursive());
+    }
+    const IR::Type type{value.Type()};
+    const size_t type_hash{static_cast<size_t>(type) << 48};
+    switch (type) {
+    case IR::Type::Reg:
+        return type_hash ^ static_cast<size_t>(value.Reg());
+    case IR::Type::Pred:
+        return type_hash ^ static_cast<size_t>(value.Pred());
+    case IR::Type::Attribute:
+        return type_hash ^ static_cast<size_t>(value.Attribute());
+    case IR::Type::Patch:
+        return type_hash ^ static_cast<size_t>(value.Patch());
+    case IR::Type::U1:
+        return type_hash ^ static_cast<size_t>(value.U1());
+    case IR::Type::U8:
+        return type_hash ^ value.U8();
+    case IR::Type::U16:
+    case IR::Type::F16:
+        return type_hash ^ value.U16();
+    case IR::Type::U32:
+        return type_hash ^ value.U32();
+    case IR::Type::F32:
+        return type_hash ^ Common::BitCast<u32>(value.F32());
+    case IR::Type::U64:
+        return type_hash ^ static_cast<size_t>(value.U64());
+    case IR::Type::F64:
+        return type_hash ^ static_cast<size_t>(Common::BitCast<u64>(value.F64()));
+    default:
+        return type_hash;
+    }
+}
+
+struct ExpressionHash {
+    size_t operator()(const Expression& expression) const noexcept {
+        size_t hash{static_cast<size_t>(expression.opcode) ^
+                    (static_cast<size_t>(expression.flags) << 16)};
+        for (size_t index = 0; index < expression.num_args; ++index) {
+            hash = hash * 0x9E3779B97F4A7C15ULL + HashValue(expression.args[index]);
+        }
+        return hash;
+    }
+};
+
+bool IsCommutative(IR::Opcode opcode) {
+    switch (opcode) {
+    case IR::Opcode::IAdd32:
+    case IR::Opcode::IAdd64:
+    case IR::Opcode::IMul32:
+    case IR::Opcode::BitwiseAnd32:
+    case IR::Opcode::BitwiseOr32:
+    case IR::Opcode::BitwiseXor32:
+    case IR::Opcode::SMin32:
+    case IR::Opcode::UMin32:
+    case IR::Opcode::SMax32:
+    case IR::Opcode::UMax32:
+    case IR::Opcode::IEqual:
+    case IR::Opcode::INotEqual:
+    case IR::Opcode::LogicalOr:
+    case IR::Opcode::LogicalAnd:
+    case IR::Opcode::LogicalXor:
+    case IR::Opcode::FPAdd16:
+    case IR::Opcode::FPAdd32:
+    case IR::Opcode::FPAdd64:
+    case IR::Opcode::FPMul16:
+    case IR::Opcode::FPMul32:
+    case IR::Opcode::FPMul64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+Expression MakeExpression(const IR::Inst& inst) {
+    Expression expression{
+        .opcode = inst.GetOpcode(),
+        .flags = inst.Flags<u32>(),
+        .num_args = inst.NumArgs(),
+    };
+    for (size_t index = 0; index < expression.num_args; ++index) {
+        expression.args[index] = inst.Arg(index).Resolve();
+    }
+    if (IsCommutative(expression.opcode) &&
+        HashValue(expression.args[1]) < HashValue(expression.args[0])) {
+        std::swap(expression.args[0], expression.args[1]);
+    }
+    return expression;
+}
+
+size_t CountInstructions(const IR::Program& program) {
+    size_t count{};
+    for (const IR::Block* const block : program.blocks) {
+        count += static_cast<size_t>(std::ranges::count_if(*block, [](const IR::Inst& inst) {
+            return inst.GetOpcode() != IR::Opcode::Identity && inst.GetOpcode() != IR::Opcode::Void;
+        }));
+    }
+    return count;
+}
+
+/// Builds the children of each block in the dominator tree, blocks are indexed in post order
+std::vector<boost::container::small_vector<size_t, 2>> DominatorTree(const IR::Program& program) {
+    const IR::BlockList& blocks{program.post_order_blocks};
+    std::unordered_map<const IR::Block*, size_t> post_order_index;
+    for (size_t index = 0; index < blocks.size(); ++index) {
+        post_order_index.emplace(blocks[index], index);
+    }
+    // Iterative algorithm from "A Simple, Fast Dominance Algorithm" by Cooper, Harvey and Kennedy
+    constexpr size_t UNDEFINED{~size_t{0}};
+    const size_t entry{blocks.size() - 1};
+    std::vector<size_t> idoms(blocks.size(), UNDEFINED);
+    idoms[entry] = entry;
+    const auto intersect{[&idoms](size_t lhs, size_t rhs) {
+        while (lhs != rhs) {
+            while (lhs < rhs) {
+                lhs = idoms[lhs];
+            }
+            while (rhs < lhs) {
+                rhs = idoms[rhs];
+            }
+        }
+        return lhs;
+    }};
+    bool changed{true};
+    while (changed) {
+        changed = false;
+        for (size_t index = entry; index-- > 0;) {
+            size_t new_idom{UNDEFINED};
+            for (const IR::Block* const predecessor : blocks[index]->ImmPredecessors()) {
+                const auto it{post_order_index.find(predecessor)};
+                if (it == post_order_index.end() || idoms[it->second] == UNDEFINED) {
+                    continue;
+                }
+                new_idom = new_idom == UNDEFINED ? it->second : intersect(it->second, new_idom);
+            }
+            if (new_idom != idoms[index]) {
+                idoms[index] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    std::vector<boost::container::small_vector<size_t, 2>> children(blocks.size());
+    for (size_t index = 0; index < entry; ++index) {
+        if (idoms[index] != UNDEFINED) {
+            children[idoms[index]].push_back(index);
+        }
+    }
+    return children;
+}
+} // Anonymous namespace
+
+bool IsPureInstruction(const IR::Inst& inst) {
+    if (inst.MayHaveSideEffects() || inst.IsPseudoInstruction()) {
+        return false;
+    }
+    switch (inst.GetOpcode()) {
+    // Constant buffer reads
+    case IR::Opcode::GetCbufU8:
+    case IR::Opcode::GetCbufS8:
+    case IR::Opcode::GetCbufU16:
+    case IR::Opcode::GetCbufS16:
+    case IR::Opcode::GetCbufU32:
+    case IR::Opcode::GetCbufF32:
+    case IR::Opcode::GetCbufU32x2:
+    // Composites
+    case IR::Opcode::CompositeConstructU32x2:
+    case IR::Opcode::CompositeExtractU32x2:
+    case IR::Opcode::CompositeInsertU32x2:
+    case IR::Opcode::CompositeConstructU32x3:
+    case IR::Opcode::CompositeExtractU32x3:
+    case IR::Opcode::CompositeInsertU32x3:
+    case IR::Opcode::CompositeConstructU32x4:
+    case IR::Opcode::CompositeExtractU32x4:
+    case IR::Opcode::CompositeInsertU32x4:
+    case IR::Opcode::CompositeConstructF16x2:
+    case IR::Opcode::CompositeExtractF16x2:
+    case IR::Opcode::CompositeInsertF16x2:
+    case IR::Opcode::CompositeConstructF16x3:
+    case IR::Opcode::CompositeExtractF16x3:
+    case IR::Opcode::CompositeInsertF16x3:
+    case IR::Opcode::CompositeConstructF16x4:
+    case IR::Opcode::CompositeExtractF16x4:
+    case IR::Opcode::CompositeInsertF16x4:
+    case IR::Opcode::CompositeConstructF32x2:
+    case IR::Opcode::CompositeExtractF32x2:
+    case IR::Opcode::CompositeInsertF32x2:
+    case IR::Opcode::CompositeConstructF32x3:
+    case IR::Opcode::CompositeExtractF32x3:
+    case IR::Opcode::CompositeInsertF32x3:
+    case IR::Opcode::CompositeConstructF32x4:
+    case IR::Opcode::CompositeExtractF32x4:
+    case IR::Opcode::CompositeInsertF32x4:
+    case IR::Opcode::CompositeConstructF64x2:
+    case IR::Opcode::CompositeExtractF64x2:
+    case IR::Opcode::CompositeInsertF64x2:
+    case IR::Opcode::CompositeConstructF64x3:
+    case IR::Opcode::CompositeExtractF64x3:
+    case IR::Opcode::CompositeInsertF64x3:
+    case IR::Opcode::CompositeConstructF64x4:
+    case IR::Opcode::CompositeExtractF64x4:
+    case IR::Opcode::CompositeInsertF64x4:
+    // Selects, bit casts and packing
+    case IR::Opcode::SelectU1:
+    case IR::Opcode::SelectU8:
+    case IR::Opcode::SelectU16:
+    case IR::Opcode::SelectU32:
+    case IR::Opcode::SelectU64:
+    case IR::Opcode::SelectF16:
+    case IR::Opcode::SelectF32:
+    case IR::Opcode::SelectF64:
+    case IR::Opcode::BitCastU16F16:
+    case IR::Opcode::BitCastU32F32:
+    case IR::Opcode::BitCastU64F64:
+    case IR::Opcode::BitCastF16U16:
+    case IR::Opcode::BitCastF32U32:
+    case IR::Opcode::BitCastF64U64:
+    case IR::Opcode::PackUint2x32:
+    case IR::Opcode::UnpackUint2x32:
+    case IR::Opcode::PackFloat2x16:
+    case IR::Opcode::UnpackFloat2x16:
+    case IR::Opcode::PackHalf2x16:
+    case IR::Opcode::UnpackHalf2x16:
+    case IR::Opcode::PackDouble2x32:
+    case IR::Opcode::UnpackDouble2x32:
+    // Floating point arithmetic and comparisons
+    case IR::Opcode::FPAbs16:
+    case IR::Opcode::FPAbs32:
+    case IR::Opcode::FPAbs64:
+    case IR::Opcode::FPAdd16:
+    case IR::Opcode::FPAdd32:
+    case IR::Opcode::FPAdd64:
+    case IR::Opcode::FPFma16:
+    case IR::Opcode::FPFma32:
+    case IR::Opcode::FPFma64:
+    case IR::Opcode::FPMax32:
+    case IR::Opcode::FPMax64:
+    case IR::Opcode::FPMin32:
+    case IR::Opcode::FPMin64:
+    case IR::Opcode::FPMul16:
+    case IR::Opcode::FPMul32:
+    case IR::Opcode::FPMul64:
+    case IR::Opcode::FPNeg16:
+    case IR::Opcode::FPNeg32:
+    case IR::Opcode::FPNeg64:
+    case IR::Opcode::FPRecip32:
+    case IR::Opcode::FPRecip64:
+    case IR::Opcode::FPRecipSqrt32:
+    case IR::Opcode::FPRecipSqrt64:
+    case IR::Opcode::FPSqrt:
+    case IR::Opcode::FPSin:
+    case IR::Opcode::FPExp2:
+    case IR::Opcode::FPCos:
+    case IR::Opcode::FPLog2:
+    case IR::Opcode::FPSaturate16:
+    case IR::Opcode::FPSaturate32:
+    case IR::Opcode::FPSaturate64:
+    case IR::Opcode::FPClamp16:
+    case IR::Opcode::FPClamp32:
+    case IR::Opcode::FPClamp64:
+    case IR::Opcode::FPRoundEven16:
+    case IR::Opcode::FPRoundEven32:
+    case IR::Opcode::FPRoundEven64:
+    case IR::Opcode::FPFloor16:
+    case IR::Opcode::FPFloor32:
+    case IR::Opcode::FPFloor64:
+    case IR::Opcode::FPCeil16:
+    case IR::Opcode::FPCeil32:
+    case IR::Opcode::FPCeil64:
+    case IR::Opcode::FPTrunc16:
+    case IR::Opcode::FPTrunc32:
+    case IR::Opcode::FPTrunc64:
+    case IR::Opcode::FPOrdEqual16:
+    case IR::Opcode::FPOrdEqual32:
+    case IR::Opcode::FPOrdEqual64:
+    case IR::Opcode::FPUnordEqual16:
+    case IR::Opcode::FPUnordEqual32:
+    case IR::Opcode::FPUnordEqual64:
+    case IR::Opcode::FPOrdNotEqual16:
+    case IR::Opcode::FPOrdNotEqual32:
+    case IR::Opcode::FPOrdNotEqual64:
+    case IR::Opcode::FPUnordNotEqual16:
+    case IR::Opcode::FPUnordNotEqual32:
+    case IR::Opcode::FPUnordNotEqual64:
+    case IR::Opcode::FPOrdLessThan16:
+    case IR::Opcode::FPOrdLessThan32:
+    case IR::Opcode::FPOrdLessThan64:
+    case IR::Opcode::FPUnordLessThan16:
+    case IR::Opcode::FPUnordLessThan32:
+    case IR::Opcode::FPUnordLessThan64:
+    case IR::Opcode::FPOrdGreaterThan16:
+    case IR::Opcode::FPOrdGreaterThan32:
+    case IR::Opcode::FPOrdGreaterThan64:
+    case IR::Opcode::FPUnordGreaterThan16:
+    case IR::Opcode::FPUnordGreaterThan32:
+    case IR::Opcode::FPUnordGreaterThan64:
+    case IR::Opcode::FPOrdLessThanEqual16:
+    case IR::Opcode::FPOrdLessThanEqual32:
+    case IR::Opcode::FPOrdLessThanEqual64:
+    case IR::Opcode::FPUnordLessThanEqual16:
+    case IR::Opcode::FPUnordLessThanEqual32:
+    case IR::Opcode::FPUnordLessThanEqual64:
+    case IR::Opcode::FPOrdGreaterThanEqual16:
+    case IR::Opcode::FPOrdGreaterThanEqual32:
+    case IR::Opcode::FPOrdGreaterThanEqual64:
+    case IR::Opcode::FPUnordGreaterThanEqual16:
+    case IR::Opcode::FPUnordGreaterThanEqual32:
+    case IR::Opcode::FPUnordGreaterThanEqual64:
+    case IR::Opcode::FPIsNan16:
+    case IR::Opcode::FPIsNan32:
+    case IR::Opcode::FPIsNan64:
+    // Integer arithmetic, bitwise operations and comparisons
+    case IR::Opcode::IAdd32:
+    case IR::Opcode::IAdd64:
+    case IR::Opcode::ISub32:
+    case IR::Opcode::ISub64:
+    case IR::Opcode::IMul32:
+    case IR::Opcode::SDiv32:
+    case IR::Opcode::UDiv32:
+    case IR::Opcode::INeg32:
+    case IR::Opcode::INeg64:
+    case IR::Opcode::IAbs32:
+    case IR::Opcode::ShiftLeftLogical32:
+    case IR::Opcode::ShiftLeftLogical64:
+    case IR::Opcode::ShiftRightLogical32:
+    case IR::Opcode::ShiftRightLogical64:
+    case IR::Opcode::ShiftRightArithmetic32:
+    case IR::Opcode::ShiftRightArithmetic64:
+    case IR::Opcode::BitwiseAnd32:
+    case IR::Opcode::BitwiseOr32:
+    case IR::Opcode::BitwiseXor32:
+    case IR::Opcode::BitFieldInsert:
+    case IR::Opcode::BitFieldSExtract:
+    case IR::Opcode::BitFieldUExtract:
+    case IR::Opcode::BitReverse32:
+    case IR::Opcode::BitCount32:
+    case IR::Opcode::BitwiseNot32:
+    case IR::Opcode::FindSMsb32:
+    case IR::Opcode::FindUMsb32:
+    case IR::Opcode::SMin32:
+    case IR::Opcode::UMin32:
+    case IR::Opcode::SMax32:
+    case IR::Opcode::UMax32:
+    case IR::Opcode::SClamp32:
+    case IR::Opcode::UClamp32:
+    case IR::Opcode::SLessThan:
+    case IR::Opcode::ULessThan:
+    case IR::Opcode::IEqual:
+    case IR::Opcode::SLessThanEqual:
+    case IR::Opcode::ULessThanEqual:
+    case IR::Opcode::SGreaterThan:
+    case IR::Opcode::UGreaterThan:
+    case IR::Opcode::INotEqual:
+    case IR::Opcode::SGreaterThanEqual:
+    case IR::Opcode::UGreaterThanEqual:
+    case IR::Opcode::LogicalOr:
+    case IR::Opcode::LogicalAnd:
+    case IR::Opcode::LogicalXor:
+    case IR::Opcode::LogicalNot:
+    // Conversions
+    case IR::Opcode::ConvertS16F16:
+    case IR::Opcode::ConvertS16F32:
+    case IR::Opcode::ConvertS16F64:
+    case IR::Opcode::ConvertS32F16:
+    case IR::Opcode::ConvertS32F32:
+    case IR::Opcode::ConvertS32F64:
+    case IR::Opcode::ConvertS64F16:
+    case IR::Opcode::ConvertS64F32:
+    case IR::Opcode::ConvertS64F64:
+    case IR::Opcode::ConvertU16F16:
+    case IR::Opcode::ConvertU16F32:
+    case IR::Opcode::ConvertU16F64:
+    case IR::Opcode::ConvertU32F16:
+    case IR::Opcode::ConvertU32F32:
+    case IR::Opcode::ConvertU32F64:
+    case IR::Opcode::ConvertU64F16:
+    case IR::Opcode::ConvertU64F32:
+    case IR::Opcode::ConvertU64F64:
+    case IR::Opcode::ConvertU64U32:
+    case IR::Opcode::ConvertU32U64:
+    case IR::Opcode::ConvertF16F32:
+    case IR::Opcode::ConvertF32F16:
+    case IR::Opcode::ConvertF32F64:
+    case IR::Opcode::ConvertF64F32:
+    case IR::Opcode::ConvertF16S8:
+    case IR::Opcode::ConvertF16S16:
+    case IR::Opcode::ConvertF16S32:
+    case IR::Opcode::ConvertF16S64:
+    case IR::Opcode::ConvertF16U8:
+    case IR::Opcode::ConvertF16U16:
+    case IR::Opcode::ConvertF16U32:
+    case IR::Opcode::ConvertF16U64:
+    case IR::Opcode::ConvertF32S8:
+    case IR::Opcode::ConvertF32S16:
+    case IR::Opcode::ConvertF32S32:
+    case IR::Opcode::ConvertF32S64:
+    case IR::Opcode::ConvertF32U8:
+    case IR::Opcode::ConvertF32U16:
+    case IR::Opcode::ConvertF32U32:
+    case IR::Opcode::ConvertF32U64:
+    case IR::Opcode::ConvertF64S8:
+    case IR::Opcode::ConvertF64S16:
+    case IR::Opcode::ConvertF64S32:
+    case IR::Opcode::ConvertF64S64:
+    case IR::Opcode::ConvertF64U8:
+    case IR::Opcode::ConvertF64U16:
+    case IR::Opcode::ConvertF64U32:
+    case IR::Opcode::ConvertF64U64:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void GlobalValueNumberingPass(IR::Program& program) {
+    if (program.post_order_blocks.empty()) {
+        return;
+    }
+    const size_t instructions_before{CountInstructions(program)};
+    const auto children{DominatorTree(program)};
+
+    // Walk the dominator tree, expressions are available in the blocks their instruction
+    // dominates and removed from the table when the walk leaves the block
+    std::unordered_map<Expression, IR::Inst*, ExpressionHash> available;
+    std::vector<std::vector<const Expression*>> scopes;
+    std::vector<std::pair<size_t, size_t>> stack{{program.post_order_blocks.size() - 1, 0}};
+    scopes.emplace_back();
+    while (!stack.empty()) {
+        auto& [block_index, child_index] = stack.back();
+        if (child_index == 0) {
+            for (IR::Inst& inst : *program.post_order_blocks[block_index]) {
+                if (!IsPureInstruction(inst)) {
+                    continue;
+                }
+                const auto [it, is_new] = available.try_emplace(MakeExpression(inst), &inst);
+                if (is_new) {
+                    scopes.back().push_back(&it->first);
+                } else if (!inst.HasAssociatedPseudoOperation()) {
+                    inst.ReplaceUsesWith(IR::Value{it->second});
+                }
+            }
+        }
+        if (child_index < children[block_index].size()) {
+            const size_t child{children[block_index][child_index]};
+            ++child_index;
+            stack.emplace_back(child, 0);
+            scopes.emplace_back();
+            continue;
+        }
+        for (const Expression* const expression : scopes.back()) {
+            available.erase(available.find(*expression));
+        }
+        scopes.pop_back();
+        stack.pop_back();
+    }
+    num_shaders.fetch_add(1, std::memory_order_relaxed);
+    num_instructions_before.fetch_add(instructions_before, std::memory_order_relaxed);
+    num_instructions_after.fetch_add(CountInstructions(program), std::memory_order_relaxed);
+}
+
+ValueNumberingStatistics GetAndResetValueNumberingStatistics() {
+    return {
+        .shaders = num_shaders.exchange(0, std::memory_order_relaxed),
+        .instructions_before = num_instructions_before.exchange(0, std::memory_order_relaxed),
+        .instructions_after = num_instructions_after.exchange(0, std::memory_order_relaxed),
+    };
+}
+
+} // namespace Shader::Optimization
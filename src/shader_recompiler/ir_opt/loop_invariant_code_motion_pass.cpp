@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/value.h"
+#include "shader_recompiler/ir_opt/passes.h"
+
+namespace Shader::Optimization {
+namespace {
+using InstBlockMap = std::unordered_map<const IR::Inst*, IR::Block*>;
+
+/// Returns the only block entering the loop from outside when it has no other successor
+IR::Block* Preheader(const IR::Block* header, const IR::Block* continue_block) {
+    IR::Block* preheader{};
+    for (IR::Block* const predecessor : header->ImmPredecessors()) {
+        if (predecessor == continue_block) {
+            continue;
+        }
+        if (preheader) {
+            return nullptr;
+        }
+        preheader = predecessor;
+    }
+    if (!preheader || preheader->ImmSuccessors().size() != 1) {
+        return nullptr;
+    }
+    return preheader;
+}
+
+bool IsInvariant(const IR::Inst& inst, const std::unordered_set<const IR::Block*>& loop_blocks,
+                 const InstBlockMap& inst_blocks) {
+    for (size_t index = 0; index < inst.NumArgs(); ++index) {
+        const IR::Value arg{inst.Arg(index).Resolve()};
+        if (arg.IsImmediate()) {
+            continue;
+        }
+        const auto it{inst_blocks.find(arg.Inst())};
+        if (it == inst_blocks.end() || loop_blocks.contains(it->second)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Hoists the invariant instructions of the loop between the syntax nodes of its header block and
+ * its repeat node. Only blocks executed on every iteration are visited, blocks inside conditionals
+ * and nested loops are left as they are. Nested loops are visited before, so their invariant
+ * instructions reach the blocks of this loop first.
+ */
+void HoistLoop(IR::Program& program, size_t header_index, size_t repeat_index,
+               InstBlockMap& inst_blocks) {
+    const IR::AbstractSyntaxList& syntax_list{program.syntax_list};
+    const IR::AbstractSyntaxNode& loop{syntax_list[header_index + 1]};
+    IR::Block* const header{syntax_list[repeat_index].data.repeat.loop_header};
+    if (syntax_list[header_index].type != IR::AbstractSyntaxNode::Type::Block ||
+        syntax_list[header_index].data.block != header) {
+        return;
+    }
+    IR::Block* const preheader{Preheader(header, loop.data.loop.continue_block)};
+    if (!preheader) {
+        return;
+    }
+    std::unordered_set<const IR::Block*> loop_blocks;
+    std::vector<IR::Block*> iteration_blocks;
+    size_t depth{};
+    for (size_t index = header_index; index < repeat_index; ++index) {
+        const IR::AbstractSyntaxNode& node{syntax_list[index]};
+        switch (node.type) {
+        case IR::AbstractSyntaxNode::Type::Block:
+            loop_blocks.insert(node.data.block);
+            if (depth == 0) {
+                iteration_blocks.push_back(node.data.block);
+            }
+            break;
+        case IR::AbstractSyntaxNode::Type::If:
+            ++depth;
+            break;
+        case IR::AbstractSyntaxNode::Type::EndIf:
+            --depth;
+            break;
+        case IR::AbstractSyntaxNode::Type::Loop:
+            if (index != header_index + 1) {
+                ++depth;
+            }
+            break;
+        case IR::AbstractSyntaxNode::Type::Repeat:
+            --depth;
+            break;
+        default:
+            break;
+        }
+    }
+    for (IR::Block* const block : iteration_blocks) {
+        IR::Block::InstructionList& instructions{block->Instructions()};
+        for (auto it = instructions.begin(); it != instructions.end();) {
+            IR::Inst& inst{*it};
+            ++it;
+            if (!IsPureInstruction(inst) || inst.HasAssociatedPseudoOperation() ||
+                !IsInvariant(inst, loop_blocks, inst_blocks)) {
+                continue;
+            }
+            // Identities may be defined inside the loop, reference their values instead
+            for (size_t index = 0; index < inst.NumArgs(); ++index) {
+                if (inst.Arg(index).IsIdentity()) {
+                    inst.SetArg(index, inst.Arg(index).Resolve());
+                }
+            }
+            instructions.erase(instructions.iterator_to(inst));
+            preheader->Instructions().push_back(inst);
+            inst_blocks[&inst] = preheader;
+        }
+    }
+}
+} // Anonymous namespace
+
+void LoopInvariantCodeMotionPass(IR::Program& program) {
+    const IR::AbstractSyntaxList& syntax_list{program.syntax_list};
+    if (std::ranges::none_of(syntax_list, [](const IR::AbstractSyntaxNode& node) {
+            return node.type == IR::AbstractSyntaxNode::Type::Loop;
+        })) {
+        return;
+    }
+    InstBlockMap inst_blocks;
+    for (IR::Block* const block : program.blocks) {
+        for (const IR::Inst& inst : *block) {
+            inst_blocks.emplace(&inst, block);
+        }
+    }
+    // Loops are hoisted when their repeat node is found, inner loops before outer loops
+    std::vector<size_t> loop_stack;
+    for (size_t index = 0; index < syntax_list.size(); ++index) {
+        switch (syntax_list[index].type) {
+        case IR::AbstractSyntaxNode::Type::Loop:
+            loop_stack.push_back(index);
+            break;
+        case IR::AbstractSyntaxNode::Type::Repeat:
+            if (!loop_stack.empty()) {
+                if (loop_stack.back() > 0) {
+                    HoistLoop(program, loop_stack.back() - 1, index, inst_blocks);
+                }
+                loop_stack.pop_back();
+            }
+            break;
+        default:
+            break;
+        }
+    }
+}
+
+} // namespace Shader::Optimization
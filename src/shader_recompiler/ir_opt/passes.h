@@ -12,15 +12,24 @@ struct HostTranslateInfo;
 
 namespace Shader::Optimization {
 
+/// Instructions counted by the value numbering pass, accumulated over the programs it optimized
+struct ValueNumberingStatistics {
+    u64 shaders{};
+    u64 instructions_before{};
+    u64 instructions_after{};
+};
+
 void CollectShaderInfoPass(Environment& env, IR::Program& program);
 void ConditionalBarrierPass(IR::Program& program);
 void ConstantPropagationPass(Environment& env, IR::Program& program);
 void DeadCodeEliminationPass(IR::Program& program);
 void GlobalMemoryToStorageBufferPass(IR::Program& program, const HostTranslateInfo& host_info);
+void GlobalValueNumberingPass(IR::Program& program);
 void IdentityRemovalPass(IR::Program& program);
 void LowerFp64ToFp32(IR::Program& program);
 void LowerFp16ToFp32(IR::Program& program);
 void LowerInt64ToInt32(IR::Program& program);
+void LoopInvariantCodeMotionPass(IR::Program& program);
 void RescalingPass(IR::Program& program);
 void SsaRewritePass(IR::Program& program);
 void PositionPass(Environment& env, IR::Program& program);
@@ -35,4 +44,11 @@ void VertexBTransformPass(IR::Program& program);
 void JoinTextureInfo(Info& base, Info& source);
 void JoinStorageInfo(Info& base, Info& source);
 
+/// Returns true when inst is known to have no side effects and a result only depending on its
+/// arguments, opcodes not known to be pure return false
+[[nodiscard]] bool IsPureInstruction(const IR::Inst& inst);
+
+/// Returns the value numbering statistics since the last call and resets them
+[[nodiscard]] ValueNumberingStatistics GetAndResetValueNumberingStatistics();
+
 } // namespace Shader::Optimization
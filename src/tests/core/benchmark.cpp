@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+
+#include <catch2/catch_test_macros.hpp>
+#include <nlohmann/json.hpp>
+
+#include "common/common_types.h"
+#include "core/perf_stats.h"
+#include "core/tools/benchmark.h"
+#include "tests/video_core/headless_gpu.h"
+
+namespace {
+
+using Tools::Benchmark;
+
+/// Number of frames kept in the frame time history of PerfStats
+constexpr u64 HISTORY_FRAMES = 216000;
+
+/// System without a title, with the GPU and the performance statistics the benchmark reads
+class BenchmarkFixture {
+public:
+    void PresentFrames(u64 num_frames) {
+        Core::PerfStats& perf_stats = gpu.system.GetPerfStats();
+        for (u64 frame = 0; frame < num_frames; ++frame) {
+            perf_stats.BeginSystemFrame();
+            perf_stats.EndSystemFrame();
+        }
+    }
+
+    Tests::HeadlessGPU gpu;
+};
+
+std::filesystem::path TestPath() {
+    return std::filesystem::temp_directory_path() / "citron_benchmark_test.json";
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Benchmark: Stops after the number of frames past the frame time history", "[core]") {
+    BenchmarkFixture fixture;
+    fixture.PresentFrames(10);
+    Benchmark benchmark{fixture.gpu.system, "-", std::nullopt, HISTORY_FRAMES + 10};
+    benchmark.Start();
+
+    // Frames presented before the start are not counted
+    fixture.PresentFrames(HISTORY_FRAMES);
+    REQUIRE(!benchmark.IsDone());
+    fixture.PresentFrames(9);
+    REQUIRE(!benchmark.IsDone());
+    fixture.PresentFrames(1);
+    REQUIRE(benchmark.IsDone());
+}
+
+TEST_CASE("Benchmark: Stops after the duration", "[core]") {
+    BenchmarkFixture fixture;
+    Benchmark finished{fixture.gpu.system, "-", std::chrono::seconds{0}, std::nullopt};
+    finished.Start();
+    REQUIRE(finished.IsDone());
+
+    Benchmark running{fixture.gpu.system, "-", std::chrono::hours{1}, 1000};
+    running.Start();
+    fixture.PresentFrames(10);
+    REQUIRE(!running.IsDone());
+}
+
+TEST_CASE("Benchmark: Writes the results as JSON", "[core]") {
+    BenchmarkFixture fixture;
+    std::filesystem::remove(TestPath());
+    {
+        Benchmark benchmark{fixture.gpu.system, TestPath().string(), std::nullopt, 20};
+        benchmark.Start();
+        fixture.PresentFrames(20);
+        REQUIRE(benchmark.IsDone());
+        benchmark.Finish();
+    }
+
+    std::ifstream file{TestPath()};
+    REQUIRE(file.is_open());
+    const nlohmann::json results = nlohmann::json::parse(file, nullptr, false);
+    REQUIRE(results.is_object());
+
+    REQUIRE(results["title_id"] == "0000000000000000");
+    REQUIRE(results["renderer"] == "Null");
+    REQUIRE(results["frames"] == 20);
+    REQUIRE(results["fps"].get<double>() > 0.0);
+    REQUIRE(results["emulation_speed"].is_number());
+    REQUIRE(results["duration_s"].get<double>() > 0.0);
+    REQUIRE(results["shaders_compiled"] == 0);
+    REQUIRE(results["threads"].is_array());
+    REQUIRE(results["peak_rss_bytes"].is_number_unsigned());
+
+    // Enough frames were presented to leave some after the ones skipped as booting
+    const nlohmann::json& frame_times = results["frame_time_ms"];
+    for (const char* const key : {"mean", "min", "p50", "p90", "p99", "max"}) {
+        REQUIRE(frame_times[key].is_number());
+    }
+    REQUIRE(frame_times["min"].get<double>() <= frame_times["p50"].get<double>());
+    REQUIRE(frame_times["p99"].get<double>() <= frame_times["max"].get<double>());
+
+    file.close();
+    std::filesystem::remove(TestPath());
+}
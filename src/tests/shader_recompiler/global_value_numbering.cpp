@@ -0,0 +1,226 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/settings.h"
+#include "shader_recompiler/exception.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/ir_emitter.h"
+#include "shader_recompiler/frontend/ir/post_order.h"
+#include "shader_recompiler/frontend/ir/program.h"
+#include "shader_recompiler/frontend/maxwell/control_flow.h"
+#include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "shader_recompiler/host_translate_info.h"
+#include "shader_recompiler/ir_opt/passes.h"
+#include "shader_recompiler/object_pool.h"
+#include "shader_recompiler/program_header.h"
+#include "video_core/pipeline_cache_file.h"
+#include "video_core/shader_environment.h"
+
+namespace {
+using namespace Shader;
+
+/// Blocks of a program whose first block is its entry
+struct TestProgram {
+    ObjectPool<IR::Inst> inst_pool;
+    ObjectPool<IR::Block> block_pool;
+    IR::Program program;
+
+    IR::Block* AddBlock() {
+        IR::Block* const block{block_pool.Create(inst_pool)};
+        program.blocks.push_back(block);
+        return block;
+    }
+
+    void Optimize() {
+        program.syntax_list.push_back({
+            .data{.block = program.blocks.front()},
+            .type = IR::AbstractSyntaxNode::Type::Block,
+        });
+        program.post_order_blocks = IR::PostOrder(program.syntax_list.front());
+        Optimization::GlobalValueNumberingPass(program);
+    }
+};
+
+/// Returns true when value was replaced by the value of other
+bool IsReplacedBy(const IR::Value& value, const IR::Value& other) {
+    return value.Inst()->GetOpcode() == IR::Opcode::Identity && value.Resolve() == other;
+}
+
+bool IsKept(const IR::Value& value) {
+    return value.Inst()->GetOpcode() != IR::Opcode::Identity;
+}
+
+/// Renderer cache version of a cache file in the indexed format, written after its format version
+std::optional<u32> ReadCacheVersion(const std::filesystem::path& path) {
+    std::ifstream file{path, std::ios::binary};
+    std::array<char, 8> magic_number{};
+    u32 format_version{};
+    u32 cache_version{};
+    file.read(magic_number.data(), magic_number.size());
+    file.read(reinterpret_cast<char*>(&format_version), sizeof(format_version));
+    file.read(reinterpret_cast<char*>(&cache_version), sizeof(cache_version));
+    if (!file || magic_number != std::array<char, 8>{'c', 'i', 't', 'r', 'o', 'n', 'p', 'c'}) {
+        return std::nullopt;
+    }
+    return cache_version;
+}
+
+/// Translates the stages of a cached pipeline the way the renderers build them
+void TranslateCachedPipeline(const VideoCommon::CachedPipeline& pipeline) {
+    ObjectPool<IR::Inst> inst_pool{8192};
+    ObjectPool<IR::Block> block_pool{32};
+    ObjectPool<Maxwell::Flow::Block> flow_block_pool{32};
+    const HostTranslateInfo host_info{};
+    for (VideoCommon::FileEnvironment& env : pipeline.LoadEnvironments()) {
+        const bool is_compute{env.ShaderStage() == Stage::Compute};
+        const u32 cfg_offset{is_compute ? env.StartAddress()
+                                        : static_cast<u32>(env.StartAddress() +
+                                                           sizeof(ProgramHeader))};
+        try {
+            Maxwell::Flow::CFG cfg(env, flow_block_pool, cfg_offset,
+                                   env.ShaderStage() == Stage::VertexA);
+            static_cast<void>(
+                Maxwell::TranslateProgram(inst_pool, block_pool, env, cfg, host_info));
+        } catch (const Exception& exception) {
+            WARN("Failed to translate shader: " << exception.what());
+        }
+    }
+}
+} // Anonymous namespace
+
+TEST_CASE("GlobalValueNumbering: Redundancy is removed where it is dominated", "[shader]") {
+    TestProgram test;
+    IR::Block* const entry{test.AddBlock()};
+    IR::Block* const then_block{test.AddBlock()};
+    IR::Block* const else_block{test.AddBlock()};
+    IR::Block* const merge{test.AddBlock()};
+    entry->AddBranch(then_block);
+    entry->AddBranch(else_block);
+    then_block->AddBranch(merge);
+    else_block->AddBranch(merge);
+
+    IR::IREmitter entry_ir{*entry};
+    const IR::U32 cbuf{entry_ir.GetCbuf(entry_ir.Imm32(0), entry_ir.Imm32(4))};
+    const IR::U32 sum{entry_ir.IAdd(cbuf, entry_ir.Imm32(1))};
+
+    IR::IREmitter then_ir{*then_block};
+    const IR::U32 then_cbuf{then_ir.GetCbuf(then_ir.Imm32(0), then_ir.Imm32(4))};
+    const IR::U32 then_sum{then_ir.IAdd(then_ir.Imm32(1), then_cbuf)};
+    const IR::U32 then_product{then_ir.IMul(sum, sum)};
+
+    IR::IREmitter else_ir{*else_block};
+    const IR::U32 else_product{else_ir.IMul(sum, sum)};
+
+    IR::IREmitter merge_ir{*merge};
+    const IR::U32 merge_product{merge_ir.IMul(sum, sum)};
+    merge_ir.SetAttribute(IR::Attribute::PositionX,
+                          merge_ir.BitCast<IR::F32, IR::U32>(merge_ir.IAdd(
+                              merge_ir.IAdd(then_sum, then_product),
+                              merge_ir.IAdd(else_product, merge_product))),
+                          merge_ir.Imm32(0));
+    test.Optimize();
+
+    // Operands of commutative operations are matched in any order
+    REQUIRE(IsReplacedBy(then_cbuf, cbuf));
+    REQUIRE(IsReplacedBy(then_sum, sum));
+
+    // Neither branch dominates the other or the merge block
+    REQUIRE(IsKept(then_product));
+    REQUIRE(IsKept(else_product));
+    REQUIRE(IsKept(merge_product));
+}
+
+TEST_CASE("GlobalValueNumbering: Memory loads are not merged", "[shader]") {
+    TestProgram test;
+    IR::Block* const entry{test.AddBlock()};
+    IR::IREmitter ir{*entry};
+    const IR::U64 address{ir.Imm64(u64{0x1000})};
+    const IR::U32 global{ir.LoadGlobal32(address)};
+    ir.WriteGlobal32(address, ir.Imm32(7));
+    const IR::U32 global_after_store{ir.LoadGlobal32(address)};
+    const IR::U32 global_again{ir.LoadGlobal32(address)};
+    const IR::U32 local{ir.LoadLocal(ir.Imm32(0))};
+    const IR::U32 local_again{ir.LoadLocal(ir.Imm32(0))};
+    const IR::Value shared{ir.LoadShared(32, false, ir.Imm32(0))};
+    const IR::Value shared_again{ir.LoadShared(32, false, ir.Imm32(0))};
+    const IR::F32 attribute{ir.GetAttribute(IR::Attribute::PositionX)};
+    const IR::F32 attribute_again{ir.GetAttribute(IR::Attribute::PositionX)};
+    test.Optimize();
+
+    REQUIRE(IsKept(global));
+    REQUIRE(IsKept(global_after_store));
+    REQUIRE(IsKept(global_again));
+    REQUIRE(IsKept(local));
+    REQUIRE(IsKept(local_again));
+    REQUIRE(IsKept(shared));
+    REQUIRE(IsKept(shared_again));
+    REQUIRE(IsKept(attribute));
+    REQUIRE(IsKept(attribute_again));
+}
+
+TEST_CASE("GlobalValueNumbering: Only known pure opcodes are pure", "[shader]") {
+    TestProgram test;
+    IR::Block* const entry{test.AddBlock()};
+    IR::IREmitter ir{*entry};
+    const IR::U32 cbuf{ir.GetCbuf(ir.Imm32(1), ir.Imm32(8))};
+    const IR::U32 lane{ir.LaneId()};
+    const IR::U32 shuffle{ir.ShuffleIndex(cbuf, ir.Imm32(0), ir.Imm32(0x1f), ir.Imm32(0))};
+    const IR::U1 vote{ir.VoteAny(ir.IEqual(cbuf, lane))};
+
+    REQUIRE(Optimization::IsPureInstruction(*cbuf.Inst()));
+    REQUIRE(Optimization::IsPureInstruction(*IR::Value{ir.IAdd(cbuf, lane)}.Inst()));
+    REQUIRE(!Optimization::IsPureInstruction(*shuffle.Inst()));
+    REQUIRE(!Optimization::IsPureInstruction(*vote.Inst()));
+}
+
+TEST_CASE("GlobalValueNumbering: Pipeline cache benchmark", "[.][benchmark]") {
+    // Set CITRON_PIPELINE_CACHE to a cache file written by a renderer, such as
+    // shader/<title id>/vulkan_pipelines.bin, to report what the pass removes from its shaders
+    const char* const cache_path{std::getenv("CITRON_PIPELINE_CACHE")};
+    if (cache_path == nullptr) {
+        WARN("CITRON_PIPELINE_CACHE is not set");
+        return;
+    }
+    const std::optional<u32> cache_version{ReadCacheVersion(cache_path)};
+    if (!cache_version) {
+        WARN(cache_path << " is not a pipeline cache file in the indexed format");
+        return;
+    }
+    // Loading deletes or rewrites the file it reads, so it reads a copy
+    const std::filesystem::path copy_path{std::filesystem::temp_directory_path() /
+                                          "citron_gvn_benchmark_pipelines.bin"};
+    std::filesystem::copy_file(cache_path, copy_path,
+                               std::filesystem::copy_options::overwrite_existing);
+
+    const bool use_value_numbering{Settings::values.use_shader_value_numbering.GetValue()};
+    Settings::values.use_shader_value_numbering.SetValue(true);
+    static_cast<void>(Optimization::GetAndResetValueNumberingStatistics());
+
+    u64 num_pipelines{};
+    const auto translate{[&](VideoCommon::CachedPipeline pipeline) {
+        TranslateCachedPipeline(pipeline);
+        ++num_pipelines;
+    }};
+    VideoCommon::PipelineCacheFile cache_file;
+    cache_file.Load<u8, u8>(copy_path, *cache_version, {}, translate, translate);
+
+    const Optimization::ValueNumberingStatistics stats{
+        Optimization::GetAndResetValueNumberingStatistics()};
+    Settings::values.use_shader_value_numbering.SetValue(use_value_numbering);
+    std::filesystem::remove(copy_path);
+
+    WARN(num_pipelines << " pipelines, " << stats.shaders << " shaders: "
+                       << stats.instructions_before << " instructions before value numbering, "
+                       << stats.instructions_after << " after, "
+                       << stats.instructions_before - stats.instructions_after << " removed");
+}
@@ -0,0 +1,183 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "shader_recompiler/frontend/ir/basic_block.h"
+#include "shader_recompiler/frontend/ir/ir_emitter.h"
+#include "shader_recompiler/frontend/ir/post_order.h"
+#include "shader_recompiler/frontend/ir/program.h"
+#include "shader_recompiler/ir_opt/passes.h"
+#include "shader_recompiler/object_pool.h"
+
+namespace {
+using namespace Shader;
+using NodeType = IR::AbstractSyntaxNode::Type;
+
+/**
+ * Loop shaped like the ones built by the structured control flow pass:
+ * preheader -> header -> body -> continue -> header or merge
+ */
+struct TestLoop {
+    TestLoop() {
+        preheader = AddBlock();
+        header = AddBlock();
+        body = AddBlock();
+        continue_block = AddBlock();
+        merge = AddBlock();
+        preheader->AddBranch(header);
+        header->AddBranch(body);
+    }
+
+    IR::Block* AddBlock() {
+        IR::Block* const block{block_pool.Create(inst_pool)};
+        program.blocks.push_back(block);
+        return block;
+    }
+
+    void AddBlockNode(IR::Block* block) {
+        program.syntax_list.push_back({.data{.block = block}, .type = NodeType::Block});
+    }
+
+    /// Emits the loop condition and the syntax list, body_nodes are the nodes of the body
+    void Finish(const std::vector<IR::AbstractSyntaxNode>& body_nodes, const IR::U32& counter) {
+        IR::IREmitter ir{*continue_block};
+        const IR::U1 cond{ir.ConditionRef(ir.ILessThan(counter, ir.Imm32(16), false))};
+        continue_block->AddBranch(header);
+        continue_block->AddBranch(merge);
+
+        AddBlockNode(preheader);
+        AddBlockNode(header);
+        IR::AbstractSyntaxNode loop{};
+        loop.type = NodeType::Loop;
+        loop.data.loop.body = body;
+        loop.data.loop.continue_block = continue_block;
+        loop.data.loop.merge = merge;
+        program.syntax_list.push_back(loop);
+        program.syntax_list.insert(program.syntax_list.end(), body_nodes.begin(),
+                                   body_nodes.end());
+        AddBlockNode(continue_block);
+        IR::AbstractSyntaxNode repeat{};
+        repeat.type = NodeType::Repeat;
+        repeat.data.repeat.cond = cond;
+        repeat.data.repeat.loop_header = header;
+        repeat.data.repeat.merge = merge;
+        program.syntax_list.push_back(repeat);
+        AddBlockNode(merge);
+        program.post_order_blocks = IR::PostOrder(program.syntax_list.front());
+    }
+
+    /// Adds a counter incremented on every iteration
+    IR::U32 AddCounter() {
+        IR::Inst* const phi{&*header->PrependNewInst(header->end(), IR::Opcode::Phi)};
+        phi->SetFlags(IR::Type::U32);
+        phi->AddPhiOperand(preheader, IR::Value{0u});
+        IR::IREmitter ir{*body};
+        const IR::U32 counter{ir.IAdd(IR::U32{IR::Value{phi}}, ir.Imm32(1))};
+        phi->AddPhiOperand(continue_block, counter);
+        return counter;
+    }
+
+    static bool Contains(const IR::Block* block, const IR::Value& value) {
+        return std::ranges::any_of(*block,
+                                   [&value](const IR::Inst& inst) { return &inst == value.Inst(); });
+    }
+
+    ObjectPool<IR::Inst> inst_pool;
+    ObjectPool<IR::Block> block_pool;
+    IR::Program program;
+    IR::Block* preheader;
+    IR::Block* header;
+    IR::Block* body;
+    IR::Block* continue_block;
+    IR::Block* merge;
+};
+} // Anonymous namespace
+
+TEST_CASE("LoopInvariantCodeMotion: Invariant instructions are hoisted", "[shader]") {
+    TestLoop loop;
+    const IR::U32 counter{loop.AddCounter()};
+    IR::IREmitter ir{*loop.body};
+    const IR::U32 cbuf{ir.GetCbuf(ir.Imm32(0), ir.Imm32(8))};
+    const IR::U32 address{ir.IAdd(ir.ShiftLeftLogical(cbuf, ir.Imm32(2)), ir.Imm32(16))};
+    const IR::U32 variant{ir.IAdd(address, counter)};
+    loop.Finish({{.data{.block = loop.body}, .type = NodeType::Block}}, counter);
+    Optimization::LoopInvariantCodeMotionPass(loop.program);
+
+    REQUIRE(TestLoop::Contains(loop.preheader, cbuf));
+    REQUIRE(TestLoop::Contains(loop.preheader, address));
+    REQUIRE(TestLoop::Contains(loop.body, variant));
+    REQUIRE(TestLoop::Contains(loop.body, counter));
+}
+
+TEST_CASE("LoopInvariantCodeMotion: Loops entered from several blocks are left alone",
+          "[shader]") {
+    TestLoop loop;
+    IR::Block* const other_entry{loop.AddBlock()};
+    other_entry->AddBranch(loop.header);
+    const IR::U32 counter{loop.AddCounter()};
+    IR::IREmitter ir{*loop.body};
+    const IR::U32 cbuf{ir.GetCbuf(ir.Imm32(0), ir.Imm32(8))};
+    loop.Finish({{.data{.block = loop.body}, .type = NodeType::Block}}, counter);
+    Optimization::LoopInvariantCodeMotionPass(loop.program);
+
+    REQUIRE(TestLoop::Contains(loop.body, cbuf));
+}
+
+TEST_CASE("LoopInvariantCodeMotion: Memory accesses stay in the loop", "[shader]") {
+    TestLoop loop;
+    const IR::U32 counter{loop.AddCounter()};
+    IR::IREmitter ir{*loop.body};
+    const IR::U64 address{ir.Imm64(u64{0x1000})};
+    ir.WriteGlobal32(address, counter);
+    const IR::U32 load{ir.LoadGlobal32(address)};
+    const IR::U32 local{ir.LoadLocal(ir.Imm32(4))};
+    loop.Finish({{.data{.block = loop.body}, .type = NodeType::Block}}, counter);
+    Optimization::LoopInvariantCodeMotionPass(loop.program);
+
+    REQUIRE(TestLoop::Contains(loop.body, load));
+    REQUIRE(TestLoop::Contains(loop.body, local));
+}
+
+TEST_CASE("LoopInvariantCodeMotion: Conditional blocks are not hoisted from", "[shader]") {
+    TestLoop loop;
+    IR::Block* const then_block{loop.AddBlock()};
+    IR::Block* const endif_block{loop.AddBlock()};
+    const IR::U32 counter{loop.AddCounter()};
+    IR::IREmitter body_ir{*loop.body};
+    const IR::U1 cond{body_ir.ConditionRef(body_ir.IEqual(counter, body_ir.Imm32(3)))};
+    loop.body->AddBranch(then_block);
+    loop.body->AddBranch(endif_block);
+    then_block->AddBranch(endif_block);
+    endif_block->AddBranch(loop.continue_block);
+
+    IR::IREmitter then_ir{*then_block};
+    const IR::U32 conditional{then_ir.GetCbuf(then_ir.Imm32(0), then_ir.Imm32(12))};
+    IR::IREmitter endif_ir{*endif_block};
+    const IR::U32 unconditional{endif_ir.GetCbuf(endif_ir.Imm32(0), endif_ir.Imm32(20))};
+
+    IR::AbstractSyntaxNode if_node{};
+    if_node.type = NodeType::If;
+    if_node.data.if_node.cond = cond;
+    if_node.data.if_node.body = then_block;
+    if_node.data.if_node.merge = endif_block;
+    IR::AbstractSyntaxNode endif_node{};
+    endif_node.type = NodeType::EndIf;
+    endif_node.data.end_if.merge = endif_block;
+    loop.Finish(
+        {
+            {.data{.block = loop.body}, .type = NodeType::Block},
+            if_node,
+            {.data{.block = then_block}, .type = NodeType::Block},
+            endif_node,
+            {.data{.block = endif_block}, .type = NodeType::Block},
+        },
+        counter);
+    Optimization::LoopInvariantCodeMotionPass(loop.program);
+
+    REQUIRE(TestLoop::Contains(then_block, conditional));
+    REQUIRE(TestLoop::Contains(loop.preheader, unconditional));
+}
@@ -0,0 +1,106 @@
+// SPDX-FileCopyrightText: Copyright 2026 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstring>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/cityhash.h"
+#include "common/common_types.h"
+#include "video_core/textures/astc.h"
+
+namespace {
+struct CorpusEntry {
+    u32 block_width;
+    u32 block_height;
+    u32 single_partition_mode; ///< Block mode used with one partition and RGBA endpoints
+    u32 dual_partition_mode;   ///< Block mode used with two partitions and RGB endpoints
+    u64 hash;                  ///< Hash of the output of the original bit by bit decoder
+};
+
+constexpr std::array CORPUS{
+    CorpusEntry{4, 4, 0x441, 0x042, 0x9709e795c7de3380},
+    CorpusEntry{5, 4, 0x4c1, 0x0c2, 0x2ec067c3ef856835},
+    CorpusEntry{5, 5, 0x4e1, 0x0e1, 0x12876035b0481b02},
+    CorpusEntry{6, 5, 0x561, 0x161, 0xd75e46de40ab4d25},
+    CorpusEntry{6, 6, 0x46d, 0x104, 0xb89a871d63f4f5a0},
+    CorpusEntry{8, 5, 0x465, 0x065, 0xa384360350f965d7},
+    CorpusEntry{8, 6, 0x465, 0x144, 0xfe1e8ffb8238075c},
+    CorpusEntry{8, 8, 0x465, 0x544, 0x8ce694416df852c2},
+    CorpusEntry{10, 5, 0x465, 0x165, 0xbc0c0fb06f3fd303},
+    CorpusEntry{10, 6, 0x465, 0x1a4, 0xf64f5b52a9236bac},
+    CorpusEntry{10, 8, 0x465, 0x564, 0xd21d8e015307f3ae},
+    CorpusEntry{10, 10, 0x764, 0x764, 0xca9057a109660c7b},
+    CorpusEntry{12, 10, 0x5c5, 0x764, 0xf5b346568340755c},
+    CorpusEntry{12, 12, 0x5c5, 0x764, 0x2562ca158a3ad018},
+};
+
+/// Builds valid blocks with random endpoints, weights and partition seeds
+std::vector<u8> MakeBlocks(const CorpusEntry& entry, u32 width, u32 height) {
+    const u32 num_blocks = ((width + entry.block_width - 1) / entry.block_width) *
+                           ((height + entry.block_height - 1) / entry.block_height);
+    std::mt19937_64 rng{entry.block_width * 16 + entry.block_height};
+    std::vector<u8> data(std::size_t{num_blocks} * 16);
+    for (u32 block = 0; block < num_blocks; ++block) {
+        u64 low = rng();
+        const u64 high = rng();
+        if (block % 2 == 0) {
+            low = (low & ~0x1FFFFULL) | entry.single_partition_mode | (12ULL << 13);
+        } else {
+            const u64 mask = 0x1FFFFFFFULL & ~(0x3FFULL << 13);
+            low = (low & ~mask) | entry.dual_partition_mode | (1ULL << 11) | (8ULL << 25);
+        }
+        std::memcpy(data.data() + block * 16, &low, sizeof(low));
+        std::memcpy(data.data() + block * 16 + 8, &high, sizeof(high));
+    }
+    return data;
+}
+} // Anonymous namespace
+
+TEST_CASE("ASTC: Decoded corpus matches reference", "[video_core]") {
+    constexpr u32 width = 100;
+    constexpr u32 height = 60;
+    for (const CorpusEntry& entry : CORPUS) {
+        const std::vector<u8> data = MakeBlocks(entry, width, height);
+        std::vector<u8> output(width * height * 4);
+        Tegra::Texture::ASTC::Decompress(data, width, height, 1, entry.block_width,
+                                         entry.block_height, output);
+        const u64 hash =
+            Common::CityHash64(reinterpret_cast<const char*>(output.data()), output.size());
+        INFO("Block size " << entry.block_width << "x" << entry.block_height);
+        REQUIRE(hash == entry.hash);
+    }
+}
+
+TEST_CASE("ASTC: Reserved block modes decode to the error color", "[video_core]") {
+    // Block mode 0 is a reserved encoding
+    std::vector<u8> data(16, 0);
+    data[15] = 0xFF;
+    std::vector<u8> output(4 * 4 * 4, 0xCD);
+    Tegra::Texture::ASTC::Decompress(data, 4, 4, 1, 4, 4, output);
+    REQUIRE(output == std::vector<u8>(4 * 4 * 4, 0));
+}
+
+TEST_CASE("ASTC: Decode benchmark", "[.][benchmark]") {
+    constexpr u32 width = 1024;
+    constexpr u32 height = 1024;
+    for (const CorpusEntry& entry : CORPUS) {
+        const std::vector<u8> data = MakeBlocks(entry, width, height);
+        std::vector<u8> output(width * height * 4);
+        const std::string name = "Decode " + std::to_string(width) + "x" +
+                                 std::to_string(height) + " ASTC " +
+                                 std::to_string(entry.block_width) + "x" +
+                                 std::to_string(entry.block_height);
+        BENCHMARK(name.c_str()) {
+            Tegra::Texture::ASTC::Decompress(data, width, height, 1, entry.block_width,
+                                             entry.block_height, output);
+            return output[0];
+        };
+    }
+}
@@ -0,0 +1,173 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <bc_decoder.h>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <stb_dxt.h>
+
+#include "common/common_types.h"
+#include "video_core/textures/bcn.h"
+
+namespace {
+
+using Tegra::Texture::BCN::Quality;
+
+constexpr std::array QUALITIES{
+    std::pair{Quality::Fast, "Fast"},
+    std::pair{Quality::Normal, "Normal"},
+    std::pair{Quality::High, "High"},
+};
+
+/// Builds an RGBA8 image of smooth gradients with a bit of noise and some hard edges
+std::vector<u8> MakeImage(u32 width, u32 height) {
+    std::mt19937 rng{width * 31 + height};
+    std::uniform_int_distribution<int> noise{-6, 6};
+    std::vector<u8> image(std::size_t{width} * height * 4);
+    for (u32 y = 0; y < height; ++y) {
+        for (u32 x = 0; x < width; ++x) {
+            const bool edge = ((x / 24) + (y / 24)) % 5 == 0;
+            const std::array<int, 4> texel{
+                static_cast<int>(x * 255 / width),
+                edge ? 230 : static_cast<int>(y * 255 / height),
+                static_cast<int>(128 + 100 * std::sin(static_cast<double>(x + y) / 20.0)),
+                static_cast<int>((x + y) * 255 / (width + height)),
+            };
+            u8* const out = &image[(std::size_t{y} * width + x) * 4];
+            for (u32 c = 0; c < 4; ++c) {
+                out[c] = static_cast<u8>(std::clamp(texel[c] + noise(rng), 0, 255));
+            }
+        }
+    }
+    return image;
+}
+
+std::vector<u8> Encode(bool bc3, std::span<const u8> image, u32 width, u32 height,
+                       Quality quality) {
+    std::vector<u8> encoded((width / 4) * (height / 4) * (bc3 ? 16 : 8));
+    if (bc3) {
+        Tegra::Texture::BCN::CompressBC3(image, width, height, 1, encoded, quality);
+    } else {
+        Tegra::Texture::BCN::CompressBC1(image, width, height, 1, encoded, quality);
+    }
+    return encoded;
+}
+
+/// Decodes the image and returns the PSNR over the channels the format encodes
+double MeasurePSNR(bool bc3, std::span<const u8> image, std::span<const u8> encoded, u32 width,
+                   u32 height) {
+    const u32 block_size = bc3 ? 16 : 8;
+    std::vector<u8> decoded(image.size());
+    for (u32 y = 0; y < height; y += 4) {
+        for (u32 x = 0; x < width; x += 4) {
+            const u8* const block = &encoded[((y / 4) * (width / 4) + x / 4) * block_size];
+            u8* const dst = &decoded[(std::size_t{y} * width + x) * 4];
+            if (bc3) {
+                bcn::DecodeBc3(block, dst, x, y, width, height);
+            } else {
+                bcn::DecodeBc1(block, dst, x, y, width, height);
+            }
+        }
+    }
+    const u32 channels = bc3 ? 4 : 3;
+    double error = 0.0;
+    for (std::size_t i = 0; i < image.size(); i += 4) {
+        // BC1 encodes texels under the alpha threshold as transparent black
+        const bool transparent = !bc3 && image[i + 3] < 128;
+        for (u32 c = 0; c < channels; ++c) {
+            const double expected = transparent ? 0.0 : static_cast<double>(image[i + c]);
+            const double diff = expected - decoded[i + c];
+            error += diff * diff;
+        }
+    }
+    const double mse = error / static_cast<double>(image.size() / 4 * channels);
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("BCN: Normal quality matches the per block encoder", "[video_core]") {
+    constexpr u32 width = 256;
+    constexpr u32 height = 128;
+    const std::vector<u8> image = MakeImage(width, height);
+    const std::vector<u8> bc1 = Encode(false, image, width, height, Quality::Normal);
+    const std::vector<u8> bc3 = Encode(true, image, width, height, Quality::Normal);
+
+    for (u32 y = 0; y < height; y += 4) {
+        for (u32 x = 0; x < width; x += 4) {
+            std::array<u8, 64> block;
+            for (u32 j = 0; j < 4; ++j) {
+                std::memcpy(&block[j * 16], &image[((y + j) * width + x) * 4], 16);
+            }
+            const u32 index = (y / 4) * (width / 4) + x / 4;
+            std::array<u8, 16> expected;
+            stb_compress_bc3_block(expected.data(), block.data(), STB_DXT_NORMAL);
+            REQUIRE(std::memcmp(&bc3[index * 16], expected.data(), 16) == 0);
+
+            bool any_alpha = false;
+            for (u32 i = 0; i < 16; ++i) {
+                any_alpha |= block[i * 4 + 3] < 128;
+                if (block[i * 4 + 3] < 128) {
+                    std::fill_n(&block[i * 4], 4, u8{0});
+                } else {
+                    block[i * 4 + 3] = 255;
+                }
+            }
+            stb_compress_bc1_block(expected.data(), block.data(), any_alpha, STB_DXT_NORMAL);
+            REQUIRE(std::memcmp(&bc1[index * 8], expected.data(), 8) == 0);
+        }
+    }
+}
+
+TEST_CASE("BCN: Every quality level keeps a usable PSNR", "[video_core]") {
+    constexpr u32 width = 256;
+    constexpr u32 height = 256;
+    // Opaque image, so BC1 encodes every block with four colors
+    std::vector<u8> image = MakeImage(width, height);
+    for (std::size_t i = 3; i < image.size(); i += 4) {
+        image[i] = 255;
+    }
+    for (const auto& [quality, name] : QUALITIES) {
+        INFO("Quality " << name);
+        const double bc1_psnr =
+            MeasurePSNR(false, image, Encode(false, image, width, height, quality), width, height);
+        const double bc3_psnr =
+            MeasurePSNR(true, image, Encode(true, image, width, height, quality), width, height);
+        REQUIRE(bc1_psnr > 32.0);
+        REQUIRE(bc3_psnr > 32.0);
+    }
+}
+
+TEST_CASE("BCN: Encode benchmark", "[.][benchmark]") {
+    constexpr u32 width = 2048;
+    constexpr u32 height = 2048;
+    const std::vector<u8> image = MakeImage(width, height);
+    const double megabytes = static_cast<double>(image.size()) / (1024.0 * 1024.0);
+
+    for (const bool bc3 : {false, true}) {
+        for (const auto& [quality, name] : QUALITIES) {
+            const std::string label = std::string(bc3 ? "BC3 " : "BC1 ") + name;
+            std::vector<u8> encoded;
+            const auto start = std::chrono::steady_clock::now();
+            encoded = Encode(bc3, image, width, height, quality);
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            WARN(label << ": " << megabytes / elapsed.count() << " MB/s, "
+                       << MeasurePSNR(bc3, image, encoded, width, height) << " dB");
+
+            BENCHMARK(std::string{label}) {
+                return Encode(bc3, image, width, height, quality);
+            };
+        }
+    }
+}
@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <bc_decoder.h>
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "video_core/texture_cache/decode_bc.h"
+
+namespace {
+
+using VideoCore::Surface::PixelFormat;
+
+struct FormatInfo {
+    PixelFormat format;
+    const char* name;
+    u32 block_size;
+};
+
+constexpr std::array FORMATS{
+    FormatInfo{PixelFormat::BC1_RGBA_UNORM, "BC1", 8},
+    FormatInfo{PixelFormat::BC2_UNORM, "BC2", 16},
+    FormatInfo{PixelFormat::BC3_UNORM, "BC3", 16},
+    FormatInfo{PixelFormat::BC4_UNORM, "BC4_UNORM", 8},
+    FormatInfo{PixelFormat::BC4_SNORM, "BC4_SNORM", 8},
+    FormatInfo{PixelFormat::BC5_UNORM, "BC5_UNORM", 16},
+    FormatInfo{PixelFormat::BC5_SNORM, "BC5_SNORM", 16},
+    FormatInfo{PixelFormat::BC6H_UFLOAT, "BC6H_UFLOAT", 16},
+    FormatInfo{PixelFormat::BC6H_SFLOAT, "BC6H_SFLOAT", 16},
+    FormatInfo{PixelFormat::BC7_UNORM, "BC7", 16},
+};
+
+VideoCommon::BufferImageCopy MakeCopy(u32 width, u32 height, u32 layers) {
+    VideoCommon::BufferImageCopy copy{};
+    copy.buffer_row_length = Common::DivCeil(width, 4U) * 4;
+    copy.buffer_image_height = Common::DivCeil(height, 4U) * 4;
+    copy.image_subresource.num_layers = layers;
+    copy.image_extent = {width, height, 1};
+    return copy;
+}
+
+std::vector<u8> RandomBlocks(size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    for (u8& value : data) {
+        value = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+/// Decodes one block at a time with the reference decoder
+void ReferenceDecode(const FormatInfo& info, const u8* src, u8* dst, u32 width, u32 height) {
+    const u32 out_bpp = VideoCommon::ConvertedBytesPerBlock(info.format);
+    const bool is_signed =
+        info.format == PixelFormat::BC4_SNORM || info.format == PixelFormat::BC5_SNORM ||
+        info.format == PixelFormat::BC6H_SFLOAT;
+    for (u32 y = 0; y < height; y += 4) {
+        for (u32 x = 0; x < width; x += 4, src += info.block_size) {
+            u8* const block_dst = dst + (size_t{y} * width + x) * out_bpp;
+            switch (info.format) {
+            case PixelFormat::BC1_RGBA_UNORM:
+                bcn::DecodeBc1(src, block_dst, x, y, width, height);
+                break;
+            case PixelFormat::BC2_UNORM:
+                bcn::DecodeBc2(src, block_dst, x, y, width, height);
+                break;
+            case PixelFormat::BC3_UNORM:
+                bcn::DecodeBc3(src, block_dst, x, y, width, height);
+                break;
+            case PixelFormat::BC4_UNORM:
+            case PixelFormat::BC4_SNORM:
+                bcn::DecodeBc4(src, block_dst, x, y, width, height, is_signed);
+                break;
+            case PixelFormat::BC5_UNORM:
+            case PixelFormat::BC5_SNORM:
+                bcn::DecodeBc5(src, block_dst, x, y, width, height, is_signed);
+                break;
+            case PixelFormat::BC6H_UFLOAT:
+            case PixelFormat::BC6H_SFLOAT:
+                bcn::DecodeBc6(src, block_dst, x, y, width, height, is_signed);
+                break;
+            default:
+                bcn::DecodeBc7(src, block_dst, x, y, width, height);
+                break;
+            }
+        }
+    }
+}
+
+} // Anonymous namespace
+
+TEST_CASE("DecodeBC: Matches the reference decoder on random blocks", "[video_core]") {
+    // Odd sizes exercise partial edge blocks, the larger one the parallel path
+    constexpr std::array<std::array<u32, 3>, 3> SIZES{{{37, 21, 2}, {3, 2, 3}, {517, 260, 2}}};
+    for (const FormatInfo& info : FORMATS) {
+        for (const auto& [width, height, layers] : SIZES) {
+            INFO(info.name << " " << width << "x" << height << "x" << layers);
+            const u32 out_bpp = VideoCommon::ConvertedBytesPerBlock(info.format);
+            const size_t input_layer_size = size_t{Common::DivCeil(width, 4U)} *
+                                            Common::DivCeil(height, 4U) * info.block_size;
+            const size_t output_layer_size = size_t{width} * height * out_bpp;
+            const std::vector<u8> input =
+                RandomBlocks(input_layer_size * layers, width * 131 + info.block_size);
+
+            std::vector<u8> expected(output_layer_size * layers);
+            for (u32 layer = 0; layer < layers; ++layer) {
+                ReferenceDecode(info, input.data() + layer * input_layer_size,
+                                expected.data() + layer * output_layer_size, width, height);
+            }
+            std::vector<u8> output(expected.size());
+            VideoCommon::BufferImageCopy copy = MakeCopy(width, height, layers);
+            VideoCommon::DecompressBCn(input, output, copy, info.format);
+            REQUIRE(output == expected);
+        }
+    }
+}
+
+TEST_CASE("DecodeBC: BC6H matches the reference decoder in every mode", "[video_core]") {
+    // Modes 0 and 1 take two bits, the rest five, and the last four encodings are reserved
+    constexpr std::array<u8, 18> MODES{0,  1,  2,  3,  6,  7,  10, 11, 14,
+                                       15, 18, 22, 26, 30, 19, 23, 27, 31};
+    constexpr u32 width = 64;
+    constexpr u32 height = 64;
+    constexpr size_t num_blocks = (width / 4) * (height / 4);
+    for (const PixelFormat format : {PixelFormat::BC6H_UFLOAT, PixelFormat::BC6H_SFLOAT}) {
+        const FormatInfo& info = *std::ranges::find(FORMATS, format, &FormatInfo::format);
+        for (const u8 mode : MODES) {
+            INFO(info.name << " mode " << static_cast<u32>(mode));
+            std::vector<u8> input = RandomBlocks(num_blocks * info.block_size, mode + 1);
+            const u8 mode_mask = mode < 2 ? 0x3 : 0x1f;
+            for (size_t block = 0; block < num_blocks; ++block) {
+                u8& header = input[block * info.block_size];
+                header = static_cast<u8>((header & ~mode_mask) | mode);
+            }
+            std::vector<u8> expected(size_t{width} * height * 8);
+            ReferenceDecode(info, input.data(), expected.data(), width, height);
+            std::vector<u8> output(expected.size());
+            VideoCommon::BufferImageCopy copy = MakeCopy(width, height, 1);
+            VideoCommon::DecompressBCn(input, output, copy, info.format);
+            REQUIRE(output == expected);
+        }
+    }
+}
+
+TEST_CASE("DecodeBC: Decode benchmark", "[.][benchmark]") {
+    constexpr u32 width = 2048;
+    constexpr u32 height = 2048;
+    for (const FormatInfo& info : FORMATS) {
+        const u32 out_bpp = VideoCommon::ConvertedBytesPerBlock(info.format);
+        const std::vector<u8> input =
+            RandomBlocks(size_t{width / 4} * (height / 4) * info.block_size, info.block_size);
+        std::vector<u8> output(size_t{width} * height * out_bpp);
+        const double megapixels = static_cast<double>(width) * height / (1000.0 * 1000.0);
+
+        VideoCommon::BufferImageCopy copy = MakeCopy(width, height, 1);
+        auto start = std::chrono::steady_clock::now();
+        VideoCommon::DecompressBCn(input, output, copy, info.format);
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        ReferenceDecode(info, input.data(), output.data(), width, height);
+        const std::chrono::duration<double> reference = std::chrono::steady_clock::now() - start;
+        WARN(info.name << ": " << megapixels / elapsed.count() << " MP/s, reference "
+                       << megapixels / reference.count() << " MP/s");
+
+        BENCHMARK(std::string{info.name}) {
+            VideoCommon::DecompressBCn(input, output, copy, info.format);
+            return output[0];
+        };
+    }
+}
@@ -0,0 +1,296 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <bit>
+#include <memory>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/settings.h"
+#include "tests/video_core/headless_gpu.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/engines/draw_manager.h"
+#include "video_core/engines/maxwell_3d.h"
+#include "video_core/engines/puller.h"
+#include "video_core/gpu.h"
+#include "video_core/macro/macro.h"
+#include "video_core/memory_manager.h"
+#include "video_core/rasterizer_interface.h"
+#include "video_core/renderer_null/null_rasterizer.h"
+
+namespace {
+
+using Tegra::Engines::Maxwell3D;
+using Tegra::Engines::PrimitiveTopology;
+
+constexpr u32 MacroRegistersStart = 0xE00;
+
+struct RecordedDraw {
+    bool is_indexed;
+    PrimitiveTopology topology;
+    u32 first;
+    u32 count;
+
+    bool operator==(const RecordedDraw&) const = default;
+};
+
+/// Rasterizer recording the ranges of the draws it is asked to issue
+class DrawRecorder final : public VideoCore::RasterizerInterface {
+public:
+    explicit DrawRecorder(const Maxwell3D& maxwell3d_) : maxwell3d{maxwell3d_} {}
+
+    void Draw(bool is_indexed, u32 instance_count) override {
+        const auto& state = maxwell3d.draw_manager->GetDrawState();
+        draws.push_back({
+            .is_indexed = is_indexed,
+            .topology = state.topology,
+            .first = is_indexed ? state.index_buffer.first : state.vertex_buffer.first,
+            .count = is_indexed ? state.index_buffer.count : state.vertex_buffer.count,
+        });
+    }
+
+    void DrawTexture() override {}
+    void Clear(u32 layer_count) override {}
+    void DispatchCompute() override {}
+    void ResetCounter(VideoCommon::QueryType type) override {}
+    void Query(GPUVAddr gpu_addr, VideoCommon::QueryType type,
+               VideoCommon::QueryPropertiesFlags flags, u32 payload, u32 subreport) override {}
+    void BindGraphicsUniformBuffer(size_t stage, u32 index, GPUVAddr gpu_addr, u32 size) override {}
+    void DisableGraphicsUniformBuffer(size_t stage, u32 index) override {}
+    void SignalFence(std::function<void()>&& func) override {
+        func();
+    }
+    void SyncOperation(std::function<void()>&& func) override {
+        func();
+    }
+    void SignalSyncPoint(u32 value) override {}
+    void SignalReference() override {}
+    void ReleaseFences(bool force) override {}
+    void FlushAll() override {}
+    void FlushRegion(DAddr addr, u64 size, VideoCommon::CacheType which) override {}
+    bool MustFlushRegion(DAddr addr, u64 size, VideoCommon::CacheType which) override {
+        return false;
+    }
+    VideoCore::RasterizerDownloadArea GetFlushArea(DAddr addr, u64 size) override {
+        return {.start_address = addr, .end_address = addr + size, .preemtive = true};
+    }
+    void InvalidateRegion(DAddr addr, u64 size, VideoCommon::CacheType which) override {}
+    void OnCacheInvalidation(PAddr addr, u64 size) override {}
+    bool OnCPUWrite(PAddr addr, u64 size) override {
+        return false;
+    }
+    void InvalidateGPUCache() override {}
+    void UnmapMemory(DAddr addr, u64 size) override {}
+    void ModifyGPUMemory(size_t as_id, GPUVAddr addr, u64 size) override {}
+    void FlushAndInvalidateRegion(DAddr addr, u64 size, VideoCommon::CacheType which) override {}
+    void WaitForIdle() override {}
+    void FragmentBarrier() override {}
+    void TiledCacheBarrier() override {}
+    void FlushCommands() override {}
+    void TickFrame() override {}
+    Tegra::Engines::AccelerateDMAInterface& AccessAccelerateDMA() override {
+        return accelerate_dma;
+    }
+    void AccelerateInlineToMemory(GPUVAddr address, size_t copy_size,
+                                  std::span<const u8> memory) override {}
+
+    std::vector<RecordedDraw> draws;
+
+private:
+    const Maxwell3D& maxwell3d;
+    Null::AccelerateDMA accelerate_dma;
+};
+
+/// Builds command lists writing to the Maxwell3D engine bound on subchannel 0
+class CommandBuilder {
+public:
+    CommandBuilder() {
+        Puller(Tegra::BufferMethods::BindObject, static_cast<u32>(Tegra::EngineID::MAXWELL_B));
+    }
+
+    void Puller(Tegra::BufferMethods method, u32 argument) {
+        Method(static_cast<u32>(method), argument);
+    }
+
+    void Method(u32 method, u32 argument) {
+        entries.prefetch_command_list.push_back(Tegra::BuildCommandHeader(
+            static_cast<Tegra::BufferMethods>(method), 1, Tegra::SubmissionMode::Increasing));
+        entries.prefetch_command_list.push_back(Tegra::CommandHeader{argument});
+    }
+
+    void Draw(PrimitiveTopology topology, u32 first, u32 count, bool is_indexed = false) {
+        Maxwell3D::Regs::Draw draw{};
+        draw.topology.Assign(topology);
+        if (is_indexed) {
+            Method(MAXWELL3D_REG_INDEX(index_buffer.first), first);
+            Method(MAXWELL3D_REG_INDEX(index_buffer.count), count);
+        } else {
+            Method(MAXWELL3D_REG_INDEX(vertex_buffer.first), first);
+            Method(MAXWELL3D_REG_INDEX(vertex_buffer.count), count);
+        }
+        Method(MAXWELL3D_REG_INDEX(draw.begin), draw.begin);
+        Method(MAXWELL3D_REG_INDEX(draw.end), 0);
+    }
+
+    Tegra::CommandList Build() {
+        return std::move(entries);
+    }
+
+private:
+    Tegra::CommandList entries;
+};
+
+/// Headless GPU with a channel whose Maxwell3D engine draws to a DrawRecorder
+class CoalescingFixture {
+public:
+    CoalescingFixture() {
+        Settings::values.use_draw_coalescing.SetValue(true);
+        channel = gpu.CreateChannel();
+        recorder = std::make_unique<DrawRecorder>(*channel->maxwell_3d);
+        channel->maxwell_3d->BindRasterizer(recorder.get());
+    }
+
+    const std::vector<RecordedDraw>& Run(CommandBuilder& commands) {
+        gpu.system.GPU().PushGPUEntries(channel->bind_id, commands.Build());
+        return recorder->draws;
+    }
+
+private:
+    Tests::HeadlessGPU gpu;
+    std::shared_ptr<Tegra::Control::ChannelState> channel;
+    std::unique_ptr<DrawRecorder> recorder;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("DrawManager: Adjacent draws of a list topology are merged", "[video_core]") {
+    CoalescingFixture fixture;
+    CommandBuilder commands;
+    commands.Draw(PrimitiveTopology::Triangles, 0, 3);
+    commands.Draw(PrimitiveTopology::Triangles, 3, 6);
+    commands.Draw(PrimitiveTopology::Triangles, 9, 3);
+
+    const std::vector<RecordedDraw> expected{{false, PrimitiveTopology::Triangles, 0, 12}};
+    REQUIRE(fixture.Run(commands) == expected);
+}
+
+TEST_CASE("DrawManager: Draws that can not be merged are issued apart", "[video_core]") {
+    CoalescingFixture fixture;
+    CommandBuilder commands;
+    commands.Draw(PrimitiveTopology::Triangles, 0, 3);
+    // Not adjacent
+    commands.Draw(PrimitiveTopology::Triangles, 6, 3);
+    // Leaves an incomplete primitive
+    commands.Draw(PrimitiveTopology::Triangles, 9, 2);
+    commands.Draw(PrimitiveTopology::Triangles, 11, 3);
+    // Strips share vertices between primitives
+    commands.Draw(PrimitiveTopology::TriangleStrip, 0, 4);
+    commands.Draw(PrimitiveTopology::TriangleStrip, 4, 4);
+
+    const std::vector<RecordedDraw> expected{
+        {false, PrimitiveTopology::Triangles, 0, 3},
+        {false, PrimitiveTopology::Triangles, 6, 3},
+        {false, PrimitiveTopology::Triangles, 9, 2},
+        {false, PrimitiveTopology::Triangles, 11, 3},
+        {false, PrimitiveTopology::TriangleStrip, 0, 4},
+        {false, PrimitiveTopology::TriangleStrip, 4, 4},
+    };
+    REQUIRE(fixture.Run(commands) == expected);
+}
+
+TEST_CASE("DrawManager: Register writes issue the pending draw", "[video_core]") {
+    CoalescingFixture fixture;
+    CommandBuilder commands;
+    const u32 line_width = MAXWELL3D_REG_INDEX(line_width_smooth);
+    commands.Draw(PrimitiveTopology::Triangles, 0, 3);
+    commands.Method(line_width, std::bit_cast<u32>(2.0f));
+    commands.Draw(PrimitiveTopology::Triangles, 3, 3);
+    // Writing the value the register already holds changes nothing
+    commands.Method(line_width, std::bit_cast<u32>(2.0f));
+    commands.Draw(PrimitiveTopology::Triangles, 6, 3);
+
+    const std::vector<RecordedDraw> expected{
+        {false, PrimitiveTopology::Triangles, 0, 3},
+        {false, PrimitiveTopology::Triangles, 3, 6},
+    };
+    REQUIRE(fixture.Run(commands) == expected);
+}
+
+TEST_CASE("DrawManager: Index and topology changes issue the pending draw", "[video_core]") {
+    CoalescingFixture fixture;
+    CommandBuilder commands;
+    commands.Draw(PrimitiveTopology::Triangles, 0, 3);
+    commands.Draw(PrimitiveTopology::Lines, 3, 2);
+    commands.Draw(PrimitiveTopology::Lines, 5, 2, true);
+    commands.Draw(PrimitiveTopology::Lines, 7, 4, true);
+
+    const std::vector<RecordedDraw> expected{
+        {false, PrimitiveTopology::Triangles, 0, 3},
+        {false, PrimitiveTopology::Lines, 3, 2},
+        {true, PrimitiveTopology::Lines, 5, 6},
+    };
+    REQUIRE(fixture.Run(commands) == expected);
+}
+
+TEST_CASE("DrawManager: Command list, puller and macro boundaries issue the pending draw",
+          "[video_core]") {
+    CoalescingFixture fixture;
+    {
+        CommandBuilder commands;
+        commands.Draw(PrimitiveTopology::Triangles, 0, 3);
+        // The draw must be issued when the command list ends, not by the next one
+        const std::vector<RecordedDraw> expected{{false, PrimitiveTopology::Triangles, 0, 3}};
+        REQUIRE(fixture.Run(commands) == expected);
+    }
+    {
+        CommandBuilder commands;
+        commands.Draw(PrimitiveTopology::Triangles, 3, 3);
+        commands.Puller(Tegra::BufferMethods::Nop, 0);
+        commands.Draw(PrimitiveTopology::Triangles, 6, 3);
+        REQUIRE(fixture.Run(commands).size() == 3);
+    }
+    {
+        using Tegra::Macro::Opcode;
+        using Tegra::Macro::Operation;
+        using Tegra::Macro::ResultOperation;
+        // Sends its parameter to the line width
+        const auto add_immediate = [](ResultOperation result, u32 src_a, u32 immediate,
+                                      bool is_exit) {
+            Opcode opcode{};
+            opcode.operation.Assign(Operation::AddImmediate);
+            opcode.result_operation.Assign(result);
+            opcode.src_a.Assign(src_a);
+            opcode.immediate.Assign(static_cast<s32>(immediate));
+            opcode.is_exit.Assign(is_exit ? 1 : 0);
+            return opcode.raw;
+        };
+        CommandBuilder commands;
+        commands.Method(MAXWELL3D_REG_INDEX(load_mme.instruction_ptr), 0);
+        for (const u32 instruction : {
+                 add_immediate(ResultOperation::MoveAndSetMethod, 0,
+                               MAXWELL3D_REG_INDEX(line_width_smooth), false),
+                 add_immediate(ResultOperation::MoveAndSend, 1, 0, true),
+                 add_immediate(ResultOperation::Move, 0, 0, false),
+             }) {
+            commands.Method(MAXWELL3D_REG_INDEX(load_mme.instruction), instruction);
+        }
+        commands.Method(MAXWELL3D_REG_INDEX(load_mme.start_address_ptr), 0);
+        commands.Method(MAXWELL3D_REG_INDEX(load_mme.start_address), 0);
+
+        commands.Draw(PrimitiveTopology::Triangles, 9, 3);
+        commands.Method(MacroRegistersStart, std::bit_cast<u32>(4.0f));
+        commands.Draw(PrimitiveTopology::Triangles, 12, 3);
+
+        const std::vector<RecordedDraw> expected{
+            {false, PrimitiveTopology::Triangles, 0, 3},
+            {false, PrimitiveTopology::Triangles, 3, 3},
+            {false, PrimitiveTopology::Triangles, 6, 3},
+            {false, PrimitiveTopology::Triangles, 9, 3},
+            {false, PrimitiveTopology::Triangles, 12, 3},
+        };
+        REQUIRE(fixture.Run(commands) == expected);
+    }
+}
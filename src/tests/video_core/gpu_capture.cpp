@@ -0,0 +1,181 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/binary_buffer.h"
+#include "common/common_types.h"
+#include "tests/video_core/headless_gpu.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_capture.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+
+namespace {
+
+using Tegra::CapturedChannel;
+using Tegra::CapturedFrame;
+using Tegra::CapturedMemory;
+using Tegra::GPUCapture;
+using Tegra::GPUCaptureData;
+
+std::filesystem::path TestPath() {
+    return std::filesystem::temp_directory_path() / "citron_gpu_capture_test.gcap";
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GPUCapture: Records the requested number of frames", "[video_core]") {
+    GPUCapture capture{2};
+    REQUIRE(capture.IsPending());
+    REQUIRE(!capture.IsRecording());
+
+    capture.Begin({CapturedChannel{.channel_id = 1}});
+    REQUIRE(!capture.IsPending());
+    REQUIRE(capture.IsRecording());
+    REQUIRE(!capture.EndFrame());
+    REQUIRE(capture.IsRecording());
+    REQUIRE(capture.EndFrame());
+    REQUIRE(!capture.IsRecording());
+    REQUIRE(capture.Data().channels.size() == 1);
+    REQUIRE(capture.Data().frames.size() == 2);
+}
+
+TEST_CASE("GPUCapture: Captures round trip through files", "[video_core]") {
+    GPUCaptureData capture;
+    CapturedChannel& channel = capture.channels.emplace_back();
+    channel.channel_id = 3;
+    channel.program_id = 0x0100000000010000;
+    channel.bound_engines = {0xB197, 0xB1C0, 0xA140, 0, 0x902D, 0, 0, 0xB0B5};
+    channel.registers = std::vector<u32>(0xE00, 0x12345678);
+    channel.shadow_registers = std::vector<u32>(0xE00, 0x9abcdef0);
+    channel.const_buffers = {0x1000, 0, 0x100, 1};
+    channel.macro_positions = {0, 4, 9};
+    channel.macro_code = {{0, {1, 2, 3, 4}}, {4, {5, 6, 7, 8, 9}}};
+
+    CapturedFrame& frame = capture.frames.emplace_back();
+    frame.submissions.push_back({.channel_id = 3,
+                                 .segments = {{.address = 0x1000, .words = {1, 2, 3}},
+                                              {.address = 0x2000, .words = {}}}});
+    frame.submissions.push_back({.channel_id = 3, .segments = {{.address = 0, .words = {4}}}});
+    capture.frames.emplace_back();
+    capture.memory.push_back(
+        {.channel_id = 3, .address = 0x10000, .data = std::vector<u8>(0x2000, 0x5a)});
+
+    const std::filesystem::path path = TestPath();
+    REQUIRE(GPUCapture::Write(path, capture));
+    const std::optional<GPUCaptureData> read = GPUCapture::Read(path);
+    std::filesystem::remove(path);
+
+    REQUIRE(read.has_value());
+    REQUIRE(read->channels.size() == 1);
+    const CapturedChannel& read_channel = read->channels[0];
+    REQUIRE(read_channel.channel_id == channel.channel_id);
+    REQUIRE(read_channel.program_id == channel.program_id);
+    REQUIRE(read_channel.bound_engines == channel.bound_engines);
+    REQUIRE(read_channel.registers == channel.registers);
+    REQUIRE(read_channel.shadow_registers == channel.shadow_registers);
+    REQUIRE(read_channel.const_buffers == channel.const_buffers);
+    REQUIRE(read_channel.macro_positions == channel.macro_positions);
+    REQUIRE(read_channel.macro_code == channel.macro_code);
+
+    REQUIRE(read->frames.size() == 2);
+    REQUIRE(read->frames[1].submissions.empty());
+    const auto& submissions = read->frames[0].submissions;
+    REQUIRE(submissions.size() == 2);
+    REQUIRE(submissions[0].segments.size() == 2);
+    REQUIRE(submissions[0].segments[0].address == 0x1000);
+    REQUIRE(submissions[0].segments[0].words == std::vector<u32>{1, 2, 3});
+    REQUIRE(submissions[0].segments[1].words.empty());
+    REQUIRE(submissions[1].segments[0].words == std::vector<u32>{4});
+
+    REQUIRE(read->memory.size() == 1);
+    REQUIRE(read->memory[0].channel_id == 3);
+    REQUIRE(read->memory[0].address == 0x10000);
+    REQUIRE(read->memory[0].data == capture.memory[0].data);
+}
+
+TEST_CASE("GPUCapture: Rejects files that are not captures", "[video_core]") {
+    const std::filesystem::path path = TestPath();
+    {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file << "not a capture";
+    }
+    REQUIRE(!GPUCapture::Read(path).has_value());
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("GPUCapture: Rejects counts larger than the data", "[video_core]") {
+    SECTION("Huge channel count") {
+        Common::BinaryWriter writer;
+        writer.Push<u32>(0xFFFFFFFF);
+        REQUIRE(!GPUCapture::Parse(writer.Buffer()).has_value());
+    }
+    SECTION("Truncated memory") {
+        Common::BinaryWriter writer;
+        writer.Push<u32>(0);
+        writer.Push<u32>(1);
+        writer.Push<s32>(1);
+        writer.Push<GPUVAddr>(0x10000);
+        writer.Push<u32>(0x1000);
+        writer.PushBytes(std::vector<u8>(0x10));
+        REQUIRE(!GPUCapture::Parse(writer.Buffer()).has_value());
+    }
+    SECTION("Missing frames") {
+        Common::BinaryWriter writer;
+        writer.Push<u32>(0);
+        writer.Push<u32>(0);
+        REQUIRE(!GPUCapture::Parse(writer.Buffer()).has_value());
+        writer.Push<u32>(0);
+        REQUIRE(GPUCapture::Parse(writer.Buffer()).has_value());
+    }
+}
+
+TEST_CASE("GPUCapture: Replays a semaphore acquire on the captured memory", "[video_core]") {
+    constexpr s32 channel_id = 1;
+    constexpr GPUVAddr semaphore_address = 0x10000;
+    constexpr u32 acquire_value = 7;
+    constexpr u32 release_value = 9;
+
+    GPUCaptureData capture;
+    CapturedMemory& memory = capture.memory.emplace_back();
+    memory.channel_id = channel_id;
+    memory.address = semaphore_address;
+    memory.data.resize(0x1000);
+    std::memcpy(memory.data.data(), &acquire_value, sizeof(acquire_value));
+
+    Tegra::CommandList entries;
+    const auto push = [&entries](Tegra::BufferMethods method, u32 argument) {
+        entries.prefetch_command_list.push_back(
+            Tegra::BuildCommandHeader(method, 1, Tegra::SubmissionMode::Increasing));
+        entries.prefetch_command_list.push_back(Tegra::CommandHeader{argument});
+    };
+    push(Tegra::BufferMethods::SemaphoreAddressHigh, static_cast<u32>(semaphore_address >> 32));
+    push(Tegra::BufferMethods::SemaphoreAddressLow, static_cast<u32>(semaphore_address));
+    push(Tegra::BufferMethods::SemaphoreAcquire, acquire_value);
+    push(Tegra::BufferMethods::SemaphoreRelease, release_value);
+
+    Tests::HeadlessGPU headless_gpu;
+    Tegra::GPU& gpu = headless_gpu.system.GPU();
+    const auto channel = headless_gpu.CreateChannel();
+    PAddr next_physical_address = 0;
+    GPUCapture::MapMemory(capture, channel_id, headless_gpu.system.Host1x().MemoryManager(),
+                          *channel->memory_manager, next_physical_address);
+
+    // Checked first, the acquire would wait forever on memory that was not restored
+    REQUIRE(channel->memory_manager->Read<u32>(semaphore_address) == acquire_value);
+    gpu.PushGPUEntries(channel->bind_id, std::move(entries));
+    REQUIRE(channel->memory_manager->Read<u32>(semaphore_address) == release_value);
+
+    GPUCapture::RestoreMemory(capture, channel_id, *channel->memory_manager);
+    REQUIRE(channel->memory_manager->Read<u32>(semaphore_address) == acquire_value);
+}
@@ -0,0 +1,247 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <initializer_list>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/settings.h"
+#include "tests/video_core/headless_gpu.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/engines/puller.h"
+#include "video_core/gpu.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+
+using Tegra::BufferMethods;
+using Tegra::CommandListHeader;
+using VideoCommon::GPUThread::CommandDataContainer;
+using VideoCommon::GPUThread::CommandQueue;
+using VideoCommon::GPUThread::FlushRegionCommand;
+
+namespace {
+
+constexpr u32 SYNCPOINT_ID = 10;
+constexpr GPUVAddr PUSHBUFFER_ADDR = 0x100000;
+constexpr u64 PUSHBUFFER_SIZE = 0x10000;
+constexpr GPUVAddr SEMAPHORE_ADDR = PUSHBUFFER_ADDR + PUSHBUFFER_SIZE;
+constexpr u64 ARENA_SIZE = PUSHBUFFER_SIZE + 0x1000;
+
+/// Headless asynchronous GPU with a channel fetching command lists written to guest memory
+class PushbufferFixture {
+public:
+    PushbufferFixture(bool is_pipelined, Settings::GpuAccuracy accuracy)
+        : gpu{true, is_pipelined}, channel{gpu.CreateChannel()} {
+        Settings::values.gpu_accuracy.SetValue(accuracy);
+        Settings::UpdateGPUAccuracy();
+        const DAddr device_address = gpu.AllocateDeviceMemory(ARENA_SIZE);
+        channel->memory_manager->Map(PUSHBUFFER_ADDR, device_address, ARENA_SIZE);
+    }
+
+    void Method(BufferMethods method, u32 argument) {
+        words.push_back(
+            Tegra::BuildCommandHeader(method, 1, Tegra::SubmissionMode::Increasing).argument);
+        words.push_back(argument);
+    }
+
+    void SetSemaphoreAddress(GPUVAddr gpu_addr) {
+        Method(BufferMethods::SemaphoreAddressHigh, static_cast<u32>(gpu_addr >> 32));
+        Method(BufferMethods::SemaphoreAddressLow, static_cast<u32>(gpu_addr));
+    }
+
+    void IncrementSyncpoint() {
+        Tegra::Engines::Puller::FenceAction action{};
+        action.op.Assign(Tegra::Engines::Puller::FenceOperation::Increment);
+        action.syncpoint_id.Assign(SYNCPOINT_ID);
+        Method(BufferMethods::SyncpointPayload, 0);
+        Method(BufferMethods::SyncpointOperation, action.raw);
+    }
+
+    /// Returns the gpu address the argument of the last method will be written to
+    [[nodiscard]] GPUVAddr LastArgumentAddress() const {
+        return write_addr + (words.size() - 1) * sizeof(u32);
+    }
+
+    /// Writes the methods added since the previous segment to guest memory
+    [[nodiscard]] CommandListHeader EndSegment(bool sync = false) {
+        CommandListHeader header{};
+        header.addr.Assign(write_addr);
+        header.size.Assign(words.size());
+        header.sync.Assign(sync ? 1 : 0);
+        channel->memory_manager->WriteBlockUnsafe(write_addr, words.data(),
+                                                  words.size() * sizeof(u32));
+        write_addr += words.size() * sizeof(u32);
+        words.clear();
+        return header;
+    }
+
+    void Submit(std::initializer_list<CommandListHeader> segments) {
+        Tegra::CommandList entries;
+        entries.command_lists.assign(segments.begin(), segments.end());
+        gpu.system.GPU().PushGPUEntries(channel->bind_id, std::move(entries));
+    }
+
+    [[nodiscard]] u32 Read(GPUVAddr gpu_addr) const {
+        return channel->memory_manager->Read<u32>(gpu_addr);
+    }
+
+    [[nodiscard]] Tegra::Host1x::SyncpointManager& Syncpoints() {
+        return gpu.system.Host1x().GetSyncpointManager();
+    }
+
+private:
+    Tests::HeadlessGPU gpu;
+    std::shared_ptr<Tegra::Control::ChannelState> channel;
+    std::vector<u32> words;
+    GPUVAddr write_addr = PUSHBUFFER_ADDR;
+};
+
+/// Submits segments releasing increasing values with waits between them, returns the semaphore
+/// value seen by each syncpoint increment
+std::vector<u32> RunReleases(bool is_pipelined, Settings::GpuAccuracy accuracy) {
+    constexpr u32 num_segments = 48;
+    constexpr u32 num_rounds = 2;
+    PushbufferFixture fixture{is_pipelined, accuracy};
+    std::vector<CommandListHeader> segments;
+    for (u32 value = 1; value <= num_segments; ++value) {
+        fixture.SetSemaphoreAddress(SEMAPHORE_ADDR);
+        fixture.Method(BufferMethods::SemaphoreRelease, value);
+        if (value % 8 == 0) {
+            fixture.Method(BufferMethods::WaitForIdle, 0);
+            fixture.Method(BufferMethods::SemaphoreAcquire, value);
+        }
+        fixture.IncrementSyncpoint();
+        segments.push_back(fixture.EndSegment());
+    }
+
+    // Segments are submitted again, so the second round replays their cached decoding
+    auto& syncpoints = fixture.Syncpoints();
+    const u32 base = syncpoints.GetHostSyncpointValue(SYNCPOINT_ID);
+    std::vector<u32> seen(num_segments * num_rounds);
+    for (u32 index = 0; index < seen.size(); ++index) {
+        syncpoints.RegisterHostAction(SYNCPOINT_ID, base + index + 1, [&fixture, &seen, index] {
+            seen[index] = fixture.Read(SEMAPHORE_ADDR);
+        });
+    }
+    for (u32 round = 0; round < num_rounds; ++round) {
+        for (size_t index = 0; index < segments.size(); index += 3) {
+            // Alternating submissions of one and two segments
+            const CommandListHeader& first = segments[index];
+            const CommandListHeader& second = segments[index + 1];
+            const CommandListHeader& third = segments[index + 2];
+            fixture.Submit({first});
+            fixture.Submit({second, third});
+        }
+    }
+    syncpoints.WaitHost(SYNCPOINT_ID, base + static_cast<u32>(seen.size()));
+    return seen;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("GPUThread: Command queue keeps order across batches and wraps", "[video_core]") {
+    constexpr u64 num_commands = CommandQueue::CAPACITY * 16 + 5;
+    const auto queue = std::make_unique<CommandQueue>();
+
+    std::jthread producer([&queue] {
+        for (u64 fence = 1; fence <= num_commands; ++fence) {
+            queue->Push(FlushRegionCommand(fence * 4, fence), fence, fence % 1000 == 0);
+        }
+    });
+
+    u64 expected_fence = 1;
+    size_t read_index = 0;
+    bool is_ordered = true;
+    while (expected_fence <= num_commands) {
+        const size_t end = queue->WaitForCommands(read_index, {});
+        for (; read_index != end; ++read_index) {
+            const CommandDataContainer& command = (*queue)[read_index];
+            const auto* const flush = std::get_if<FlushRegionCommand>(&command.data);
+            is_ordered &= flush && flush->addr == expected_fence * 4 &&
+                          flush->size == expected_fence && command.fence == expected_fence &&
+                          command.block == (expected_fence % 1000 == 0);
+            ++expected_fence;
+        }
+        queue->Release(end);
+    }
+    producer.join();
+    REQUIRE(is_ordered);
+
+    const auto stats = queue->GetAndResetStats();
+    REQUIRE(stats.batches > 0);
+    REQUIRE(stats.peak_depth <= CommandQueue::CAPACITY);
+    REQUIRE(queue->GetAndResetStats().batches == 0);
+}
+
+TEST_CASE("GPUThread: Command queue wakes up the consumer on stop", "[video_core]") {
+    const auto queue = std::make_unique<CommandQueue>();
+    std::stop_source stop_source;
+    size_t result = 1;
+
+    std::jthread consumer([&] { result = queue->WaitForCommands(0, stop_source.get_token()); });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    stop_source.request_stop();
+    queue->Interrupt();
+    consumer.join();
+
+    REQUIRE(result == 0);
+}
+
+TEST_CASE("GPUThread: Pipelined decoding keeps the order of releases and syncpoints",
+          "[video_core]") {
+    for (const auto accuracy : {Settings::GpuAccuracy::Normal, Settings::GpuAccuracy::High}) {
+        const std::vector<u32> executed = RunReleases(false, accuracy);
+        const std::vector<u32> pipelined = RunReleases(true, accuracy);
+        for (size_t index = 0; index < executed.size(); ++index) {
+            REQUIRE(executed[index] == index % (executed.size() / 2) + 1);
+        }
+        REQUIRE(pipelined == executed);
+    }
+}
+
+TEST_CASE("GPUThread: Segments with the sync bit are fetched after the methods before them",
+          "[video_core]") {
+    constexpr u32 STALE = 0xDEAD;
+    constexpr u32 PATCHED = 0x1234;
+    for (const bool is_pipelined : {false, true}) {
+        for (const auto accuracy : {Settings::GpuAccuracy::Normal, Settings::GpuAccuracy::High}) {
+            PushbufferFixture fixture{is_pipelined, accuracy};
+            auto& syncpoints = fixture.Syncpoints();
+            const u32 base = syncpoints.GetHostSyncpointValue(SYNCPOINT_ID);
+
+            // The first segment writes the release value of the second one
+            const auto patched_pair = [&](u32 value) {
+                fixture.SetSemaphoreAddress(SEMAPHORE_ADDR);
+                fixture.Method(BufferMethods::SemaphoreRelease, STALE);
+                const GPUVAddr patch_addr = fixture.LastArgumentAddress();
+                fixture.IncrementSyncpoint();
+                const CommandListHeader patched = fixture.EndSegment(true);
+                fixture.SetSemaphoreAddress(patch_addr);
+                fixture.Method(BufferMethods::SemaphoreRelease, value);
+                return std::pair{fixture.EndSegment(), patched};
+            };
+            const auto [first_writer, first_patched] = patched_pair(PATCHED);
+            const auto [second_writer, second_patched] = patched_pair(PATCHED + 1);
+
+            // In the same submission and in separate ones
+            fixture.Submit({first_writer, first_patched});
+            syncpoints.WaitHost(SYNCPOINT_ID, base + 1);
+            REQUIRE(fixture.Read(SEMAPHORE_ADDR) == PATCHED);
+
+            fixture.Submit({second_writer});
+            fixture.Submit({second_patched});
+            syncpoints.WaitHost(SYNCPOINT_ID, base + 2);
+            REQUIRE(fixture.Read(SEMAPHORE_ADDR) == PATCHED + 1);
+        }
+    }
+}
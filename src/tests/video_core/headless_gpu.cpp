@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "core/frontend/graphics_context.h"
+#include "tests/video_core/headless_gpu.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/gpu.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+
+namespace Tests {
+
+std::unique_ptr<Core::Frontend::GraphicsContext> NullWindow::CreateSharedContext() const {
+    return std::make_unique<Core::Frontend::GraphicsContext>();
+}
+
+GPUSettingsGuard::GPUSettingsGuard()
+    : renderer_backend{Settings::values.renderer_backend.GetValue()},
+      use_asynchronous_gpu_emulation{Settings::values.use_asynchronous_gpu_emulation.GetValue()},
+      use_pipelined_gpu{Settings::values.use_pipelined_gpu.GetValue()},
+      use_draw_coalescing{Settings::values.use_draw_coalescing.GetValue()},
+      gpu_accuracy{Settings::values.gpu_accuracy.GetValue()} {}
+
+GPUSettingsGuard::~GPUSettingsGuard() {
+    Settings::values.renderer_backend.SetValue(renderer_backend);
+    Settings::values.use_asynchronous_gpu_emulation.SetValue(use_asynchronous_gpu_emulation);
+    Settings::values.use_pipelined_gpu.SetValue(use_pipelined_gpu);
+    Settings::values.use_draw_coalescing.SetValue(use_draw_coalescing);
+    Settings::values.gpu_accuracy.SetValue(gpu_accuracy);
+    Settings::UpdateGPUAccuracy();
+}
+
+HeadlessGPU::HeadlessGPU(bool is_async, bool is_pipelined) {
+    Settings::values.renderer_backend.SetValue(Settings::RendererBackend::Null);
+    Settings::values.use_asynchronous_gpu_emulation.SetValue(is_async);
+    Settings::values.use_pipelined_gpu.SetValue(is_pipelined);
+
+    system.Initialize();
+    REQUIRE(system.InitializeGPUReplay(window) == Core::SystemResultStatus::Success);
+    system.GPU().Start();
+}
+
+HeadlessGPU::~HeadlessGPU() {
+    system.ShutdownGPUReplay();
+}
+
+std::shared_ptr<Tegra::Control::ChannelState> HeadlessGPU::CreateChannel() {
+    Tegra::GPU& gpu = system.GPU();
+    auto channel = gpu.AllocateChannel();
+    channel->memory_manager = std::make_shared<Tegra::MemoryManager>(system);
+    gpu.InitAddressSpace(*channel->memory_manager);
+    gpu.InitChannel(*channel, 0);
+    return channel;
+}
+
+DAddr HeadlessGPU::AllocateDeviceMemory(u64 size) {
+    auto& device_memory = system.Host1x().MemoryManager();
+    const DAddr device_address = device_memory.Allocate(size);
+    device_memory.MapPhysical(device_address, next_physical_address, size);
+    next_physical_address += size;
+    return device_address;
+}
+
+} // namespace Tests
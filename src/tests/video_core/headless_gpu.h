@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <memory>
+
+#include "common/common_types.h"
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/frontend/emu_window.h"
+
+namespace Tegra::Control {
+struct ChannelState;
+}
+
+namespace Tests {
+
+/// Window of the headless GPU
+class NullWindow final : public Core::Frontend::EmuWindow {
+public:
+    std::unique_ptr<Core::Frontend::GraphicsContext> CreateSharedContext() const override;
+
+    bool IsShown() const override {
+        return false;
+    }
+};
+
+/// Restores the settings tests change to run the GPU when leaving the scope
+class GPUSettingsGuard {
+public:
+    GPUSettingsGuard();
+    ~GPUSettingsGuard();
+
+private:
+    Settings::RendererBackend renderer_backend;
+    bool use_asynchronous_gpu_emulation;
+    bool use_pipelined_gpu;
+    bool use_draw_coalescing;
+    Settings::GpuAccuracy gpu_accuracy;
+};
+
+/**
+ * System without a title whose GPU runs on the null renderer. The GPU settings it overrides, and
+ * any other the test changes through GPUSettingsGuard, are restored when it is destroyed.
+ */
+class HeadlessGPU {
+public:
+    explicit HeadlessGPU(bool is_async = false, bool is_pipelined = false);
+    ~HeadlessGPU();
+
+    /// Allocates a channel with its own address space and initializes its engines
+    [[nodiscard]] std::shared_ptr<Tegra::Control::ChannelState> CreateChannel();
+
+    /// Allocates device memory backed by physical memory no other allocation uses
+    [[nodiscard]] DAddr AllocateDeviceMemory(u64 size);
+
+    Core::System system;
+
+private:
+    GPUSettingsGuard settings_guard;
+    NullWindow window;
+    PAddr next_physical_address = 0;
+};
+
+} // namespace Tests
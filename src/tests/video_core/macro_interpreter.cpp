@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/macro/macro_interpreter.h"
+
+namespace {
+
+using Tegra::Macro::ALUOperation;
+using Tegra::Macro::BranchCondition;
+using Tegra::Macro::Opcode;
+using Tegra::Macro::Operation;
+using Tegra::Macro::ResultOperation;
+using Tegra::Macro::ThreadedProgram;
+using Send = std::pair<u32, u32>;
+
+class RecordingTarget final : public Tegra::Macro::ExecutionTarget {
+public:
+    void Send(u32 method, u32 value) override {
+        sends.emplace_back(method, value);
+    }
+
+    u32 Read(u32 method) const override {
+        return method * 3 + 1;
+    }
+
+    std::vector<std::pair<u32, u32>> sends;
+};
+
+/// Method address with an increment, as set by the SetMethod result operations
+constexpr s32 Method(u32 address, u32 increment) {
+    return static_cast<s32>(address | (increment << 12));
+}
+
+u32 AddImmediate(ResultOperation result, u32 dst, u32 src_a, s32 immediate,
+                 bool is_exit = false) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::AddImmediate);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(immediate);
+    opcode.is_exit.Assign(is_exit ? 1 : 0);
+    return opcode.raw;
+}
+
+u32 Alu(ALUOperation operation, ResultOperation result, u32 dst, u32 src_a, u32 src_b) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::ALU);
+    opcode.alu_operation.Assign(operation);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.src_b.Assign(src_b);
+    return opcode.raw;
+}
+
+u32 Bitfield(Operation operation, u32 dst, u32 src_a, u32 src_b, u32 src_bit, u32 size,
+             u32 dst_bit) {
+    Opcode opcode{};
+    opcode.operation.Assign(operation);
+    opcode.result_operation.Assign(ResultOperation::MoveAndSend);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.src_b.Assign(src_b);
+    opcode.bf_src_bit.Assign(src_bit);
+    opcode.bf_size.Assign(size);
+    opcode.bf_dst_bit.Assign(dst_bit);
+    return opcode.raw;
+}
+
+u32 Read(ResultOperation result, u32 dst, u32 src_a, s32 immediate) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::Read);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(immediate);
+    return opcode.raw;
+}
+
+u32 Branch(BranchCondition condition, u32 src_a, s32 offset, bool annul, bool is_exit = false) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::Branch);
+    opcode.branch_condition.Assign(condition);
+    opcode.branch_annul.Assign(annul ? 1 : 0);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(offset);
+    opcode.is_exit.Assign(is_exit ? 1 : 0);
+    return opcode.raw;
+}
+
+/// Sends every parameter after the first, which holds the number of parameters to send
+const std::vector<u32> STREAM_PARAMETERS{
+    AddImmediate(ResultOperation::MoveAndSetMethod, 2, 0, Method(0x100, 1)),
+    AddImmediate(ResultOperation::IgnoreAndFetch, 3, 0, 0),
+    AddImmediate(ResultOperation::MoveAndSend, 0, 3, 0),
+    AddImmediate(ResultOperation::Move, 1, 1, -1),
+    Branch(BranchCondition::NotZero, 1, -3, false),
+    AddImmediate(ResultOperation::Move, 4, 4, 1),
+    AddImmediate(ResultOperation::MoveAndSend, 0, 4, 0, true),
+    Read(ResultOperation::MoveAndSend, 0, 0, 0x10),
+    AddImmediate(ResultOperation::MoveAndSend, 0, 0, 99),
+};
+
+std::vector<Send> Run(const std::vector<u32>& code, const std::vector<u32>& parameters) {
+    const ThreadedProgram program{code};
+    RecordingTarget target;
+    program.Execute(target, parameters);
+    return std::move(target.sends);
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MacroInterpreter: Loop with delay slots and exit", "[video_core]") {
+    const std::vector<Send> expected{
+        {0x100, 10}, {0x101, 20}, {0x102, 30}, {0x103, 3}, {0x104, 0x10 * 3 + 1},
+    };
+    REQUIRE(Run(STREAM_PARAMETERS, {3, 10, 20, 30}) == expected);
+    // State must not leak between invocations
+    REQUIRE(Run(STREAM_PARAMETERS, {3, 10, 20, 30}) == expected);
+}
+
+TEST_CASE("MacroInterpreter: ALU, carry and bitfield operations", "[video_core]") {
+    const std::vector<u32> code{
+        AddImmediate(ResultOperation::IgnoreAndFetch, 6, 0, 0),
+        Alu(ALUOperation::Add, ResultOperation::Move, 2, 1, 1),
+        Alu(ALUOperation::AddWithCarry, ResultOperation::Move, 3, 0, 0),
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, Method(0x200, 1)),
+        Alu(ALUOperation::Add, ResultOperation::MoveAndSend, 0, 2, 3),
+        Alu(ALUOperation::Subtract, ResultOperation::MoveAndSend, 4, 0, 3),
+        Alu(ALUOperation::SubtractWithBorrow, ResultOperation::MoveAndSend, 5, 3, 0),
+        Bitfield(Operation::ExtractInsert, 0, 1, 3, 0, 4, 8),
+        Bitfield(Operation::ExtractShiftLeftImmediate, 0, 3, 6, 0, 8, 4),
+        Bitfield(Operation::ExtractShiftLeftRegister, 0, 3, 6, 4, 4, 0),
+        Alu(ALUOperation::Nand, ResultOperation::MoveAndSend, 7, 6, 6),
+        AddImmediate(ResultOperation::MoveAndSetMethodSend, 0, 0, Method(0x300, 5), true),
+        Read(ResultOperation::MoveAndSend, 0, 3, 0x10),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 99),
+    };
+    const std::vector<Send> expected{
+        {0x200, 3},            // 2 + carry out of 0x80000001 + 0x80000001
+        {0x201, 0xffffffff},   // $r0 still reads as zero after being written
+        {0x202, 0},            // Borrow from the previous subtraction
+        {0x203, 0x80000101},   // Insert bits 0-3 of $r3 at bit 8
+        {0x204, 0x780},        // (0xf0 >> $r3) & 0xff, shifted left by 4
+        {0x205, 0x1e},         // (0xf0 >> 4) & 0xf, shifted left by $r3
+        {0x206, 0xffffff0f},   // Nand
+        {0x300, 5},            // Bits 12-17 of the new method address
+        {0x305, 0x11 * 3 + 1}, // Read in the delay slot of the exit
+    };
+    REQUIRE(Run(code, {0x80000001, 0xf0}) == expected);
+}
+
+TEST_CASE("MacroInterpreter: Annulled branches and exits in delay slots", "[video_core]") {
+    const std::vector<u32> code{
+        Branch(BranchCondition::Zero, 1, 3, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 1),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 1, true),
+        Branch(BranchCondition::Zero, 1, 3, false, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 2, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 3),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 4, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 5),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 0, 6),
+    };
+    const std::vector<Send> expected{{0, 2}, {0, 4}, {0, 5}};
+    REQUIRE(Run(code, {0}) == expected);
+
+    // Not taken, so the exit flag of the branch applies after its delay slot
+    const std::vector<Send> not_taken{{0, 2}};
+    REQUIRE(Run({code.begin() + 3, code.end()}, {1}) == not_taken);
+}
+
+TEST_CASE("MacroInterpreter: Replay benchmark", "[.][benchmark]") {
+    // Invocations in the shape of those recorded from games: short parameter streams with a
+    // count in the first parameter, interleaved with bitfield heavy state macros
+    const std::vector<u32> state_macro{
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, Method(0x400, 1)),
+        Bitfield(Operation::ExtractInsert, 2, 1, 1, 0, 8, 8),
+        Bitfield(Operation::ExtractShiftLeftImmediate, 3, 0, 1, 0, 16, 16),
+        Alu(ALUOperation::Or, ResultOperation::MoveAndSend, 4, 2, 3),
+        Read(ResultOperation::MoveAndSend, 5, 0, 0x20),
+        Alu(ALUOperation::Add, ResultOperation::MoveAndSend, 6, 5, 4),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 6, 1, true),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 6, 2),
+    };
+    const ThreadedProgram stream{STREAM_PARAMETERS};
+    const ThreadedProgram state{state_macro};
+    std::vector<u32> stream_parameters{16};
+    for (u32 i = 0; i < 16; ++i) {
+        stream_parameters.push_back(i * 7);
+    }
+    const std::vector<u32> state_parameters{0x12345678};
+    RecordingTarget target;
+    target.sends.reserve(1 << 16);
+
+    BENCHMARK("Replay 1000 invocations") {
+        target.sends.clear();
+        for (u32 i = 0; i < 500; ++i) {
+            stream.Execute(target, stream_parameters);
+            state.Execute(target, state_parameters);
+        }
+        return target.sends.size();
+    };
+}
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <chrono>
+#include <filesystem>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/macro/macro_interpreter.h"
+#include "video_core/macro/macro_profiler.h"
+
+namespace {
+
+using namespace std::chrono_literals;
+using Tegra::MacroProfiler;
+using Tegra::MacroRecording;
+using Tegra::Macro::Opcode;
+using Tegra::Macro::Operation;
+using Tegra::Macro::ResultOperation;
+
+class RecordingTarget final : public Tegra::Macro::ExecutionTarget {
+public:
+    void Send(u32 method, u32 value) override {
+        sends.emplace_back(method, value);
+    }
+
+    u32 Read(u32 method) const override {
+        return method;
+    }
+
+    std::vector<std::pair<u32, u32>> sends;
+};
+
+u32 AddImmediate(ResultOperation result, u32 dst, u32 src_a, s32 immediate,
+                 bool is_exit = false) {
+    Opcode opcode{};
+    opcode.operation.Assign(Operation::AddImmediate);
+    opcode.result_operation.Assign(result);
+    opcode.dst.Assign(dst);
+    opcode.src_a.Assign(src_a);
+    opcode.immediate.Assign(immediate);
+    opcode.is_exit.Assign(is_exit ? 1 : 0);
+    return opcode.raw;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MacroProfiler: Entries are ranked by cumulative time", "[video_core]") {
+    MacroProfiler profiler{false};
+    profiler.Record(0xa, false, 4, 10us);
+    profiler.Record(0xb, true, 1, 15us);
+    profiler.Record(0xa, false, 6, 10us);
+    profiler.Record(0xc, false, 0, 1us);
+    // Recording is disabled, so invocations are dropped
+    profiler.RecordInvocation(0xa, std::vector<u32>{1}, std::vector<u32>{2});
+
+    const std::vector<MacroProfiler::Entry> entries = profiler.GetEntries();
+    REQUIRE(entries.size() == 3);
+    REQUIRE(entries[0].hash == 0xa);
+    REQUIRE(entries[0].invocations == 2);
+    REQUIRE(entries[0].method_calls == 10);
+    REQUIRE(entries[0].time == 20us);
+    REQUIRE(entries[1].hash == 0xb);
+    REQUIRE(entries[1].is_hle);
+    REQUIRE(entries[2].hash == 0xc);
+
+    const std::string report = profiler.GetReport();
+    REQUIRE(report.find("3 programs, 4 invocations") != std::string::npos);
+    REQUIRE(report.find("HLE coverage: 25.0% of invocations, 41.7% of execution time") !=
+            std::string::npos);
+}
+
+TEST_CASE("MacroProfiler: Recordings replay through the interpreter", "[video_core]") {
+    // Sends the first parameter plus one to method 0x10
+    const std::vector<u32> code{
+        AddImmediate(ResultOperation::MoveAndSetMethod, 0, 0, 0x10),
+        AddImmediate(ResultOperation::MoveAndSend, 0, 1, 1, true),
+        AddImmediate(ResultOperation::Move, 0, 0, 0),
+    };
+    MacroRecording recording{
+        .hash = 0x1234,
+        .code = code,
+        .invocations = {{5}, {7}, {0}},
+    };
+    const std::filesystem::path path =
+        std::filesystem::temp_directory_path() / "citron_macro_profiler_test.mrec";
+    REQUIRE(MacroProfiler::WriteRecording(path, recording));
+    const std::optional<MacroRecording> read = MacroProfiler::ReadRecording(path);
+    std::filesystem::remove(path);
+
+    REQUIRE(read.has_value());
+    REQUIRE(read->code == recording.code);
+    REQUIRE(read->invocations == recording.invocations);
+
+    const Tegra::Macro::ThreadedProgram program{read->code};
+    RecordingTarget target;
+    for (const std::vector<u32>& parameters : read->invocations) {
+        program.Execute(target, parameters);
+    }
+    const std::vector<std::pair<u32, u32>> expected{{0x10, 6}, {0x10, 8}, {0x10, 1}};
+    REQUIRE(target.sends == expected);
+}
@@ -0,0 +1,238 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/device_memory_manager.h"
+#include "tests/video_core/headless_gpu.h"
+#include "video_core/control/channel_state.h"
+#include "video_core/engines/maxwell_dma.h"
+#include "video_core/gpu.h"
+#include "video_core/memory_manager.h"
+
+namespace {
+
+using Tegra::Engines::DmaCopyStats;
+using CopyPath = DmaCopyStats::CopyPath;
+
+// Device memory mapped straight to physical memory only has host spans within a device page, so
+// copies inside a page take the direct paths and copies crossing a page take the staged ones
+constexpr u64 PAGE_SIZE = Core::DEVICE_PAGESIZE;
+constexpr u64 ARENA_SIZE = 16 * PAGE_SIZE;
+constexpr GPUVAddr PITCH_ARENA = 0x100000;
+constexpr GPUVAddr BLOCK_ARENA = 0x200000;
+constexpr GPUVAddr DIRECT_BASE = PITCH_ARENA + PAGE_SIZE + 0x10;
+constexpr GPUVAddr STAGED_PAGE_END = PITCH_ARENA + 4 * PAGE_SIZE;
+
+constexpr u32 OFFSET_IN_UPPER = 0x100;
+constexpr u32 OFFSET_IN_LOWER = 0x101;
+constexpr u32 OFFSET_OUT_UPPER = 0x102;
+constexpr u32 OFFSET_OUT_LOWER = 0x103;
+constexpr u32 PITCH_IN = 0x104;
+constexpr u32 PITCH_OUT = 0x105;
+constexpr u32 LINE_LENGTH_IN = 0x106;
+constexpr u32 LINE_COUNT = 0x107;
+constexpr u32 LAUNCH_DMA = 0xC0;
+
+/// Non pipelined launch without semaphore
+constexpr u32 LAUNCH_BUFFER = 2;
+/// Non pipelined multi line launch with both sides in pitch layout
+constexpr u32 LAUNCH_PITCH_TO_PITCH = LAUNCH_BUFFER | (1 << 7) | (1 << 8) | (1 << 9);
+
+struct PitchCopy {
+    u32 src_offset;
+    u32 dst_offset;
+    u32 pitch_in;
+    u32 pitch_out;
+    u32 line_length;
+    u32 line_count;
+
+    /// Bytes from the base address covering both rectangles
+    [[nodiscard]] u64 Extent() const {
+        return std::max(src_offset + (line_count - 1) * pitch_in,
+                        dst_offset + (line_count - 1) * pitch_out) +
+               line_length;
+    }
+};
+
+/// Pattern that only depends on the offset within the range it fills
+std::vector<u8> Pattern(u64 size) {
+    std::vector<u8> data(size);
+    for (size_t i = 0; i < data.size(); ++i) {
+        data[i] = static_cast<u8>(i * 31 + (i >> 8) * 101 + 7);
+    }
+    return data;
+}
+
+/// Headless GPU with a channel whose DMA engine copies within a pitch and a block linear arena
+class DmaFixture {
+public:
+    DmaFixture() : channel{gpu.CreateChannel()} {
+        Map(PITCH_ARENA, Tegra::PTEKind::PITCH);
+        Map(BLOCK_ARENA, Tegra::PTEKind::GENERIC_16BX2);
+        static_cast<void>(gpu.system.GPU().DmaCopyStats().GetAndReset());
+    }
+
+    void Fill(GPUVAddr gpu_addr, u64 size) {
+        const std::vector<u8> data = Pattern(size);
+        channel->memory_manager->WriteBlockUnsafe(gpu_addr, data.data(), size);
+    }
+
+    [[nodiscard]] std::vector<u8> Read(GPUVAddr gpu_addr, u64 size) const {
+        std::vector<u8> data(size);
+        channel->memory_manager->ReadBlockUnsafe(gpu_addr, data.data(), size);
+        return data;
+    }
+
+    void Launch(GPUVAddr src_addr, GPUVAddr dst_addr, u32 pitch_in, u32 pitch_out,
+                u32 line_length, u32 line_count, u32 launch) {
+        Method(OFFSET_IN_UPPER, static_cast<u32>(src_addr >> 32));
+        Method(OFFSET_IN_LOWER, static_cast<u32>(src_addr));
+        Method(OFFSET_OUT_UPPER, static_cast<u32>(dst_addr >> 32));
+        Method(OFFSET_OUT_LOWER, static_cast<u32>(dst_addr));
+        Method(PITCH_IN, pitch_in);
+        Method(PITCH_OUT, pitch_out);
+        Method(LINE_LENGTH_IN, line_length);
+        Method(LINE_COUNT, line_count);
+        Method(LAUNCH_DMA, launch);
+    }
+
+    /// Runs a pitch copy from a freshly filled base address, returns the bytes it covers
+    [[nodiscard]] std::vector<u8> RunPitchCopy(GPUVAddr base, const PitchCopy& copy) {
+        Fill(base, copy.Extent());
+        Launch(base + copy.src_offset, base + copy.dst_offset, copy.pitch_in, copy.pitch_out,
+               copy.line_length, copy.line_count, LAUNCH_PITCH_TO_PITCH);
+        return Read(base, copy.Extent());
+    }
+
+    [[nodiscard]] DmaCopyStats::Snapshot GetAndResetStats() {
+        return gpu.system.GPU().DmaCopyStats().GetAndReset();
+    }
+
+private:
+    void Map(GPUVAddr gpu_addr, Tegra::PTEKind kind) {
+        const DAddr device_address = gpu.AllocateDeviceMemory(ARENA_SIZE);
+        channel->memory_manager->Map(gpu_addr, device_address, ARENA_SIZE, kind, false);
+    }
+
+    void Method(u32 method, u32 argument) {
+        channel->maxwell_dma->CallMethod(method, argument, true);
+    }
+
+    Tests::HeadlessGPU gpu;
+    std::shared_ptr<Tegra::Control::ChannelState> channel;
+};
+
+} // Anonymous namespace
+
+TEST_CASE("MaxwellDMA: Direct pitch copies match the staged copies", "[video_core]") {
+    DmaFixture fixture;
+    const PitchCopy copies[]{
+        // Packed lines
+        {.src_offset = 0,
+         .dst_offset = 0x600,
+         .pitch_in = 256,
+         .pitch_out = 256,
+         .line_length = 256,
+         .line_count = 4},
+        // Lines with different pitches
+        {.src_offset = 0,
+         .dst_offset = 0x600,
+         .pitch_in = 256,
+         .pitch_out = 320,
+         .line_length = 200,
+         .line_count = 6},
+        // Overlapping rectangles, each line sees the lines written before it
+        {.src_offset = 0,
+         .dst_offset = 128,
+         .pitch_in = 256,
+         .pitch_out = 256,
+         .line_length = 200,
+         .line_count = 8},
+        {.src_offset = 128,
+         .dst_offset = 0,
+         .pitch_in = 256,
+         .pitch_out = 256,
+         .line_length = 200,
+         .line_count = 8},
+        {.src_offset = 0,
+         .dst_offset = 64,
+         .pitch_in = 256,
+         .pitch_out = 256,
+         .line_length = 256,
+         .line_count = 4},
+    };
+    for (const PitchCopy& copy : copies) {
+        const std::vector<u8> direct = fixture.RunPitchCopy(DIRECT_BASE, copy);
+        REQUIRE(fixture.GetAndResetStats().Copies(CopyPath::PitchToPitchDirect) == 1);
+
+        // The page boundary splits the first source line
+        const GPUVAddr staged_base = STAGED_PAGE_END - copy.src_offset - copy.line_length / 2;
+        const std::vector<u8> staged = fixture.RunPitchCopy(staged_base, copy);
+        REQUIRE(fixture.GetAndResetStats().Copies(CopyPath::PitchToPitchStaged) == 1);
+
+        REQUIRE(direct == staged);
+        REQUIRE(direct != Pattern(copy.Extent()));
+    }
+}
+
+TEST_CASE("MaxwellDMA: Direct buffer swizzles match the staged swizzles", "[video_core]") {
+    constexpr u32 LENGTH = 1024;
+    constexpr GPUVAddr BLOCK_ADDR = BLOCK_ARENA + PAGE_SIZE + 0x40;
+    // Whole GOBs covered by the block linear side
+    constexpr GPUVAddr BLOCK_BEGIN = BLOCK_ARENA + PAGE_SIZE;
+    constexpr u64 BLOCK_SIZE = 3 * 512;
+    constexpr GPUVAddr STAGED_LINEAR_ADDR = STAGED_PAGE_END - LENGTH / 2;
+
+    DmaFixture fixture;
+    const auto swizzle = [&](GPUVAddr linear_addr, bool is_src_pitch) {
+        fixture.Fill(linear_addr, LENGTH);
+        fixture.Fill(BLOCK_BEGIN, BLOCK_SIZE);
+        if (is_src_pitch) {
+            fixture.Launch(linear_addr, BLOCK_ADDR, 0, 0, LENGTH, 1, LAUNCH_BUFFER);
+            return fixture.Read(BLOCK_BEGIN, BLOCK_SIZE);
+        }
+        fixture.Launch(BLOCK_ADDR, linear_addr, 0, 0, LENGTH, 1, LAUNCH_BUFFER);
+        return fixture.Read(linear_addr, LENGTH);
+    };
+    for (const bool is_src_pitch : {true, false}) {
+        const std::vector<u8> direct = swizzle(DIRECT_BASE, is_src_pitch);
+        REQUIRE(fixture.GetAndResetStats().Copies(CopyPath::BufferSwizzleDirect) == 1);
+        const std::vector<u8> staged = swizzle(STAGED_LINEAR_ADDR, is_src_pitch);
+        REQUIRE(fixture.GetAndResetStats().Copies(CopyPath::BufferSwizzleStaged) == 1);
+        REQUIRE(direct == staged);
+        REQUIRE(direct != Pattern(is_src_pitch ? BLOCK_SIZE : LENGTH));
+    }
+}
+
+TEST_CASE("DmaCopyStats: Reports the copies per frame of the paths taken", "[video_core]") {
+    DmaCopyStats stats;
+    for (int copy = 0; copy < 6; ++copy) {
+        stats.RecordCopy(CopyPath::PitchToPitchDirect);
+    }
+    stats.RecordCopy(CopyPath::BufferSwizzleStaged);
+    stats.NotifyFrameEnd();
+    stats.NotifyFrameEnd();
+
+    const DmaCopyStats::Snapshot snapshot = stats.GetAndReset();
+    REQUIRE(snapshot.Copies(CopyPath::PitchToPitchDirect) == 6);
+    REQUIRE(snapshot.Copies(CopyPath::BufferSwizzleStaged) == 1);
+    REQUIRE(snapshot.Copies(CopyPath::PitchToPitchStaged) == 0);
+    REQUIRE(snapshot.frames == 2);
+
+    const std::string report = DmaCopyStats::FormatReport(snapshot);
+    REQUIRE(report.find("Pitch to pitch (direct)") != std::string::npos);
+    REQUIRE(report.find("3.0") != std::string::npos);
+    REQUIRE(report.find("Buffer swizzle (staged)") != std::string::npos);
+    REQUIRE(report.find("Pitch to pitch (staged)") == std::string::npos);
+
+    const DmaCopyStats::Snapshot empty = stats.GetAndReset();
+    REQUIRE(empty.Copies(CopyPath::PitchToPitchDirect) == 0);
+    REQUIRE(empty.frames == 0);
+}
@@ -0,0 +1,274 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <span>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "common/literals.h"
+#include "tests/video_core/headless_gpu.h"
+#include "video_core/gpu.h"
+#include "video_core/host1x/host1x.h"
+#include "video_core/memory_manager.h"
+
+namespace {
+
+using namespace Common::Literals;
+using Tegra::MemoryManager;
+
+constexpr u64 BIG_PAGE_SIZE = 64_KiB;
+/// Queries longer than four big pages go through the translation cache
+constexpr u64 CACHED_SIZE = 1_MiB;
+constexpr GPUVAddr GPU_ADDR = 0x10000000;
+
+/// Headless GPU creating memory managers and the device memory they map
+class MemoryManagerFixture {
+public:
+    MemoryManager& CreateManager() {
+        auto& manager = managers.emplace_back(std::make_unique<MemoryManager>(gpu.system));
+        gpu.system.GPU().InitAddressSpace(*manager);
+        return *manager;
+    }
+
+    /// Allocates device memory backed by physical memory, filled with a byte
+    DAddr Allocate(u64 size, u8 fill) {
+        const DAddr device_address = gpu.AllocateDeviceMemory(size);
+        const std::vector<u8> data(size, fill);
+        gpu.system.Host1x().MemoryManager().WriteBlockUnsafe(device_address, data.data(), size);
+        return device_address;
+    }
+
+    u8* HostPointer(DAddr device_address) {
+        return gpu.system.Host1x().MemoryManager().GetPointer<u8>(device_address);
+    }
+
+private:
+    Tests::HeadlessGPU gpu;
+    std::vector<std::unique_ptr<MemoryManager>> managers;
+};
+
+u8 ReadByte(const MemoryManager& manager, GPUVAddr gpu_addr) {
+    u8 value{};
+    manager.ReadBlockUnsafe(gpu_addr, &value, sizeof(value));
+    return value;
+}
+
+/// Returns true when a range reads as the given byte
+bool IsFilled(const MemoryManager& manager, GPUVAddr gpu_addr, u64 size, u8 fill) {
+    std::vector<u8> data(size);
+    manager.ReadBlockUnsafe(gpu_addr, data.data(), size);
+    return std::ranges::all_of(data, [fill](u8 value) { return value == fill; });
+}
+
+} // Anonymous namespace
+
+TEST_CASE("MemoryManager: Cached translations are invalidated by remaps", "[video_core]") {
+    MemoryManagerFixture fixture;
+    MemoryManager& manager = fixture.CreateManager();
+    const DAddr first = fixture.Allocate(2_MiB, 0x11);
+    const DAddr second = fixture.Allocate(BIG_PAGE_SIZE, 0x22);
+    manager.Map(GPU_ADDR, first, 2_MiB);
+
+    // Queried twice, the second query hits the run cached by the first one
+    for (int pass = 0; pass < 2; ++pass) {
+        REQUIRE(manager.IsContinuousRange(GPU_ADDR, CACHED_SIZE));
+        REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == 2_MiB);
+        REQUIRE(IsFilled(manager, GPU_ADDR, CACHED_SIZE, 0x11));
+    }
+
+    const u64 generation = manager.TranslationGeneration();
+    const GPUVAddr remapped = GPU_ADDR + 8 * BIG_PAGE_SIZE;
+    manager.Map(remapped, second, BIG_PAGE_SIZE);
+    REQUIRE(manager.TranslationGeneration() != generation);
+    REQUIRE(!manager.IsContinuousRange(GPU_ADDR, CACHED_SIZE));
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == 8 * BIG_PAGE_SIZE);
+    REQUIRE(manager.GpuToCpuAddress(remapped) == second);
+
+    std::vector<u8> data(CACHED_SIZE);
+    manager.ReadBlockUnsafe(GPU_ADDR, data.data(), data.size());
+    REQUIRE(data[8 * BIG_PAGE_SIZE - 1] == 0x11);
+    REQUIRE(data[8 * BIG_PAGE_SIZE] == 0x22);
+    REQUIRE(data[9 * BIG_PAGE_SIZE - 1] == 0x22);
+    REQUIRE(data[9 * BIG_PAGE_SIZE] == 0x11);
+
+    manager.Unmap(GPU_ADDR + 4 * BIG_PAGE_SIZE, BIG_PAGE_SIZE);
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == 4 * BIG_PAGE_SIZE);
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR + 4 * BIG_PAGE_SIZE, 2_MiB) == 0);
+    REQUIRE(!manager.GpuToCpuAddress(GPU_ADDR + 4 * BIG_PAGE_SIZE));
+}
+
+TEST_CASE("MemoryManager: Cached runs are extended by longer queries", "[video_core]") {
+    MemoryManagerFixture fixture;
+    MemoryManager& manager = fixture.CreateManager();
+    const DAddr first = fixture.Allocate(4_MiB, 0x11);
+    manager.Map(GPU_ADDR, first, 4_MiB);
+
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, CACHED_SIZE) == CACHED_SIZE);
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == 2_MiB);
+    // Past the end of the mapping the run stops being contiguous
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 8_MiB) == 4_MiB);
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR + CACHED_SIZE, 8_MiB) == 3_MiB);
+    REQUIRE(manager.GpuToCpuAddress(GPU_ADDR + 3_MiB) == first + 3_MiB);
+
+    // Extending a run stops at a page mapped to a different device address
+    const DAddr second = fixture.Allocate(BIG_PAGE_SIZE, 0x22);
+    manager.Map(GPU_ADDR + 3_MiB, second, BIG_PAGE_SIZE);
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, CACHED_SIZE) == CACHED_SIZE);
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 4_MiB) == 3_MiB);
+}
+
+TEST_CASE("MemoryManager: Translation caches are separate per manager", "[video_core]") {
+    MemoryManagerFixture fixture;
+    MemoryManager& first_manager = fixture.CreateManager();
+    MemoryManager& second_manager = fixture.CreateManager();
+    const DAddr first = fixture.Allocate(2_MiB, 0x11);
+    const DAddr second = fixture.Allocate(2_MiB, 0x22);
+    first_manager.Map(GPU_ADDR, first, 2_MiB);
+    second_manager.Map(GPU_ADDR, second, 2_MiB);
+
+    // Both managers use the same cache slots of this thread
+    for (int pass = 0; pass < 2; ++pass) {
+        REQUIRE(IsFilled(first_manager, GPU_ADDR, CACHED_SIZE, 0x11));
+        REQUIRE(IsFilled(second_manager, GPU_ADDR, CACHED_SIZE, 0x22));
+    }
+
+    // Remapping in one manager leaves the translations of the other one alone
+    first_manager.Unmap(GPU_ADDR + CACHED_SIZE / 2, BIG_PAGE_SIZE);
+    REQUIRE(first_manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == CACHED_SIZE / 2);
+    REQUIRE(second_manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == 2_MiB);
+    REQUIRE(ReadByte(first_manager, GPU_ADDR + CACHED_SIZE) == 0x11);
+    REQUIRE(ReadByte(second_manager, GPU_ADDR + CACHED_SIZE) == 0x22);
+}
+
+TEST_CASE("MemoryManager: Remaps invalidate the translations cached by other threads",
+          "[video_core]") {
+    MemoryManagerFixture fixture;
+    MemoryManager& manager = fixture.CreateManager();
+    const DAddr first = fixture.Allocate(2_MiB, 0x11);
+    const DAddr second = fixture.Allocate(BIG_PAGE_SIZE, 0x22);
+    manager.Map(GPU_ADDR, first, 2_MiB);
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == 2_MiB);
+
+    size_t thread_range = 0;
+    std::thread([&] {
+        // The thread starts with an empty cache and fills its own
+        thread_range = manager.MaxContinuousRange(GPU_ADDR, 2_MiB);
+        manager.Map(GPU_ADDR + CACHED_SIZE, second, BIG_PAGE_SIZE);
+    }).join();
+    REQUIRE(thread_range == 2_MiB);
+
+    // The run cached by this thread before the remap is not used anymore
+    REQUIRE(manager.MaxContinuousRange(GPU_ADDR, 2_MiB) == CACHED_SIZE);
+    REQUIRE(ReadByte(manager, GPU_ADDR + CACHED_SIZE) == 0x22);
+    std::thread([&] { thread_range = manager.MaxContinuousRange(GPU_ADDR, 2_MiB); }).join();
+    REQUIRE(thread_range == CACHED_SIZE);
+}
+
+TEST_CASE("MemoryManager: Host spans merge contiguous pieces and skip holes", "[video_core]") {
+    constexpr u64 SMALL_PAGE_SIZE = 4_KiB;
+    MemoryManagerFixture fixture;
+    MemoryManager& manager = fixture.CreateManager();
+    // Allocated back to back, so their host memory is contiguous
+    const DAddr big = fixture.Allocate(BIG_PAGE_SIZE, 0x11);
+    const DAddr small = fixture.Allocate(SMALL_PAGE_SIZE, 0x22);
+    u8* const host = fixture.HostPointer(big);
+    REQUIRE(fixture.HostPointer(small) == host + BIG_PAGE_SIZE);
+
+    // A big page, a small page following it in host memory, an unmapped small page and a small
+    // page mapped back inside the big one
+    const GPUVAddr small_addr = GPU_ADDR + BIG_PAGE_SIZE;
+    const GPUVAddr hole_addr = small_addr + SMALL_PAGE_SIZE;
+    const GPUVAddr aliased_addr = hole_addr + SMALL_PAGE_SIZE;
+    manager.Map(GPU_ADDR, big, BIG_PAGE_SIZE);
+    manager.Map(small_addr, small, SMALL_PAGE_SIZE, Tegra::PTEKind::INVALID, false);
+    manager.Map(aliased_addr, big + SMALL_PAGE_SIZE, SMALL_PAGE_SIZE, Tegra::PTEKind::INVALID,
+                false);
+
+    using Piece = std::pair<GPUVAddr, std::span<u8>>;
+    const auto spans = [&manager](GPUVAddr gpu_addr, u64 size) {
+        const auto result = manager.GetHostSpans(gpu_addr, size);
+        return std::vector<Piece>(result.begin(), result.end());
+    };
+    const auto is_equal = [](const std::vector<Piece>& result,
+                             const std::vector<Piece>& expected) {
+        return std::ranges::equal(result, expected, [](const Piece& lhs, const Piece& rhs) {
+            return lhs.first == rhs.first && lhs.second.data() == rhs.second.data() &&
+                   lhs.second.size() == rhs.second.size();
+        });
+    };
+
+    REQUIRE(is_equal(spans(GPU_ADDR, aliased_addr + SMALL_PAGE_SIZE - GPU_ADDR),
+                     {
+                         {GPU_ADDR, std::span<u8>(host, BIG_PAGE_SIZE + SMALL_PAGE_SIZE)},
+                         {aliased_addr, std::span<u8>(host + SMALL_PAGE_SIZE, SMALL_PAGE_SIZE)},
+                     }));
+    // Unaligned ends crossing from the big page to the small one
+    REQUIRE(is_equal(spans(small_addr - 0x10, 0x20),
+                     {{small_addr - 0x10, std::span<u8>(host + BIG_PAGE_SIZE - 0x10, 0x20)}}));
+    // Within a single device page
+    REQUIRE(is_equal(spans(GPU_ADDR + 0x100, 0x40),
+                     {{GPU_ADDR + 0x100, std::span<u8>(host + 0x100, 0x40)}}));
+    REQUIRE(spans(hole_addr, SMALL_PAGE_SIZE).empty());
+    REQUIRE(is_equal(spans(hole_addr + 0x800, SMALL_PAGE_SIZE),
+                     {{aliased_addr, std::span<u8>(host + SMALL_PAGE_SIZE, 0x800)}}));
+}
+
+TEST_CASE("MemoryManager: Translation benchmark", "[.][benchmark]") {
+    constexpr u64 MAPPED_SIZE = 64_MiB;
+    constexpr size_t WORKING_SET_SIZE = 192;
+    MemoryManagerFixture fixture;
+    MemoryManager& manager = fixture.CreateManager();
+    manager.Map(GPU_ADDR, fixture.Allocate(MAPPED_SIZE, 0), MAPPED_SIZE);
+
+    // Addresses reused by the caches of the GPU, like the ones of buffers and textures
+    std::mt19937 generator{1234};
+    std::uniform_int_distribution<u64> big_page{0, (MAPPED_SIZE - 4_MiB) / BIG_PAGE_SIZE};
+    std::vector<GPUVAddr> working_set(WORKING_SET_SIZE);
+    for (GPUVAddr& gpu_addr : working_set) {
+        gpu_addr = GPU_ADDR + big_page(generator) * BIG_PAGE_SIZE;
+    }
+    std::vector<u8> buffer(256_KiB);
+
+    BENCHMARK("IsContinuousRange 1 MiB") {
+        size_t continuous = 0;
+        for (const GPUVAddr gpu_addr : working_set) {
+            continuous += manager.IsContinuousRange(gpu_addr, 1_MiB) ? 1 : 0;
+        }
+        return continuous;
+    };
+    BENCHMARK("MaxContinuousRange 4 MiB") {
+        size_t size = 0;
+        for (const GPUVAddr gpu_addr : working_set) {
+            size += manager.MaxContinuousRange(gpu_addr, 4_MiB);
+        }
+        return size;
+    };
+    BENCHMARK("GpuToCpuAddress") {
+        DAddr sum = 0;
+        for (const GPUVAddr gpu_addr : working_set) {
+            sum += manager.GpuToCpuAddress(gpu_addr).value_or(0);
+        }
+        return sum;
+    };
+    BENCHMARK("GetSpan 256 KiB") {
+        size_t found = 0;
+        for (const GPUVAddr gpu_addr : working_set) {
+            found += manager.GetSpan(gpu_addr, buffer.size()) != nullptr ? 1 : 0;
+        }
+        return found;
+    };
+    BENCHMARK("ReadBlockUnsafe 256 KiB") {
+        for (const GPUVAddr gpu_addr : working_set) {
+            manager.ReadBlockUnsafe(gpu_addr, buffer.data(), buffer.size());
+        }
+        return buffer[0];
+    };
+}
@@ -1,10 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2023 citron Emulator Project
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <memory>
+#include <random>
 #include <stdexcept>
 #include <unordered_map>
+#include <vector>
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include "common/alignment.h"
@@ -546,3 +550,136 @@ TEST_CASE("MemoryTracker: Cached write downloads") {
     memory_track->MarkRegionAsCpuModified(c, WORD);
     REQUIRE(rasterizer.Count() == 0);
 }
+
+TEST_CASE("MemoryTracker: Modified ranges across summary words", "[video_core]") {
+    // Large enough to spill to the heap and to need more than one summary word
+    RasterizerInterface rasterizer;
+    VideoCommon::WordManager<RasterizerInterface> manager(c, rasterizer, WORD * 130);
+    manager.ChangeRegionState<VideoCommon::Type::CPU, false>(c, WORD * 130);
+    REQUIRE(rasterizer.Count() == 130 * 64);
+    REQUIRE(!manager.IsRegionModified<VideoCommon::Type::CPU>(0, WORD * 130));
+
+    manager.ChangeRegionState<VideoCommon::Type::CPU, true>(c + WORD * 64 - PAGE, PAGE * 2);
+    manager.ChangeRegionState<VideoCommon::Type::CPU, true>(c + WORD * 129, PAGE);
+    REQUIRE(manager.ModifiedRegion<VideoCommon::Type::CPU>(0, WORD * 130) ==
+            Range{WORD * 64 - PAGE, WORD * 129 + PAGE});
+    REQUIRE(!manager.IsRegionModified<VideoCommon::Type::CPU>(WORD * 65, WORD * 64));
+
+    std::vector<Range> ranges;
+    manager.ForEachModifiedRange<VideoCommon::Type::CPU, true>(
+        c, WORD * 130, [&](u64 offset, u64 size) { ranges.emplace_back(offset, offset + size); });
+    REQUIRE(ranges == std::vector<Range>{{c + WORD * 64 - PAGE, c + WORD * 64 + PAGE},
+                                         {c + WORD * 129, c + WORD * 129 + PAGE}});
+    REQUIRE(!manager.IsRegionModified<VideoCommon::Type::CPU>(0, WORD * 130));
+    REQUIRE(rasterizer.Count() == 130 * 64);
+}
+
+TEST_CASE("MemoryTracker: Cached writes across summary words", "[video_core]") {
+    RasterizerInterface rasterizer;
+    VideoCommon::WordManager<RasterizerInterface> manager(c, rasterizer, WORD * 130);
+    manager.ChangeRegionState<VideoCommon::Type::CPU, false>(c, WORD * 130);
+    manager.ChangeRegionState<VideoCommon::Type::CachedCPU, true>(c + WORD * 127, WORD * 2);
+    REQUIRE(rasterizer.Count() == 128 * 64);
+    REQUIRE(!manager.IsRegionModified<VideoCommon::Type::CPU>(0, WORD * 130));
+
+    manager.FlushCachedWrites();
+    REQUIRE(manager.ModifiedRegion<VideoCommon::Type::CPU>(0, WORD * 130) ==
+            Range{WORD * 127, WORD * 129});
+    REQUIRE(!manager.IsRegionModified<VideoCommon::Type::CachedCPU>(0, WORD * 130));
+    REQUIRE(rasterizer.Count() == 128 * 64);
+}
+
+TEST_CASE("MemoryTracker: Random operations match a page model", "[video_core]") {
+    constexpr u64 NUM_PAGES = 3 * HIGH_PAGE_SIZE / PAGE;
+    RasterizerInterface rasterizer;
+    std::unique_ptr<MemoryTracker> memory_track(std::make_unique<MemoryTracker>(rasterizer));
+    // Regions are created with every page CPU modified
+    std::vector<bool> cpu_pages(NUM_PAGES, true);
+    std::vector<bool> gpu_pages(NUM_PAGES, false);
+    memory_track->MarkRegionAsCpuModified(c, NUM_PAGES * PAGE);
+
+    std::mt19937 rng{1234};
+    const auto random_range = [&] {
+        const u64 begin = std::uniform_int_distribution<u64>{0, NUM_PAGES - 1}(rng);
+        const u64 max_size = std::min<u64>(NUM_PAGES - begin, WORD * 3 / PAGE);
+        return Range{begin, begin + std::uniform_int_distribution<u64>{1, max_size}(rng)};
+    };
+    const auto any_set = [](const std::vector<bool>& pages, Range range) {
+        return std::any_of(pages.begin() + range.first, pages.begin() + range.second,
+                           [](bool page) { return page; });
+    };
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        const Range range = random_range();
+        const VAddr addr = c + range.first * PAGE;
+        const u64 size = (range.second - range.first) * PAGE;
+        switch (std::uniform_int_distribution<int>{0, 4}(rng)) {
+        case 0:
+            memory_track->MarkRegionAsCpuModified(addr, size);
+            std::fill(cpu_pages.begin() + range.first, cpu_pages.begin() + range.second, true);
+            break;
+        case 1:
+            memory_track->UnmarkRegionAsCpuModified(addr, size);
+            std::fill(cpu_pages.begin() + range.first, cpu_pages.begin() + range.second, false);
+            break;
+        case 2:
+            memory_track->MarkRegionAsGpuModified(addr, size);
+            std::fill(gpu_pages.begin() + range.first, gpu_pages.begin() + range.second, true);
+            break;
+        case 3:
+            memory_track->UnmarkRegionAsGpuModified(addr, size);
+            std::fill(gpu_pages.begin() + range.first, gpu_pages.begin() + range.second, false);
+            break;
+        case 4: {
+            u64 num_pages = 0;
+            memory_track->ForEachUploadRange(addr, size, [&](u64 offset, u64 upload_size) {
+                num_pages += upload_size / PAGE;
+            });
+            const auto first = cpu_pages.begin() + range.first;
+            const auto last = cpu_pages.begin() + range.second;
+            REQUIRE(num_pages == static_cast<u64>(std::count(first, last, true)));
+            std::fill(first, last, false);
+            break;
+        }
+        }
+        const Range query = random_range();
+        const VAddr query_addr = c + query.first * PAGE;
+        const u64 query_size = (query.second - query.first) * PAGE;
+        REQUIRE(memory_track->IsRegionCpuModified(query_addr, query_size) ==
+                any_set(cpu_pages, query));
+        // GPU modifications of pages modified by the CPU are not reported
+        bool is_gpu_modified = false;
+        for (u64 page = query.first; page < query.second; ++page) {
+            is_gpu_modified |= gpu_pages[page] && !cpu_pages[page];
+        }
+        REQUIRE(memory_track->IsRegionGpuModified(query_addr, query_size) == is_gpu_modified);
+    }
+    // Pages that are not CPU modified are the ones tracked by the rasterizer
+    REQUIRE(rasterizer.Count() == static_cast<u64>(std::count(cpu_pages.begin(),
+                                                              cpu_pages.end(), false)));
+}
+
+TEST_CASE("MemoryTracker: Sparse upload benchmark", "[.][benchmark]") {
+    constexpr u64 REGION_SIZE = 64 * HIGH_PAGE_SIZE;
+    RasterizerInterface rasterizer;
+    std::unique_ptr<MemoryTracker> memory_track(std::make_unique<MemoryTracker>(rasterizer));
+    memory_track->UnmarkRegionAsCpuModified(c, REGION_SIZE);
+
+    BENCHMARK("Clean region query") {
+        return memory_track->IsRegionCpuModified(c, REGION_SIZE);
+    };
+    BENCHMARK("Clean region upload") {
+        u64 uploaded = 0;
+        memory_track->ForEachUploadRange(c, REGION_SIZE,
+                                         [&](u64 offset, u64 size) { uploaded += size; });
+        return uploaded;
+    };
+    BENCHMARK("Sparse region upload") {
+        for (u64 offset = 0; offset < REGION_SIZE; offset += HIGH_PAGE_SIZE) {
+            memory_track->MarkRegionAsCpuModified(c + offset + PAGE * 7, PAGE);
+        }
+        u64 uploaded = 0;
+        memory_track->ForEachUploadRange(c, REGION_SIZE,
+                                         [&](u64 offset, u64 size) { uploaded += size; });
+        return uploaded;
+    };
+}
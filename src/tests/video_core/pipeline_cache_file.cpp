@@ -0,0 +1,269 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stop_token>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "shader_recompiler/program_header.h"
+#include "shader_recompiler/stage.h"
+#include "video_core/pipeline_cache_file.h"
+
+namespace {
+
+using VideoCommon::CachedPipeline;
+using VideoCommon::PipelineCacheFile;
+
+using ComputeKey = u64;
+using GraphicsKey = std::array<u64, 2>;
+
+constexpr u32 CACHE_VERSION = 7;
+constexpr u32 NUM_INSTRUCTIONS = 256;
+
+struct LoadedPipeline {
+    u64 key;
+    std::vector<u64> first_instructions;
+};
+
+std::filesystem::path TestPath() {
+    return std::filesystem::temp_directory_path() / "citron_pipeline_cache_test.bin";
+}
+
+template <typename T>
+void Push(std::vector<u8>& data, const T& value) {
+    const auto bytes = reinterpret_cast<const u8*>(&value);
+    data.insert(data.end(), bytes, bytes + sizeof(T));
+}
+
+/// Builds an environment in the serialization format of FileEnvironment
+std::vector<u8> MakeEnvironment(Shader::Stage stage, u64 seed) {
+    std::vector<u8> data;
+    Push(data, static_cast<u64>(NUM_INSTRUCTIONS * sizeof(u64))); // code_size
+    for (size_t index = 0; index < 4; ++index) {
+        Push(data, u64{0}); // No textures nor constant buffer values
+    }
+    Push(data, u32{0});                                          // local_memory_size
+    Push(data, u32{1});                                          // texture_bound
+    Push(data, u32{0});                                          // start_address
+    Push(data, u32{0});                                          // read_lowest
+    Push(data, static_cast<u32>(NUM_INSTRUCTIONS * sizeof(u64))); // read_highest
+    Push(data, u32{1});                                          // viewport_transform_state
+    Push(data, stage);
+    for (u64 index = 0; index < NUM_INSTRUCTIONS; ++index) {
+        // Similar code in every environment, as in real shaders
+        Push(data, index % 16 == 0 ? seed : 0xE30000000007000FULL + index * 8);
+    }
+    if (stage == Shader::Stage::Compute) {
+        Push(data, std::array<u32, 3>{32, 1, 1});
+        Push(data, u32{0}); // shared_memory_size
+    } else {
+        Push(data, Shader::ProgramHeader{});
+    }
+    return data;
+}
+
+void AppendCompute(PipelineCacheFile& file, ComputeKey key) {
+    const std::array environments{MakeEnvironment(Shader::Stage::Compute, key)};
+    file.AppendPipeline(std::span(reinterpret_cast<const char*>(&key), sizeof(key)),
+                        environments, 1U << static_cast<u32>(Shader::Stage::Compute));
+}
+
+void AppendGraphics(PipelineCacheFile& file, const GraphicsKey& key) {
+    const std::array environments{MakeEnvironment(Shader::Stage::VertexB, key[0]),
+                                  MakeEnvironment(Shader::Stage::Fragment, key[1])};
+    file.AppendPipeline(std::span(reinterpret_cast<const char*>(&key), sizeof(key)),
+                        environments,
+                        (1U << static_cast<u32>(Shader::Stage::VertexB)) |
+                            (1U << static_cast<u32>(Shader::Stage::Fragment)));
+}
+
+void LoadEnvironments(const CachedPipeline& cached, LoadedPipeline& pipeline) {
+    for (auto& env : cached.LoadEnvironments()) {
+        pipeline.first_instructions.push_back(env.ReadInstruction(0));
+    }
+}
+
+std::vector<LoadedPipeline> LoadFile(PipelineCacheFile& file, u32 version = CACHE_VERSION) {
+    std::vector<LoadedPipeline> pipelines;
+    file.Load<ComputeKey, GraphicsKey>(
+        TestPath(), version, std::stop_token{},
+        [&pipelines](CachedPipeline cached) {
+            ComputeKey key{};
+            REQUIRE(cached.ReadKey(key));
+            LoadedPipeline& pipeline = pipelines.emplace_back(key);
+            LoadEnvironments(cached, pipeline);
+        },
+        [&pipelines](CachedPipeline cached) {
+            GraphicsKey key{};
+            REQUIRE(cached.ReadKey(key));
+            LoadedPipeline& pipeline = pipelines.emplace_back(key[0] ^ key[1]);
+            LoadEnvironments(cached, pipeline);
+        });
+    return pipelines;
+}
+
+std::vector<u8> ReadTestFile() {
+    std::ifstream file(TestPath(), std::ios::binary);
+    return std::vector<u8>(std::istreambuf_iterator<char>(file), {});
+}
+
+u32 ReadHeaderField(const std::vector<u8>& data, size_t offset) {
+    u32 value{};
+    std::memcpy(&value, data.data() + offset, sizeof(value));
+    return value;
+}
+
+bool HasMagic(const std::vector<u8>& data, const char (&magic)[9]) {
+    return data.size() >= 8 && std::memcmp(data.data(), magic, 8) == 0;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PipelineCacheFile: Pipelines round trip and share environments", "[video_core]") {
+    std::filesystem::remove(TestPath());
+    {
+        PipelineCacheFile file;
+        REQUIRE(LoadFile(file).empty());
+        REQUIRE(file.IsOpen());
+        AppendCompute(file, 0x1111);
+        AppendGraphics(file, {0x2222, 0x3333});
+        AppendGraphics(file, {0x2222, 0x4444});
+    }
+    const auto check_pipelines{[](const std::vector<LoadedPipeline>& pipelines) {
+        REQUIRE(pipelines.size() == 3);
+        REQUIRE(pipelines[0].key == 0x1111);
+        REQUIRE(pipelines[0].first_instructions == std::vector<u64>{0x1111});
+        REQUIRE(pipelines[1].key == (0x2222 ^ 0x3333));
+        REQUIRE(pipelines[1].first_instructions == std::vector<u64>{0x2222, 0x3333});
+        REQUIRE(pipelines[2].key == (0x2222 ^ 0x4444));
+        REQUIRE(pipelines[2].first_instructions == std::vector<u64>{0x2222, 0x4444});
+    }};
+    PipelineCacheFile file;
+    check_pipelines(LoadFile(file));
+
+    // The journal is merged into the index, with the shared vertex environment stored once
+    std::vector<u8> data = ReadTestFile();
+    REQUIRE(HasMagic(data, "citronpc"));
+    REQUIRE(ReadHeaderField(data, 16) == 4);
+    REQUIRE(ReadHeaderField(data, 20) == 3);
+    REQUIRE(ReadHeaderField(data, 32) == data.size());
+
+    // A pipeline made of stored environments only appends its key and environment hashes
+    AppendGraphics(file, {0x2222, 0x4444});
+    const size_t appended_size = ReadTestFile().size() - data.size();
+    REQUIRE(appended_size == 8 + 8 + 2 * sizeof(u128) + sizeof(GraphicsKey));
+
+    PipelineCacheFile reloaded;
+    const std::vector<LoadedPipeline> pipelines = LoadFile(reloaded);
+    REQUIRE(pipelines.size() == 4);
+    REQUIRE(pipelines[3].first_instructions == std::vector<u64>{0x2222, 0x4444});
+    std::filesystem::remove(TestPath());
+}
+
+TEST_CASE("PipelineCacheFile: Legacy files are migrated", "[video_core]") {
+    {
+        std::vector<u8> data{'y', 'u', 'z', 'u', 'c', 'a', 'c', 'h'};
+        Push(data, CACHE_VERSION);
+        const auto push_pipeline{[&data](auto key, auto... environments) {
+            Push(data, static_cast<u32>(sizeof...(environments)));
+            (data.insert(data.end(), environments.begin(), environments.end()), ...);
+            Push(data, key);
+        }};
+        push_pipeline(ComputeKey{1}, MakeEnvironment(Shader::Stage::Compute, 1));
+        push_pipeline(GraphicsKey{2, 3}, MakeEnvironment(Shader::Stage::VertexB, 2),
+                      MakeEnvironment(Shader::Stage::Fragment, 3));
+        push_pipeline(ComputeKey{4}, MakeEnvironment(Shader::Stage::Compute, 1));
+        std::ofstream file(TestPath(), std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+    }
+    PipelineCacheFile file;
+    const std::vector<LoadedPipeline> pipelines = LoadFile(file);
+    REQUIRE(pipelines.size() == 3);
+    REQUIRE(pipelines[0].first_instructions == std::vector<u64>{1});
+    REQUIRE(pipelines[1].key == (2 ^ 3));
+    REQUIRE(pipelines[1].first_instructions == std::vector<u64>{2, 3});
+    REQUIRE(pipelines[2].key == 4);
+    REQUIRE(pipelines[2].first_instructions == std::vector<u64>{1});
+
+    const std::vector<u8> data = ReadTestFile();
+    REQUIRE(HasMagic(data, "citronpc"));
+    REQUIRE(ReadHeaderField(data, 16) == 3);
+
+    PipelineCacheFile reloaded;
+    REQUIRE(LoadFile(reloaded).size() == 3);
+    std::filesystem::remove(TestPath());
+}
+
+TEST_CASE("PipelineCacheFile: Partial records are dropped", "[video_core]") {
+    std::filesystem::remove(TestPath());
+    {
+        PipelineCacheFile file;
+        LoadFile(file);
+        AppendCompute(file, 1);
+        AppendCompute(file, 2);
+    }
+    std::filesystem::resize_file(TestPath(), std::filesystem::file_size(TestPath()) - 3);
+
+    PipelineCacheFile file;
+    const std::vector<LoadedPipeline> pipelines = LoadFile(file);
+    REQUIRE(pipelines.size() == 1);
+    REQUIRE(pipelines[0].key == 1);
+    REQUIRE(ReadHeaderField(ReadTestFile(), 20) == 1);
+    std::filesystem::remove(TestPath());
+}
+
+TEST_CASE("PipelineCacheFile: Files of other versions are deleted", "[video_core]") {
+    std::filesystem::remove(TestPath());
+    {
+        PipelineCacheFile file;
+        LoadFile(file);
+        AppendCompute(file, 1);
+    }
+    PipelineCacheFile file;
+    REQUIRE(LoadFile(file, CACHE_VERSION + 1).empty());
+    REQUIRE(!std::filesystem::exists(TestPath()));
+
+    // Pipelines are written in a new file for the new version
+    AppendCompute(file, 2);
+    PipelineCacheFile reloaded;
+    const std::vector<LoadedPipeline> pipelines = LoadFile(reloaded, CACHE_VERSION + 1);
+    REQUIRE(pipelines.size() == 1);
+    REQUIRE(pipelines[0].key == 2);
+    std::filesystem::remove(TestPath());
+}
+
+TEST_CASE("PipelineCacheFile: Environments are compressed with a dictionary", "[video_core]") {
+    constexpr u64 NUM_PIPELINES = 200;
+    std::filesystem::remove(TestPath());
+    {
+        PipelineCacheFile file;
+        LoadFile(file);
+        for (u64 key = 0; key < NUM_PIPELINES; ++key) {
+            AppendCompute(file, key);
+        }
+    }
+    PipelineCacheFile file;
+    REQUIRE(LoadFile(file).size() == NUM_PIPELINES);
+    const std::vector<u8> data = ReadTestFile();
+    REQUIRE(ReadHeaderField(data, 28) != 0);
+
+    // Pipelines appended afterwards use the dictionary of the file
+    AppendCompute(file, NUM_PIPELINES);
+
+    PipelineCacheFile reloaded;
+    const std::vector<LoadedPipeline> pipelines = LoadFile(reloaded);
+    REQUIRE(pipelines.size() == NUM_PIPELINES + 1);
+    for (u64 key = 0; key <= NUM_PIPELINES; ++key) {
+        REQUIRE(pipelines[key].key == key);
+        REQUIRE(pipelines[key].first_instructions == std::vector<u64>{key});
+    }
+    std::filesystem::remove(TestPath());
+}
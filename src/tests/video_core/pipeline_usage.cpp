@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/binary_buffer.h"
+#include "common/common_types.h"
+#include "video_core/pipeline_usage.h"
+
+namespace {
+
+using VideoCommon::PipelineUsage;
+
+std::filesystem::path TestPath() {
+    return std::filesystem::temp_directory_path() / "citron_pipeline_usage_test.bin";
+}
+
+void WriteTestFile(const std::vector<u8>& data) {
+    std::ofstream file(TestPath(), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PipelineUsage: Pipelines without usage are built at boot", "[video_core]") {
+    std::filesystem::remove(TestPath());
+    PipelineUsage usage;
+    usage.Load(TestPath());
+
+    const std::array<u64, 3> key_hashes{30, 10, 20};
+    const PipelineUsage::WarmupOrder order{usage.Prioritize(key_hashes)};
+    REQUIRE(order.synchronous == std::vector<size_t>{0, 1, 2});
+    REQUIRE(order.background.empty());
+}
+
+TEST_CASE("PipelineUsage: Pipelines are ordered by their first use", "[video_core]") {
+    std::filesystem::remove(TestPath());
+    {
+        PipelineUsage usage;
+        usage.Load(TestPath());
+        usage.StartSession();
+        usage.RecordLookup(20, false);
+        usage.RecordLookup(10, false);
+        usage.RecordLookup(20, true);
+        usage.RecordLookup(20, true);
+
+        const PipelineUsage::Statistics statistics{usage.GetStatistics()};
+        REQUIRE(statistics.hits == 2);
+        REQUIRE(statistics.misses == 2);
+        usage.Save();
+    }
+    PipelineUsage usage;
+    usage.Load(TestPath());
+
+    // Used pipelines come first, unused ones are left to the background in cache order
+    const std::array<u64, 4> key_hashes{30, 10, 40, 20};
+    const PipelineUsage::WarmupOrder order{usage.Prioritize(key_hashes)};
+    REQUIRE(order.synchronous == std::vector<size_t>{3, 1});
+    REQUIRE(order.background == std::vector<size_t>{0, 2});
+
+    // Pipelines not used in a session keep their previous usage
+    usage.StartSession();
+    usage.RecordLookup(40, false);
+    usage.Save();
+
+    PipelineUsage reloaded;
+    reloaded.Load(TestPath());
+    REQUIRE(reloaded.Prioritize(key_hashes).background == std::vector<size_t>{0});
+    std::filesystem::remove(TestPath());
+}
+
+TEST_CASE("PipelineUsage: Invalid files load as no usage", "[video_core]") {
+    std::filesystem::remove(TestPath());
+    {
+        PipelineUsage usage;
+        usage.Load(TestPath());
+        usage.StartSession();
+        usage.RecordLookup(20, false);
+        usage.Save();
+    }
+    std::vector<u8> valid;
+    {
+        std::ifstream file(TestPath(), std::ios::binary);
+        valid.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    // Magic number and version, then the number of entries
+    constexpr size_t count_offset = 12;
+    REQUIRE(valid.size() == count_offset + 4 + 16);
+
+    std::vector<std::vector<u8>> invalid_files;
+    invalid_files.emplace_back(valid.begin(), valid.begin() + 6);
+    invalid_files.emplace_back(valid.begin(), valid.end() - 1);
+    invalid_files.push_back(valid);
+    invalid_files.back().push_back(0);
+    invalid_files.push_back(valid);
+    invalid_files.back()[0] ^= 0xFF;
+    for (const u32 count : {2u, 0x10000000u, 0xFFFFFFFFu}) {
+        // Counts larger than the rest of the file must not allocate their entries
+        Common::BinaryWriter writer;
+        writer.PushBytes(valid);
+        writer.Overwrite(count_offset, count);
+        invalid_files.push_back(writer.Buffer());
+    }
+
+    const std::array<u64, 2> key_hashes{10, 20};
+    for (const std::vector<u8>& data : invalid_files) {
+        WriteTestFile(data);
+        PipelineUsage usage;
+        usage.Load(TestPath());
+        const PipelineUsage::WarmupOrder order{usage.Prioritize(key_hashes)};
+        REQUIRE(order.synchronous == std::vector<size_t>{0, 1});
+        REQUIRE(order.background.empty());
+    }
+
+    WriteTestFile(valid);
+    PipelineUsage usage;
+    usage.Load(TestPath());
+    REQUIRE(usage.Prioritize(key_hashes).synchronous == std::vector<size_t>{1});
+    std::filesystem::remove(TestPath());
+}
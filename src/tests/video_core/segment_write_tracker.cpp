@@ -0,0 +1,85 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <memory>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "core/device_memory.h"
+#include "core/memory.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+#include "video_core/segment_write_tracker.h"
+
+namespace {
+
+using Tegra::SegmentWriteTracker;
+
+constexpr u64 PAGE = Core::Memory::CITRON_PAGESIZE;
+// Device addresses without CPU backing, the tracker only counts them in the device memory
+constexpr DAddr BASE = 0x10000 * PAGE;
+constexpr size_t SEGMENT_SIZE = PAGE + 0x200;
+
+struct DeviceMemoryFixture {
+    Core::DeviceMemory device_memory;
+    std::unique_ptr<Tegra::MaxwellDeviceMemoryManager> device_memory_manager =
+        std::make_unique<Tegra::MaxwellDeviceMemoryManager>(device_memory);
+};
+
+} // Anonymous namespace
+
+TEST_CASE("SegmentWriteTracker: Writes to tracked pages mark the range", "[video_core]") {
+    DeviceMemoryFixture fixture;
+    SegmentWriteTracker tracker(*fixture.device_memory_manager);
+
+    const u64 track_counter = tracker.Track(BASE, SEGMENT_SIZE);
+    REQUIRE(!tracker.IsWritten(BASE, SEGMENT_SIZE, track_counter));
+
+    // Writes outside the pages of the range are ignored
+    tracker.OnWrite(BASE + 2 * PAGE, 4);
+    tracker.OnWrite(BASE - 4, 4);
+    REQUIRE(!tracker.IsWritten(BASE, SEGMENT_SIZE, track_counter));
+
+    // A write to the second page, which the range only partly covers
+    tracker.OnWrite(BASE + PAGE + 0x400, 4);
+    REQUIRE(tracker.IsWritten(BASE, SEGMENT_SIZE, track_counter));
+
+    // Tracking again starts from the current writes
+    tracker.Untrack(BASE, SEGMENT_SIZE);
+    const u64 new_track_counter = tracker.Track(BASE, SEGMENT_SIZE);
+    REQUIRE(!tracker.IsWritten(BASE, SEGMENT_SIZE, new_track_counter));
+    tracker.Untrack(BASE, SEGMENT_SIZE);
+}
+
+TEST_CASE("SegmentWriteTracker: Large invalidations mark the tracked pages", "[video_core]") {
+    DeviceMemoryFixture fixture;
+    SegmentWriteTracker tracker(*fixture.device_memory_manager);
+
+    const u64 track_counter = tracker.Track(BASE, SEGMENT_SIZE);
+    tracker.OnWrite(BASE + 4 * PAGE, 0x1000 * PAGE);
+    REQUIRE(!tracker.IsWritten(BASE, SEGMENT_SIZE, track_counter));
+
+    tracker.OnWrite(0, 0x1000000 * PAGE);
+    REQUIRE(tracker.IsWritten(BASE, SEGMENT_SIZE, track_counter));
+    tracker.Untrack(BASE, SEGMENT_SIZE);
+}
+
+TEST_CASE("SegmentWriteTracker: Ranges sharing pages are tracked separately", "[video_core]") {
+    DeviceMemoryFixture fixture;
+    SegmentWriteTracker tracker(*fixture.device_memory_manager);
+
+    const u64 first_counter = tracker.Track(BASE, PAGE);
+    const u64 second_counter = tracker.Track(BASE, 2 * PAGE);
+    tracker.Untrack(BASE, 2 * PAGE);
+
+    // The first range keeps its page tracked, the page only used by the second one is released
+    REQUIRE(!tracker.IsWritten(BASE, PAGE, first_counter));
+    REQUIRE(tracker.IsWritten(BASE, 2 * PAGE, second_counter));
+
+    tracker.OnWrite(BASE, 4);
+    REQUIRE(tracker.IsWritten(BASE, PAGE, first_counter));
+    tracker.Untrack(BASE, PAGE);
+
+    // Ranges that are not tracked are always reported as written
+    REQUIRE(tracker.IsWritten(BASE, PAGE, first_counter));
+}
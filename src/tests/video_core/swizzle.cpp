@@ -0,0 +1,171 @@
+// SPDX-FileCopyrightText: Copyright 2026 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/textures/decoders.h"
+
+namespace {
+using Tegra::Texture::SwizzleKernel;
+
+constexpr std::array BYTES_PER_PIXEL{1U, 2U, 3U, 4U, 6U, 8U, 12U, 16U};
+constexpr std::array KERNELS{SwizzleKernel::Generic, SwizzleKernel::SSE2, SwizzleKernel::AVX2,
+                             SwizzleKernel::NEON};
+
+constexpr u32 WIDTH = 83;
+constexpr u32 HEIGHT = 45;
+constexpr u32 DEPTH = 3;
+
+std::vector<u8> RandomBytes(std::size_t size, u32 seed) {
+    std::mt19937 rng{seed};
+    std::vector<u8> data(size);
+    for (u8& value : data) {
+        value = static_cast<u8>(rng());
+    }
+    return data;
+}
+
+/// Restores the host's best swizzle kernel when leaving the scope
+struct KernelGuard {
+    ~KernelGuard() {
+        Tegra::Texture::SetSwizzleKernel(Tegra::Texture::GetBestSwizzleKernel());
+    }
+};
+} // Anonymous namespace
+
+TEST_CASE("Swizzle: Unswizzle kernels match scalar", "[video_core]") {
+    KernelGuard guard;
+    for (const u32 bpp : BYTES_PER_PIXEL) {
+        for (u32 block_height = 0; block_height <= 5; ++block_height) {
+            for (u32 block_depth = 0; block_depth <= 1; ++block_depth) {
+                const std::size_t tiled_size = Tegra::Texture::CalculateSize(
+                    true, bpp, WIDTH, HEIGHT, DEPTH, block_height, block_depth);
+                const std::size_t linear_size = std::size_t{WIDTH} * HEIGHT * DEPTH * bpp;
+                const std::vector<u8> input = RandomBytes(tiled_size, bpp * 8 + block_height);
+
+                std::vector<u8> expected(linear_size);
+                Tegra::Texture::SetSwizzleKernel(SwizzleKernel::Scalar);
+                Tegra::Texture::UnswizzleTexture(expected, input, bpp, WIDTH, HEIGHT, DEPTH,
+                                                 block_height, block_depth);
+                for (const SwizzleKernel kernel : KERNELS) {
+                    if (!Tegra::Texture::IsSwizzleKernelSupported(kernel)) {
+                        continue;
+                    }
+                    std::vector<u8> output(linear_size);
+                    Tegra::Texture::SetSwizzleKernel(kernel);
+                    Tegra::Texture::UnswizzleTexture(output, input, bpp, WIDTH, HEIGHT, DEPTH,
+                                                     block_height, block_depth);
+                    REQUIRE(output == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Swizzle: Swizzle kernels match scalar", "[video_core]") {
+    KernelGuard guard;
+    for (const u32 bpp : BYTES_PER_PIXEL) {
+        for (u32 block_height = 0; block_height <= 5; ++block_height) {
+            for (u32 block_depth = 0; block_depth <= 1; ++block_depth) {
+                const std::size_t tiled_size = Tegra::Texture::CalculateSize(
+                    true, bpp, WIDTH, HEIGHT, DEPTH, block_height, block_depth);
+                const std::size_t linear_size = std::size_t{WIDTH} * HEIGHT * DEPTH * bpp;
+                const std::vector<u8> input = RandomBytes(linear_size, bpp * 8 + block_height);
+
+                std::vector<u8> expected(tiled_size);
+                Tegra::Texture::SetSwizzleKernel(SwizzleKernel::Scalar);
+                Tegra::Texture::SwizzleTexture(expected, input, bpp, WIDTH, HEIGHT, DEPTH,
+                                               block_height, block_depth);
+                for (const SwizzleKernel kernel : KERNELS) {
+                    if (!Tegra::Texture::IsSwizzleKernelSupported(kernel)) {
+                        continue;
+                    }
+                    std::vector<u8> output(tiled_size);
+                    Tegra::Texture::SetSwizzleKernel(kernel);
+                    Tegra::Texture::SwizzleTexture(output, input, bpp, WIDTH, HEIGHT, DEPTH,
+                                                   block_height, block_depth);
+                    REQUIRE(output == expected);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Swizzle: Subrect kernels match scalar", "[video_core]") {
+    KernelGuard guard;
+    constexpr u32 origin_x = 5;
+    constexpr u32 origin_y = 3;
+    constexpr u32 extent_x = 70;
+    constexpr u32 extent_y = 39;
+    for (const u32 bpp : BYTES_PER_PIXEL) {
+        for (u32 block_height = 0; block_height <= 5; ++block_height) {
+            const std::size_t tiled_size =
+                Tegra::Texture::CalculateSize(true, bpp, WIDTH, HEIGHT, 1, block_height, 0);
+            const u32 pitch = extent_x * bpp + 16;
+            const std::size_t linear_size = std::size_t{pitch} * HEIGHT;
+            const std::vector<u8> tiled = RandomBytes(tiled_size, bpp * 8 + block_height);
+            const std::vector<u8> linear = RandomBytes(linear_size, bpp * 16 + block_height);
+
+            std::vector<u8> expected_linear(linear_size);
+            std::vector<u8> expected_tiled(tiled_size);
+            Tegra::Texture::SetSwizzleKernel(SwizzleKernel::Scalar);
+            Tegra::Texture::UnswizzleSubrect(expected_linear, tiled, bpp, WIDTH, HEIGHT, 1,
+                                             origin_x, origin_y, extent_x, extent_y,
+                                             block_height, 0, pitch);
+            Tegra::Texture::SwizzleSubrect(expected_tiled, linear, bpp, WIDTH, HEIGHT, 1, origin_x,
+                                           origin_y, extent_x, extent_y, block_height, 0, pitch);
+            for (const SwizzleKernel kernel : KERNELS) {
+                if (!Tegra::Texture::IsSwizzleKernelSupported(kernel)) {
+                    continue;
+                }
+                std::vector<u8> output_linear(linear_size);
+                std::vector<u8> output_tiled(tiled_size);
+                Tegra::Texture::SetSwizzleKernel(kernel);
+                Tegra::Texture::UnswizzleSubrect(output_linear, tiled, bpp, WIDTH, HEIGHT, 1,
+                                                 origin_x, origin_y, extent_x, extent_y,
+                                                 block_height, 0, pitch);
+                Tegra::Texture::SwizzleSubrect(output_tiled, linear, bpp, WIDTH, HEIGHT, 1,
+                                               origin_x, origin_y, extent_x, extent_y,
+                                               block_height, 0, pitch);
+                REQUIRE(output_linear == expected_linear);
+                REQUIRE(output_tiled == expected_tiled);
+            }
+        }
+    }
+}
+
+TEST_CASE("Swizzle: Line bands match whole texture", "[video_core]") {
+    constexpr u32 bpp = 4;
+    constexpr u32 block_height = 2;
+    constexpr u32 band_lines = 8U << block_height;
+    const std::size_t tiled_size =
+        Tegra::Texture::CalculateSize(true, bpp, WIDTH, HEIGHT, DEPTH, block_height, 0);
+    const std::size_t linear_size = std::size_t{WIDTH} * HEIGHT * DEPTH * bpp;
+    const std::vector<u8> tiled = RandomBytes(tiled_size, 1);
+    const std::vector<u8> linear = RandomBytes(linear_size, 2);
+
+    std::vector<u8> expected_linear(linear_size);
+    std::vector<u8> expected_tiled(tiled_size);
+    Tegra::Texture::UnswizzleTexture(expected_linear, tiled, bpp, WIDTH, HEIGHT, DEPTH,
+                                     block_height, 0);
+    Tegra::Texture::SwizzleTexture(expected_tiled, linear, bpp, WIDTH, HEIGHT, DEPTH, block_height,
+                                   0);
+
+    std::vector<u8> output_linear(linear_size);
+    std::vector<u8> output_tiled(tiled_size);
+    for (u32 line = 0; line < HEIGHT; line += band_lines) {
+        const u32 line_end = std::min(HEIGHT, line + band_lines);
+        Tegra::Texture::UnswizzleTextureLines(output_linear, tiled, bpp, WIDTH, HEIGHT, DEPTH,
+                                              block_height, 0, 1, line, line_end);
+        Tegra::Texture::SwizzleTextureLines(output_tiled, linear, bpp, WIDTH, HEIGHT, DEPTH,
+                                            block_height, 0, 1, line, line_end);
+    }
+    REQUIRE(output_linear == expected_linear);
+    REQUIRE(output_tiled == expected_tiled);
+}
@@ -0,0 +1,142 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/translated_stage_cache.h"
+
+namespace {
+
+using VideoCommon::RecordingEnvironment;
+using VideoCommon::TranslatedStageCache;
+
+class TestEnvironment final : public Shader::Environment {
+public:
+    explicit TestEnvironment(u32 cbuf_value_) : cbuf_value{cbuf_value_} {}
+
+    u64 ReadInstruction(u32 address) override {
+        return address;
+    }
+
+    u32 ReadCbufValue(u32, u32 cbuf_offset) override {
+        return cbuf_offset == 0 ? cbuf_value : 0;
+    }
+
+    Shader::TextureType ReadTextureType(u32) override {
+        return Shader::TextureType::Color2D;
+    }
+
+    Shader::TexturePixelFormat ReadTexturePixelFormat(u32) override {
+        return {};
+    }
+
+    bool IsTexturePixelFormatInteger(u32) override {
+        return false;
+    }
+
+    u32 ReadViewportTransformState() override {
+        return 1;
+    }
+
+    u32 TextureBoundBuffer() const override {
+        return 2;
+    }
+
+    u32 LocalMemorySize() const override {
+        return 0;
+    }
+
+    u32 SharedMemorySize() const override {
+        return 0;
+    }
+
+    std::array<u32, 3> WorkgroupSize() const override {
+        return {};
+    }
+
+    bool HasHLEMacroState() const override {
+        return false;
+    }
+
+    std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(u32, u32) override {
+        return std::nullopt;
+    }
+
+    void Dump(u64, u64) override {}
+
+private:
+    u32 cbuf_value;
+};
+
+/// Reads from the environment what a translation of a shader would
+VideoCommon::EnvironmentReads Translate(Shader::Environment& env) {
+    RecordingEnvironment recording_env{env};
+    for (u32 address = 0x10; address <= 0x80; address += 8) {
+        static_cast<void>(recording_env.ReadInstruction(address));
+    }
+    static_cast<void>(recording_env.ReadCbufValue(1, 0));
+    static_cast<void>(recording_env.ReadTextureType(5));
+    static_cast<void>(recording_env.TextureBoundBuffer());
+    return recording_env.TakeReads();
+}
+
+Shader::IR::Program MakeProgram(Shader::Stage stage) {
+    Shader::IR::Program program;
+    program.stage = stage;
+    program.info.uses_fp16 = true;
+    return program;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TranslatedStageCache: Stages are reused with equal environment reads", "[video_core]") {
+    TranslatedStageCache cache(1ULL << 20);
+    TestEnvironment env{7};
+    cache.Insert(1, Translate(env), MakeProgram(Shader::Stage::Fragment), {.texture = 3},
+                 std::vector<u32>{1, 2, 3});
+
+    TestEnvironment same_env{7};
+    const auto stage = cache.Find(1, same_env);
+    REQUIRE(stage != nullptr);
+    REQUIRE(stage->program.stage == Shader::Stage::Fragment);
+    REQUIRE(stage->program.info.uses_fp16);
+    REQUIRE(stage->bindings.texture == 3);
+    REQUIRE(stage->spirv == std::vector<u32>{1, 2, 3});
+    REQUIRE(stage->reads.lowest_instruction == 0x10);
+    REQUIRE(stage->reads.highest_instruction == 0x80);
+
+    TestEnvironment other_env{8};
+    REQUIRE(cache.Find(1, other_env) == nullptr);
+    REQUIRE(cache.Find(2, same_env) == nullptr);
+
+    // The stage translated again replaces the previous one
+    cache.Insert(1, Translate(other_env), MakeProgram(Shader::Stage::Fragment), {},
+                 std::vector<u32>{4});
+    REQUIRE(cache.Find(1, other_env)->spirv == std::vector<u32>{4});
+    REQUIRE(cache.Find(1, same_env) == nullptr);
+}
+
+TEST_CASE("TranslatedStageCache: Least recently used stages are evicted", "[video_core]") {
+    TestEnvironment env{7};
+    const std::vector<u32> code(1024);
+    TranslatedStageCache sizing_cache(~size_t{0});
+    sizing_cache.Insert(0, Translate(env), MakeProgram(Shader::Stage::VertexB), {}, code);
+    const size_t stage_size = sizing_cache.SizeBytes();
+
+    TranslatedStageCache cache(stage_size * 3);
+    for (u64 key = 0; key < 3; ++key) {
+        cache.Insert(key, Translate(env), MakeProgram(Shader::Stage::VertexB), {}, code);
+    }
+    REQUIRE(cache.SizeBytes() == stage_size * 3);
+    REQUIRE(cache.Find(0, env) != nullptr);
+
+    cache.Insert(3, Translate(env), MakeProgram(Shader::Stage::VertexB), {}, code);
+    REQUIRE(cache.SizeBytes() == stage_size * 3);
+    REQUIRE(cache.Find(0, env) != nullptr);
+    REQUIRE(cache.Find(1, env) == nullptr);
+    REQUIRE(cache.Find(2, env) != nullptr);
+    REQUIRE(cache.Find(3, env) != nullptr);
+}
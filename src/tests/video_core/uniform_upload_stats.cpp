@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <span>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/common_types.h"
+#include "video_core/buffer_cache/uniform_upload_stats.h"
+
+using VideoCommon::UniformUploadFilter;
+using VideoCommon::UniformUploadStats;
+
+TEST_CASE("UniformUploadFilter: Skips contents identical to the last upload", "[video_core]") {
+    UniformUploadFilter<2, 2> filter;
+    std::array<u8, 64> data{};
+    data.fill(0x11);
+
+    REQUIRE(!filter.IsUploaded(0, 0, data));
+    REQUIRE(filter.IsUploaded(0, 0, data));
+
+    // Each binding remembers its own upload
+    REQUIRE(!filter.IsUploaded(0, 1, data));
+    REQUIRE(!filter.IsUploaded(1, 0, data));
+
+    data[63] = 0x22;
+    REQUIRE(!filter.IsUploaded(0, 0, data));
+    REQUIRE(filter.IsUploaded(0, 0, data));
+    REQUIRE(!filter.IsUploaded(0, 1, data));
+}
+
+TEST_CASE("UniformUploadFilter: Compares the size of the contents", "[video_core]") {
+    UniformUploadFilter<1, 1> filter;
+    const std::array<u8, 64> data{};
+
+    REQUIRE(!filter.IsUploaded(0, 0, data));
+    REQUIRE(!filter.IsUploaded(0, 0, std::span(data).first(32)));
+    REQUIRE(filter.IsUploaded(0, 0, std::span(data).first(32)));
+
+    // Empty contents were never uploaded
+    UniformUploadFilter<1, 1> empty_filter;
+    REQUIRE(!empty_filter.IsUploaded(0, 0, {}));
+    REQUIRE(empty_filter.IsUploaded(0, 0, {}));
+}
+
+TEST_CASE("UniformUploadStats: Resets the counters when read", "[video_core]") {
+    UniformUploadStats stats;
+    stats.RecordUpload(256);
+    stats.RecordUpload(64);
+    stats.RecordSkip(128);
+    stats.NotifyFrameEnd();
+
+    const UniformUploadStats::Snapshot snapshot = stats.GetAndReset();
+    REQUIRE(snapshot.uploaded_bytes == 320);
+    REQUIRE(snapshot.skipped_bytes == 128);
+    REQUIRE(snapshot.frames == 1);
+
+    const UniformUploadStats::Snapshot empty = stats.GetAndReset();
+    REQUIRE(empty.uploaded_bytes == 0);
+    REQUIRE(empty.skipped_bytes == 0);
+    REQUIRE(empty.frames == 0);
+}
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <algorithm>
+#include <cstring>
 #include <memory>
 #include <numeric>
 
@@ -807,18 +808,41 @@ void BufferCache<P>::BindHostGraphicsUniformBuffer(size_t stage, u32 index, u32
                     channel_state->uniform_buffer_binding_sizes[stage][binding_index] = size;
                     runtime.BindFastUniformBuffer(stage, binding_index, size);
                 }
+                // Nothing else writes to the fast buffers, skip the push when it holds the data
                 const auto span = ImmediateBufferWithData(device_addr, size);
-                runtime.PushFastUniformBuffer(stage, binding_index, span);
+                const bool is_uploaded =
+                    uploaded_uniform_buffers.IsUploaded(stage, binding_index, span);
+                if (!is_uploaded) {
+                    runtime.PushFastUniformBuffer(stage, binding_index, span);
+                }
+                RecordUniformUpload(size, is_uploaded);
                 return;
             }
         }
+        if constexpr (CAN_REBIND_MAPPED_UNIFORM_BUFFERS) {
+            // Reuse the previous stream allocation of the binding when it holds the same data
+            const u32 upload_index = NEEDS_BIND_UNIFORM_INDEX ? binding_index : index;
+            const auto data = ImmediateBufferWithData(device_addr, size);
+            const bool is_uploaded =
+                uploaded_uniform_buffers.IsUploaded(stage, upload_index, data) &&
+                runtime.RebindMappedUniformBuffer(stage, upload_index, size);
+            if (!is_uploaded) {
+                // Copied straight from the guest memory when it is contiguous
+                const std::span<u8> span =
+                    runtime.BindMappedUniformBuffer(stage, upload_index, size);
+                std::memcpy(span.data(), data.data(), size);
+            }
+            RecordUniformUpload(size, is_uploaded);
+            return;
+        }
         if constexpr (IS_OPENGL) {
             channel_state->fast_bound_uniform_buffers[stage] |= 1U << binding_index;
             channel_state->uniform_buffer_binding_sizes[stage][binding_index] = size;
         }
-        // Stream buffer path to avoid stalling on non-Nvidia drivers or Vulkan
+        // Stream buffer path to avoid stalling on non-Nvidia drivers
         const std::span<u8> span = runtime.BindMappedUniformBuffer(stage, binding_index, size);
         device_memory.ReadBlockUnsafe(device_addr, span.data(), size);
+        RecordUniformUpload(size, false);
         return;
     }
     // Classic cached path
@@ -1784,6 +1808,18 @@ bool BufferCache<P>::HasFastUniformBufferBound(size_t stage, u32 binding_index)
     }
 }
 
+template <class P>
+void BufferCache<P>::RecordUniformUpload(u32 size, bool is_skipped) {
+    if (!uniform_upload_stats) {
+        return;
+    }
+    if (is_skipped) {
+        uniform_upload_stats->RecordSkip(size);
+    } else {
+        uniform_upload_stats->RecordUpload(size);
+    }
+}
+
 template <class P>
 std::pair<typename BufferCache<P>::Buffer*, u32> BufferCache<P>::GetDrawIndirectCount() {
     auto& buffer = slot_buffers[channel_state->count_buffer_binding.buffer_id];
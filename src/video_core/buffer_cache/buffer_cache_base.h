@@ -23,6 +23,7 @@
 #include "common/settings.h"
 #include "common/slot_vector.h"
 #include "video_core/buffer_cache/buffer_base.h"
+#include "video_core/buffer_cache/uniform_upload_stats.h"
 #include "video_core/control/channel_state_cache.h"
 #include "video_core/delayed_destruction_ring.h"
 #include "video_core/dirty_flags.h"
@@ -169,6 +170,7 @@ class BufferCache : public VideoCommon::ChannelSetupCaches<BufferCacheChannelInf
     static constexpr bool USE_MEMORY_MAPS = P::USE_MEMORY_MAPS;
     static constexpr bool SEPARATE_IMAGE_BUFFERS_BINDINGS = P::SEPARATE_IMAGE_BUFFER_BINDINGS;
     static constexpr bool USE_MEMORY_MAPS_FOR_UPLOADS = P::USE_MEMORY_MAPS_FOR_UPLOADS;
+    static constexpr bool CAN_REBIND_MAPPED_UNIFORM_BUFFERS = P::CAN_REBIND_MAPPED_UNIFORM_BUFFERS;
 
     static constexpr s64 DEFAULT_EXPECTED_MEMORY = 512_MiB;
     static constexpr s64 DEFAULT_CRITICAL_MEMORY = 1_GiB;
@@ -297,6 +299,10 @@ public:
 
     [[nodiscard]] std::pair<Buffer*, u32> GetDrawIndirectBuffer();
 
+    void SetUniformUploadStats(UniformUploadStats* stats) {
+        uniform_upload_stats = stats;
+    }
+
     template <typename Func>
     void BufferOperations(Func&& func) {
         do {
@@ -440,6 +446,8 @@ private:
 
     [[nodiscard]] bool HasFastUniformBufferBound(size_t stage, u32 binding_index) const noexcept;
 
+    void RecordUniformUpload(u32 size, bool is_skipped);
+
     void ClearDownload(DAddr base_addr, u64 size);
 
     void InlineMemoryImplementation(DAddr dest_address, size_t copy_size,
@@ -470,6 +478,10 @@ private:
     size_t immediate_buffer_capacity = 0;
     Common::ScratchBuffer<u8> immediate_buffer_alloc;
 
+    /// Last contents streamed through the fast path for each uniform buffer binding
+    UniformUploadFilter<NUM_STAGES, NUM_GRAPHICS_UNIFORM_BUFFERS> uploaded_uniform_buffers;
+    UniformUploadStats* uniform_upload_stats{};
+
     struct LRUItemParams {
         using ObjectType = BufferId;
         using TickType = u64;
@@ -0,0 +1,89 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <span>
+
+#include "common/cityhash.h"
+#include "common/common_types.h"
+#include "video_core/stat_counter.h"
+
+namespace VideoCommon {
+
+/// Uniform buffers streamed to the host by the fast path of the buffer caches
+class UniformUploadStats {
+public:
+    /// Statistics since the last call to GetAndReset
+    struct Snapshot {
+        /// Bytes copied to the host because they differed from the last upload of the binding
+        u64 uploaded_bytes{};
+        /// Bytes not copied because they were identical to the last upload of the binding
+        u64 skipped_bytes{};
+        /// Frames presented
+        u64 frames{};
+    };
+
+    void RecordUpload(u32 size) {
+        uploaded_bytes.Add(size);
+    }
+
+    void RecordSkip(u32 size) {
+        skipped_bytes.Add(size);
+    }
+
+    void NotifyFrameEnd() {
+        frames.Add(1);
+    }
+
+    [[nodiscard]] Snapshot GetAndReset() {
+        return {
+            .uploaded_bytes = uploaded_bytes.GetAndReset(),
+            .skipped_bytes = skipped_bytes.GetAndReset(),
+            .frames = frames.GetAndReset(),
+        };
+    }
+
+private:
+    StatCounter uploaded_bytes;
+    StatCounter skipped_bytes;
+    StatCounter frames;
+};
+
+/**
+ * Remembers the contents last streamed to each uniform buffer binding, so streaming identical
+ * contents again can be skipped. Contents are compared by hash, which is computed on the guest
+ * memory in place instead of keeping a copy of every upload.
+ */
+template <size_t num_stages, size_t num_bindings>
+class UniformUploadFilter {
+public:
+    /// Records the contents streamed to a binding.
+    /// Returns true when they are identical to the previous upload, so it can be skipped.
+    [[nodiscard]] bool IsUploaded(size_t stage, u32 binding, std::span<const u8> data) {
+        Upload& upload = uploads[stage][binding];
+        const u64 hash =
+            Common::CityHash64(reinterpret_cast<const char*>(data.data()), data.size());
+        if (upload.is_valid && upload.size == data.size() && upload.hash == hash) {
+            return true;
+        }
+        upload = {
+            .hash = hash,
+            .size = data.size(),
+            .is_valid = true,
+        };
+        return false;
+    }
+
+private:
+    struct Upload {
+        u64 hash{};
+        size_t size{};
+        bool is_valid{};
+    };
+
+    std::array<std::array<Upload, num_bindings>, num_stages> uploads{};
+};
+
+} // namespace VideoCommon
@@ -4,6 +4,7 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <limits>
 #include <span>
@@ -20,6 +21,7 @@ namespace VideoCommon {
 constexpr u64 PAGES_PER_WORD = 64;
 constexpr u64 BYTES_PER_PAGE = Core::DEVICE_PAGESIZE;
 constexpr u64 BYTES_PER_WORD = PAGES_PER_WORD * BYTES_PER_PAGE;
+constexpr u64 WORDS_PER_SUMMARY = 64;
 
 enum class Type {
     CPU,
@@ -29,6 +31,8 @@ enum class Type {
     Preflushable,
 };
 
+constexpr size_t NUM_TYPES = 5;
+
 /// Vector tracking modified pages tightly packed with small vector optimization
 template <size_t stack_words = 1>
 struct WordsArray {
@@ -46,20 +50,31 @@ struct WordsArray {
     u64* heap;                            ///< Not-small buffers pointer to the storage
 };
 
+/**
+ * Pages state of a buffer, one bit per page for each Type.
+ * Each type also has a summary with one bit per word, set when any page of the word is set, so
+ * queries can skip clean words without loading them.
+ */
 template <size_t stack_words = 1>
 struct Words {
+    static constexpr size_t stack_summary_words = Common::DivCeil(stack_words, WORDS_PER_SUMMARY);
+
     explicit Words() = default;
     explicit Words(u64 size_bytes_) : size_bytes{size_bytes_} {
         num_words = Common::DivCeil(size_bytes, BYTES_PER_WORD);
+        const size_t num_summary_words = NumSummaryWords();
         if (IsShort()) {
             cpu.stack.fill(~u64{0});
             gpu.stack.fill(0);
             cached_cpu.stack.fill(0);
             untracked.stack.fill(~u64{0});
             preflushable.stack.fill(0);
+            for (WordsArray<stack_summary_words>& summary : summaries) {
+                summary.stack.fill(0);
+            }
         } else {
             // Share allocation between CPU and GPU pages and set their default values
-            u64* const alloc = new u64[num_words * 5];
+            u64* const alloc = new u64[(num_words + num_summary_words) * NUM_TYPES];
             cpu.heap = alloc;
             gpu.heap = alloc + num_words;
             cached_cpu.heap = alloc + num_words * 2;
@@ -70,6 +85,17 @@ struct Words {
             std::fill_n(cached_cpu.heap, num_words, 0);
             std::fill_n(untracked.heap, num_words, ~u64{0});
             std::fill_n(preflushable.heap, num_words, 0);
+            u64* const summaries_alloc = alloc + num_words * NUM_TYPES;
+            for (size_t type = 0; type < NUM_TYPES; ++type) {
+                summaries[type].heap = summaries_alloc + num_summary_words * type;
+            }
+            std::fill_n(summaries_alloc, num_summary_words * NUM_TYPES, 0);
+        }
+        // Every word starts with CPU modified and untracked pages
+        for (size_t index = 0; index < num_words; ++index) {
+            const u64 bit = u64{1} << (index % WORDS_PER_SUMMARY);
+            Summary<Type::CPU>()[index / WORDS_PER_SUMMARY] |= bit;
+            Summary<Type::Untracked>()[index / WORDS_PER_SUMMARY] |= bit;
         }
         // Clean up tailing bits
         const u64 last_word_size = size_bytes % BYTES_PER_WORD;
@@ -93,13 +119,15 @@ struct Words {
         cached_cpu = rhs.cached_cpu;
         untracked = rhs.untracked;
         preflushable = rhs.preflushable;
+        summaries = rhs.summaries;
         rhs.cpu.heap = nullptr;
         return *this;
     }
 
     Words(Words&& rhs) noexcept
         : size_bytes{rhs.size_bytes}, num_words{rhs.num_words}, cpu{rhs.cpu}, gpu{rhs.gpu},
-          cached_cpu{rhs.cached_cpu}, untracked{rhs.untracked}, preflushable{rhs.preflushable} {
+          cached_cpu{rhs.cached_cpu}, untracked{rhs.untracked}, preflushable{rhs.preflushable},
+          summaries{rhs.summaries} {
         rhs.cpu.heap = nullptr;
     }
 
@@ -116,6 +144,11 @@ struct Words {
         return num_words;
     }
 
+    /// Returns the number of words of each summary
+    [[nodiscard]] size_t NumSummaryWords() const noexcept {
+        return Common::DivCeil(num_words, WORDS_PER_SUMMARY);
+    }
+
     /// Release buffer resources
     void Release() {
         if (!IsShort()) {
@@ -154,6 +187,18 @@ struct Words {
         }
     }
 
+    template <Type type>
+    std::span<u64> Summary() noexcept {
+        return std::span<u64>(summaries[static_cast<size_t>(type)].Pointer(IsShort()),
+                              NumSummaryWords());
+    }
+
+    template <Type type>
+    std::span<const u64> Summary() const noexcept {
+        return std::span<const u64>(summaries[static_cast<size_t>(type)].Pointer(IsShort()),
+                                    NumSummaryWords());
+    }
+
     u64 size_bytes = 0;
     size_t num_words = 0;
     WordsArray<stack_words> cpu;
@@ -161,6 +206,7 @@ struct Words {
     WordsArray<stack_words> cached_cpu;
     WordsArray<stack_words> untracked;
     WordsArray<stack_words> preflushable;
+    std::array<WordsArray<stack_summary_words>, NUM_TYPES> summaries; ///< Indexed by Type
 };
 
 template <class DeviceTracker, size_t stack_words = 1>
@@ -227,6 +273,48 @@ public:
         }
     }
 
+    /**
+     * Like IterateWords, but only calls func for the words with pages set in any of the given
+     * types, found through their summaries.
+     */
+    template <Type... types, typename Func>
+    void IterateDirtyWords(size_t offset, size_t size, Func&& func) const {
+        using FuncReturn = std::invoke_result_t<Func, std::size_t, u64>;
+        static constexpr bool BOOL_BREAK = std::is_same_v<FuncReturn, bool>;
+        const size_t start = static_cast<size_t>(std::max<s64>(static_cast<s64>(offset), 0LL));
+        const size_t end = static_cast<size_t>(std::max<s64>(static_cast<s64>(offset + size), 0LL));
+        if (start >= SizeBytes() || end <= start) {
+            return;
+        }
+        const size_t page_begin = start / BYTES_PER_PAGE;
+        const size_t page_end =
+            std::min<size_t>(Common::DivCeil(end, BYTES_PER_PAGE), NumWords() * PAGES_PER_WORD);
+        const size_t word_begin = page_begin / PAGES_PER_WORD;
+        const size_t word_end = Common::DivCeil(page_end, PAGES_PER_WORD);
+        constexpr u64 base_mask{~0ULL};
+        for (size_t summary_index = word_begin / WORDS_PER_SUMMARY;
+             summary_index * WORDS_PER_SUMMARY < word_end; ++summary_index) {
+            const size_t base_word = summary_index * WORDS_PER_SUMMARY;
+            u64 dirty = (words.template Summary<types>()[summary_index] | ...);
+            dirty = ExtractBits(dirty, word_begin - std::min(word_begin, base_word),
+                                word_end - base_word);
+            while (dirty != 0) {
+                const size_t word_index = base_word + std::countr_zero(dirty);
+                dirty &= dirty - 1;
+                const size_t base_page = word_index * PAGES_PER_WORD;
+                const size_t local_begin = page_begin - std::min(page_begin, base_page);
+                const u64 mask = ExtractBits(base_mask, local_begin, page_end - base_page);
+                if constexpr (BOOL_BREAK) {
+                    if (func(word_index, mask)) {
+                        return;
+                    }
+                } else {
+                    func(word_index, mask);
+                }
+            }
+        }
+    }
+
     template <typename Func>
     void IteratePages(u64 mask, Func&& func) const {
         size_t offset = 0;
@@ -253,7 +341,7 @@ public:
         std::span<u64> state_words = words.template Span<type>();
         [[maybe_unused]] std::span<u64> untracked_words = words.template Span<Type::Untracked>();
         [[maybe_unused]] std::span<u64> cached_words = words.template Span<Type::CachedCPU>();
-        IterateWords(dirty_addr - cpu_addr, size, [&](size_t index, u64 mask) {
+        const auto change = [&](size_t index, u64 mask) {
             if constexpr (type == Type::CPU || type == Type::CachedCPU) {
                 NotifyRasterizer<!enable>(index, untracked_words[index], mask);
             }
@@ -275,7 +363,17 @@ public:
                     untracked_words[index] &= ~mask;
                 }
             }
-        });
+            UpdateSummaries<type>(index);
+        };
+        const size_t offset = dirty_addr - cpu_addr;
+        if constexpr (enable) {
+            IterateWords(offset, size, change);
+        } else if constexpr (type == Type::CPU || type == Type::CachedCPU) {
+            // Pages may still be untracked after they were cleared
+            IterateDirtyWords<type, Type::Untracked>(offset, size, change);
+        } else {
+            IterateDirtyWords<type>(offset, size, change);
+        }
     }
 
     /**
@@ -301,7 +399,7 @@ public:
             func(cpu_addr + pending_offset * BYTES_PER_PAGE,
                  (pending_pointer - pending_offset) * BYTES_PER_PAGE);
         };
-        IterateWords(offset, size, [&](size_t index, u64 mask) {
+        const auto modified_word = [&](size_t index, u64 mask) {
             if constexpr (type == Type::GPU) {
                 mask &= ~untracked_words[index];
             }
@@ -317,6 +415,7 @@ public:
                 if constexpr (type == Type::CPU) {
                     cached_words[index] &= ~word;
                 }
+                UpdateSummaries<type>(index);
             }
             const size_t base_offset = index * PAGES_PER_WORD;
             IteratePages(word, [&](size_t pages_offset, size_t pages_size) {
@@ -336,7 +435,12 @@ public:
                 release();
                 reset();
             });
-        });
+        };
+        if constexpr (clear && (type == Type::CPU || type == Type::CachedCPU)) {
+            IterateDirtyWords<type, Type::Untracked>(offset, size, modified_word);
+        } else {
+            IterateDirtyWords<type>(offset, size, modified_word);
+        }
         if (pending) {
             release();
         }
@@ -356,7 +460,7 @@ public:
         [[maybe_unused]] const std::span<const u64> untracked_words =
             words.template Span<Type::Untracked>();
         bool result = false;
-        IterateWords(offset, size, [&](size_t index, u64 mask) {
+        IterateDirtyWords<type>(offset, size, [&](size_t index, u64 mask) {
             if constexpr (type == Type::GPU) {
                 mask &= ~untracked_words[index];
             }
@@ -384,7 +488,7 @@ public:
             words.template Span<Type::Untracked>();
         u64 begin = std::numeric_limits<u64>::max();
         u64 end = 0;
-        IterateWords(offset, size, [&](size_t index, u64 mask) {
+        IterateDirtyWords<type>(offset, size, [&](size_t index, u64 mask) {
             if constexpr (type == Type::GPU) {
                 mask &= ~untracked_words[index];
             }
@@ -418,17 +522,17 @@ public:
     }
 
     void FlushCachedWrites() noexcept {
-        const u64 num_words = NumWords();
         u64* const cached_words = Array<Type::CachedCPU>();
         u64* const untracked_words = Array<Type::Untracked>();
         u64* const cpu_words = Array<Type::CPU>();
-        for (u64 word_index = 0; word_index < num_words; ++word_index) {
+        IterateDirtyWords<Type::CachedCPU>(0, SizeBytes(), [&](size_t word_index, u64) {
             const u64 cached_bits = cached_words[word_index];
             NotifyRasterizer<false>(word_index, untracked_words[word_index], cached_bits);
             untracked_words[word_index] |= cached_bits;
             cpu_words[word_index] |= cached_bits;
             cached_words[word_index] = 0;
-        }
+            UpdateSummaries<Type::CPU>(word_index);
+        });
     }
 
 private:
@@ -458,6 +562,26 @@ private:
         }
     }
 
+    /// Updates the summary bit of a word for the given type
+    template <Type type>
+    void UpdateSummary(size_t word_index) noexcept {
+        u64& summary = words.template Summary<type>()[word_index / WORDS_PER_SUMMARY];
+        const u64 bit = u64{1} << (word_index % WORDS_PER_SUMMARY);
+        summary = words.template Span<type>()[word_index] != 0 ? summary | bit : summary & ~bit;
+    }
+
+    /// Updates the summary bits of a word for the types changed along with the given type
+    template <Type type>
+    void UpdateSummaries(size_t word_index) noexcept {
+        UpdateSummary<type>(word_index);
+        if constexpr (type == Type::CPU || type == Type::CachedCPU) {
+            UpdateSummary<Type::Untracked>(word_index);
+        }
+        if constexpr (type == Type::CPU) {
+            UpdateSummary<Type::CachedCPU>(word_index);
+        }
+    }
+
     /**
      * Notify tracker about changes in the CPU tracking state of a word in the buffer
      *
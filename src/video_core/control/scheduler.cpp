@@ -23,6 +23,41 @@ void Scheduler::Push(s32 channel, CommandList&& entries) {
     channel_state->dma_pusher->DispatchCalls();
 }
 
+void Scheduler::Queue(s32 channel, CommandList&& entries) {
+    std::unique_lock lk(scheduling_guard);
+    auto it = channels.find(channel);
+    ASSERT(it != channels.end());
+    it->second->dma_pusher->Push(std::move(entries));
+}
+
+void Scheduler::Dispatch(s32 channel) {
+    std::unique_lock lk(scheduling_guard);
+    auto it = channels.find(channel);
+    ASSERT(it != channels.end());
+    auto channel_state = it->second;
+    gpu.BindChannel(channel_state->bind_id);
+    channel_state->dma_pusher->DispatchCalls();
+}
+
+DmaPusher::DecodeResult Scheduler::Decode(s32 channel, CommandList& entries,
+                                          DmaPusher::DecodedList& list) {
+    // Decoding runs on its own thread, do not hold the guard while executing or decoding
+    return GetChannel(channel)->dma_pusher->Decode(entries, list);
+}
+
+void Scheduler::Execute(s32 channel, const DmaPusher::DecodedList& list) {
+    const auto channel_state = GetChannel(channel);
+    gpu.BindChannel(channel_state->bind_id);
+    channel_state->dma_pusher->Execute(list);
+}
+
+std::shared_ptr<ChannelState> Scheduler::GetChannel(s32 channel) {
+    std::unique_lock lk(scheduling_guard);
+    auto it = channels.find(channel);
+    ASSERT(it != channels.end());
+    return it->second;
+}
+
 void Scheduler::DeclareChannel(std::shared_ptr<ChannelState> new_channel) {
     s32 channel = new_channel->bind_id;
     std::unique_lock lk(scheduling_guard);
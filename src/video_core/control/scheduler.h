@@ -24,9 +24,24 @@ public:
 
     void Push(s32 channel, CommandList&& entries);
 
+    /// Queues command lists on a channel without executing them
+    void Queue(s32 channel, CommandList&& entries);
+
+    /// Executes every command list queued on a channel
+    void Dispatch(s32 channel);
+
+    /// Decodes command lists of a channel ahead of their execution, appending them to the list
+    DmaPusher::DecodeResult Decode(s32 channel, CommandList& entries,
+                                   DmaPusher::DecodedList& list);
+
+    /// Executes command lists previously decoded for a channel
+    void Execute(s32 channel, const DmaPusher::DecodedList& list);
+
     void DeclareChannel(std::shared_ptr<ChannelState> new_channel);
 
 private:
+    std::shared_ptr<ChannelState> GetChannel(s32 channel);
+
     std::unordered_map<s32, std::shared_ptr<ChannelState>> channels;
     std::mutex scheduling_guard;
     GPU& gpu;
@@ -1,15 +1,20 @@
 // SPDX-FileCopyrightText: Copyright 2018 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+
 #include "common/cityhash.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
 #include "core/core.h"
+#include "video_core/control/channel_state.h"
 #include "video_core/dma_pusher.h"
+#include "video_core/engines/draw_manager.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/gpu.h"
 #include "video_core/guest_memory.h"
 #include "video_core/memory_manager.h"
+#include "video_core/segment_write_tracker.h"
 
 namespace Tegra {
 
@@ -18,10 +23,13 @@ constexpr u32 MacroRegistersStart = 0xE00;
 
 DmaPusher::DmaPusher(Core::System& system_, GPU& gpu_, MemoryManager& memory_manager_,
                      Control::ChannelState& channel_state_)
-    : gpu{gpu_}, system{system_}, memory_manager{memory_manager_}, puller{gpu_, memory_manager_,
-                                                                          *this, channel_state_} {}
+    : gpu{gpu_}, system{system_}, memory_manager{memory_manager_},
+      segment_write_tracker{gpu_.SegmentWriteTracker()}, channel_state{channel_state_},
+      puller{gpu_, memory_manager_, *this, channel_state_} {}
 
-DmaPusher::~DmaPusher() = default;
+DmaPusher::~DmaPusher() {
+    ClearSegmentCache();
+}
 
 MICROPROFILE_DEFINE(DispatchCalls, "GPU", "Execute command buffer", MP_RGB(128, 128, 192));
 
@@ -37,6 +45,7 @@ void DmaPusher::DispatchCalls() {
             break;
         }
     }
+    FlushPendingDraw();
     gpu.FlushCommands();
     gpu.OnCommandListEnd();
 }
@@ -60,7 +69,7 @@ bool DmaPusher::Step() {
 
     if (command_list.prefetch_command_list.size()) {
         // Prefetched command list from nvdrv, used for things like synchronization
-        ProcessCommands(command_list.prefetch_command_list);
+        ProcessCommands<ProcessMode::Execute>(command_list.prefetch_command_list);
         dma_pushbuffer.pop();
     } else {
         const CommandListHeader command_list_header{
@@ -83,20 +92,20 @@ bool DmaPusher::Step() {
                                           Tegra::Memory::GuestMemoryFlags::SafeRead>
                 headers(memory_manager, dma_state.dma_get, command_list_header.size,
                         &command_headers);
-            ProcessCommands(headers);
+            ProcessSegment(headers);
         };
         const auto unsafe_process = [&] {
             Tegra::Memory::GpuGuestMemory<Tegra::CommandHeader,
                                           Tegra::Memory::GuestMemoryFlags::UnsafeRead>
                 headers(memory_manager, dma_state.dma_get, command_list_header.size,
                         &command_headers);
-            ProcessCommands(headers);
+            ProcessSegment(headers);
         };
 
         // Use safe reads when necessary to prevent data corruption
         if (Settings::IsGPULevelHigh() || dma_state.method >= MacroRegistersStart) {
             safe_process();
-        } else {
+        } else if (!ProcessUnchangedSegment(command_list_header.size, nullptr)) {
             unsafe_process();
         }
         return true;
@@ -104,7 +113,342 @@ bool DmaPusher::Step() {
     return true;
 }
 
-void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
+DmaPusher::DecodeResult DmaPusher::Decode(CommandList& entries, DecodedList& list) {
+    if (!entries.prefetch_command_list.empty()) {
+        const std::span<const CommandHeader> commands{entries.prefetch_command_list.data(),
+                                                      entries.prefetch_command_list.size()};
+        decoded_calls.clear();
+        ProcessCommands<ProcessMode::Record>(commands, &decoded_calls);
+        AppendSegment(list, decoded_calls, commands);
+        entries.prefetch_command_list.clear();
+        return DecodeResult::Done;
+    }
+    auto& command_lists = entries.command_lists;
+    for (auto it = command_lists.begin(); it != command_lists.end(); ++it) {
+        CommandListHeader& command_list_header = *it;
+        if (command_list_header.size == 0) {
+            continue;
+        }
+        if (command_list_header.sync != 0) {
+            // Like the fetch unit, segments are read before the methods preceding them execute
+            // unless their entry asks to wait for them, as pushbuffers written by the GPU do
+            command_list_header.sync.Assign(0);
+            command_lists.erase(command_lists.begin(), it);
+            return DecodeResult::WaitForGpu;
+        }
+        dma_state.dma_get = command_list_header.addr;
+        const size_t size = command_list_header.size * sizeof(u32);
+        const bool is_safe_read =
+            Settings::IsGPULevelHigh() || dma_state.method >= MacroRegistersStart;
+        if (is_safe_read) {
+            // Only the GPU thread can flush the rasterizer, segments it has no pending writes to
+            // read the same without flushing
+            if (memory_manager.IsMemoryDirty(command_list_header.addr, size)) {
+                command_lists.erase(command_lists.begin(), it);
+                return DecodeResult::ReadOnGpu;
+            }
+        } else if (ProcessUnchangedSegment(command_list_header.size, &list)) {
+            continue;
+        }
+        Tegra::Memory::GpuGuestMemory<Tegra::CommandHeader,
+                                      Tegra::Memory::GuestMemoryFlags::UnsafeRead>
+            headers(memory_manager, dma_state.dma_get, command_list_header.size, &command_headers);
+        ProcessSegment(headers, &list);
+    }
+    command_lists.clear();
+    return DecodeResult::Done;
+}
+
+MICROPROFILE_DEFINE(ExecuteDecoded, "GPU", "Execute decoded commands", MP_RGB(128, 128, 192));
+
+void DmaPusher::Execute(const DecodedList& list) {
+    MICROPROFILE_SCOPE(ExecuteDecoded);
+
+    DmaState state{};
+    for (const DecodedCall& call : list.calls) {
+        state.method = call.method;
+        state.subchannel = call.subchannel;
+        state.method_count = call.method_count;
+        state.is_last_call = call.is_last_call;
+        state.dma_word_offset = call.dma_word_offset;
+        if (call.num_methods == 0) {
+            CallMethod(state, call.argument);
+        } else {
+            CallMultiMethod(state, &list.arguments[call.argument], call.num_methods);
+        }
+    }
+    FlushPendingDraw();
+    gpu.FlushCommands();
+    gpu.OnCommandListEnd();
+}
+
+void DmaPusher::ProcessSegment(std::span<const CommandHeader> commands, DecodedList* decoded) {
+    const auto process = [&] {
+        if (decoded) {
+            decoded_calls.clear();
+            ProcessCommands<ProcessMode::Record>(commands, &decoded_calls);
+            AppendSegment(*decoded, decoded_calls, commands);
+        } else {
+            ProcessCommands<ProcessMode::Execute>(commands);
+        }
+    };
+    // Only segments starting on a command header are cached, so their calls do not depend on the
+    // state left behind by the previous segment
+    if (commands.size() < min_cached_segment_words || dma_state.method_count != 0 ||
+        !dma_state.is_last_call) {
+        process();
+        return;
+    }
+    const u64 hash = Common::CityHash64(reinterpret_cast<const char*>(commands.data()),
+                                        commands.size_bytes());
+    if (segment_cache.size() >= max_cached_segments && !segment_cache.contains(dma_state.dma_get)) {
+        ClearSegmentCache();
+    }
+    const auto [it, is_new] = segment_cache.try_emplace(dma_state.dma_get);
+    DecodedSegment& segment = it->second;
+    if (is_new || segment.hash != hash || segment.num_words != commands.size()) {
+        // Wait for the contents to repeat before spending time decoding them, pushbuffers that
+        // are rewritten every frame never get decoded
+        UntrackSegment(segment);
+        segment.hash = hash;
+        segment.num_words = commands.size();
+        segment.is_decoded = false;
+        segment.calls.clear();
+        segment.runs.clear();
+        process();
+        return;
+    }
+    if (!segment.is_decoded) {
+        if (decoded) {
+            ProcessCommands<ProcessMode::Record>(commands, &segment.calls);
+            AppendSegment(*decoded, segment.calls, commands);
+        } else {
+            ProcessCommands<ProcessMode::ExecuteAndRecord>(commands, &segment.calls);
+        }
+        segment.exit_state = dma_state;
+        segment.exit_increment_once = dma_increment_once;
+        // Segments without calls may not define the exit state, keep parsing them
+        segment.is_decoded = !segment.calls.empty();
+        return;
+    }
+    if (!segment.is_tracked && !segment.is_volatile) {
+        TrackSegment(segment, commands);
+    }
+    if (decoded) {
+        AppendSegment(*decoded, segment.calls, commands);
+    } else {
+        ReplaySegment(segment, commands);
+    }
+    dma_state = segment.exit_state;
+    dma_increment_once = segment.exit_increment_once;
+}
+
+bool DmaPusher::ProcessUnchangedSegment(size_t num_words, DecodedList* decoded) {
+    if (num_words < min_cached_segment_words || dma_state.method_count != 0 ||
+        !dma_state.is_last_call) {
+        return false;
+    }
+    const auto it = segment_cache.find(dma_state.dma_get);
+    if (it == segment_cache.end()) {
+        return false;
+    }
+    DecodedSegment& segment = it->second;
+    if (!segment.is_tracked || segment.num_words != num_words) {
+        return false;
+    }
+    const size_t size = num_words * sizeof(u32);
+    const u64 generation = memory_manager.TranslationGeneration();
+    if (segment.translation_generation != generation) {
+        // The address space changed, the segment is still valid if it maps to the same memory
+        if (memory_manager.GpuToCpuAddress(dma_state.dma_get) != segment.device_address ||
+            !memory_manager.IsContinuousRange(dma_state.dma_get, size)) {
+            UntrackSegment(segment);
+            return false;
+        }
+        segment.translation_generation = generation;
+    }
+    if (segment_write_tracker.IsWritten(segment.device_address, size, segment.track_counter)) {
+        // Segments written once are usually rewritten every frame, stop tracking them so the
+        // writes to their pages do not keep going through the GPU
+        UntrackSegment(segment);
+        segment.is_volatile = true;
+        return false;
+    }
+    if (decoded) {
+        AppendSegment(*decoded, segment.calls, segment.words);
+    } else {
+        ReplaySegment(segment, segment.words);
+    }
+    dma_state = segment.exit_state;
+    dma_increment_once = segment.exit_increment_once;
+    return true;
+}
+
+void DmaPusher::TrackSegment(DecodedSegment& segment, std::span<const CommandHeader> commands) {
+    const GPUVAddr address = dma_state.dma_get;
+    const size_t size = commands.size_bytes();
+    const u64 generation = memory_manager.TranslationGeneration();
+    const std::optional<DAddr> device_address = memory_manager.GpuToCpuAddress(address);
+    if (!device_address || !memory_manager.IsContinuousRange(address, size)) {
+        return;
+    }
+    const u64 track_counter = segment_write_tracker.Track(*device_address, size);
+    // Writes between the read of the segment and the start of the tracking were missed, read it
+    // again to make sure it still holds the decoded contents
+    segment.words.resize(commands.size());
+    memory_manager.ReadBlockUnsafe(address, segment.words.data(), size);
+    if (Common::CityHash64(reinterpret_cast<const char*>(segment.words.data()), size) !=
+        segment.hash) {
+        segment_write_tracker.Untrack(*device_address, size);
+        segment.words.clear();
+        return;
+    }
+    // Only multi method calls index the words, keep them for those alone
+    const bool has_multi_methods = std::ranges::any_of(
+        segment.calls, [](const DecodedCall& call) { return call.num_methods != 0; });
+    if (!has_multi_methods) {
+        segment.words.clear();
+        segment.words.shrink_to_fit();
+    }
+    segment.is_tracked = true;
+    segment.device_address = *device_address;
+    segment.translation_generation = generation;
+    segment.track_counter = track_counter;
+}
+
+void DmaPusher::UntrackSegment(DecodedSegment& segment) {
+    if (!segment.is_tracked) {
+        return;
+    }
+    segment_write_tracker.Untrack(segment.device_address, segment.num_words * sizeof(u32));
+    segment.is_tracked = false;
+    segment.words.clear();
+    segment.words.shrink_to_fit();
+}
+
+void DmaPusher::ClearSegmentCache() {
+    for (auto& [address, segment] : segment_cache) {
+        UntrackSegment(segment);
+    }
+    segment_cache.clear();
+}
+
+void DmaPusher::BuildReplayRuns(DecodedSegment& segment) const {
+    segment.runs.clear();
+    segment.sink_writes.clear();
+    segment.run_subchannels = subchannels;
+    // Binding an engine in the middle of the segment would change where the writes after it go
+    const bool binds_engines = std::ranges::any_of(segment.calls, [](const DecodedCall& call) {
+        return call.method == static_cast<u32>(BufferMethods::BindObject);
+    });
+    const auto is_sink_write = [&](const DecodedCall& call) {
+        if (binds_engines || call.method < non_puller_methods || call.num_methods != 0) {
+            return false;
+        }
+        const Engines::EngineInterface* const engine = subchannels[call.subchannel];
+        return engine != nullptr && !engine->execution_mask[call.method];
+    };
+    const u32 num_calls = static_cast<u32>(segment.calls.size());
+    for (u32 first = 0; first < num_calls;) {
+        const DecodedCall& first_call = segment.calls[first];
+        const bool is_sink = is_sink_write(first_call);
+        u32 last = first + 1;
+        while (last < num_calls && is_sink_write(segment.calls[last]) == is_sink &&
+               (!is_sink || segment.calls[last].subchannel == first_call.subchannel)) {
+            ++last;
+        }
+        segment.runs.push_back({
+            .first_call = first,
+            .num_calls = last - first,
+            .is_sink = is_sink,
+            .first_sink_write = static_cast<u32>(segment.sink_writes.size()),
+        });
+        if (is_sink) {
+            for (u32 index = first; index < last; ++index) {
+                const DecodedCall& call = segment.calls[index];
+                segment.sink_writes.emplace_back(call.method, call.argument);
+            }
+        }
+        first = last;
+    }
+}
+
+void DmaPusher::ReplaySegment(DecodedSegment& segment, std::span<const CommandHeader> commands) {
+    if (segment.runs.empty() || segment.run_subchannels != subchannels) {
+        BuildReplayRuns(segment);
+    }
+    for (const ReplayRun& run : segment.runs) {
+        if (run.is_sink) {
+            // Register writes that do not trigger anything, what CallMethod does one at a time
+            const DecodedCall& call = segment.calls[run.first_call];
+            Engines::EngineInterface* const engine = subchannels[call.subchannel];
+            const auto writes = segment.sink_writes.begin() + run.first_sink_write;
+            const auto start = engine_times ? std::chrono::steady_clock::now()
+                                            : std::chrono::steady_clock::time_point{};
+            engine->method_sink.insert(engine->method_sink.end(), writes, writes + run.num_calls);
+            if (engine_times) [[unlikely]] {
+                dma_state.method = call.method;
+                dma_state.subchannel = call.subchannel;
+                AccountEngineTime(dma_state, start);
+            }
+            continue;
+        }
+        for (const DecodedCall& call :
+             std::span(segment.calls).subspan(run.first_call, run.num_calls)) {
+            dma_state.method = call.method;
+            dma_state.subchannel = call.subchannel;
+            dma_state.method_count = call.method_count;
+            dma_state.is_last_call = call.is_last_call;
+            dma_state.dma_word_offset = call.dma_word_offset;
+            if (call.num_methods == 0) {
+                CallMethod(dma_state, call.argument);
+            } else {
+                CallMultiMethod(dma_state, &commands[call.argument].argument, call.num_methods);
+            }
+        }
+    }
+}
+
+void DmaPusher::AppendSegment(DecodedList& decoded, std::span<const DecodedCall> calls,
+                              std::span<const CommandHeader> commands) const {
+    const u32 base = static_cast<u32>(decoded.arguments.size());
+    bool has_multi_methods = false;
+    for (DecodedCall call : calls) {
+        // Make the calls independent of the segment they were decoded from
+        call.dma_word_offset += dma_state.dma_get;
+        if (call.num_methods != 0) {
+            call.argument += base;
+            has_multi_methods = true;
+        }
+        decoded.calls.push_back(call);
+    }
+    if (has_multi_methods) {
+        const u32* const words = &commands.front().argument;
+        decoded.arguments.insert(decoded.arguments.end(), words, words + commands.size());
+    }
+}
+
+template <DmaPusher::ProcessMode mode>
+void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands,
+                                std::vector<DecodedCall>* recorded_calls) {
+    const auto record_call = [&](u32 argument, u32 num_methods) {
+        if constexpr (mode != ProcessMode::Execute) {
+            recorded_calls->push_back({
+                .method = dma_state.method,
+                .subchannel = dma_state.subchannel,
+                .method_count = dma_state.method_count,
+                .argument = argument,
+                .num_methods = num_methods,
+                .is_last_call = dma_state.is_last_call,
+                .dma_word_offset = dma_state.dma_word_offset,
+            });
+        }
+    };
+    const auto call_method = [&](u32 argument) {
+        if constexpr (mode != ProcessMode::Record) {
+            CallMethod(dma_state, argument);
+        }
+    };
     for (std::size_t index = 0; index < commands.size();) {
         const CommandHeader& command_header = commands[index];
 
@@ -114,14 +458,18 @@ void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
             if (dma_state.non_incrementing) {
                 const u32 max_write = static_cast<u32>(
                     std::min<std::size_t>(index + dma_state.method_count, commands.size()) - index);
-                CallMultiMethod(&command_header.argument, max_write);
+                record_call(static_cast<u32>(index), max_write);
+                if constexpr (mode != ProcessMode::Record) {
+                    CallMultiMethod(dma_state, &command_header.argument, max_write);
+                }
                 dma_state.method_count -= max_write;
                 dma_state.is_last_call = true;
                 index += max_write;
                 continue;
             } else {
                 dma_state.is_last_call = dma_state.method_count <= 1;
-                CallMethod(command_header.argument);
+                record_call(command_header.argument, 0);
+                call_method(command_header.argument);
             }
 
             if (!dma_state.non_incrementing) {
@@ -151,7 +499,8 @@ void DmaPusher::ProcessCommands(std::span<const CommandHeader> commands) {
                 dma_state.subchannel = command_header.subchannel;
                 dma_state.dma_word_offset = static_cast<u64>(
                     -static_cast<s64>(dma_state.dma_get)); // negate to set address as 0
-                CallMethod(command_header.arg_count);
+                record_call(command_header.arg_count, 0);
+                call_method(command_header.arg_count);
                 dma_state.non_incrementing = true;
                 dma_increment_once = false;
                 break;
@@ -174,39 +523,80 @@ void DmaPusher::SetState(const CommandHeader& command_header) {
     dma_state.method_count = command_header.method_count;
 }
 
-void DmaPusher::CallMethod(u32 argument) const {
-    if (dma_state.method < non_puller_methods) {
+void DmaPusher::CallMethod(const DmaState& state, u32 argument) const {
+    if (engine_times) [[unlikely]] {
+        const auto start = std::chrono::steady_clock::now();
+        CallMethodImpl(state, argument);
+        AccountEngineTime(state, start);
+        return;
+    }
+    CallMethodImpl(state, argument);
+}
+
+void DmaPusher::CallMultiMethod(const DmaState& state, const u32* base_start,
+                                u32 num_methods) const {
+    if (engine_times) [[unlikely]] {
+        const auto start = std::chrono::steady_clock::now();
+        CallMultiMethodImpl(state, base_start, num_methods);
+        AccountEngineTime(state, start);
+        return;
+    }
+    CallMultiMethodImpl(state, base_start, num_methods);
+}
+
+void DmaPusher::CallMethodImpl(const DmaState& state, u32 argument) const {
+    if (state.method < non_puller_methods) {
+        FlushPendingDraw();
         puller.CallPullerMethod(Engines::Puller::MethodCall{
-            dma_state.method,
+            state.method,
             argument,
-            dma_state.subchannel,
-            dma_state.method_count,
+            state.subchannel,
+            state.method_count,
         });
     } else {
-        auto subchannel = subchannels[dma_state.subchannel];
-        if (!subchannel->execution_mask[dma_state.method]) [[likely]] {
-            subchannel->method_sink.emplace_back(dma_state.method, argument);
+        auto subchannel = subchannels[state.subchannel];
+        if (!subchannel->execution_mask[state.method]) [[likely]] {
+            subchannel->method_sink.emplace_back(state.method, argument);
             return;
         }
+        if (subchannel_type[state.subchannel] != Engines::EngineTypes::Maxwell3D) {
+            FlushPendingDraw();
+        }
         subchannel->ConsumeSink();
-        subchannel->current_dma_segment = dma_state.dma_get + dma_state.dma_word_offset;
-        subchannel->CallMethod(dma_state.method, argument, dma_state.is_last_call);
+        subchannel->current_dma_segment = state.dma_get + state.dma_word_offset;
+        subchannel->CallMethod(state.method, argument, state.is_last_call);
     }
 }
 
-void DmaPusher::CallMultiMethod(const u32* base_start, u32 num_methods) const {
-    if (dma_state.method < non_puller_methods) {
-        puller.CallMultiMethod(dma_state.method, dma_state.subchannel, base_start, num_methods,
-                               dma_state.method_count);
+void DmaPusher::CallMultiMethodImpl(const DmaState& state, const u32* base_start,
+                                    u32 num_methods) const {
+    if (state.method < non_puller_methods) {
+        FlushPendingDraw();
+        puller.CallMultiMethod(state.method, state.subchannel, base_start, num_methods,
+                               state.method_count);
     } else {
-        auto subchannel = subchannels[dma_state.subchannel];
+        auto subchannel = subchannels[state.subchannel];
+        if (subchannel_type[state.subchannel] != Engines::EngineTypes::Maxwell3D) {
+            FlushPendingDraw();
+        }
         subchannel->ConsumeSink();
-        subchannel->current_dma_segment = dma_state.dma_get + dma_state.dma_word_offset;
-        subchannel->CallMultiMethod(dma_state.method, base_start, num_methods,
-                                    dma_state.method_count);
+        subchannel->current_dma_segment = state.dma_get + state.dma_word_offset;
+        subchannel->CallMultiMethod(state.method, base_start, num_methods, state.method_count);
     }
 }
 
+void DmaPusher::AccountEngineTime(const DmaState& state,
+                                  std::chrono::steady_clock::time_point start) const {
+    const size_t index = state.method < non_puller_methods
+                             ? EngineTimes::PULLER
+                             : static_cast<size_t>(subchannel_type[state.subchannel]);
+    engine_times->times[index] += std::chrono::steady_clock::now() - start;
+}
+
+void DmaPusher::FlushPendingDraw() const {
+    channel_state.maxwell_3d->draw_manager->FlushPendingDraw();
+}
+
 void DmaPusher::BindRasterizer(VideoCore::RasterizerInterface* rasterizer) {
     puller.BindRasterizer(rasterizer);
 }
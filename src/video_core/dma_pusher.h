@@ -4,7 +4,9 @@
 #pragma once
 
 #include <array>
+#include <chrono>
 #include <span>
+#include <unordered_map>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 #include <queue>
@@ -27,6 +29,7 @@ struct ChannelState;
 
 class GPU;
 class MemoryManager;
+class SegmentWriteTracker;
 
 enum class SubmissionMode : u32 {
     IncreasingOld = 0,
@@ -76,6 +79,8 @@ struct CommandListHeader {
         BitField<0, 40, GPUVAddr> addr;
         BitField<41, 1, u64> is_non_main;
         BitField<42, 21, u64> size;
+        /// Waits for the methods before it to execute before fetching the segment
+        BitField<63, 1, u64> sync;
     };
 };
 static_assert(sizeof(CommandListHeader) == sizeof(u64), "CommandListHeader is incorrect size");
@@ -100,6 +105,13 @@ inline CommandHeader BuildCommandHeader(BufferMethods method, u32 arg_count, Sub
     return result;
 }
 
+/// CPU time spent executing methods, indexed by Engines::EngineTypes with the puller last.
+struct EngineTimes {
+    static constexpr size_t PULLER = 5;
+
+    std::array<std::chrono::nanoseconds, PULLER + 1> times{};
+};
+
 struct CommandList final {
     CommandList() = default;
     explicit CommandList(std::size_t size) : command_lists(size) {}
@@ -120,6 +132,24 @@ struct CommandList final {
  */
 class DmaPusher final {
 public:
+    /// Method call decoded from a command list segment
+    struct DecodedCall {
+        u32 method;
+        u32 subchannel;
+        u32 method_count;
+        u32 argument;    ///< Argument, or index of the first argument for multi method calls
+        u32 num_methods; ///< Number of arguments for multi method calls, zero otherwise
+        bool is_last_call;
+        u64 dma_word_offset;
+    };
+
+    /// Command lists decoded ahead of their execution by the pipelined GPU thread. Multi method
+    /// calls index the copied arguments and the word offsets of the calls are absolute addresses.
+    struct DecodedList {
+        std::vector<DecodedCall> calls;
+        std::vector<u32> arguments;
+    };
+
     explicit DmaPusher(Core::System& system_, GPU& gpu_, MemoryManager& memory_manager_,
                        Control::ChannelState& channel_state_);
     ~DmaPusher();
@@ -130,6 +160,22 @@ public:
 
     void DispatchCalls();
 
+    /// Reason Decode returned
+    enum class DecodeResult {
+        Done,       ///< Every command list was decoded
+        WaitForGpu, ///< Stopped before a segment fetched once the GPU executed everything before
+        ReadOnGpu,  ///< Stopped before a segment that has to be read on the GPU thread
+    };
+
+    /// Fetches and decodes the command lists without executing them, appending their calls to the
+    /// list. Only touches the decoding state, so it can run on another thread than Execute. When
+    /// decoding stops early, entries is left with the commands that were not decoded and the
+    /// decoding state must not be touched until the GPU has executed everything before them.
+    DecodeResult Decode(CommandList& entries, DecodedList& list);
+
+    /// Executes the calls of lists returned by Decode.
+    void Execute(const DecodedList& list);
+
     void BindSubchannel(Engines::EngineInterface* engine, u32 subchannel_id,
                         Engines::EngineTypes engine_type) {
         subchannels[subchannel_id] = engine;
@@ -138,22 +184,21 @@ public:
 
     void BindRasterizer(VideoCore::RasterizerInterface* rasterizer);
 
+    /// Returns the class of the engine bound to the subchannel, zero when none was bound.
+    [[nodiscard]] u32 BoundEngine(u32 subchannel) const {
+        return puller.BoundEngine(subchannel);
+    }
+
+    /// Accounts the time spent in each engine, or stops accounting when null.
+    void SetEngineTimes(EngineTimes* engine_times_) {
+        engine_times = engine_times_;
+    }
+
 private:
     static constexpr u32 non_puller_methods = 0x40;
     static constexpr u32 max_subchannels = 8;
-    bool Step();
-    void ProcessCommands(std::span<const CommandHeader> commands);
-
-    void SetState(const CommandHeader& command_header);
-
-    void CallMethod(u32 argument) const;
-    void CallMultiMethod(const u32* base_start, u32 num_methods) const;
-
-    Common::ScratchBuffer<CommandHeader>
-        command_headers; ///< Buffer for list of commands fetched at once
-
-    std::queue<CommandList> dma_pushbuffer; ///< Queue of command lists to be processed
-    std::size_t dma_pushbuffer_subindex{};  ///< Index within a command list within the pushbuffer
+    static constexpr size_t min_cached_segment_words = 64;
+    static constexpr size_t max_cached_segments = 4096;
 
     struct DmaState {
         u32 method;            ///< Current method
@@ -166,9 +211,103 @@ private:
         bool is_last_call;
     };
 
+    enum class ProcessMode {
+        Execute,
+        ExecuteAndRecord,
+        Record,
+    };
+
+    struct DecodedSegment;
+
+    bool Step();
+
+    void ProcessSegment(std::span<const CommandHeader> commands, DecodedList* decoded = nullptr);
+
+    template <ProcessMode mode>
+    void ProcessCommands(std::span<const CommandHeader> commands,
+                         std::vector<DecodedCall>* recorded_calls = nullptr);
+
+    /// Replays or decodes the segment at dma_get from its cached calls without reading it, when
+    /// its memory was not written since it was decoded. Returns false when it has to be read.
+    bool ProcessUnchangedSegment(size_t num_words, DecodedList* decoded);
+
+    /// Starts tracking the writes to the memory of a decoded segment
+    void TrackSegment(DecodedSegment& segment, std::span<const CommandHeader> commands);
+
+    /// Stops tracking the writes to the memory of a segment
+    void UntrackSegment(DecodedSegment& segment);
+
+    void ClearSegmentCache();
+
+    /// Groups the consecutive register writes to the same engine, which are appended to its method
+    /// sink at once on replays
+    void BuildReplayRuns(DecodedSegment& segment) const;
+
+    void ReplaySegment(DecodedSegment& segment, std::span<const CommandHeader> commands);
+
+    void AppendSegment(DecodedList& decoded, std::span<const DecodedCall> calls,
+                       std::span<const CommandHeader> commands) const;
+
+    void SetState(const CommandHeader& command_header);
+
+    void CallMethod(const DmaState& state, u32 argument) const;
+    void CallMultiMethod(const DmaState& state, const u32* base_start, u32 num_methods) const;
+
+    void CallMethodImpl(const DmaState& state, u32 argument) const;
+    void CallMultiMethodImpl(const DmaState& state, const u32* base_start, u32 num_methods) const;
+
+    void AccountEngineTime(const DmaState& state,
+                           std::chrono::steady_clock::time_point start) const;
+
+    /// Issues the draw Maxwell3D holds back for coalescing, before anything else can observe it.
+    void FlushPendingDraw() const;
+
+    Common::ScratchBuffer<CommandHeader>
+        command_headers; ///< Buffer for list of commands fetched at once
+
+    std::queue<CommandList> dma_pushbuffer; ///< Queue of command lists to be processed
+    std::size_t dma_pushbuffer_subindex{};  ///< Index within a command list within the pushbuffer
+
     DmaState dma_state{};
     bool dma_increment_once{};
 
+    /// Calls of a decoded segment replayed together
+    struct ReplayRun {
+        u32 first_call;
+        u32 num_calls;
+        /// Register writes to one engine, appended to its method sink at once from sink_writes
+        bool is_sink;
+        u32 first_sink_write;
+    };
+
+    /// Segment seen at a GPU address, decoded once its contents repeat
+    struct DecodedSegment {
+        u64 hash;
+        size_t num_words;
+        bool is_decoded;
+        std::vector<DecodedCall> calls;
+        DmaState exit_state;
+        bool exit_increment_once;
+
+        /// Calls grouped for the engines bound when they were built, empty when not built
+        std::vector<ReplayRun> runs;
+        std::vector<std::pair<u32, u32>> sink_writes;
+        std::array<Engines::EngineInterface*, max_subchannels> run_subchannels{};
+
+        /// Set while the writes to the memory of the segment are tracked, it is then replayed
+        /// without reading it as long as the memory is not written
+        bool is_tracked{};
+        /// Set when the memory was written while tracked, the segment is not tracked again
+        bool is_volatile{};
+        DAddr device_address{};
+        u64 translation_generation{};
+        u64 track_counter{};
+        /// Words of tracked segments with multi method calls, which index them
+        std::vector<CommandHeader> words;
+    };
+    std::unordered_map<GPUVAddr, DecodedSegment> segment_cache;
+    std::vector<DecodedCall> decoded_calls; ///< Calls of the segment being decoded
+
     const bool ib_enable{true}; ///< IB mode enabled
 
     std::array<Engines::EngineInterface*, max_subchannels> subchannels{};
@@ -177,7 +316,10 @@ private:
     GPU& gpu;
     Core::System& system;
     MemoryManager& memory_manager;
+    SegmentWriteTracker& segment_write_tracker;
+    Control::ChannelState& channel_state;
     mutable Engines::Puller puller;
+    EngineTimes* engine_times{};
 };
 
 } // namespace Tegra
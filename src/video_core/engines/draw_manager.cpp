@@ -1,12 +1,39 @@
 // SPDX-FileCopyrightText: Copyright 2022 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <limits>
+#include <utility>
+
 #include "common/settings.h"
+#include "core/core.h"
 #include "video_core/dirty_flags.h"
 #include "video_core/engines/draw_manager.h"
+#include "video_core/gpu.h"
 #include "video_core/rasterizer_interface.h"
 
 namespace Tegra::Engines {
+namespace {
+/// Number of vertices of each primitive for list topologies, zero for topologies where primitives
+/// share vertices and can not be merged
+u32 VerticesPerPrimitive(PrimitiveTopology topology) {
+    switch (topology) {
+    case PrimitiveTopology::Points:
+        return 1;
+    case PrimitiveTopology::Lines:
+        return 2;
+    case PrimitiveTopology::Triangles:
+        return 3;
+    case PrimitiveTopology::Quads:
+    case PrimitiveTopology::LinesAdjacency:
+        return 4;
+    case PrimitiveTopology::TrianglesAdjacency:
+        return 6;
+    default:
+        return 0;
+    }
+}
+} // Anonymous namespace
+
 DrawManager::DrawManager(Maxwell3D* maxwell3d_) : maxwell3d(maxwell3d_) {}
 
 void DrawManager::ProcessMethodCall(u32 method, u32 argument) {
@@ -67,6 +94,20 @@ void DrawManager::ProcessMethodCall(u32 method, u32 argument) {
     }
 }
 
+bool DrawManager::IsDrawRangeMethod(u32 method) {
+    switch (method) {
+    case MAXWELL3D_REG_INDEX(draw.begin):
+    case MAXWELL3D_REG_INDEX(draw.end):
+    case MAXWELL3D_REG_INDEX(vertex_buffer.first):
+    case MAXWELL3D_REG_INDEX(vertex_buffer.count):
+    case MAXWELL3D_REG_INDEX(index_buffer.first):
+    case MAXWELL3D_REG_INDEX(index_buffer.count):
+        return true;
+    default:
+        return false;
+    }
+}
+
 void DrawManager::Clear(u32 layer_count) {
     if (maxwell3d->ShouldExecute()) {
         maxwell3d->rasterizer->Clear(layer_count);
@@ -148,6 +189,10 @@ void DrawManager::DrawBegin() {
     auto reset_instance_count = regs.draw.instance_id == Maxwell3D::Regs::Draw::InstanceId::First;
     auto increment_instance_count =
         regs.draw.instance_id == Maxwell3D::Regs::Draw::InstanceId::Subsequent;
+    if (HasPendingDraw() &&
+        (increment_instance_count || regs.draw.topology != pending_draw.topology)) {
+        IssuePendingDraw();
+    }
     if (reset_instance_count) {
         DrawDeferred();
         draw_state.instance_count = 0;
@@ -169,6 +214,11 @@ void DrawManager::DrawEnd(u32 instance_count, bool force_draw) {
         }
         [[fallthrough]];
     case DrawMode::General:
+        if (!force_draw && Settings::values.use_draw_coalescing.GetValue()) {
+            QueueDraw();
+            break;
+        }
+        FlushPendingDraw();
         draw_state.base_instance = regs.global_base_instance_index;
         draw_state.base_index = regs.global_base_vertex_index;
         if (draw_state.draw_indexed) {
@@ -267,10 +317,82 @@ void DrawManager::ProcessDraw(bool draw_indexed, u32 instance_count) {
     UpdateTopology();
 
     if (maxwell3d->ShouldExecute()) {
+        if (maxwell3d->system.GPU().IsCapturingMemory()) [[unlikely]] {
+            CaptureDrawMemory(draw_indexed);
+        }
         maxwell3d->rasterizer->Draw(draw_indexed, instance_count);
     }
 }
 
+void DrawManager::QueueDraw() {
+    const auto& regs{maxwell3d->regs};
+    const bool draw_indexed = draw_state.draw_indexed;
+    draw_state.draw_indexed = false;
+    if (HasPendingDraw()) {
+        if (CanMergeDraw(draw_indexed)) {
+            if (draw_indexed) {
+                draw_state.index_buffer.count += regs.index_buffer.count;
+            } else {
+                draw_state.vertex_buffer.count += regs.vertex_buffer.count;
+            }
+            ++pending_draw.num_draws;
+            return;
+        }
+        IssuePendingDraw();
+    }
+    draw_state.base_instance = regs.global_base_instance_index;
+    draw_state.base_index = regs.global_base_vertex_index;
+    if (draw_indexed) {
+        draw_state.index_buffer = regs.index_buffer;
+    } else {
+        draw_state.vertex_buffer = regs.vertex_buffer;
+    }
+    UpdateTopology();
+    const u32 vertices_per_primitive = VerticesPerPrimitive(draw_state.topology);
+    // A restart index would leave the primitives of the following draw misaligned
+    if (vertices_per_primitive == 0 || (draw_indexed && regs.primitive_restart.enabled != 0)) {
+        ProcessDraw(draw_indexed, 1);
+        return;
+    }
+    pending_draw = {
+        .num_draws = 1,
+        .draw_indexed = draw_indexed,
+        .vertices_per_primitive = vertices_per_primitive,
+        .topology = regs.draw.topology,
+    };
+}
+
+bool DrawManager::CanMergeDraw(bool draw_indexed) const {
+    const auto& regs{maxwell3d->regs};
+    if (draw_indexed != pending_draw.draw_indexed || regs.draw.topology != pending_draw.topology) {
+        return false;
+    }
+    const u32 first = draw_indexed ? regs.index_buffer.first : regs.vertex_buffer.first;
+    const u32 count = draw_indexed ? regs.index_buffer.count : regs.vertex_buffer.count;
+    const u32 pending_first =
+        draw_indexed ? draw_state.index_buffer.first : draw_state.vertex_buffer.first;
+    const u32 pending_count =
+        draw_indexed ? draw_state.index_buffer.count : draw_state.vertex_buffer.count;
+    // Every primitive must be complete, so the next draw starts a new one as it would on its own
+    return static_cast<u64>(pending_first) + pending_count == first &&
+           pending_count % pending_draw.vertices_per_primitive == 0 &&
+           count <= std::numeric_limits<u32>::max() - pending_count;
+}
+
+void DrawManager::IssuePendingDraw() {
+    const PendingDraw draw = std::exchange(pending_draw, {});
+    if (draw.num_draws > 1) {
+        if (draw.draw_indexed) {
+            // The index buffer is bound with the size of the range being drawn
+            maxwell3d->dirty.flags[VideoCommon::Dirty::IndexBuffer] = true;
+        }
+        if (coalescing_stats) {
+            coalescing_stats->RecordCoalescedDraw(draw.num_draws);
+        }
+    }
+    ProcessDraw(draw.draw_indexed, 1);
+}
+
 void DrawManager::ProcessDrawIndirect() {
     LOG_TRACE(
         HW_GPU,
@@ -281,7 +403,36 @@ void DrawManager::ProcessDrawIndirect() {
     UpdateTopology();
 
     if (maxwell3d->ShouldExecute()) {
+        if (maxwell3d->system.GPU().IsCapturingMemory()) [[unlikely]] {
+            CaptureDrawMemory(indirect_state.is_indexed);
+        }
         maxwell3d->rasterizer->DrawIndirect();
     }
 }
+
+void DrawManager::CaptureDrawMemory(bool draw_indexed) const {
+    const auto& regs{maxwell3d->regs};
+    Tegra::GPU& gpu = maxwell3d->system.GPU();
+    if (draw_indexed) {
+        const GPUVAddr start = regs.index_buffer.StartAddress();
+        gpu.CaptureMemory(start, regs.index_buffer.EndAddress() - start + 1);
+    }
+    for (size_t index = 0; index < Maxwell3D::Regs::NumVertexArrays; ++index) {
+        const auto& stream = regs.vertex_streams[index];
+        if (!stream.IsEnabled()) {
+            continue;
+        }
+        const GPUVAddr end = regs.vertex_stream_limits[index].Address();
+        if (end >= stream.Address()) {
+            gpu.CaptureMemory(stream.Address(), end - stream.Address() + 1);
+        }
+    }
+    for (const auto& stage : maxwell3d->state.shader_stages) {
+        for (const ConstBufferInfo& const_buffer : stage.const_buffers) {
+            if (const_buffer.enabled) {
+                gpu.CaptureMemory(const_buffer.address, const_buffer.size);
+            }
+        }
+    }
+}
 } // namespace Tegra::Engines
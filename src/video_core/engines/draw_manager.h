@@ -2,8 +2,10 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #pragma once
+
 #include "common/common_types.h"
 #include "video_core/engines/maxwell_3d.h"
+#include "video_core/stat_counter.h"
 
 namespace VideoCore {
 class RasterizerInterface;
@@ -17,6 +19,50 @@ using IndexBuffer = Maxwell3D::Regs::IndexBuffer;
 using VertexBuffer = Maxwell3D::Regs::VertexBuffer;
 using IndexBufferSmall = Maxwell3D::Regs::IndexBufferSmall;
 
+/// Draws merged by the coalescing stage of the draw managers of every channel
+class DrawCoalescingStats {
+public:
+    /// Statistics since the last call to GetAndReset
+    struct Snapshot {
+        /// Guest draws that were merged into the host draw of a previous guest draw
+        u64 merged_draws{};
+        /// Host draws issued for more than one guest draw
+        u64 coalesced_draws{};
+        /// Frames presented
+        u64 frames{};
+    };
+
+    void RecordCoalescedDraw(u32 num_guest_draws) {
+        merged_draws.Add(num_guest_draws - 1);
+        coalesced_draws.Add(1);
+    }
+
+    void NotifyFrameEnd() {
+        frames.Add(1);
+    }
+
+    [[nodiscard]] Snapshot GetAndReset() {
+        return {
+            .merged_draws = merged_draws.GetAndReset(),
+            .coalesced_draws = coalesced_draws.GetAndReset(),
+            .frames = frames.GetAndReset(),
+        };
+    }
+
+private:
+    VideoCommon::StatCounter merged_draws;
+    VideoCommon::StatCounter coalesced_draws;
+    VideoCommon::StatCounter frames;
+};
+
+/**
+ * Turns the draw methods of Maxwell3D into rasterizer draws.
+ *
+ * Consecutive draws that share all of their state and draw adjacent ranges of a list topology are
+ * coalesced into a single rasterizer draw. The last draw is held back until a draw that can not be
+ * merged with it arrives, or until anything else could observe it: a register changing its value,
+ * a method with side effects, a HLE macro, another engine or the end of the command list.
+ */
 class DrawManager {
 public:
     enum class DrawMode : u32 { General = 0, Instance, InlineIndex };
@@ -76,6 +122,25 @@ public:
 
     void DrawIndexedIndirect(PrimitiveTopology topology, u32 index_first, u32 index_count);
 
+    /// Issues the draw held back to be merged with the following draws, if there is one.
+    void FlushPendingDraw() {
+        if (HasPendingDraw()) [[unlikely]] {
+            IssuePendingDraw();
+        }
+    }
+
+    [[nodiscard]] bool HasPendingDraw() const {
+        return pending_draw.num_draws != 0;
+    }
+
+    /// Returns true when the method only sets the range of the next draw, so writing to it does
+    /// not affect a pending draw.
+    [[nodiscard]] static bool IsDrawRangeMethod(u32 method);
+
+    void SetCoalescingStats(DrawCoalescingStats* stats) {
+        coalescing_stats = stats;
+    }
+
     const State& GetDrawState() const {
         return draw_state;
     }
@@ -109,9 +174,31 @@ private:
 
     void ProcessDrawIndirect();
 
+    /// Saves the index, vertex and constant buffers used by a draw in the GPU capture.
+    void CaptureDrawMemory(bool draw_indexed) const;
+
+    /// Draws the range set by the registers, merging it with the pending draw when possible.
+    void QueueDraw();
+
+    [[nodiscard]] bool CanMergeDraw(bool draw_indexed) const;
+
+    void IssuePendingDraw();
+
+    /// Draw whose range is stored in draw_state, waiting for more draws to be merged into it
+    struct PendingDraw {
+        /// Number of guest draws merged into it, zero when there is no pending draw
+        u32 num_draws{};
+        bool draw_indexed{};
+        u32 vertices_per_primitive{};
+        /// Topology as set by draw.begin, before overrides
+        PrimitiveTopology topology{};
+    };
+
     Maxwell3D* maxwell3d{};
     State draw_state{};
     DrawTextureState draw_texture_state{};
     IndirectParams indirect_state{};
+    PendingDraw pending_draw{};
+    DrawCoalescingStats* coalescing_stats{};
 };
 } // namespace Tegra::Engines
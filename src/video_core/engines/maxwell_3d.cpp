@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2018 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <cstring>
 #include <optional>
 #include "common/assert.h"
@@ -13,6 +14,7 @@
 #include "video_core/engines/draw_manager.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/gpu.h"
+#include "video_core/gpu_capture.h"
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/textures/texture.h"
@@ -33,6 +35,10 @@ Maxwell3D::Maxwell3D(Core::System& system_, MemoryManager& memory_manager_)
     for (size_t i = 0; i < execution_mask.size(); i++) {
         execution_mask[i] = IsMethodExecutable(static_cast<u32>(i));
     }
+    if (Settings::values.profile_macros || Settings::values.record_macros) {
+        macro_engine->SetProfiler(&system.GPU().MacroProfiler());
+    }
+    draw_manager->SetCoalescingStats(&system.GPU().DrawCoalescingStats());
 }
 
 Maxwell3D::~Maxwell3D() = default;
@@ -224,6 +230,8 @@ void Maxwell3D::RefreshParametersImpl() {
     if (!Settings::IsGPULevelHigh()) {
         return;
     }
+    // The parameters may have been written by the pending draw
+    draw_manager->FlushPendingDraw();
     size_t current_index = 0;
     for (auto& segment : macro_segments) {
         if (segment.first == 0) {
@@ -319,6 +327,10 @@ void Maxwell3D::ProcessDirtyRegisters(u32 method, u32 argument) {
     if (regs.reg_array[method] == argument) {
         return;
     }
+    if (draw_manager->HasPendingDraw() && !DrawManager::IsDrawRangeMethod(method)) {
+        // The pending draw has to be issued with the state it was recorded with
+        draw_manager->FlushPendingDraw();
+    }
     regs.reg_array[method] = argument;
 
     for (const auto& table : dirty.tables) {
@@ -328,6 +340,10 @@ void Maxwell3D::ProcessDirtyRegisters(u32 method, u32 argument) {
 
 void Maxwell3D::ProcessMethodCall(u32 method, u32 argument, u32 nonshadow_argument,
                                   bool is_last_call) {
+    if (draw_manager->HasPendingDraw() && execution_mask[method] &&
+        !DrawManager::IsDrawRangeMethod(method)) {
+        draw_manager->FlushPendingDraw();
+    }
     switch (method) {
     case MAXWELL3D_REG_INDEX(wait_for_idle):
         return rasterizer->WaitForIdle();
@@ -411,6 +427,8 @@ void Maxwell3D::CallMacroMethod(u32 method, const std::vector<u32>& parameters)
 }
 
 void Maxwell3D::CallMethod(u32 method, u32 method_argument, bool is_last_call) {
+    ++method_call_count;
+
     // It is an error to write to a register other than the current macro's ARG register before
     // it has finished execution.
     if (executing_macro != 0) {
@@ -434,6 +452,8 @@ void Maxwell3D::CallMethod(u32 method, u32 method_argument, bool is_last_call) {
 
 void Maxwell3D::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
                                 u32 methods_pending) {
+    method_call_count += amount;
+
     // Methods after 0xE00 are special, they're actually triggers for some microcode that was
     // uploaded to the GPU during initialization.
     if (method >= MacroRegistersStart) {
@@ -457,10 +477,12 @@ void Maxwell3D::CallMultiMethod(u32 method, const u32* base_start, u32 amount,
     case MAXWELL3D_REG_INDEX(const_buffer.buffer) + 13:
     case MAXWELL3D_REG_INDEX(const_buffer.buffer) + 14:
     case MAXWELL3D_REG_INDEX(const_buffer.buffer) + 15:
+        draw_manager->FlushPendingDraw();
         ProcessCBMultiData(base_start, amount);
         break;
     case MAXWELL3D_REG_INDEX(inline_data): {
         ASSERT(methods_pending == amount);
+        draw_manager->FlushPendingDraw();
         upload_state.ProcessData(base_start, amount);
         return;
     }
@@ -671,6 +693,39 @@ u32 Maxwell3D::GetRegisterValue(u32 method) const {
     return regs.reg_array[method];
 }
 
+void Maxwell3D::SaveCaptureState(CapturedChannel& channel) const {
+    static_assert(sizeof(State) % sizeof(u32) == 0, "State must be made of words");
+    channel.registers.assign(regs.reg_array.begin(), regs.reg_array.end());
+    channel.shadow_registers.assign(shadow_state.reg_array.begin(), shadow_state.reg_array.end());
+    channel.const_buffers.resize(sizeof(State) / sizeof(u32));
+    std::memcpy(channel.const_buffers.data(), &state, sizeof(State));
+    channel.macro_positions.assign(macro_positions.begin(), macro_positions.end());
+    channel.macro_code.assign(macro_engine->UploadedCode().begin(),
+                              macro_engine->UploadedCode().end());
+}
+
+void Maxwell3D::LoadCaptureState(const CapturedChannel& channel) {
+    if (channel.registers.size() != Regs::NUM_REGS ||
+        channel.shadow_registers.size() != Regs::NUM_REGS ||
+        channel.const_buffers.size() * sizeof(u32) != sizeof(State) ||
+        channel.macro_positions.size() != macro_positions.size()) {
+        LOG_ERROR(HW_GPU, "Captured Maxwell3D state of channel {} is malformed",
+                  channel.channel_id);
+        return;
+    }
+    std::ranges::copy(channel.registers, regs.reg_array.begin());
+    std::ranges::copy(channel.shadow_registers, shadow_state.reg_array.begin());
+    std::memcpy(&state, channel.const_buffers.data(), sizeof(State));
+    std::ranges::copy(channel.macro_positions, macro_positions.begin());
+    for (const auto& [method, code] : channel.macro_code) {
+        macro_engine->ClearCode(method);
+        for (const u32 word : code) {
+            macro_engine->AddCode(method, word);
+        }
+    }
+    dirty.flags.set();
+}
+
 void Maxwell3D::SetHLEReplacementAttributeType(u32 bank, u32 offset,
                                                HLEReplacementAttributeType name) {
     const u64 key = (static_cast<u64>(bank) << 32) | offset;
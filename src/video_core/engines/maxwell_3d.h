@@ -29,6 +29,7 @@ class System;
 
 namespace Tegra {
 class MemoryManager;
+struct CapturedChannel;
 }
 
 namespace VideoCore {
@@ -3071,6 +3072,17 @@ public:
     /// Reads a register value located at the input method address
     u32 GetRegisterValue(u32 method) const;
 
+    /// Returns the number of methods written so far, used to account the methods sent by macros
+    [[nodiscard]] u64 MethodCallCount() const {
+        return method_call_count;
+    }
+
+    /// Saves the registers, constant buffer bindings and macros into a GPU capture.
+    void SaveCaptureState(CapturedChannel& channel) const;
+
+    /// Restores the state saved by SaveCaptureState, marking everything as dirty.
+    void LoadCaptureState(const CapturedChannel& channel);
+
     /// Write the value to the register identified by method.
     void CallMethod(u32 method, u32 method_argument, bool is_last_call) override;
 
@@ -3209,6 +3221,8 @@ private:
     std::vector<std::pair<GPUVAddr, size_t>> macro_segments;
     std::vector<GPUVAddr> macro_addresses;
     bool current_macro_dirty{};
+
+    u64 method_call_count{};
 };
 
 #define ASSERT_REG_POSITION(field_name, position)                                                  \
@@ -1,7 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2018 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cstring>
+
+#include <fmt/format.h>
+
 #include "common/algorithm.h"
+#include "common/alignment.h"
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/microprofile.h"
@@ -10,6 +15,7 @@
 #include "core/core.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/maxwell_dma.h"
+#include "video_core/gpu.h"
 #include "video_core/guest_memory.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_base.h"
@@ -28,8 +34,53 @@ namespace Tegra::Engines {
 
 using namespace Texture;
 
+namespace {
+constexpr std::array<const char*, DmaCopyStats::NUM_COPY_PATHS> COPY_PATH_NAMES{
+    "Pitch to pitch (direct)",
+    "Pitch to pitch (staged)",
+    "Block linear to pitch (accelerated)",
+    "Block linear to pitch (software)",
+    "Pitch to block linear (accelerated)",
+    "Pitch to block linear (software)",
+    "Block linear to block linear",
+    "Buffer clear",
+    "Buffer copy (accelerated)",
+    "Buffer copy (staged)",
+    "Buffer swizzle (direct)",
+    "Buffer swizzle (staged)",
+};
+
+/// Moves bits 4 to 8 of a linear address to their positions within a GOB.
+constexpr u64 ConvertLinearToBlockLinearAddr(u64 address) {
+    return (address & ~0x1f0ULL) | ((address & 0x40) >> 2) | ((address & 0x10) << 1) |
+           ((address & 0x180) >> 1) | ((address & 0x20) << 3);
+}
+} // Anonymous namespace
+
+DmaCopyStats::Snapshot DmaCopyStats::GetAndReset() {
+    Snapshot snapshot{.frames = frames.GetAndReset()};
+    for (size_t path = 0; path < NUM_COPY_PATHS; ++path) {
+        snapshot.copies[path] = copies[path].GetAndReset();
+    }
+    return snapshot;
+}
+
+std::string DmaCopyStats::FormatReport(const Snapshot& snapshot) {
+    const double num_frames = static_cast<double>(std::max<u64>(snapshot.frames, 1));
+    std::string report = "DMA copies per frame:";
+    for (size_t path = 0; path < NUM_COPY_PATHS; ++path) {
+        if (snapshot.copies[path] != 0) {
+            fmt::format_to(std::back_inserter(report), "\n  {:<36} {:>10.1f}",
+                           COPY_PATH_NAMES[path],
+                           static_cast<double>(snapshot.copies[path]) / num_frames);
+        }
+    }
+    return report;
+}
+
 MaxwellDMA::MaxwellDMA(Core::System& system_, MemoryManager& memory_manager_)
-    : system{system_}, memory_manager{memory_manager_} {
+    : system{system_}, memory_manager{memory_manager_},
+      copy_stats{system.GPU().DmaCopyStats()} {
     execution_mask.reset();
     execution_mask[offsetof(Regs, launch_dma) / sizeof(u32)] = true;
 }
@@ -81,18 +132,27 @@ void MaxwellDMA::Launch() {
         if (!is_src_pitch && !is_dst_pitch) {
             // If both the source and the destination are in block layout, assert.
             MICROPROFILE_SCOPE(GPU_DMAEngineBB);
+            CountCopy(CopyPath::BlockLinearToBlockLinear);
             CopyBlockLinearToBlockLinear();
             ReleaseSemaphore();
             return;
         }
 
         if (is_src_pitch && is_dst_pitch) {
+            if (CopyPitchToPitchDirect()) {
+                CountCopy(CopyPath::PitchToPitchDirect);
+                ReleaseSemaphore();
+                return;
+            }
+            CountCopy(CopyPath::PitchToPitchStaged);
             for (u32 line = 0; line < regs.line_count; ++line) {
                 const GPUVAddr source_line =
                     regs.offset_in + static_cast<size_t>(line) * regs.pitch_in;
                 const GPUVAddr dest_line =
                     regs.offset_out + static_cast<size_t>(line) * regs.pitch_out;
-                memory_manager.CopyBlock(dest_line, source_line, regs.line_length_in);
+                if (!CopyLineThroughHostSpans(dest_line, source_line, regs.line_length_in)) {
+                    memory_manager.CopyBlock(dest_line, source_line, regs.line_length_in);
+                }
             }
         } else {
             if (!is_src_pitch && is_dst_pitch) {
@@ -109,6 +169,7 @@ void MaxwellDMA::Launch() {
         const bool is_const_a_dst = regs.remap_const.dst_x == RemapConst::Swizzle::CONST_A;
         if (regs.launch_dma.remap_enable != 0 && is_const_a_dst) {
             ASSERT(regs.remap_const.component_size_minus_one == 3);
+            CountCopy(CopyPath::BufferClear);
             accelerate.BufferClear(regs.offset_out, regs.line_length_in,
                                    regs.remap_const.remap_consta_value);
             read_buffer.resize_destructive(regs.line_length_in * sizeof(u32));
@@ -119,10 +180,6 @@ void MaxwellDMA::Launch() {
                                             regs.line_length_in * sizeof(u32));
         } else {
             memory_manager.FlushCaching();
-            const auto convert_linear_2_blocklinear_addr = [](u64 address) {
-                return (address & ~0x1f0ULL) | ((address & 0x40) >> 2) | ((address & 0x10) << 1) |
-                       ((address & 0x180) >> 1) | ((address & 0x20) << 3);
-            };
             const auto src_kind = memory_manager.GetPageKind(regs.offset_in);
             const auto dst_kind = memory_manager.GetPageKind(regs.offset_out);
             const bool is_src_pitch = IsPitchKind(src_kind);
@@ -131,12 +188,18 @@ void MaxwellDMA::Launch() {
                 UNIMPLEMENTED_IF(regs.line_length_in % 16 != 0);
                 UNIMPLEMENTED_IF(regs.offset_in % 16 != 0);
                 UNIMPLEMENTED_IF(regs.offset_out % 16 != 0);
+                if (CopyBufferSwizzleDirect(false)) {
+                    CountCopy(CopyPath::BufferSwizzleDirect);
+                    ReleaseSemaphore();
+                    return;
+                }
+                CountCopy(CopyPath::BufferSwizzleStaged);
                 read_buffer.resize_destructive(16);
                 for (u32 offset = 0; offset < regs.line_length_in; offset += 16) {
                     Tegra::Memory::GpuGuestMemoryScoped<
                         u8, Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
                         tmp_write_buffer(memory_manager,
-                                         convert_linear_2_blocklinear_addr(regs.offset_in + offset),
+                                         ConvertLinearToBlockLinearAddr(regs.offset_in + offset),
                                          16, &read_buffer);
                     tmp_write_buffer.SetAddressAndSize(regs.offset_out + offset, 16);
                 }
@@ -144,16 +207,25 @@ void MaxwellDMA::Launch() {
                 UNIMPLEMENTED_IF(regs.line_length_in % 16 != 0);
                 UNIMPLEMENTED_IF(regs.offset_in % 16 != 0);
                 UNIMPLEMENTED_IF(regs.offset_out % 16 != 0);
+                if (CopyBufferSwizzleDirect(true)) {
+                    CountCopy(CopyPath::BufferSwizzleDirect);
+                    ReleaseSemaphore();
+                    return;
+                }
+                CountCopy(CopyPath::BufferSwizzleStaged);
                 read_buffer.resize_destructive(16);
                 for (u32 offset = 0; offset < regs.line_length_in; offset += 16) {
                     Tegra::Memory::GpuGuestMemoryScoped<
                         u8, Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
                         tmp_write_buffer(memory_manager, regs.offset_in + offset, 16, &read_buffer);
                     tmp_write_buffer.SetAddressAndSize(
-                        convert_linear_2_blocklinear_addr(regs.offset_out + offset), 16);
+                        ConvertLinearToBlockLinearAddr(regs.offset_out + offset), 16);
                 }
             } else {
-                if (!accelerate.BufferCopy(regs.offset_in, regs.offset_out, regs.line_length_in)) {
+                if (accelerate.BufferCopy(regs.offset_in, regs.offset_out, regs.line_length_in)) {
+                    CountCopy(CopyPath::BufferCopyAccelerated);
+                } else {
+                    CountCopy(CopyPath::BufferCopyStaged);
                     Tegra::Memory::GpuGuestMemoryScoped<
                         u8, Tegra::Memory::GuestMemoryFlags::SafeReadCachedWrite>
                         tmp_write_buffer(memory_manager, regs.offset_in, regs.line_length_in,
@@ -186,8 +258,10 @@ void MaxwellDMA::CopyBlockLinearToPitch() {
     copy_info.length_y = regs.line_count;
     auto& accelerate = rasterizer->AccessAccelerateDMA();
     if (accelerate.ImageToBuffer(copy_info, src_operand, dst_operand)) {
+        CountCopy(CopyPath::BlockLinearToPitchAccelerated);
         return;
     }
+    CountCopy(CopyPath::BlockLinearToPitchSoftware);
 
     UNIMPLEMENTED_IF(regs.src_params.block_size.width != 0);
     UNIMPLEMENTED_IF(regs.src_params.block_size.depth != 0);
@@ -259,8 +333,10 @@ void MaxwellDMA::CopyPitchToBlockLinear() {
     copy_info.length_y = regs.line_count;
     auto& accelerate = rasterizer->AccessAccelerateDMA();
     if (accelerate.BufferToImage(copy_info, src_operand, dst_operand)) {
+        CountCopy(CopyPath::PitchToBlockLinearAccelerated);
         return;
     }
+    CountCopy(CopyPath::PitchToBlockLinearSoftware);
 
     const auto& dst_params = regs.dst_params;
 
@@ -358,6 +434,123 @@ void MaxwellDMA::CopyBlockLinearToBlockLinear() {
                    dst.block_size.height, dst.block_size.depth, pitch);
 }
 
+bool MaxwellDMA::CopyPitchToPitchDirect() {
+    if (regs.pitch_in < 0 || regs.pitch_out < 0 || regs.line_count == 0 ||
+        regs.line_length_in == 0) {
+        return false;
+    }
+    const GPUVAddr src_addr = regs.offset_in;
+    const GPUVAddr dst_addr = regs.offset_out;
+    const size_t src_pitch = static_cast<size_t>(regs.pitch_in);
+    const size_t dst_pitch = static_cast<size_t>(regs.pitch_out);
+    const size_t line_length = regs.line_length_in;
+    const size_t src_size = (regs.line_count - 1) * src_pitch + line_length;
+    const size_t dst_size = (regs.line_count - 1) * dst_pitch + line_length;
+    const u8* const src = memory_manager.GetSpan(src_addr, src_size);
+    u8* const dst = memory_manager.GetSpan(dst_addr, dst_size);
+    if (src == nullptr || dst == nullptr) {
+        return false;
+    }
+    const bool is_packed = src_pitch == line_length && dst_pitch == line_length;
+    const bool overlaps = src_addr < dst_addr + dst_size && dst_addr < src_addr + src_size;
+    if (is_packed && !overlaps) {
+        memory_manager.FlushRegion(src_addr, src_size);
+        memory_manager.InvalidateRegion(dst_addr, dst_size);
+        std::memcpy(dst, src, src_size);
+        return true;
+    }
+    // Copy line by line in order, overlapping rectangles see the lines written before them
+    for (size_t line = 0; line < regs.line_count; ++line) {
+        const size_t src_offset = line * src_pitch;
+        const size_t dst_offset = line * dst_pitch;
+        memory_manager.FlushRegion(src_addr + src_offset, line_length);
+        memory_manager.InvalidateRegion(dst_addr + dst_offset, line_length);
+        std::memmove(dst + dst_offset, src + src_offset, line_length);
+    }
+    return true;
+}
+
+bool MaxwellDMA::CopyBufferSwizzleDirect(bool is_src_pitch) {
+    const size_t length = regs.line_length_in;
+    const GPUVAddr linear_addr = is_src_pitch ? regs.offset_in : regs.offset_out;
+    const GPUVAddr block_addr = is_src_pitch ? regs.offset_out : regs.offset_in;
+    // The conversion only moves bits within a GOB, so the block linear side spans whole GOBs
+    const GPUVAddr block_begin = Common::AlignDown(block_addr, GOB_SIZE);
+    const GPUVAddr block_end = Common::AlignUp(block_addr + length, GOB_SIZE);
+    const size_t block_size = block_end - block_begin;
+    if (length == 0 || (linear_addr < block_end && block_begin < linear_addr + length)) {
+        return false;
+    }
+    u8* const linear = memory_manager.GetSpan(linear_addr, length);
+    u8* const block = memory_manager.GetSpan(block_begin, block_size);
+    if (linear == nullptr || block == nullptr) {
+        return false;
+    }
+    // Invalidating whole GOBs also covers the bytes that are not written, flush them first so
+    // their contents survive
+    memory_manager.FlushRegion(block_begin, block_size);
+    if (is_src_pitch) {
+        memory_manager.FlushRegion(linear_addr, length);
+        memory_manager.InvalidateRegion(block_begin, block_size);
+    } else {
+        memory_manager.InvalidateRegion(linear_addr, length);
+    }
+    for (size_t offset = 0; offset < length; offset += 16) {
+        const size_t block_offset =
+            static_cast<size_t>(ConvertLinearToBlockLinearAddr(block_addr + offset) - block_begin);
+        if (is_src_pitch) {
+            std::memcpy(block + block_offset, linear + offset, 16);
+        } else {
+            std::memcpy(linear + offset, block + block_offset, 16);
+        }
+    }
+    return true;
+}
+
+bool MaxwellDMA::CopyLineThroughHostSpans(GPUVAddr dst_addr, GPUVAddr src_addr, size_t length) {
+    if (length == 0 || (src_addr < dst_addr + length && dst_addr < src_addr + length)) {
+        return false;
+    }
+    const auto src_spans = memory_manager.GetHostSpans(src_addr, length);
+    const auto dst_spans = memory_manager.GetHostSpans(dst_addr, length);
+    // Unmapped pieces are skipped, CopyBlock reads them as zeros and drops their writes
+    const auto is_mapped = [length](const auto& spans) {
+        size_t mapped = 0;
+        for (const auto& [piece_addr, span] : spans) {
+            mapped += span.size();
+        }
+        return mapped == length;
+    };
+    if (!is_mapped(src_spans) || !is_mapped(dst_spans)) {
+        return false;
+    }
+    memory_manager.FlushRegion(src_addr, length);
+    memory_manager.InvalidateRegion(dst_addr, length);
+    auto src_it = src_spans.begin();
+    auto dst_it = dst_spans.begin();
+    size_t src_offset = 0;
+    size_t dst_offset = 0;
+    for (size_t copied = 0; copied < length;) {
+        const size_t amount =
+            std::min(src_it->second.size() - src_offset, dst_it->second.size() - dst_offset);
+        // Different gpu addresses may still alias the same host memory
+        std::memmove(dst_it->second.data() + dst_offset, src_it->second.data() + src_offset,
+                     amount);
+        copied += amount;
+        src_offset += amount;
+        dst_offset += amount;
+        if (src_offset == src_it->second.size()) {
+            ++src_it;
+            src_offset = 0;
+        }
+        if (dst_offset == dst_it->second.size()) {
+            ++dst_it;
+            dst_offset = 0;
+        }
+    }
+    return true;
+}
+
 void MaxwellDMA::ReleaseSemaphore() {
     const auto type = regs.launch_dma.semaphore_type;
     const GPUVAddr address = regs.semaphore.address;
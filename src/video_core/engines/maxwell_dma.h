@@ -5,6 +5,7 @@
 
 #include <array>
 #include <cstddef>
+#include <string>
 #include <vector>
 
 #include "common/bit_field.h"
@@ -12,6 +13,7 @@
 #include "common/common_types.h"
 #include "common/scratch_buffer.h"
 #include "video_core/engines/engine_interface.h"
+#include "video_core/stat_counter.h"
 
 namespace Core {
 class System;
@@ -89,6 +91,59 @@ public:
                                const DMA::ImageOperand& dst) = 0;
 };
 
+/// Copies executed by the DMA engines of every channel, per path
+class DmaCopyStats {
+public:
+    /// Routes taken by the copies. Staged copies go through intermediate buffers, per chunk guest
+    /// memory accesses or the host spans of each line, software copies (un)swizzle on the CPU.
+    enum class CopyPath : u32 {
+        PitchToPitchDirect,
+        PitchToPitchStaged,
+        BlockLinearToPitchAccelerated,
+        BlockLinearToPitchSoftware,
+        PitchToBlockLinearAccelerated,
+        PitchToBlockLinearSoftware,
+        BlockLinearToBlockLinear,
+        BufferClear,
+        BufferCopyAccelerated,
+        BufferCopyStaged,
+        BufferSwizzleDirect,
+        BufferSwizzleStaged,
+        Count,
+    };
+
+    static constexpr size_t NUM_COPY_PATHS = static_cast<size_t>(CopyPath::Count);
+
+    /// Statistics since the last call to GetAndReset
+    struct Snapshot {
+        /// Copies per path
+        std::array<u64, NUM_COPY_PATHS> copies{};
+        /// Frames presented
+        u64 frames{};
+
+        [[nodiscard]] u64 Copies(CopyPath path) const {
+            return copies[static_cast<size_t>(path)];
+        }
+    };
+
+    void RecordCopy(CopyPath path) {
+        copies[static_cast<size_t>(path)].Add(1);
+    }
+
+    void NotifyFrameEnd() {
+        frames.Add(1);
+    }
+
+    [[nodiscard]] Snapshot GetAndReset();
+
+    /// Returns a human readable summary of the copies per frame of each path taken.
+    [[nodiscard]] static std::string FormatReport(const Snapshot& snapshot);
+
+private:
+    std::array<VideoCommon::StatCounter, NUM_COPY_PATHS> copies;
+    VideoCommon::StatCounter frames;
+};
+
 /**
  * This engine is known as gk104_copy. Documentation can be found in:
  * https://github.com/NVIDIA/open-gpu-doc/blob/master/classes/dma-copy/clb0b5.h
@@ -249,6 +304,8 @@ public:
                          u32 methods_pending) override;
 
 private:
+    using CopyPath = DmaCopyStats::CopyPath;
+
     /// Performs the copy from the source buffer to the destination buffer as configured in the
     /// registers.
     void Launch();
@@ -259,6 +316,21 @@ private:
 
     void CopyBlockLinearToBlockLinear();
 
+    /// Copies the lines between host pointers when both rectangles are contiguous.
+    bool CopyPitchToPitchDirect();
+
+    /// Copies a linear buffer from or to a single line of GOBs between host pointers when both
+    /// ranges are contiguous.
+    bool CopyBufferSwizzleDirect(bool is_src_pitch);
+
+    /// Copies a line between the host spans backing it, when both sides are fully mapped and do
+    /// not overlap.
+    bool CopyLineThroughHostSpans(GPUVAddr dst_addr, GPUVAddr src_addr, size_t length);
+
+    void CountCopy(CopyPath path) {
+        copy_stats.RecordCopy(path);
+    }
+
     void ReleaseSemaphore();
 
     void ConsumeSinkImpl() override;
@@ -272,6 +344,8 @@ private:
     Common::ScratchBuffer<u8> write_buffer;
     Common::ScratchBuffer<u8> intermediate_buffer;
 
+    DmaCopyStats& copy_stats;
+
     static constexpr std::size_t NUM_REGS = 0x800;
     struct Regs {
         union {
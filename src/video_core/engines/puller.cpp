@@ -112,6 +112,9 @@ void Puller::ProcessSemaphoreTriggerMethod() {
                 LOG_ERROR(HW_GPU, "Invalid semaphore operation");
             }
         } while (false);
+        if (gpu.IsCapturingMemory()) [[unlikely]] {
+            gpu.CaptureMemory(regs.semaphore_address.SemaphoreAddress(), sizeof(u32));
+        }
     }
 }
 
@@ -134,6 +137,10 @@ void Puller::ProcessSemaphoreAcquire() {
         regs.acquire_mode = false;
         regs.acquire_source = false;
     }
+    // Saved once acquired, so replays find the value they wait for
+    if (gpu.IsCapturingMemory()) [[unlikely]] {
+        gpu.CaptureMemory(regs.semaphore_address.SemaphoreAddress(), sizeof(u32));
+    }
 }
 
 /// Calls a GPU puller method.
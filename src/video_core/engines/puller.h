@@ -16,6 +16,7 @@ class System;
 }
 
 namespace Tegra {
+class GPU;
 class MemoryManager;
 class DmaPusher;
 
@@ -84,6 +85,11 @@ public:
     void CallEngineMultiMethod(u32 method, u32 subchannel, const u32* base_start, u32 amount,
                                u32 methods_pending);
 
+    /// Returns the class of the engine bound to the subchannel, zero when none was bound.
+    [[nodiscard]] u32 BoundEngine(u32 subchannel) const {
+        return static_cast<u32>(bound_engines[subchannel]);
+    }
+
 private:
     Tegra::GPU& gpu;
 
@@ -3,8 +3,11 @@
 
 #include <algorithm>
 #include <cmath>
+#include <functional>
 #include <vector>
 
+#include "common/alignment.h"
+#include "common/div_ceil.h"
 #include "common/scratch_buffer.h"
 #include "video_core/engines/sw_blitter/blitter.h"
 #include "video_core/engines/sw_blitter/converter.h"
@@ -12,6 +15,7 @@
 #include "video_core/memory_manager.h"
 #include "video_core/surface.h"
 #include "video_core/textures/decoders.h"
+#include "video_core/textures/workers.h"
 
 namespace Tegra {
 class MemoryManager;
@@ -28,85 +32,68 @@ namespace {
 
 constexpr size_t ir_components = 4;
 
-void NearestNeighbor(std::span<const u8> input, std::span<u8> output, u32 src_width, u32 src_height,
-                     u32 dst_width, u32 dst_height, size_t bpp) {
-    const size_t dx_du = std::llround((static_cast<f64>(src_width) / dst_width) * (1ULL << 32));
-    const size_t dy_dv = std::llround((static_cast<f64>(src_height) / dst_height) * (1ULL << 32));
-    size_t src_y = 0;
-    for (u32 y = 0; y < dst_height; y++) {
-        size_t src_x = 0;
-        for (u32 x = 0; x < dst_width; x++) {
-            const size_t read_from = ((src_y * src_width + src_x) >> 32) * bpp;
-            const size_t write_to = (y * dst_width + x) * bpp;
-
-            std::memcpy(&output[write_to], &input[read_from], bpp);
-            src_x += dx_du;
-        }
-        src_y += dy_dv;
-    }
-}
+/// Blits writing fewer pixels than this are done on the calling thread
+constexpr size_t PARALLEL_BLIT_THRESHOLD = 256 * 256;
+/// Approximate amount of pixels processed by each worker task
+constexpr size_t BLIT_TASK_PIXELS = 128 * 128;
 
-void NearestNeighborFast(std::span<const f32> input, std::span<f32> output, u32 src_width,
-                         u32 src_height, u32 dst_width, u32 dst_height) {
+template <typename T>
+void NearestNeighbor(std::span<const T> input, std::span<T> output, u32 src_width, u32 src_height,
+                     u32 dst_width, u32 dst_height, size_t texel_size, u32 y_begin, u32 y_end) {
     const size_t dx_du = std::llround((static_cast<f64>(src_width) / dst_width) * (1ULL << 32));
     const size_t dy_dv = std::llround((static_cast<f64>(src_height) / dst_height) * (1ULL << 32));
-    size_t src_y = 0;
-    for (u32 y = 0; y < dst_height; y++) {
+    for (u32 y = y_begin; y < y_end; y++) {
+        const size_t src_row = ((y * dy_dv) >> 32) * src_width;
         size_t src_x = 0;
         for (u32 x = 0; x < dst_width; x++) {
-            const size_t read_from = ((src_y * src_width + src_x) >> 32) * ir_components;
-            const size_t write_to = (y * dst_width + x) * ir_components;
+            const size_t read_from = (src_row + (src_x >> 32)) * texel_size;
+            const size_t write_to = (size_t{y} * dst_width + x) * texel_size;
 
-            std::memcpy(&output[write_to], &input[read_from], sizeof(f32) * ir_components);
+            std::memcpy(&output[write_to], &input[read_from], sizeof(T) * texel_size);
             src_x += dx_du;
         }
-        src_y += dy_dv;
     }
 }
 
 void Bilinear(std::span<const f32> input, std::span<f32> output, size_t src_width,
-              size_t src_height, size_t dst_width, size_t dst_height) {
-    const auto bilinear_sample = [](std::span<const f32> x0_y0, std::span<const f32> x1_y0,
-                                    std::span<const f32> x0_y1, std::span<const f32> x1_y1,
-                                    f32 weight_x, f32 weight_y) {
-        std::array<f32, ir_components> result{};
-        for (size_t i = 0; i < ir_components; i++) {
-            const f32 a = std::lerp(x0_y0[i], x1_y0[i], weight_x);
-            const f32 b = std::lerp(x0_y1[i], x1_y1[i], weight_x);
-            result[i] = std::lerp(a, b, weight_y);
-        }
-        return result;
+              size_t src_height, size_t dst_width, size_t dst_height, u32 y_begin, u32 y_end) {
+    struct Sample {
+        size_t low;
+        size_t high;
+        f32 weight;
+    };
+    const auto make_sample = [](size_t position, f32 step, size_t size) {
+        const f32 coordinate = static_cast<f32>(position) * step;
+        const f32 low = std::floor(coordinate);
+        const size_t index = std::min(static_cast<size_t>(low), size - 1);
+        return Sample{index, std::min(index + 1, size - 1), coordinate - low};
     };
     const f32 dx_du =
         dst_width > 1 ? static_cast<f32>(src_width - 1) / static_cast<f32>(dst_width - 1) : 0.f;
     const f32 dy_dv =
         dst_height > 1 ? static_cast<f32>(src_height - 1) / static_cast<f32>(dst_height - 1) : 0.f;
-    for (u32 y = 0; y < dst_height; y++) {
-        for (u32 x = 0; x < dst_width; x++) {
-            const f32 x_low = std::floor(static_cast<f32>(x) * dx_du);
-            const f32 y_low = std::floor(static_cast<f32>(y) * dy_dv);
-            const f32 x_high = std::ceil(static_cast<f32>(x) * dx_du);
-            const f32 y_high = std::ceil(static_cast<f32>(y) * dy_dv);
-            const f32 weight_x = (static_cast<f32>(x) * dx_du) - x_low;
-            const f32 weight_y = (static_cast<f32>(y) * dy_dv) - y_low;
-
-            const auto read_src = [&](f32 in_x, f32 in_y) {
-                const size_t read_from =
-                    ((static_cast<size_t>(in_x) * src_width + static_cast<size_t>(in_y)) >> 32) *
-                    ir_components;
-                return std::span<const f32>(&input[read_from], ir_components);
-            };
-
-            auto x0_y0 = read_src(x_low, y_low);
-            auto x1_y0 = read_src(x_high, y_low);
-            auto x0_y1 = read_src(x_low, y_high);
-            auto x1_y1 = read_src(x_high, y_high);
-
-            const auto result = bilinear_sample(x0_y0, x1_y0, x0_y1, x1_y1, weight_x, weight_y);
-
-            const size_t write_to = (y * dst_width + x) * ir_components;
-
-            std::memcpy(&output[write_to], &result, sizeof(f32) * ir_components);
+    // Every row samples the same columns
+    std::vector<Sample> columns(dst_width);
+    for (size_t x = 0; x < dst_width; x++) {
+        const Sample column = make_sample(x, dx_du, src_width);
+        columns[x] = {column.low * ir_components, column.high * ir_components, column.weight};
+    }
+    for (u32 y = y_begin; y < y_end; y++) {
+        const Sample row = make_sample(y, dy_dv, src_height);
+        const f32* const row_low = &input[row.low * src_width * ir_components];
+        const f32* const row_high = &input[row.high * src_width * ir_components];
+        f32* write_to = &output[y * dst_width * ir_components];
+        for (const Sample& column : columns) {
+            for (size_t i = 0; i < ir_components; i++) {
+                const f32 x0_y0 = row_low[column.low + i];
+                const f32 x1_y0 = row_low[column.high + i];
+                const f32 x0_y1 = row_high[column.low + i];
+                const f32 x1_y1 = row_high[column.high + i];
+                const f32 a = x0_y0 + (x1_y0 - x0_y0) * column.weight;
+                const f32 b = x0_y1 + (x1_y1 - x0_y1) * column.weight;
+                write_to[i] = a + (b - a) * row.weight;
+            }
+            write_to += ir_components;
         }
     }
 }
@@ -125,34 +112,98 @@ void ProcessPitchLinear(std::span<const u8> input, std::span<u8> output, size_t
     }
 }
 
+size_t GetSurfaceSize(const Fermi2D::Surface& surface, u32 bytes_per_pixel) {
+    if (surface.linear == Fermi2D::MemoryLayout::BlockLinear) {
+        return CalculateSize(true, bytes_per_pixel, surface.width, surface.height, surface.depth,
+                             surface.block_height, surface.block_depth);
+    }
+    return static_cast<size_t>(surface.pitch * surface.height);
+}
+
+/// Bytes of a surface holding a range of its rows, seen as a shorter surface of its own
+struct SurfaceWindow {
+    size_t offset;
+    size_t size;
+    u32 first_row;
+    Fermi2D::Surface surface;
+};
+
+SurfaceWindow GetSurfaceWindow(const Fermi2D::Surface& surface, u32 bytes_per_pixel,
+                               s32 row_begin, s32 row_end) {
+    const size_t surface_size = GetSurfaceSize(surface, bytes_per_pixel);
+    SurfaceWindow window{
+        .offset = 0,
+        .size = surface_size,
+        .first_row = 0,
+        .surface = surface,
+    };
+    if (surface.depth != 1 || row_begin < 0 || row_end <= row_begin ||
+        static_cast<u32>(row_end) > surface.height) {
+        return window;
+    }
+    u32 rows_per_block = 1;
+    size_t block_size = surface.pitch;
+    if (surface.linear == Fermi2D::MemoryLayout::BlockLinear) {
+        const u32 block_height = surface.block_height;
+        const u32 stride =
+            Common::AlignUpLog2(surface.width * bytes_per_pixel, GOB_SIZE_X_SHIFT);
+        rows_per_block = GOB_SIZE_Y << block_height;
+        block_size = size_t{stride >> GOB_SIZE_X_SHIFT}
+                     << (GOB_SIZE_SHIFT + block_height + surface.block_depth);
+    }
+    const u32 first_block = static_cast<u32>(row_begin) / rows_per_block;
+    const u32 last_block = Common::DivCeil(static_cast<u32>(row_end), rows_per_block);
+    window.offset = std::min(first_block * block_size, surface_size);
+    window.size = std::min((last_block - first_block) * block_size, surface_size - window.offset);
+    window.first_row = first_block * rows_per_block;
+    window.surface.height =
+        std::min(surface.height, last_block * rows_per_block) - window.first_row;
+    return window;
+}
+
+/**
+ * Runs func over consecutive bands of rows in [0, num_rows), in parallel when there are enough
+ * pixels. Band edges fall on multiples of a GOB height once offset by first_row, so bands never
+ * share a GOB of a block linear surface.
+ */
+void ForEachBand(u32 num_rows, u32 first_row, size_t row_pixels, bool can_split,
+                 const std::function<void(u32, u32)>& func) {
+    if (!can_split || num_rows * row_pixels < PARALLEL_BLIT_THRESHOLD) {
+        func(0, num_rows);
+        return;
+    }
+    const u32 band_rows = Common::AlignUp(
+        static_cast<u32>(std::max<size_t>(BLIT_TASK_PIXELS / row_pixels, 1)), GOB_SIZE_Y);
+    const u32 skew = first_row % band_rows;
+    const u32 num_bands = Common::DivCeil(num_rows + skew, band_rows);
+    ParallelFor(num_bands, [&](size_t band) {
+        const u32 band_begin = static_cast<u32>(band) * band_rows;
+        const u32 begin = band_begin > skew ? band_begin - skew : 0;
+        const u32 end = std::min(band_begin + band_rows - skew, num_rows);
+        func(begin, end);
+    });
+}
+
 } // namespace
 
-struct SoftwareBlitEngine::BlitEngineImpl {
-    Common::ScratchBuffer<u8> tmp_buffer;
+struct SurfaceBlitter::Impl {
     Common::ScratchBuffer<u8> src_buffer;
     Common::ScratchBuffer<u8> dst_buffer;
+    Common::ScratchBuffer<u8> scaled_buffer;
     Common::ScratchBuffer<f32> intermediate_src;
     Common::ScratchBuffer<f32> intermediate_dst;
     ConverterFactory converter_factory;
 };
 
-SoftwareBlitEngine::SoftwareBlitEngine(MemoryManager& memory_manager_)
-    : memory_manager{memory_manager_} {
-    impl = std::make_unique<BlitEngineImpl>();
+SurfaceBlitter::SurfaceBlitter() {
+    impl = std::make_unique<Impl>();
 }
 
-SoftwareBlitEngine::~SoftwareBlitEngine() = default;
-
-bool SoftwareBlitEngine::Blit(Fermi2D::Surface& src, Fermi2D::Surface& dst,
-                              Fermi2D::Config& config) {
-    const auto get_surface_size = [](Fermi2D::Surface& surface, u32 bytes_per_pixel) {
-        if (surface.linear == Fermi2D::MemoryLayout::BlockLinear) {
-            return CalculateSize(true, bytes_per_pixel, surface.width, surface.height,
-                                 surface.depth, surface.block_height, surface.block_depth);
-        }
-        return static_cast<size_t>(surface.pitch * surface.height);
-    };
+SurfaceBlitter::~SurfaceBlitter() = default;
 
+void SurfaceBlitter::Blit(std::span<const u8> src_memory, const Fermi2D::Surface& src,
+                          std::span<u8> dst_memory, const Fermi2D::Surface& dst,
+                          const Fermi2D::Config& config) {
     const u32 src_extent_x = config.src_x1 - config.src_x0;
     const u32 src_extent_y = config.src_y1 - config.src_y0;
 
@@ -160,80 +211,158 @@ bool SoftwareBlitEngine::Blit(Fermi2D::Surface& src, Fermi2D::Surface& dst,
     const u32 dst_extent_y = config.dst_y1 - config.dst_y0;
     const auto src_bytes_per_pixel = BytesPerBlock(PixelFormatFromRenderTargetFormat(src.format));
     const auto dst_bytes_per_pixel = BytesPerBlock(PixelFormatFromRenderTargetFormat(dst.format));
-    const size_t src_size = get_surface_size(src, src_bytes_per_pixel);
-
-    Tegra::Memory::GpuGuestMemory<u8, Tegra::Memory::GuestMemoryFlags::SafeRead> tmp_buffer(
-        memory_manager, src.Address(), src_size, &impl->tmp_buffer);
-
-    const size_t src_copy_size = src_extent_x * src_extent_y * src_bytes_per_pixel;
-    const size_t dst_copy_size = dst_extent_x * dst_extent_y * dst_bytes_per_pixel;
-
-    impl->src_buffer.resize_destructive(src_copy_size);
-
-    const bool no_passthrough =
-        src.format != dst.format || src_extent_x != dst_extent_x || src_extent_y != dst_extent_y;
-
-    const auto conversion_phase_same_format = [&]() {
-        NearestNeighbor(impl->src_buffer, impl->dst_buffer, src_extent_x, src_extent_y,
-                        dst_extent_x, dst_extent_y, dst_bytes_per_pixel);
-    };
-
-    const auto conversion_phase_ir = [&]() {
-        auto* input_converter = impl->converter_factory.GetFormatConverter(src.format);
-        impl->intermediate_src.resize_destructive((src_copy_size / src_bytes_per_pixel) *
+    const size_t src_row_size = size_t{src_extent_x} * src_bytes_per_pixel;
+    const size_t dst_row_size = size_t{dst_extent_x} * dst_bytes_per_pixel;
+
+    impl->src_buffer.resize_destructive(src_row_size * src_extent_y);
+
+    const bool passthrough =
+        src.format == dst.format && src_extent_x == dst_extent_x && src_extent_y == dst_extent_y;
+    // Bilinear filtering needs the f32 intermediate, nearest filtering can skip it when a
+    // specialized converter exists for the pair of formats
+    const bool bilinear = config.filter == Fermi2D::Filter::Bilinear;
+    const bool same_format = !bilinear && src.format == dst.format;
+    const DirectConverter direct_converter =
+        bilinear || src.format == dst.format
+            ? nullptr
+            : ConverterFactory::GetDirectConverter(src.format, dst.format);
+    const bool use_ir = !passthrough && !same_format && !direct_converter;
+
+    Converter* input_converter = nullptr;
+    Converter* output_converter = nullptr;
+    if (use_ir) {
+        input_converter = impl->converter_factory.GetFormatConverter(src.format);
+        output_converter = impl->converter_factory.GetFormatConverter(dst.format);
+        impl->intermediate_src.resize_destructive(size_t{src_extent_x} * src_extent_y *
                                                   ir_components);
-        impl->intermediate_dst.resize_destructive((dst_copy_size / dst_bytes_per_pixel) *
+        impl->intermediate_dst.resize_destructive(size_t{dst_extent_x} * dst_extent_y *
                                                   ir_components);
-        input_converter->ConvertTo(impl->src_buffer, impl->intermediate_src);
+    }
+    if (!passthrough) {
+        impl->dst_buffer.resize_destructive(dst_row_size * dst_extent_y);
+    }
+    const bool scaled_direct =
+        direct_converter && (src_extent_x != dst_extent_x || src_extent_y != dst_extent_y);
+    if (scaled_direct) {
+        impl->scaled_buffer.resize_destructive(size_t{dst_extent_x} * dst_extent_y *
+                                               src_bytes_per_pixel);
+    }
 
-        if (config.filter != Fermi2D::Filter::Bilinear) {
-            NearestNeighborFast(impl->intermediate_src, impl->intermediate_dst, src_extent_x,
-                                src_extent_y, dst_extent_x, dst_extent_y);
+    // Gathers source rows, converted to the intermediate when needed
+    const auto gather_rows = [&](u32 begin, u32 end) {
+        const std::span<u8> rows = std::span<u8>(impl->src_buffer).subspan(begin * src_row_size);
+        if (src.linear == Fermi2D::MemoryLayout::BlockLinear) {
+            UnswizzleSubrect(rows, src_memory, src_bytes_per_pixel, src.width, src.height,
+                             src.depth, config.src_x0, config.src_y0 + begin, src_extent_x,
+                             end - begin, src.block_height, src.block_depth,
+                             static_cast<u32>(src_row_size));
         } else {
-            Bilinear(impl->intermediate_src, impl->intermediate_dst, src_extent_x, src_extent_y,
-                     dst_extent_x, dst_extent_y);
+            ProcessPitchLinear<false>(src_memory, rows, src_extent_x, end - begin, src.pitch,
+                                      config.src_x0, config.src_y0 + begin, src_bytes_per_pixel);
+        }
+        if (use_ir) {
+            const size_t first_pixel = size_t{begin} * src_extent_x;
+            const size_t num_pixels = size_t{end - begin} * src_extent_x;
+            input_converter->ConvertTo(
+                rows.first(num_pixels * src_bytes_per_pixel),
+                std::span<f32>(impl->intermediate_src)
+                    .subspan(first_pixel * ir_components, num_pixels * ir_components));
         }
-
-        auto* output_converter = impl->converter_factory.GetFormatConverter(dst.format);
-        output_converter->ConvertFrom(impl->intermediate_dst, impl->dst_buffer);
     };
 
-    // Do actual Blit
-
-    impl->dst_buffer.resize_destructive(dst_copy_size);
-    if (src.linear == Fermi2D::MemoryLayout::BlockLinear) {
-        UnswizzleSubrect(impl->src_buffer, tmp_buffer, src_bytes_per_pixel, src.width, src.height,
-                         src.depth, config.src_x0, config.src_y0, src_extent_x, src_extent_y,
-                         src.block_height, src.block_depth, src_extent_x * src_bytes_per_pixel);
-    } else {
-        ProcessPitchLinear<false>(tmp_buffer, impl->src_buffer, src_extent_x, src_extent_y,
-                                  src.pitch, config.src_x0, config.src_y0, src_bytes_per_pixel);
-    }
+    // Produces destination rows and writes them straight to the destination surface
+    const std::span<u8> result = passthrough ? impl->src_buffer : impl->dst_buffer;
+    const auto produce_rows = [&](u32 begin, u32 end) {
+        const size_t first_pixel = size_t{begin} * dst_extent_x;
+        const size_t num_pixels = size_t{end - begin} * dst_extent_x;
+        const std::span<u8> rows =
+            result.subspan(begin * dst_row_size, (end - begin) * dst_row_size);
+        if (same_format && !passthrough) {
+            NearestNeighbor<u8>(impl->src_buffer, impl->dst_buffer, src_extent_x, src_extent_y,
+                                dst_extent_x, dst_extent_y, dst_bytes_per_pixel, begin, end);
+        } else if (scaled_direct) {
+            NearestNeighbor<u8>(impl->src_buffer, impl->scaled_buffer, src_extent_x,
+                                src_extent_y, dst_extent_x, dst_extent_y, src_bytes_per_pixel,
+                                begin, end);
+            direct_converter(std::span<const u8>(impl->scaled_buffer)
+                                 .subspan(first_pixel * src_bytes_per_pixel,
+                                          num_pixels * src_bytes_per_pixel),
+                             rows);
+        } else if (direct_converter) {
+            direct_converter(std::span<const u8>(impl->src_buffer)
+                                 .subspan(first_pixel * src_bytes_per_pixel,
+                                          num_pixels * src_bytes_per_pixel),
+                             rows);
+        } else if (use_ir) {
+            if (bilinear) {
+                Bilinear(impl->intermediate_src, impl->intermediate_dst, src_extent_x,
+                         src_extent_y, dst_extent_x, dst_extent_y, begin, end);
+            } else {
+                NearestNeighbor<f32>(impl->intermediate_src, impl->intermediate_dst, src_extent_x,
+                                     src_extent_y, dst_extent_x, dst_extent_y, ir_components,
+                                     begin, end);
+            }
+            output_converter->ConvertFrom(
+                std::span<const f32>(impl->intermediate_dst)
+                    .subspan(first_pixel * ir_components, num_pixels * ir_components),
+                rows);
+        }
 
-    // Conversion Phase
-    if (no_passthrough) {
-        if (src.format != dst.format || config.filter == Fermi2D::Filter::Bilinear) {
-            conversion_phase_ir();
+        if (dst.linear == Fermi2D::MemoryLayout::BlockLinear) {
+            SwizzleSubrect(dst_memory, rows, dst_bytes_per_pixel, dst.width, dst.height,
+                           dst.depth, config.dst_x0, config.dst_y0 + begin, dst_extent_x,
+                           end - begin, dst.block_height, dst.block_depth,
+                           static_cast<u32>(dst_row_size));
         } else {
-            conversion_phase_same_format();
+            ProcessPitchLinear<true>(rows, dst_memory, dst_extent_x, end - begin, dst.pitch,
+                                     config.dst_x0, config.dst_y0 + begin,
+                                     static_cast<size_t>(dst_bytes_per_pixel));
         }
-    } else {
-        impl->dst_buffer.swap(impl->src_buffer);
-    }
+    };
+
+    // Every source row has to be ready before scaling reads them
+    ForEachBand(src_extent_y, 0, src_extent_x, src.depth == 1, gather_rows);
+    ForEachBand(dst_extent_y, config.dst_y0, dst_extent_x, dst.depth == 1, produce_rows);
+}
+
+struct SoftwareBlitEngine::BlitEngineImpl {
+    Common::ScratchBuffer<u8> src_tmp_buffer;
+    Common::ScratchBuffer<u8> dst_tmp_buffer;
+    SurfaceBlitter surface_blitter;
+};
+
+SoftwareBlitEngine::SoftwareBlitEngine(MemoryManager& memory_manager_)
+    : memory_manager{memory_manager_} {
+    impl = std::make_unique<BlitEngineImpl>();
+}
 
-    const size_t dst_size = get_surface_size(dst, dst_bytes_per_pixel);
+SoftwareBlitEngine::~SoftwareBlitEngine() = default;
+
+bool SoftwareBlitEngine::Blit(Fermi2D::Surface& src, Fermi2D::Surface& dst,
+                              Fermi2D::Config& config) {
+    const auto src_bytes_per_pixel = BytesPerBlock(PixelFormatFromRenderTargetFormat(src.format));
+    const auto dst_bytes_per_pixel = BytesPerBlock(PixelFormatFromRenderTargetFormat(dst.format));
+
+    // Only map the rows the blit touches, as seen from the start of their first block
+    const SurfaceWindow src_window =
+        GetSurfaceWindow(src, src_bytes_per_pixel, config.src_y0, config.src_y1);
+    const SurfaceWindow dst_window =
+        GetSurfaceWindow(dst, dst_bytes_per_pixel, config.dst_y0, config.dst_y1);
+    Fermi2D::Config window_config = config;
+    window_config.src_y0 -= static_cast<s32>(src_window.first_row);
+    window_config.src_y1 -= static_cast<s32>(src_window.first_row);
+    window_config.dst_y0 -= static_cast<s32>(dst_window.first_row);
+    window_config.dst_y1 -= static_cast<s32>(dst_window.first_row);
+
+    Tegra::Memory::GpuGuestMemory<u8, Tegra::Memory::GuestMemoryFlags::SafeRead> src_memory(
+        memory_manager, src.Address() + src_window.offset, src_window.size,
+        &impl->src_tmp_buffer);
     Tegra::Memory::GpuGuestMemoryScoped<u8, Tegra::Memory::GuestMemoryFlags::SafeReadWrite>
-        tmp_buffer2(memory_manager, dst.Address(), dst_size, &impl->tmp_buffer);
-
-    if (dst.linear == Fermi2D::MemoryLayout::BlockLinear) {
-        SwizzleSubrect(tmp_buffer2, impl->dst_buffer, dst_bytes_per_pixel, dst.width, dst.height,
-                       dst.depth, config.dst_x0, config.dst_y0, dst_extent_x, dst_extent_y,
-                       dst.block_height, dst.block_depth, dst_extent_x * dst_bytes_per_pixel);
-    } else {
-        ProcessPitchLinear<true>(impl->dst_buffer, tmp_buffer2, dst_extent_x, dst_extent_y,
-                                 dst.pitch, config.dst_x0, config.dst_y0,
-                                 static_cast<size_t>(dst_bytes_per_pixel));
-    }
+        dst_memory(memory_manager, dst.Address() + dst_window.offset, dst_window.size,
+                   &impl->dst_tmp_buffer);
+
+    impl->surface_blitter.Blit(src_memory, src_window.surface, dst_memory, dst_window.surface,
+                               window_config);
     return true;
 }
 
@@ -3,6 +3,9 @@
 
 #pragma once
 
+#include <memory>
+#include <span>
+
 #include "video_core/engines/fermi_2d.h"
 
 namespace Tegra {
@@ -11,6 +14,26 @@ class MemoryManager;
 
 namespace Tegra::Engines::Blitter {
 
+/// Blits between surfaces that are already mapped to host memory.
+class SurfaceBlitter {
+public:
+    SurfaceBlitter();
+    ~SurfaceBlitter();
+
+    /**
+     * Copies the source rectangle of config to its destination rectangle, converting and scaling
+     * as needed. Both spans start at the first byte of their surface. Large blits are split in
+     * bands of rows across the transcode workers.
+     */
+    void Blit(std::span<const u8> src_memory, const Fermi2D::Surface& src,
+              std::span<u8> dst_memory, const Fermi2D::Surface& dst,
+              const Fermi2D::Config& config);
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
 class SoftwareBlitEngine {
 public:
     explicit SoftwareBlitEngine(MemoryManager& memory_manager_);
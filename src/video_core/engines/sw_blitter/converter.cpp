@@ -1,11 +1,17 @@
 // SPDX-FileCopyrightText: Copyright 2022 citron Emulator Project
 // SPDX-License-Identifier: GPL-3.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <cmath>
+#include <cstring>
 #include <span>
 #include <unordered_map>
 
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#endif
+
 #include "common/assert.h"
 #include "common/bit_cast.h"
 #include "video_core/engines/sw_blitter/converter.h"
@@ -920,6 +926,231 @@ public:
     ~ConverterImpl() override = default;
 };
 
+namespace {
+
+/// How a direct converter produces one byte of the destination pixel
+enum class ByteOp : u32 {
+    Copy,         ///< Copy the source byte as is
+    SrgbToLinear, ///< Decode an sRGB source byte to a linear destination
+    LinearToSrgb, ///< Encode a linear source byte to an sRGB destination
+    Constant,     ///< Write a constant, for channels missing on either side
+};
+
+struct ByteMapping {
+    ByteOp op;
+    u32 src_byte;
+    u8 constant;
+};
+
+template <class Traits>
+constexpr bool IsDirectFormat() {
+    if (Traits::num_components != 4) {
+        return false;
+    }
+    for (size_t i = 0; i < Traits::num_components; i++) {
+        if (Traits::component_sizes[i] != 8 ||
+            (Traits::component_types[i] != ComponentType::UNORM &&
+             Traits::component_types[i] != ComponentType::SRGB)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <class Traits>
+constexpr bool IsSrgbByte(size_t byte) {
+    // Alpha is always stored linearly
+    return Traits::component_types[byte] == ComponentType::SRGB &&
+           Traits::component_swizzle[byte] != Swizzle::A;
+}
+
+/// Matches each destination byte with its source byte, following what the f32 path does
+template <class SrcTraits, class DstTraits>
+constexpr std::array<ByteMapping, 4> BuildByteMappings() {
+    std::array<ByteMapping, 4> result{};
+    for (size_t dst_byte = 0; dst_byte < 4; dst_byte++) {
+        const Swizzle swizzle = DstTraits::component_swizzle[dst_byte];
+        result[dst_byte] = {ByteOp::Constant, 0, 0};
+        if (swizzle == Swizzle::None) {
+            continue;
+        }
+        for (size_t src_byte = 0; src_byte < 4; src_byte++) {
+            if (SrcTraits::component_swizzle[src_byte] != swizzle) {
+                continue;
+            }
+            const bool src_srgb = IsSrgbByte<SrcTraits>(src_byte);
+            const bool dst_srgb = IsSrgbByte<DstTraits>(dst_byte);
+            ByteOp op = ByteOp::Copy;
+            if (src_srgb && !dst_srgb) {
+                op = ByteOp::SrgbToLinear;
+            } else if (!src_srgb && dst_srgb) {
+                op = ByteOp::LinearToSrgb;
+            }
+            result[dst_byte] = {op, static_cast<u32>(src_byte), 0};
+        }
+        if (result[dst_byte].op == ByteOp::Constant && swizzle == Swizzle::A) {
+            // Sources without alpha are opaque
+            result[dst_byte].constant = 0xff;
+        }
+    }
+    return result;
+}
+
+constexpr std::array<u8, 256> BuildByteLut(const std::array<f32, 256>& lut) {
+    std::array<u8, 256> result{};
+    for (size_t i = 0; i < 256; i++) {
+        result[i] = static_cast<u8>(static_cast<u32>(lut[i] * 255.0f));
+    }
+    return result;
+}
+
+constexpr std::array<u8, 256> SRGB_TO_LINEAR_BYTES = BuildByteLut(SRGB_TO_RGB_LUT);
+constexpr std::array<u8, 256> LINEAR_TO_SRGB_BYTES = BuildByteLut(RGB_TO_SRGB_LUT);
+
+template <class SrcTraits, class DstTraits>
+class DirectConverterImpl {
+    static constexpr std::array<ByteMapping, 4> mappings =
+        BuildByteMappings<SrcTraits, DstTraits>();
+
+    static constexpr bool is_identity = [] {
+        for (u32 i = 0; i < 4; i++) {
+            if (mappings[i].op != ByteOp::Copy || mappings[i].src_byte != i) {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    static constexpr bool is_shuffle = [] {
+        for (const ByteMapping& mapping : mappings) {
+            if (mapping.op != ByteOp::Copy && mapping.op != ByteOp::Constant) {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    static constexpr u32 constant_bits = [] {
+        u32 result = 0;
+        for (u32 i = 0; i < 4; i++) {
+            if (mappings[i].op == ByteOp::Constant) {
+                result |= u32{mappings[i].constant} << (i * 8);
+            }
+        }
+        return result;
+    }();
+
+    template <size_t dst_byte>
+    static FORCE_INLINE u32 ConvertByte(u32 pixel) {
+        constexpr ByteMapping mapping = mappings[dst_byte];
+        constexpr u32 dst_shift = dst_byte * 8;
+        if constexpr (mapping.op == ByteOp::Constant) {
+            return 0;
+        } else {
+            const u32 value = (pixel >> (mapping.src_byte * 8)) & 0xff;
+            if constexpr (mapping.op == ByteOp::SrgbToLinear) {
+                return u32{SRGB_TO_LINEAR_BYTES[value]} << dst_shift;
+            } else if constexpr (mapping.op == ByteOp::LinearToSrgb) {
+                return u32{LINEAR_TO_SRGB_BYTES[value]} << dst_shift;
+            } else {
+                return value << dst_shift;
+            }
+        }
+    }
+
+    static FORCE_INLINE u32 ConvertPixel(u32 pixel) {
+        return ConvertByte<0>(pixel) | ConvertByte<1>(pixel) | ConvertByte<2>(pixel) |
+               ConvertByte<3>(pixel) | constant_bits;
+    }
+
+#if defined(ARCHITECTURE_x86_64)
+    template <size_t dst_byte>
+    static FORCE_INLINE __m128i ShuffleByte(__m128i pixels) {
+        constexpr ByteMapping mapping = mappings[dst_byte];
+        if constexpr (mapping.op == ByteOp::Constant) {
+            return _mm_setzero_si128();
+        } else {
+            constexpr int shift = static_cast<int>(dst_byte * 8) -
+                                  static_cast<int>(mapping.src_byte * 8);
+            const __m128i mask = _mm_set1_epi32(static_cast<int>(0xffU << (dst_byte * 8)));
+            if constexpr (shift >= 0) {
+                return _mm_and_si128(_mm_slli_epi32(pixels, shift), mask);
+            } else {
+                return _mm_and_si128(_mm_srli_epi32(pixels, -shift), mask);
+            }
+        }
+    }
+
+    /// Moves the bytes of four pixels at once, returns the number of pixels converted
+    static size_t ShuffleSSE2(const u8* input, u8* output, size_t num_pixels) {
+        const __m128i constants = _mm_set1_epi32(static_cast<int>(constant_bits));
+        size_t pixel = 0;
+        for (; pixel + 4 <= num_pixels; pixel += 4) {
+            const __m128i in =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + pixel * 4));
+            const __m128i out =
+                _mm_or_si128(_mm_or_si128(ShuffleByte<0>(in), ShuffleByte<1>(in)),
+                             _mm_or_si128(_mm_or_si128(ShuffleByte<2>(in), ShuffleByte<3>(in)),
+                                          constants));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(output + pixel * 4), out);
+        }
+        return pixel;
+    }
+#endif
+
+public:
+    static void Convert(std::span<const u8> input, std::span<u8> output) {
+        const size_t num_pixels = std::min(input.size(), output.size()) / 4;
+        if constexpr (is_identity) {
+            std::memcpy(output.data(), input.data(), num_pixels * 4);
+            return;
+        }
+        size_t pixel = 0;
+#if defined(ARCHITECTURE_x86_64)
+        if constexpr (is_shuffle) {
+            pixel = ShuffleSSE2(input.data(), output.data(), num_pixels);
+        }
+#endif
+        for (; pixel < num_pixels; pixel++) {
+            u32 value;
+            std::memcpy(&value, &input[pixel * 4], sizeof(value));
+            value = ConvertPixel(value);
+            std::memcpy(&output[pixel * 4], &value, sizeof(value));
+        }
+    }
+};
+
+/// Calls func with the traits of format if it has a direct converter
+template <typename Func>
+void VisitDirectFormat(RenderTargetFormat format, Func&& func) {
+    const auto visit = [&func]<class Traits>(Traits traits) {
+        static_assert(IsDirectFormat<Traits>());
+        func(traits);
+    };
+    switch (format) {
+    case RenderTargetFormat::A8R8G8B8_UNORM:
+        return visit(A8R8G8B8_UNORMTraits{});
+    case RenderTargetFormat::A8R8G8B8_SRGB:
+        return visit(A8R8G8B8_SRGBTraits{});
+    case RenderTargetFormat::A8B8G8R8_UNORM:
+        return visit(A8B8G8R8_UNORMTraits{});
+    case RenderTargetFormat::A8B8G8R8_SRGB:
+        return visit(A8B8G8R8_SRGBTraits{});
+    case RenderTargetFormat::X8R8G8B8_UNORM:
+        return visit(X8R8G8B8_UNORMTraits{});
+    case RenderTargetFormat::X8R8G8B8_SRGB:
+        return visit(X8R8G8B8_SRGBTraits{});
+    case RenderTargetFormat::X8B8G8R8_UNORM:
+        return visit(X8B8G8R8_UNORMTraits{});
+    case RenderTargetFormat::X8B8G8R8_SRGB:
+        return visit(X8B8G8R8_SRGBTraits{});
+    default:
+        return;
+    }
+}
+
+} // namespace
+
 struct ConverterFactory::ConverterFactoryImpl {
     std::unordered_map<RenderTargetFormat, std::unique_ptr<Converter>> converters_cache;
 };
@@ -938,6 +1169,17 @@ Converter* ConverterFactory::GetFormatConverter(RenderTargetFormat format) {
     return it->second.get();
 }
 
+DirectConverter ConverterFactory::GetDirectConverter(RenderTargetFormat src_format,
+                                                     RenderTargetFormat dst_format) {
+    DirectConverter result = nullptr;
+    VisitDirectFormat(src_format, [&]<class SrcTraits>(SrcTraits) {
+        VisitDirectFormat(dst_format, [&]<class DstTraits>(DstTraits) {
+            result = &DirectConverterImpl<SrcTraits, DstTraits>::Convert;
+        });
+    });
+    return result;
+}
+
 class NullConverter : public Converter {
 public:
     void ConvertTo([[maybe_unused]] std::span<const u8> input, std::span<f32> output) override {
@@ -19,6 +19,9 @@ public:
     virtual ~Converter() = default;
 };
 
+/// Converts packed pixels straight from one format to another, without the f32 intermediate
+using DirectConverter = void (*)(std::span<const u8> input, std::span<u8> output);
+
 class ConverterFactory {
 public:
     ConverterFactory();
@@ -26,6 +29,10 @@ public:
 
     Converter* GetFormatConverter(RenderTargetFormat format);
 
+    /// Returns a specialized converter between two formats, or nullptr when there is none
+    static DirectConverter GetDirectConverter(RenderTargetFormat src_format,
+                                              RenderTargetFormat dst_format);
+
 private:
     Converter* BuildConverter(RenderTargetFormat format);
 
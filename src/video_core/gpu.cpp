@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2018 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <chrono>
@@ -17,21 +18,26 @@
 #include "core/frontend/graphics_context.h"
 #include "core/hle/service/nvdrv/nvdata.h"
 #include "core/perf_stats.h"
+#include "video_core/buffer_cache/uniform_upload_stats.h"
 #include "video_core/cdma_pusher.h"
 #include "video_core/control/channel_state.h"
 #include "video_core/control/scheduler.h"
 #include "video_core/dma_pusher.h"
+#include "video_core/engines/draw_manager.h"
 #include "video_core/engines/fermi_2d.h"
 #include "video_core/engines/kepler_compute.h"
 #include "video_core/engines/kepler_memory.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/engines/maxwell_dma.h"
 #include "video_core/gpu.h"
+#include "video_core/gpu_capture.h"
 #include "video_core/gpu_thread.h"
 #include "video_core/host1x/host1x.h"
 #include "video_core/host1x/syncpoint_manager.h"
+#include "video_core/macro/macro_profiler.h"
 #include "video_core/memory_manager.h"
 #include "video_core/renderer_base.h"
+#include "video_core/segment_write_tracker.h"
 #include "video_core/shader_notify.h"
 
 namespace Tegra {
@@ -40,7 +46,12 @@ struct GPU::Impl {
     explicit Impl(GPU& gpu_, Core::System& system_, bool is_async_, bool use_nvdec_)
         : gpu{gpu_}, system{system_}, host1x{system.Host1x()}, use_nvdec{use_nvdec_},
           shader_notify{std::make_unique<VideoCore::ShaderNotify>()}, is_async{is_async_},
-          gpu_thread{system_, is_async_}, scheduler{std::make_unique<Control::Scheduler>(gpu)} {}
+          gpu_thread{system_, is_async_}, scheduler{std::make_unique<Control::Scheduler>(gpu)} {
+        if (const u16 capture_frames = Settings::values.gpu_capture_frames.GetValue();
+            capture_frames != 0) {
+            gpu_capture = std::make_unique<Tegra::GPUCapture>(capture_frames);
+        }
+    }
 
     ~Impl() = default;
 
@@ -75,6 +86,7 @@ struct GPU::Impl {
 
     void InitAddressSpace(Tegra::MemoryManager& memory_manager) {
         memory_manager.BindRasterizer(rasterizer);
+        memory_manager.BindSegmentWriteTracker(&segment_write_tracker);
     }
 
     void ReleaseChannel(Control::ChannelState& to_release) {
@@ -97,7 +109,10 @@ struct GPU::Impl {
     /// Synchronizes CPU writes with Host GPU memory.
     void InvalidateGPUCache() {
         std::function<void(PAddr, size_t)> callback_writes(
-            [this](PAddr address, size_t size) { rasterizer->OnCacheInvalidation(address, size); });
+            [this](PAddr address, size_t size) {
+                segment_write_tracker.OnWrite(address, size);
+                rasterizer->OnCacheInvalidation(address, size);
+            });
         system.GatherGPUDirtyMemory(callback_writes);
     }
 
@@ -176,6 +191,26 @@ struct GPU::Impl {
         return *current_channel->dma_pusher;
     }
 
+    /// Returns a reference to the macro profiler.
+    [[nodiscard]] Tegra::MacroProfiler& MacroProfiler() {
+        return macro_profiler;
+    }
+
+    /// Returns a reference to the statistics of the draw coalescing stage.
+    [[nodiscard]] Tegra::Engines::DrawCoalescingStats& DrawCoalescingStats() {
+        return draw_coalescing_stats;
+    }
+
+    /// Returns a reference to the statistics of the DMA copies.
+    [[nodiscard]] Tegra::Engines::DmaCopyStats& DmaCopyStats() {
+        return dma_copy_stats;
+    }
+
+    /// Returns a reference to the statistics of the uniform buffer uploads.
+    [[nodiscard]] VideoCommon::UniformUploadStats& UniformUploadStats() {
+        return uniform_upload_stats;
+    }
+
     /// Returns a reference to the underlying renderer.
     [[nodiscard]] VideoCore::RendererBase& Renderer() {
         return *renderer;
@@ -196,6 +231,11 @@ struct GPU::Impl {
         return *shader_notify;
     }
 
+    /// Returns the statistics of the GPU thread command queue since the last call.
+    [[nodiscard]] VideoCommon::GPUThread::QueueStats GetAndResetQueueStats() {
+        return gpu_thread.GetAndResetQueueStats();
+    }
+
     [[nodiscard]] u64 GetTicks() const {
         u64 gpu_tick = system.CoreTiming().GetGPUTicks();
 
@@ -216,6 +256,9 @@ struct GPU::Impl {
 
     void RendererFrameEndNotify() {
         system.GetPerfStats().EndGameFrame();
+        draw_coalescing_stats.NotifyFrameEnd();
+        dma_copy_stats.NotifyFrameEnd();
+        uniform_upload_stats.NotifyFrameEnd();
     }
 
     /// Performs any additional setup necessary in order to begin GPU emulation.
@@ -230,6 +273,11 @@ struct GPU::Impl {
         std::unique_lock lk{sync_mutex};
         shutting_down.store(true, std::memory_order::relaxed);
         sync_cv.notify_all();
+        lk.unlock();
+
+        if (Settings::values.profile_macros || Settings::values.record_macros) {
+            macro_profiler.Dump();
+        }
     }
 
     /// Obtain the CPU Context
@@ -247,9 +295,69 @@ struct GPU::Impl {
 
     /// Push GPU command entries to be processed
     void PushGPUEntries(s32 channel, Tegra::CommandList&& entries) {
+        if (gpu_capture) [[unlikely]] {
+            // Record the submissions in the order the GPU thread receives them
+            std::scoped_lock lock{capture_mutex};
+            if (gpu_capture->IsRecording()) {
+                gpu_capture->RecordSubmission(channel, entries,
+                                              *channels.at(channel)->memory_manager);
+            }
+            gpu_thread.SubmitList(channel, std::move(entries));
+            return;
+        }
         gpu_thread.SubmitList(channel, std::move(entries));
     }
 
+    /// Starts the capture on the first presentation and closes one of its frames on the others.
+    void UpdateCapture() {
+        std::scoped_lock lock{capture_mutex};
+        if (gpu_capture->IsPending()) {
+            // Channels are saved on the GPU thread, after the submissions that precede the capture
+            std::vector<Tegra::CapturedChannel> captured_channels;
+            const u64 fence = RequestSyncOperation(
+                [this, &captured_channels] { captured_channels = SaveChannels(); });
+            gpu_thread.TickGPU();
+            WaitForSyncOperation(fence);
+            gpu_capture->Begin(std::move(captured_channels));
+            is_capturing_memory.store(true, std::memory_order_relaxed);
+        } else if (gpu_capture->IsRecording() && gpu_capture->EndFrame()) {
+            is_capturing_memory.store(false, std::memory_order_relaxed);
+            std::scoped_lock memory_lock{capture_memory_mutex};
+            gpu_capture->Dump();
+        }
+    }
+
+    [[nodiscard]] bool IsCapturingMemory() const {
+        return is_capturing_memory.load(std::memory_order_relaxed);
+    }
+
+    /// Called on the GPU thread, which may run while the submission lock is held
+    void CaptureMemory(GPUVAddr address, u64 size) {
+        std::scoped_lock lock{capture_memory_mutex};
+        if (gpu_capture->IsRecording()) {
+            gpu_capture->RecordMemory(bound_channel, *current_channel->memory_manager, address,
+                                      size);
+        }
+    }
+
+    std::vector<Tegra::CapturedChannel> SaveChannels() const {
+        std::vector<Tegra::CapturedChannel> captured_channels;
+        for (const auto& [channel_id, channel] : channels) {
+            if (!channel->initialized) {
+                continue;
+            }
+            Tegra::CapturedChannel& captured = captured_channels.emplace_back();
+            captured.channel_id = channel_id;
+            captured.program_id = channel->program_id;
+            for (u32 subchannel = 0; subchannel < captured.bound_engines.size(); ++subchannel) {
+                captured.bound_engines[subchannel] = channel->dma_pusher->BoundEngine(subchannel);
+            }
+            channel->maxwell_3d->SaveCaptureState(captured);
+        }
+        std::ranges::sort(captured_channels, {}, &Tegra::CapturedChannel::channel_id);
+        return captured_channels;
+    }
+
     /// Push GPU command buffer entries to be processed
     void PushCommandBuffer(u32 id, Tegra::ChCommandHeaderList& entries) {
         if (!use_nvdec) {
@@ -296,20 +404,26 @@ struct GPU::Impl {
 
     /// Notify rasterizer that any caches of the specified region should be invalidated
     void InvalidateRegion(DAddr addr, u64 size) {
+        segment_write_tracker.OnWrite(addr, size);
         gpu_thread.InvalidateRegion(addr, size);
     }
 
     bool OnCPUWrite(DAddr addr, u64 size) {
+        segment_write_tracker.OnWrite(addr, size);
         return rasterizer->OnCPUWrite(addr, size);
     }
 
     /// Notify rasterizer that any caches of the specified region should be flushed and invalidated
     void FlushAndInvalidateRegion(DAddr addr, u64 size) {
+        segment_write_tracker.OnWrite(addr, size);
         gpu_thread.FlushAndInvalidateRegion(addr, size);
     }
 
     void RequestComposite(std::vector<Tegra::FramebufferConfig>&& layers,
                           std::vector<Service::Nvidia::NvFence>&& fences) {
+        if (gpu_capture) [[unlikely]] {
+            UpdateCapture();
+        }
         size_t num_fences{fences.size()};
         size_t current_request_counter{};
         {
@@ -361,6 +475,8 @@ struct GPU::Impl {
     GPU& gpu;
     Core::System& system;
     Host1x::Host1x& host1x;
+    /// Writes to the command list segments cached by the DMA pushers of every channel
+    Tegra::SegmentWriteTracker segment_write_tracker{host1x.MemoryManager()};
 
     std::map<u32, std::unique_ptr<Tegra::CDmaPusher>> cdma_pushers;
     std::unique_ptr<VideoCore::RendererBase> renderer;
@@ -370,6 +486,20 @@ struct GPU::Impl {
     s32 new_channel_id{1};
     /// Shader build notifier
     std::unique_ptr<VideoCore::ShaderNotify> shader_notify;
+    /// Macro statistics and recordings, collected when enabled in the settings
+    Tegra::MacroProfiler macro_profiler{Settings::values.record_macros.GetValue()};
+    /// Draws merged by the draw managers of every channel
+    Tegra::Engines::DrawCoalescingStats draw_coalescing_stats;
+    /// Copies of the DMA engines of every channel, per path
+    Tegra::Engines::DmaCopyStats dma_copy_stats;
+    /// Uniform buffer uploads of the buffer cache
+    VideoCommon::UniformUploadStats uniform_upload_stats;
+    /// Command stream capture, created when frames to capture are set in the settings
+    std::unique_ptr<Tegra::GPUCapture> gpu_capture;
+    std::mutex capture_mutex;
+    /// Guards the memory of the capture, recorded by the GPU thread
+    std::mutex capture_memory_mutex;
+    std::atomic_bool is_capturing_memory{};
     /// When true, we are about to shut down emulation session, so terminate outstanding tasks
     std::atomic_bool shutting_down{};
 
@@ -495,6 +625,26 @@ const Tegra::DmaPusher& GPU::DmaPusher() const {
     return impl->DmaPusher();
 }
 
+Tegra::MacroProfiler& GPU::MacroProfiler() {
+    return impl->MacroProfiler();
+}
+
+Tegra::Engines::DrawCoalescingStats& GPU::DrawCoalescingStats() {
+    return impl->DrawCoalescingStats();
+}
+
+Tegra::Engines::DmaCopyStats& GPU::DmaCopyStats() {
+    return impl->DmaCopyStats();
+}
+
+VideoCommon::UniformUploadStats& GPU::UniformUploadStats() {
+    return impl->UniformUploadStats();
+}
+
+Tegra::SegmentWriteTracker& GPU::SegmentWriteTracker() {
+    return impl->segment_write_tracker;
+}
+
 VideoCore::RendererBase& GPU::Renderer() {
     return impl->Renderer();
 }
@@ -511,6 +661,10 @@ const VideoCore::ShaderNotify& GPU::ShaderNotify() const {
     return impl->ShaderNotify();
 }
 
+VideoCommon::GPUThread::QueueStats GPU::GetAndResetQueueStats() {
+    return impl->GetAndResetQueueStats();
+}
+
 void GPU::RequestComposite(std::vector<Tegra::FramebufferConfig>&& layers,
                            std::vector<Service::Nvidia::NvFence>&& fences) {
     impl->RequestComposite(std::move(layers), std::move(fences));
@@ -520,6 +674,14 @@ std::vector<u8> GPU::GetAppletCaptureBuffer() {
     return impl->GetAppletCaptureBuffer();
 }
 
+bool GPU::IsCapturingMemory() const {
+    return impl->IsCapturingMemory();
+}
+
+void GPU::CaptureMemory(GPUVAddr address, u64 size) {
+    impl->CaptureMemory(address, size);
+}
+
 u64 GPU::GetTicks() const {
     return impl->GetTicks();
 }
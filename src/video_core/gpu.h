@@ -21,8 +21,18 @@ class RendererBase;
 class ShaderNotify;
 } // namespace VideoCore
 
+namespace VideoCommon {
+class UniformUploadStats;
+} // namespace VideoCommon
+
+namespace VideoCommon::GPUThread {
+struct QueueStats;
+} // namespace VideoCommon::GPUThread
+
 namespace Tegra {
 class DmaPusher;
+class MacroProfiler;
+class SegmentWriteTracker;
 struct CommandList;
 
 // TODO: Implement the commented ones
@@ -120,6 +130,8 @@ enum class DepthFormat : u32 {
 namespace Engines {
 class Maxwell3D;
 class KeplerCompute;
+class DrawCoalescingStats;
+class DmaCopyStats;
 } // namespace Engines
 
 namespace Control {
@@ -192,6 +204,21 @@ public:
     /// Returns a const reference to the GPU DMA pusher.
     [[nodiscard]] const Tegra::DmaPusher& DmaPusher() const;
 
+    /// Returns a reference to the profiler shared by the macro engines.
+    [[nodiscard]] Tegra::MacroProfiler& MacroProfiler();
+
+    /// Returns a reference to the statistics shared by the draw managers.
+    [[nodiscard]] Tegra::Engines::DrawCoalescingStats& DrawCoalescingStats();
+
+    /// Returns a reference to the statistics shared by the DMA engines.
+    [[nodiscard]] Tegra::Engines::DmaCopyStats& DmaCopyStats();
+
+    /// Returns a reference to the statistics of the uniform buffer uploads.
+    [[nodiscard]] VideoCommon::UniformUploadStats& UniformUploadStats();
+
+    /// Returns a reference to the tracker of the writes to the cached command list segments.
+    [[nodiscard]] Tegra::SegmentWriteTracker& SegmentWriteTracker();
+
     /// Returns a reference to the underlying renderer.
     [[nodiscard]] VideoCore::RendererBase& Renderer();
 
@@ -204,6 +231,15 @@ public:
     /// Returns a const reference to the shader notifier.
     [[nodiscard]] const VideoCore::ShaderNotify& ShaderNotify() const;
 
+    /// Returns the statistics of the GPU thread command queue since the last call.
+    [[nodiscard]] VideoCommon::GPUThread::QueueStats GetAndResetQueueStats();
+
+    /// Returns true while a GPU capture records the memory used by the commands.
+    [[nodiscard]] bool IsCapturingMemory() const;
+
+    /// Saves a range used by the commands of the bound channel in the GPU capture.
+    void CaptureMemory(GPUVAddr address, u64 size);
+
     [[nodiscard]] u64 GetTicks() const;
 
     [[nodiscard]] bool IsAsync() const;
@@ -0,0 +1,290 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <span>
+
+#include <fmt/format.h>
+
+#include "common/alignment.h"
+#include "common/binary_buffer.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "video_core/dma_pusher.h"
+#include "video_core/gpu_capture.h"
+#include "video_core/memory_manager.h"
+
+namespace Tegra {
+namespace {
+constexpr u32 CAPTURE_MAGIC = 0x50414347; // "GCAP"
+constexpr u32 CAPTURE_VERSION = 2;
+
+/// Granularity of the captured memory
+constexpr u64 CAPTURE_PAGE_SIZE = 4096;
+/// Largest range captured for a single use, bounds ranges taken from guest limits
+constexpr u64 MAX_CAPTURE_RANGE_SIZE = 16ULL << 20;
+
+// Smallest serialized sizes of the captured structures, their counts are checked against them
+constexpr size_t MIN_CHANNEL_SIZE =
+    sizeof(s32) + sizeof(u64) + sizeof(CapturedChannel::bound_engines) + 5 * sizeof(u32);
+constexpr size_t MIN_MACRO_SIZE = 2 * sizeof(u32);
+constexpr size_t MIN_MEMORY_SIZE = sizeof(s32) + sizeof(GPUVAddr) + sizeof(u32);
+constexpr size_t MIN_FRAME_SIZE = sizeof(u32);
+constexpr size_t MIN_SUBMISSION_SIZE = sizeof(s32) + sizeof(u32);
+constexpr size_t MIN_SEGMENT_SIZE = sizeof(GPUVAddr) + sizeof(u32);
+
+void WriteChannel(Common::BinaryWriter& writer, const CapturedChannel& channel) {
+    writer.Push(channel.channel_id);
+    writer.Push(channel.program_id);
+    writer.Push(channel.bound_engines);
+    writer.PushArray<u32>(channel.registers);
+    writer.PushArray<u32>(channel.shadow_registers);
+    writer.PushArray<u32>(channel.const_buffers);
+    writer.PushArray<u32>(channel.macro_positions);
+    writer.Push(static_cast<u32>(channel.macro_code.size()));
+    for (const auto& [method, code] : channel.macro_code) {
+        writer.Push(method);
+        writer.PushArray<u32>(code);
+    }
+}
+
+bool ReadChannel(Common::BinaryReader& reader, CapturedChannel& channel) {
+    u32 num_macros{};
+    if (!reader.Pop(channel.channel_id) || !reader.Pop(channel.program_id) ||
+        !reader.Pop(channel.bound_engines) || !reader.PopArray(channel.registers) ||
+        !reader.PopArray(channel.shadow_registers) || !reader.PopArray(channel.const_buffers) ||
+        !reader.PopArray(channel.macro_positions) || !reader.PopCount(num_macros, MIN_MACRO_SIZE)) {
+        return false;
+    }
+    channel.macro_code.resize(num_macros);
+    for (auto& [method, code] : channel.macro_code) {
+        if (!reader.Pop(method) || !reader.PopArray(code)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void WriteMemory(Common::BinaryWriter& writer, const CapturedMemory& memory) {
+    writer.Push(memory.channel_id);
+    writer.Push(memory.address);
+    writer.PushArray<u8>(memory.data);
+}
+
+bool ReadMemory(Common::BinaryReader& reader, CapturedMemory& memory) {
+    return reader.Pop(memory.channel_id) && reader.Pop(memory.address) &&
+           reader.PopArray(memory.data);
+}
+
+void WriteFrame(Common::BinaryWriter& writer, const CapturedFrame& frame) {
+    writer.Push(static_cast<u32>(frame.submissions.size()));
+    for (const CapturedSubmission& submission : frame.submissions) {
+        writer.Push(submission.channel_id);
+        writer.Push(static_cast<u32>(submission.segments.size()));
+        for (const CapturedSegment& segment : submission.segments) {
+            writer.Push(segment.address);
+            writer.PushArray<u32>(segment.words);
+        }
+    }
+}
+
+bool ReadFrame(Common::BinaryReader& reader, CapturedFrame& frame) {
+    u32 num_submissions{};
+    if (!reader.PopCount(num_submissions, MIN_SUBMISSION_SIZE)) {
+        return false;
+    }
+    frame.submissions.resize(num_submissions);
+    for (CapturedSubmission& submission : frame.submissions) {
+        u32 num_segments{};
+        if (!reader.Pop(submission.channel_id) ||
+            !reader.PopCount(num_segments, MIN_SEGMENT_SIZE)) {
+            return false;
+        }
+        submission.segments.resize(num_segments);
+        for (CapturedSegment& segment : submission.segments) {
+            if (!reader.Pop(segment.address) || !reader.PopArray(segment.words)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Reads a counted array of structures with the given element reader
+template <typename T, typename Func>
+bool ReadArray(Common::BinaryReader& reader, std::vector<T>& values, size_t min_element_size,
+               Func&& read_element) {
+    u32 count{};
+    if (!reader.PopCount(count, min_element_size)) {
+        return false;
+    }
+    values.resize(count);
+    return std::ranges::all_of(values, [&](T& value) { return read_element(reader, value); });
+}
+} // Anonymous namespace
+
+GPUCapture::GPUCapture(u32 num_frames_) : num_frames{num_frames_} {}
+
+GPUCapture::~GPUCapture() = default;
+
+void GPUCapture::Begin(std::vector<CapturedChannel>&& channels) {
+    data.channels = std::move(channels);
+    is_started = true;
+    LOG_INFO(HW_GPU, "Capturing {} frames from {} channels", num_frames, data.channels.size());
+}
+
+void GPUCapture::RecordSubmission(s32 channel_id, const CommandList& entries,
+                                  const MemoryManager& memory_manager) {
+    CapturedSubmission& submission = current_frame.submissions.emplace_back();
+    submission.channel_id = channel_id;
+    if (!entries.prefetch_command_list.empty()) {
+        CapturedSegment& segment = submission.segments.emplace_back();
+        segment.words.resize(entries.prefetch_command_list.size());
+        std::memcpy(segment.words.data(), entries.prefetch_command_list.data(),
+                    segment.words.size() * sizeof(u32));
+        return;
+    }
+    for (const CommandListHeader header : entries.command_lists) {
+        CapturedSegment& segment = submission.segments.emplace_back();
+        segment.address = header.addr;
+        segment.words.resize(header.size);
+        memory_manager.ReadBlockUnsafe(segment.address, segment.words.data(),
+                                       segment.words.size() * sizeof(u32));
+    }
+}
+
+void GPUCapture::RecordMemory(s32 channel_id, const MemoryManager& memory_manager,
+                              GPUVAddr address, u64 size) {
+    const GPUVAddr end = address + std::min(size, MAX_CAPTURE_RANGE_SIZE);
+    for (GPUVAddr page = Common::AlignDown(address, CAPTURE_PAGE_SIZE); page < end;
+         page += CAPTURE_PAGE_SIZE) {
+        // Pages keep the contents they had when the capture first used them
+        const u64 key = (static_cast<u64>(channel_id) << 48) | page;
+        if (!captured_pages.insert(key).second || !memory_manager.GpuToCpuAddress(page)) {
+            continue;
+        }
+        const bool extends_last = !data.memory.empty() &&
+                                  data.memory.back().channel_id == channel_id &&
+                                  data.memory.back().address + data.memory.back().data.size() ==
+                                      page;
+        if (!extends_last) {
+            data.memory.push_back({.channel_id = channel_id, .address = page, .data{}});
+        }
+        std::vector<u8>& bytes = data.memory.back().data;
+        bytes.resize(bytes.size() + CAPTURE_PAGE_SIZE);
+        memory_manager.ReadBlockUnsafe(page, bytes.data() + bytes.size() - CAPTURE_PAGE_SIZE,
+                                       CAPTURE_PAGE_SIZE);
+    }
+}
+
+bool GPUCapture::EndFrame() {
+    data.frames.push_back(std::move(current_frame));
+    current_frame = {};
+    return data.frames.size() == num_frames;
+}
+
+void GPUCapture::Dump() const {
+    const auto base_dir{Common::FS::GetCitronPath(Common::FS::CitronPath::DumpDir)};
+    const auto capture_dir{base_dir / "gpu_captures"};
+    if (!Common::FS::CreateDir(base_dir) || !Common::FS::CreateDir(capture_dir)) {
+        LOG_ERROR(Common_Filesystem, "Failed to create GPU capture dump directories");
+        return;
+    }
+    const u64 program_id = data.channels.empty() ? 0 : data.channels.front().program_id;
+    const auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch());
+    const auto path{capture_dir / fmt::format("{:016X}_{}.gcap", program_id, seconds.count())};
+    if (!Write(path, data)) {
+        LOG_ERROR(Common_Filesystem, "Unable to write GPU capture {}",
+                  Common::FS::PathToUTF8String(path));
+        return;
+    }
+    LOG_INFO(HW_GPU, "Wrote GPU capture of {} frames to {}", data.frames.size(),
+             Common::FS::PathToUTF8String(path));
+}
+
+bool GPUCapture::Write(const std::filesystem::path& path, const GPUCaptureData& capture) {
+    Common::BinaryWriter writer;
+    writer.Push(static_cast<u32>(capture.channels.size()));
+    for (const CapturedChannel& channel : capture.channels) {
+        WriteChannel(writer, channel);
+    }
+    writer.Push(static_cast<u32>(capture.memory.size()));
+    for (const CapturedMemory& memory : capture.memory) {
+        WriteMemory(writer, memory);
+    }
+    writer.Push(static_cast<u32>(capture.frames.size()));
+    for (const CapturedFrame& frame : capture.frames) {
+        WriteFrame(writer, frame);
+    }
+    const std::vector<u8> compressed = Common::Compression::CompressDataZSTDDefault(
+        writer.Buffer().data(), writer.Buffer().size());
+
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&CAPTURE_MAGIC), sizeof(CAPTURE_MAGIC));
+    file.write(reinterpret_cast<const char*>(&CAPTURE_VERSION), sizeof(CAPTURE_VERSION));
+    file.write(reinterpret_cast<const char*>(compressed.data()),
+               static_cast<std::streamsize>(compressed.size()));
+    return static_cast<bool>(file);
+}
+
+std::optional<GPUCaptureData> GPUCapture::Read(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    u32 magic{};
+    u32 version{};
+    if (!file || !file.read(reinterpret_cast<char*>(&magic), sizeof(magic)) ||
+        !file.read(reinterpret_cast<char*>(&version), sizeof(version)) ||
+        magic != CAPTURE_MAGIC || version != CAPTURE_VERSION) {
+        return std::nullopt;
+    }
+    const std::vector<u8> compressed{std::istreambuf_iterator<char>(file),
+                                     std::istreambuf_iterator<char>()};
+    return Parse(Common::Compression::DecompressDataZSTD(compressed));
+}
+
+std::optional<GPUCaptureData> GPUCapture::Parse(std::span<const u8> data) {
+    Common::BinaryReader reader{data};
+    GPUCaptureData capture;
+    if (!ReadArray(reader, capture.channels, MIN_CHANNEL_SIZE, ReadChannel) ||
+        !ReadArray(reader, capture.memory, MIN_MEMORY_SIZE, ReadMemory) ||
+        !ReadArray(reader, capture.frames, MIN_FRAME_SIZE, ReadFrame)) {
+        return std::nullopt;
+    }
+    return capture;
+}
+
+void GPUCapture::MapMemory(const GPUCaptureData& capture, s32 channel_id,
+                           MaxwellDeviceMemoryManager& device_memory,
+                           MemoryManager& memory_manager, PAddr& next_physical_address) {
+    for (const CapturedMemory& memory : capture.memory) {
+        if (memory.channel_id != channel_id || memory.data.empty()) {
+            continue;
+        }
+        const size_t size = Common::AlignUp(memory.data.size(), CAPTURE_PAGE_SIZE);
+        const DAddr device_address = device_memory.Allocate(size);
+        device_memory.MapPhysical(device_address, next_physical_address, size);
+        next_physical_address += size;
+        memory_manager.Map(memory.address, device_address, size, PTEKind::PITCH, false);
+        memory_manager.WriteBlockUnsafe(memory.address, memory.data.data(), memory.data.size());
+    }
+}
+
+void GPUCapture::RestoreMemory(const GPUCaptureData& capture, s32 channel_id,
+                               MemoryManager& memory_manager) {
+    for (const CapturedMemory& memory : capture.memory) {
+        if (memory.channel_id == channel_id) {
+            memory_manager.WriteBlock(memory.address, memory.data.data(), memory.data.size());
+        }
+    }
+}
+
+} // namespace Tegra
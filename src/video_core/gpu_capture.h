@@ -0,0 +1,145 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "common/common_types.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+
+namespace Tegra {
+
+struct CommandList;
+class MemoryManager;
+
+/// State of a channel when the capture started, restored before replaying its submissions.
+struct CapturedChannel {
+    s32 channel_id{};
+    u64 program_id{};
+    /// Engine class bound to each subchannel, zero when unbound
+    std::array<u32, 8> bound_engines{};
+    std::vector<u32> registers;
+    std::vector<u32> shadow_registers;
+    /// Constant buffers bound to each shader stage, which are not kept in the registers
+    std::vector<u32> const_buffers;
+    std::vector<u32> macro_positions;
+    /// Uploaded macro code, keyed by its start address in the macro memory
+    std::vector<std::pair<u32, std::vector<u32>>> macro_code;
+};
+
+/// Guest memory used by the commands of a channel, as it was when the capture first used it.
+struct CapturedMemory {
+    s32 channel_id{};
+    GPUVAddr address{};
+    std::vector<u8> data;
+};
+
+/// Words of a command list, read from the given GPU address or zero for prefetched lists.
+struct CapturedSegment {
+    GPUVAddr address{};
+    std::vector<u32> words;
+};
+
+/// GPFIFO entries pushed to a channel at once.
+struct CapturedSubmission {
+    s32 channel_id{};
+    std::vector<CapturedSegment> segments;
+};
+
+/// Submissions between two presentations.
+struct CapturedFrame {
+    std::vector<CapturedSubmission> submissions;
+};
+
+struct GPUCaptureData {
+    std::vector<CapturedChannel> channels;
+    std::vector<CapturedMemory> memory;
+    std::vector<CapturedFrame> frames;
+};
+
+/**
+ * Records the GPFIFO submissions of a number of frames, along with the Maxwell3D register and
+ * macro state they start from, so they can be replayed deterministically without the guest.
+ *
+ * The pages used for semaphores, constant buffers, indices and vertices are saved the first time
+ * the commands use them, so replays find the values semaphores are acquired on and draw from the
+ * captured data. Other memory, like shaders, descriptor tables and textures, is not captured, so
+ * replays only run on the null renderer.
+ *
+ * Captures are stored as a u32 magic and version followed by the Zstandard compressed channels,
+ * memory and frames. Synchronization with the guest, like syncpoint increments, is part of the
+ * captured prefetched command lists.
+ */
+class GPUCapture {
+public:
+    explicit GPUCapture(u32 num_frames_);
+    ~GPUCapture();
+
+    /// Returns true until the capture begins.
+    [[nodiscard]] bool IsPending() const {
+        return !is_started;
+    }
+
+    /// Returns true while submissions are being recorded.
+    [[nodiscard]] bool IsRecording() const {
+        return is_started && data.frames.size() < num_frames;
+    }
+
+    /// Starts recording from the given state of the channels.
+    void Begin(std::vector<CapturedChannel>&& channels);
+
+    /// Copies the words of the command lists, which are written before their submission.
+    void RecordSubmission(s32 channel_id, const CommandList& entries,
+                          const MemoryManager& memory_manager);
+
+    /// Saves the pages of a range used by the commands of a channel, unless they were saved before.
+    void RecordMemory(s32 channel_id, const MemoryManager& memory_manager, GPUVAddr address,
+                      u64 size);
+
+    /// Closes the frame being recorded, returns true when it was the last one.
+    bool EndFrame();
+
+    [[nodiscard]] const GPUCaptureData& Data() const {
+        return data;
+    }
+
+    /// Writes the capture to the "gpu_captures" dump directory.
+    void Dump() const;
+
+    /// Writes a capture in the format read by Read.
+    static bool Write(const std::filesystem::path& path, const GPUCaptureData& capture);
+
+    /// Reads a capture written by Dump.
+    [[nodiscard]] static std::optional<GPUCaptureData> Read(const std::filesystem::path& path);
+
+    /// Parses the decompressed contents of a capture.
+    [[nodiscard]] static std::optional<GPUCaptureData> Parse(std::span<const u8> data);
+
+    /// Maps the memory captured for a channel into its address space and fills it with the
+    /// captured contents. Replays run without a process owning that memory, so its pages are
+    /// backed by the physical memory handed out from next_physical_address onward.
+    static void MapMemory(const GPUCaptureData& capture, s32 channel_id,
+                          MaxwellDeviceMemoryManager& device_memory,
+                          MemoryManager& memory_manager, PAddr& next_physical_address);
+
+    /// Writes the captured contents back into the memory mapped by MapMemory.
+    static void RestoreMemory(const GPUCaptureData& capture, s32 channel_id,
+                              MemoryManager& memory_manager);
+
+private:
+    u32 num_frames;
+    bool is_started{};
+    CapturedFrame current_frame;
+    GPUCaptureData data;
+    /// Pages saved in the memory of the capture, keyed by channel and address
+    std::unordered_set<u64> captured_pages;
+};
+
+} // namespace Tegra
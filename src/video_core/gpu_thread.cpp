@@ -1,6 +1,14 @@
 // SPDX-FileCopyrightText: Copyright 2019 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(ARCHITECTURE_x86_64)
+#include <xmmintrin.h>
+#endif
+
 #include "common/assert.h"
 #include "common/microprofile.h"
 #include "common/scope_exit.h"
@@ -15,6 +23,110 @@
 #include "video_core/renderer_base.h"
 
 namespace VideoCommon::GPUThread {
+namespace {
+/// Number of times a side of the command queue polls before going to sleep
+constexpr u32 SPIN_ITERATIONS = 2048;
+
+void ThreadPause() {
+#if defined(ARCHITECTURE_x86_64)
+    _mm_pause();
+#elif defined(ARCHITECTURE_arm64) && defined(_MSC_VER)
+    __yield();
+#elif defined(ARCHITECTURE_arm64)
+    asm volatile("yield");
+#endif
+}
+
+/// Returns true when the command at index is pending and submits to the given channel
+bool IsSubmitTo(CommandQueue& queue, size_t index, size_t end, s32 channel) {
+    if (index == end) {
+        return false;
+    }
+    const auto* const submit_list = std::get_if<SubmitListCommand>(&queue[index].data);
+    return submit_list && submit_list->channel == channel;
+}
+
+void SignalFence(SynchState& state, u64 fence) {
+    state.signaled_fence.store(fence, std::memory_order_release);
+    state.signaled_fence.notify_all();
+}
+} // Anonymous namespace
+
+template <typename Func>
+void CommandQueue::Wait(Sleeper& sleeper, Func&& is_ready) {
+    for (u32 spin = 0; spin < SPIN_ITERATIONS; ++spin) {
+        if (is_ready()) {
+            return;
+        }
+        ThreadPause();
+    }
+    while (true) {
+        const u32 sequence = sleeper.sequence.load(std::memory_order_acquire);
+        // Announce the sleep before checking again, so either this check sees the other side's
+        // progress or the other side sees the flag and wakes us up
+        sleeper.is_sleeping.store(true);
+        if (is_ready()) {
+            sleeper.is_sleeping.store(false, std::memory_order_relaxed);
+            return;
+        }
+        sleeper.sequence.wait(sequence, std::memory_order_acquire);
+    }
+}
+
+bool CommandQueue::Wake(Sleeper& sleeper) {
+    if (!sleeper.is_sleeping.exchange(false)) {
+        return false;
+    }
+    sleeper.sequence.fetch_add(1, std::memory_order_release);
+    sleeper.sequence.notify_one();
+    return true;
+}
+
+void CommandQueue::Push(CommandData&& data, u64 fence, bool block) {
+    const size_t write = write_index.load(std::memory_order_relaxed);
+    Wait(producer, [this, write] { return write - read_index.load() < CAPACITY; });
+
+    commands[write % CAPACITY] = CommandDataContainer(std::move(data), fence, block);
+    write_index.store(write + 1);
+    if (Wake(consumer)) {
+        wakeups.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t CommandQueue::WaitForCommands(size_t read, std::stop_token stop_token) {
+    size_t end = read;
+    Wait(consumer, [this, read, &end, &stop_token] {
+        end = write_index.load();
+        return end != read || stop_token.stop_requested();
+    });
+    if (stop_token.stop_requested()) {
+        return read;
+    }
+    const size_t depth = end - read;
+    if (depth > peak_depth.load(std::memory_order_relaxed)) {
+        peak_depth.store(depth, std::memory_order_relaxed);
+    }
+    batches.fetch_add(1, std::memory_order_relaxed);
+    return end;
+}
+
+void CommandQueue::Release(size_t read) {
+    read_index.store(read);
+    Wake(producer);
+}
+
+void CommandQueue::Interrupt() {
+    consumer.sequence.fetch_add(1, std::memory_order_release);
+    consumer.sequence.notify_one();
+}
+
+QueueStats CommandQueue::GetAndResetStats() {
+    return {
+        .peak_depth = peak_depth.exchange(0, std::memory_order_relaxed),
+        .batches = batches.exchange(0, std::memory_order_relaxed),
+        .wakeups = wakeups.exchange(0, std::memory_order_relaxed),
+    };
+}
 
 /// Runs the GPU thread
 static void RunThread(std::stop_token stop_token, Core::System& system,
@@ -33,31 +145,133 @@ static void RunThread(std::stop_token stop_token, Core::System& system,
     auto current_context = context.Acquire();
     VideoCore::RasterizerInterface* const rasterizer = renderer.ReadRasterizer();
 
-    CommandDataContainer next;
+    // In pipelined mode, commands come from the decoding thread instead
+    CommandQueue& queue = state.decoded_queue ? *state.decoded_queue : state.queue;
+    const std::stop_callback interrupt{stop_token, [&queue] { queue.Interrupt(); }};
+    size_t read_index = 0;
 
     while (!stop_token.stop_requested()) {
-        state.queue.PopWait(next, stop_token);
+        const size_t end = queue.WaitForCommands(read_index, stop_token);
         if (stop_token.stop_requested()) {
             break;
         }
-        if (auto* submit_list = std::get_if<SubmitListCommand>(&next.data)) {
-            scheduler.Push(submit_list->channel, std::move(submit_list->entries));
-        } else if (std::holds_alternative<GPUTickCommand>(next.data)) {
-            system.GPU().TickWork();
-        } else if (const auto* flush = std::get_if<FlushRegionCommand>(&next.data)) {
-            rasterizer->FlushRegion(flush->addr, flush->size);
-        } else if (const auto* invalidate = std::get_if<InvalidateRegionCommand>(&next.data)) {
-            rasterizer->OnCacheInvalidation(invalidate->addr, invalidate->size);
-        } else {
-            ASSERT(false);
+        for (; read_index != end; ++read_index) {
+            CommandDataContainer& next = queue[read_index];
+            if (auto* submit_list = std::get_if<SubmitListCommand>(&next.data)) {
+                const s32 channel = submit_list->channel;
+                scheduler.Queue(channel, std::move(submit_list->entries));
+                // Consecutive submissions to a channel are executed in a single dispatch
+                if (next.block || !IsSubmitTo(queue, read_index + 1, end, channel)) {
+                    scheduler.Dispatch(channel);
+                }
+            } else if (const auto* decoded = std::get_if<DecodedListCommand>(&next.data)) {
+                scheduler.Execute(decoded->channel, decoded->list);
+            } else if (const auto* sync = std::get_if<DecodeSyncCommand>(&next.data)) {
+                state.decode_synced.store(sync->id, std::memory_order_release);
+                state.decode_synced.notify_all();
+            } else if (std::holds_alternative<GPUTickCommand>(next.data)) {
+                system.GPU().TickWork();
+            } else if (const auto* flush = std::get_if<FlushRegionCommand>(&next.data)) {
+                rasterizer->FlushRegion(flush->addr, flush->size);
+            } else if (const auto* invalidate = std::get_if<InvalidateRegionCommand>(&next.data)) {
+                rasterizer->OnCacheInvalidation(invalidate->addr, invalidate->size);
+            } else {
+                ASSERT(false);
+            }
+            if (next.block) {
+                SignalFence(state, next.fence);
+            }
         }
-        state.signaled_fence.store(next.fence);
-        if (next.block) {
-            // We have to lock the write_lock to ensure that the condition_variable wait not get a
-            // race between the check and the lock itself.
-            std::scoped_lock lk{state.write_lock};
-            state.cv.notify_all();
+        // Only blocking commands wake up waiters, the rest of the batch is signaled at once
+        state.signaled_fence.store(queue[end - 1].fence, std::memory_order_release);
+        queue.Release(end);
+    }
+    // Let any caller still blocked on a fence return
+    SignalFence(state, std::numeric_limits<u64>::max());
+}
+
+/// Runs the decoding thread of the pipelined mode, which fetches and decodes command lists ahead of
+/// the GPU thread and forwards every other command to it in order. Decoding only waits for the GPU
+/// before segments whose entry asks for it and segments the rasterizer has pending writes to.
+static void RunDecodeThread(std::stop_token stop_token, Tegra::Control::Scheduler& scheduler,
+                            SynchState& state) {
+    using DecodeResult = Tegra::DmaPusher::DecodeResult;
+
+    std::string name = "GPUDecode";
+    MicroProfileOnThreadCreate(name.c_str());
+    SCOPE_EXIT {
+        MicroProfileOnThreadExit();
+    };
+
+    Common::SetCurrentThreadName(name.c_str());
+    Common::SetCurrentThreadPriority(Common::ThreadPriority::Critical);
+
+    CommandQueue& decoded_queue = *state.decoded_queue;
+    const std::stop_callback interrupt{stop_token, [&state] {
+        state.queue.Interrupt();
+        state.decode_synced.store(std::numeric_limits<u64>::max(), std::memory_order_release);
+        state.decode_synced.notify_all();
+    }};
+    size_t read_index = 0;
+    u64 sync_id = 0;
+
+    // Waits for the GPU thread to execute every command pushed so far, the fence must not signal
+    // the submission being decoded
+    const auto wait_for_gpu = [&](u64 fence) {
+        decoded_queue.Push(DecodeSyncCommand{++sync_id}, fence, false);
+        u64 synced = state.decode_synced.load(std::memory_order_acquire);
+        while (synced < sync_id) {
+            state.decode_synced.wait(synced, std::memory_order_acquire);
+            synced = state.decode_synced.load(std::memory_order_acquire);
+        }
+        return !stop_token.stop_requested();
+    };
+
+    while (!stop_token.stop_requested()) {
+        const size_t end = state.queue.WaitForCommands(read_index, stop_token);
+        if (stop_token.stop_requested()) {
+            break;
         }
+        while (read_index != end) {
+            CommandDataContainer& next = state.queue[read_index++];
+            auto* const submit_list = std::get_if<SubmitListCommand>(&next.data);
+            if (!submit_list) {
+                decoded_queue.Push(std::move(next.data), next.fence, next.block);
+                continue;
+            }
+            // Consecutive submissions to a channel are decoded into a single list
+            const s32 channel = submit_list->channel;
+            DecodedListCommand decoded{channel};
+            CommandDataContainer* last = &next;
+            Tegra::CommandList* entries = &submit_list->entries;
+            while (true) {
+                const DecodeResult result = scheduler.Decode(channel, *entries, decoded.list);
+                if (result != DecodeResult::Done) {
+                    const u64 fence = last->fence - 1;
+                    if (!decoded.list.calls.empty()) {
+                        decoded_queue.Push(std::exchange(decoded, DecodedListCommand{channel}),
+                                           fence, false);
+                    }
+                    if (result == DecodeResult::ReadOnGpu) {
+                        decoded_queue.Push(SubmitListCommand(channel, std::move(*entries)), fence,
+                                           false);
+                    }
+                    if (!wait_for_gpu(fence)) {
+                        return;
+                    }
+                    if (result == DecodeResult::WaitForGpu) {
+                        continue;
+                    }
+                }
+                if (last->block || !IsSubmitTo(state.queue, read_index, end, channel)) {
+                    break;
+                }
+                last = &state.queue[read_index++];
+                entries = &std::get<SubmitListCommand>(last->data).entries;
+            }
+            decoded_queue.Push(std::move(decoded), last->fence, last->block);
+        }
+        state.queue.Release(end);
     }
 }
 
@@ -70,8 +284,15 @@ void ThreadManager::StartThread(VideoCore::RendererBase& renderer,
                                 Core::Frontend::GraphicsContext& context,
                                 Tegra::Control::Scheduler& scheduler) {
     rasterizer = renderer.ReadRasterizer();
+    const bool is_pipelined = is_async && Settings::values.use_pipelined_gpu.GetValue();
+    if (is_pipelined) {
+        state.decoded_queue = std::make_unique<CommandQueue>();
+    }
     thread = std::jthread(RunThread, std::ref(system), std::ref(renderer), std::ref(context),
                           std::ref(scheduler), std::ref(state));
+    if (is_pipelined) {
+        decode_thread = std::jthread(RunDecodeThread, std::ref(scheduler), std::ref(state));
+    }
 }
 
 void ThreadManager::SubmitList(s32 channel, Tegra::CommandList&& entries) {
@@ -112,17 +333,26 @@ u64 ThreadManager::PushCommand(CommandData&& command_data, bool block) {
         block = true;
     }
 
-    std::unique_lock lk(state.write_lock);
-    const u64 fence{++state.last_fence};
-    state.queue.EmplaceWait(std::move(command_data), fence, block);
+    u64 fence;
+    {
+        std::scoped_lock lk{state.write_lock};
+        fence = ++state.last_fence;
+        state.queue.Push(std::move(command_data), fence, block);
+    }
 
     if (block) {
-        Common::CondvarWait(state.cv, lk, thread.get_stop_token(), [this, fence] {
-            return fence <= state.signaled_fence.load(std::memory_order_relaxed);
-        });
+        u64 signaled_fence = state.signaled_fence.load(std::memory_order_acquire);
+        while (signaled_fence < fence) {
+            state.signaled_fence.wait(signaled_fence, std::memory_order_acquire);
+            signaled_fence = state.signaled_fence.load(std::memory_order_acquire);
+        }
     }
 
     return fence;
 }
 
+QueueStats ThreadManager::GetAndResetQueueStats() {
+    return state.queue.GetAndResetStats();
+}
+
 } // namespace VideoCommon::GPUThread
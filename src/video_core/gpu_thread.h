@@ -3,14 +3,14 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
-#include <condition_variable>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <thread>
 #include <variant>
 
-#include "common/bounded_threadsafe_queue.h"
 #include "common/polyfill_thread.h"
 #include "video_core/framebuffer_config.h"
 
@@ -44,6 +44,19 @@ struct SubmitListCommand final {
     Tegra::CommandList entries;
 };
 
+/// Command lists decoded ahead of their execution by the pipelined GPU thread
+struct DecodedListCommand final {
+    explicit DecodedListCommand(s32 channel_) : channel{channel_} {}
+
+    s32 channel;
+    Tegra::DmaPusher::DecodedList list;
+};
+
+/// Command to let the decoding thread know the GPU thread has executed everything before it
+struct DecodeSyncCommand final {
+    u64 id;
+};
+
 /// Command to signal to the GPU thread to flush a region
 struct FlushRegionCommand final {
     explicit constexpr FlushRegionCommand(DAddr addr_, u64 size_) : addr{addr_}, size{size_} {}
@@ -73,8 +86,9 @@ struct FlushAndInvalidateRegionCommand final {
 struct GPUTickCommand final {};
 
 using CommandData =
-    std::variant<std::monostate, SubmitListCommand, FlushRegionCommand, InvalidateRegionCommand,
-                 FlushAndInvalidateRegionCommand, GPUTickCommand>;
+    std::variant<std::monostate, SubmitListCommand, DecodedListCommand, DecodeSyncCommand,
+                 FlushRegionCommand, InvalidateRegionCommand, FlushAndInvalidateRegionCommand,
+                 GPUTickCommand>;
 
 struct CommandDataContainer {
     CommandDataContainer() = default;
@@ -87,14 +101,79 @@ struct CommandDataContainer {
     bool block{};
 };
 
+/// Statistics of the command queue, reset every time they are read
+struct QueueStats {
+    /// Largest number of commands that were waiting for the GPU thread at once
+    size_t peak_depth{};
+    /// Number of batches of commands executed by the GPU thread
+    u64 batches{};
+    /// Number of times the GPU thread had to be woken up after going to sleep
+    u64 wakeups{};
+};
+
+/**
+ * Preallocated ring of commands for the GPU thread. Producers are serialized by the write lock of
+ * SynchState, so there is a single producer and a single consumer at any time and the ring needs
+ * no lock of its own. Both sides spin for a while before sleeping on an atomic wait, and are only
+ * woken up by the other side when they actually went to sleep.
+ */
+class CommandQueue final {
+public:
+    static constexpr size_t CAPACITY = 0x1000;
+
+    /// Waits for a free slot and writes the command to it. Must be called with the write lock held.
+    void Push(CommandData&& data, u64 fence, bool block);
+
+    /// Waits for commands past read_index, returns the index after the last available command or
+    /// read_index when a stop was requested.
+    [[nodiscard]] size_t WaitForCommands(size_t read_index, std::stop_token stop_token);
+
+    /// Returns the command at the given index, valid until it is released.
+    [[nodiscard]] CommandDataContainer& operator[](size_t index) {
+        return commands[index % CAPACITY];
+    }
+
+    /// Hands the slots of the commands before read_index back to the producer.
+    void Release(size_t read_index);
+
+    /// Wakes up the consumer, so it can notice a stop request.
+    void Interrupt();
+
+    [[nodiscard]] QueueStats GetAndResetStats();
+
+private:
+    struct Sleeper {
+        std::atomic<u32> sequence{};
+        std::atomic_bool is_sleeping{};
+    };
+
+    template <typename Func>
+    static void Wait(Sleeper& sleeper, Func&& is_ready);
+
+    static bool Wake(Sleeper& sleeper);
+
+    alignas(128) std::atomic<size_t> read_index{};
+    alignas(128) std::atomic<size_t> write_index{};
+    Sleeper consumer;
+    Sleeper producer;
+
+    std::atomic<size_t> peak_depth{};
+    std::atomic<u64> batches{};
+    std::atomic<u64> wakeups{};
+
+    std::array<CommandDataContainer, CAPACITY> commands;
+};
+
 /// Struct used to synchronize the GPU thread
 struct SynchState final {
-    using CommandQueue = Common::MPSCQueue<CommandDataContainer>;
     std::mutex write_lock;
     CommandQueue queue;
+    /// Commands handed from the decoding thread to the GPU thread in pipelined mode
+    std::unique_ptr<CommandQueue> decoded_queue;
+    /// Last DecodeSyncCommand executed by the GPU thread
+    std::atomic<u64> decode_synced{};
     u64 last_fence{};
     std::atomic<u64> signaled_fence{};
-    std::condition_variable_any cv;
 };
 
 /// Class used to manage the GPU thread
@@ -121,6 +200,9 @@ public:
 
     void TickGPU();
 
+    /// Returns the statistics of the command queue since the last call
+    [[nodiscard]] QueueStats GetAndResetQueueStats();
+
 private:
     /// Pushes a command to be executed by the GPU thread
     u64 PushCommand(CommandData&& command_data, bool block = false);
@@ -131,6 +213,9 @@ private:
 
     SynchState state;
     std::jthread thread;
+    /// Fetches and decodes command lists ahead of the GPU thread in pipelined mode. Declared after
+    /// the GPU thread so it is stopped first, while the GPU thread still drains its queue.
+    std::jthread decode_thread;
 };
 
 } // namespace VideoCommon::GPUThread
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2020 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
 #include <cstring>
 #include <fstream>
 #include <optional>
@@ -14,10 +15,12 @@
 #include "common/fs/path_util.h"
 #include "common/microprofile.h"
 #include "common/settings.h"
+#include "video_core/engines/draw_manager.h"
 #include "video_core/engines/maxwell_3d.h"
 #include "video_core/macro/macro.h"
 #include "video_core/macro/macro_hle.h"
 #include "video_core/macro/macro_interpreter.h"
+#include "video_core/macro/macro_profiler.h"
 
 #ifdef ARCHITECTURE_x86_64
 #include "video_core/macro/macro_jit_x64.h"
@@ -69,16 +72,44 @@ void MacroEngine::ClearCode(u32 method) {
 }
 
 void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
+    if (profiler) [[unlikely]] {
+        ExecuteProfiled(method, parameters);
+        return;
+    }
+    ExecuteImpl(method, parameters);
+}
+
+void MacroEngine::ExecuteProfiled(u32 method, const std::vector<u32>& parameters) {
+    const u64 method_calls = maxwell3d.MethodCallCount();
+    const auto start = std::chrono::steady_clock::now();
+    const CacheInfo* const cache_info = ExecuteImpl(method, parameters);
+    const auto time = std::chrono::steady_clock::now() - start;
+    if (!cache_info) {
+        return;
+    }
+    profiler->Record(cache_info->hash, cache_info->has_hle_program,
+                     maxwell3d.MethodCallCount() - method_calls,
+                     std::chrono::duration_cast<std::chrono::nanoseconds>(time));
+    if (const auto code = uploaded_macro_code.find(method); code != uploaded_macro_code.end()) {
+        profiler->RecordInvocation(cache_info->hash, code->second, parameters);
+    }
+}
+
+const MacroEngine::CacheInfo* MacroEngine::ExecuteImpl(u32 method,
+                                                       const std::vector<u32>& parameters) {
     auto compiled_macro = macro_cache.find(method);
     if (compiled_macro != macro_cache.end()) {
         const auto& cache_info = compiled_macro->second;
         if (cache_info.has_hle_program) {
             MICROPROFILE_SCOPE(MacroHLE);
+            // HLE macros change registers directly, behind the back of the pending draw
+            maxwell3d.draw_manager->FlushPendingDraw();
             cache_info.hle_program->Execute(parameters, method);
         } else {
             maxwell3d.RefreshParameters();
             cache_info.lle_program->Execute(parameters, method);
         }
+        return &cache_info;
     } else {
         // Macro not compiled, check if it's uploaded and if so, compile it
         std::optional<u32> mid_method;
@@ -92,7 +123,7 @@ void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
             }
             if (!mid_method.has_value()) {
                 ASSERT_MSG(false, "Macro 0x{0:x} was not uploaded", method);
-                return;
+                return nullptr;
             }
         }
         auto& cache_info = macro_cache[method];
@@ -119,12 +150,14 @@ void MacroEngine::Execute(u32 method, const std::vector<u32>& parameters) {
             cache_info.has_hle_program = true;
             cache_info.hle_program = std::move(hle_program);
             MICROPROFILE_SCOPE(MacroHLE);
+            maxwell3d.draw_manager->FlushPendingDraw();
             cache_info.hle_program->Execute(parameters, method);
         }
 
         if (Settings::values.dump_macros) {
             Dump(cache_info.hash, macro_code->second, cache_info.has_hle_program);
         }
+        return &cache_info;
     }
 }
 
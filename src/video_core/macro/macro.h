@@ -96,6 +96,7 @@ union MethodAddress {
 } // namespace Macro
 
 class HLEMacro;
+class MacroProfiler;
 
 class CachedMacro {
 public:
@@ -120,9 +121,19 @@ public:
     // Clear the code associated with a method.
     void ClearCode(u32 method);
 
+    // Returns the uploaded macro code, keyed by its start address in the macro memory
+    [[nodiscard]] const std::unordered_map<u32, std::vector<u32>>& UploadedCode() const {
+        return uploaded_macro_code;
+    }
+
     // Compiles the macro if its not in the cache, and executes the compiled macro
     void Execute(u32 method, const std::vector<u32>& parameters);
 
+    // Accounts every executed macro in the given profiler, or stops profiling when null
+    void SetProfiler(MacroProfiler* profiler_) {
+        profiler = profiler_;
+    }
+
 protected:
     virtual std::unique_ptr<CachedMacro> Compile(const std::vector<u32>& code) = 0;
 
@@ -134,9 +145,14 @@ private:
         bool has_hle_program{};
     };
 
+    const CacheInfo* ExecuteImpl(u32 method, const std::vector<u32>& parameters);
+
+    void ExecuteProfiled(u32 method, const std::vector<u32>& parameters);
+
     std::unordered_map<u32, CacheInfo> macro_cache;
     std::unordered_map<u32, std::vector<u32>> uploaded_macro_code;
     std::unique_ptr<HLEMacro> hle_macros;
+    MacroProfiler* profiler{};
     Engines::Maxwell3D& maxwell3d;
 };
 
@@ -2,7 +2,7 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <array>
-#include <optional>
+#include <limits>
 
 #include "common/assert.h"
 #include "common/logging/log.h"
@@ -13,344 +13,406 @@
 MICROPROFILE_DEFINE(MacroInterp, "GPU", "Execute macro interpreter", MP_RGB(128, 128, 192));
 
 namespace Tegra {
+namespace Macro {
 namespace {
-class MacroInterpreterImpl final : public CachedMacro {
-public:
-    explicit MacroInterpreterImpl(Engines::Maxwell3D& maxwell3d_, const std::vector<u32>& code_)
-        : maxwell3d{maxwell3d_}, code{code_} {}
-
-    void Execute(const std::vector<u32>& params, u32 method) override;
-
-private:
-    /// Resets the execution engine state, zeroing registers, etc.
-    void Reset();
-
-    /**
-     * Executes a single macro instruction located at the current program counter. Returns whether
-     * the interpreter should keep running.
-     *
-     * @param is_delay_slot Whether the current step is being executed due to a delay slot in a
-     *                      previous instruction.
-     */
-    bool Step(bool is_delay_slot);
-
-    /// Calculates the result of an ALU operation. src_a OP src_b;
-    u32 GetALUResult(Macro::ALUOperation operation, u32 src_a, u32 src_b);
+/// Writes to $r0 are redirected to this register, so $r0 always reads as zero.
+constexpr u32 ZERO_REGISTER_SINK = NUM_MACRO_REGISTERS;
+
+/// Program counter returned by handlers once the macro has exited.
+constexpr u32 EXIT_PC = std::numeric_limits<u32>::max();
+
+struct ExecutionState {
+    std::array<u32, NUM_MACRO_REGISTERS + 1> registers{};
+    MethodAddress method_address{};
+    bool carry_flag{};
+    std::span<const u32> parameters;
+    size_t next_parameter{};
+    const DecodedInstruction* program{};
+    ExecutionTarget& target;
+};
 
-    /// Performs the result operation on the input result and stores it in the specified register
-    /// (if necessary).
-    void ProcessResult(Macro::ResultOperation operation, u32 reg, u32 result);
+/// Runs the instruction without any control flow.
+using EffectFn = void (*)(ExecutionState&, const DecodedInstruction&);
+/// Runs the instruction, or the straight-line run it starts, and returns the next program counter.
+using HandlerFn = u32 (*)(ExecutionState&, const DecodedInstruction&);
+} // Anonymous namespace
 
-    /// Evaluates the branch condition and returns whether the branch should be taken or not.
-    bool EvaluateBranchCondition(Macro::BranchCondition cond, u32 value) const;
+struct DecodedInstruction {
+    HandlerFn handler;
+    EffectFn effect;
+    u32 raw;
+    u32 pc;
+    u32 run_end;       ///< End of the straight-line run starting at this instruction
+    u32 branch_target; ///< Absolute branch target, clamped to the end of the program
+    u32 immediate;
+    u32 bitfield_mask;
+    u32 src_bit;
+    u32 dst_bit;
+    u32 dst;
+    u32 src_a;
+    u32 src_b;
+    bool is_exit;
+    bool branch_annul;
+    bool branch_on_zero;
+};
 
-    /// Reads an opcode at the current program counter location.
-    Macro::Opcode GetOpcode() const;
+namespace {
+u32 FetchParameter(ExecutionState& state) {
+    if (state.next_parameter < state.parameters.size()) [[likely]] {
+        return state.parameters[state.next_parameter++];
+    }
+    ASSERT_MSG(false, "Macro fetched more than its {} parameters", state.parameters.size());
+    return 0;
+}
 
-    /// Returns the specified register's value. Register 0 is hardcoded to always return 0.
-    u32 GetRegister(u32 register_id) const;
+void Send(ExecutionState& state, u32 value) {
+    MethodAddress& method_address = state.method_address;
+    state.target.Send(method_address.address, value);
+    // Increment the method address by the method increment.
+    method_address.address.Assign(method_address.address.Value() +
+                                  method_address.increment.Value());
+}
 
-    /// Sets the register to the input value.
-    void SetRegister(u32 register_id, u32 value);
+template <ResultOperation operation>
+void ProcessResult(ExecutionState& state, u32 reg, u32 result) {
+    auto& registers = state.registers;
+    if constexpr (operation == ResultOperation::IgnoreAndFetch) {
+        registers[reg] = FetchParameter(state);
+    } else if constexpr (operation == ResultOperation::Move) {
+        registers[reg] = result;
+    } else if constexpr (operation == ResultOperation::MoveAndSetMethod) {
+        registers[reg] = result;
+        state.method_address.raw = result;
+    } else if constexpr (operation == ResultOperation::FetchAndSend) {
+        registers[reg] = FetchParameter(state);
+        Send(state, result);
+    } else if constexpr (operation == ResultOperation::MoveAndSend) {
+        registers[reg] = result;
+        Send(state, result);
+    } else if constexpr (operation == ResultOperation::FetchAndSetMethod) {
+        registers[reg] = FetchParameter(state);
+        state.method_address.raw = result;
+    } else if constexpr (operation == ResultOperation::MoveAndSetMethodFetchAndSend) {
+        registers[reg] = result;
+        state.method_address.raw = result;
+        Send(state, FetchParameter(state));
+    } else {
+        static_assert(operation == ResultOperation::MoveAndSetMethodSend);
+        registers[reg] = result;
+        state.method_address.raw = result;
+        Send(state, (result >> 12) & 0b111111);
+    }
+}
 
-    /// Sets the method address to use for the next Send instruction.
-    void SetMethodAddress(u32 address);
+template <ALUOperation operation>
+u32 ComputeALU(ExecutionState& state, u32 src_a, u32 src_b) {
+    if constexpr (operation == ALUOperation::Add) {
+        const u64 result{static_cast<u64>(src_a) + src_b};
+        state.carry_flag = result > 0xffffffff;
+        return static_cast<u32>(result);
+    } else if constexpr (operation == ALUOperation::AddWithCarry) {
+        const u64 result{static_cast<u64>(src_a) + src_b + (state.carry_flag ? 1ULL : 0ULL)};
+        state.carry_flag = result > 0xffffffff;
+        return static_cast<u32>(result);
+    } else if constexpr (operation == ALUOperation::Subtract) {
+        const u64 result{static_cast<u64>(src_a) - src_b};
+        state.carry_flag = result < 0x100000000;
+        return static_cast<u32>(result);
+    } else if constexpr (operation == ALUOperation::SubtractWithBorrow) {
+        const u64 result{static_cast<u64>(src_a) - src_b - (state.carry_flag ? 0ULL : 1ULL)};
+        state.carry_flag = result < 0x100000000;
+        return static_cast<u32>(result);
+    } else if constexpr (operation == ALUOperation::Xor) {
+        return src_a ^ src_b;
+    } else if constexpr (operation == ALUOperation::Or) {
+        return src_a | src_b;
+    } else if constexpr (operation == ALUOperation::And) {
+        return src_a & src_b;
+    } else if constexpr (operation == ALUOperation::AndNot) {
+        return src_a & ~src_b;
+    } else {
+        static_assert(operation == ALUOperation::Nand);
+        return ~(src_a & src_b);
+    }
+}
 
-    /// Calls a GPU Engine method with the input parameter.
-    void Send(u32 value);
+template <ALUOperation alu_operation, ResultOperation result_operation>
+void ExecuteALU(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 result = ComputeALU<alu_operation>(state, state.registers[inst.src_a],
+                                                 state.registers[inst.src_b]);
+    ProcessResult<result_operation>(state, inst.dst, result);
+}
 
-    /// Reads a GPU register located at the method address.
-    u32 Read(u32 method) const;
+template <ResultOperation result_operation>
+void ExecuteInvalidALU(ExecutionState& state, const DecodedInstruction& inst) {
+    UNIMPLEMENTED_MSG("Unimplemented ALU operation {}",
+                      static_cast<u32>(Opcode{inst.raw}.alu_operation.Value()));
+    ProcessResult<result_operation>(state, inst.dst, 0);
+}
 
-    /// Returns the next parameter in the parameter queue.
-    u32 FetchParameter();
+template <ResultOperation result_operation>
+void ExecuteAddImmediate(ExecutionState& state, const DecodedInstruction& inst) {
+    ProcessResult<result_operation>(state, inst.dst, state.registers[inst.src_a] + inst.immediate);
+}
 
-    Engines::Maxwell3D& maxwell3d;
+template <ResultOperation result_operation>
+void ExecuteExtractInsert(ExecutionState& state, const DecodedInstruction& inst) {
+    u32 dst = state.registers[inst.src_a];
+    const u32 src = (state.registers[inst.src_b] >> inst.src_bit) & inst.bitfield_mask;
+    dst &= ~(inst.bitfield_mask << inst.dst_bit);
+    dst |= src << inst.dst_bit;
+    ProcessResult<result_operation>(state, inst.dst, dst);
+}
 
-    /// Current program counter
-    u32 pc{};
-    /// Program counter to execute at after the delay slot is executed.
-    std::optional<u32> delayed_pc;
+template <ResultOperation result_operation>
+void ExecuteExtractShiftLeftImmediate(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 shift = state.registers[inst.src_a] & 31;
+    const u32 src = state.registers[inst.src_b];
+    ProcessResult<result_operation>(state, inst.dst,
+                                    ((src >> shift) & inst.bitfield_mask) << inst.dst_bit);
+}
 
-    /// General purpose macro registers.
-    std::array<u32, Macro::NUM_MACRO_REGISTERS> registers = {};
+template <ResultOperation result_operation>
+void ExecuteExtractShiftLeftRegister(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 shift = state.registers[inst.src_a] & 31;
+    const u32 src = state.registers[inst.src_b];
+    ProcessResult<result_operation>(state, inst.dst,
+                                    ((src >> inst.src_bit) & inst.bitfield_mask) << shift);
+}
 
-    /// Method address to use for the next Send instruction.
-    Macro::MethodAddress method_address = {};
+template <ResultOperation result_operation>
+void ExecuteRead(ExecutionState& state, const DecodedInstruction& inst) {
+    const u32 result = state.target.Read(state.registers[inst.src_a] + inst.immediate);
+    ProcessResult<result_operation>(state, inst.dst, result);
+}
 
-    /// Input parameters of the current macro.
-    std::unique_ptr<u32[]> parameters;
-    std::size_t num_parameters = 0;
-    std::size_t parameters_capacity = 0;
-    /// Index of the next parameter that will be fetched by the 'parm' instruction.
-    u32 next_parameter_index = 0;
+void ExecuteUnused(ExecutionState&, const DecodedInstruction& inst) {
+    UNIMPLEMENTED_MSG("Unimplemented macro operation {}",
+                      static_cast<u32>(Opcode{inst.raw}.operation.Value()));
+}
 
-    bool carry_flag = false;
-    const std::vector<u32>& code;
-};
+void ExecuteBranchInDelaySlot(ExecutionState&, const DecodedInstruction&) {
+    ASSERT_MSG(false, "Executing a branch in a delay slot is not valid");
+}
 
-void MacroInterpreterImpl::Execute(const std::vector<u32>& params, u32 method) {
-    MICROPROFILE_SCOPE(MacroInterp);
-    Reset();
+void ExecuteNothing(ExecutionState&, const DecodedInstruction&) {}
 
-    registers[1] = params[0];
-    num_parameters = params.size();
+/// Executes the instruction in the delay slot of a branch or exit, ignoring its exit flag.
+void RunDelaySlot(ExecutionState& state, u32 pc) {
+    const DecodedInstruction& inst = state.program[pc];
+    inst.effect(state, inst);
+}
 
-    if (num_parameters > parameters_capacity) {
-        parameters_capacity = num_parameters;
-        parameters = std::make_unique<u32[]>(num_parameters);
-    }
-    std::memcpy(parameters.get(), params.data(), num_parameters * sizeof(u32));
+template <EffectFn effect>
+u32 RunInstruction(ExecutionState& state, const DecodedInstruction& inst) {
+    effect(state, inst);
+    return inst.pc + 1;
+}
 
-    // Execute the code until we hit an exit condition.
-    bool keep_executing = true;
-    while (keep_executing) {
-        keep_executing = Step(false);
+u32 RunStraightLine(ExecutionState& state, const DecodedInstruction& inst) {
+    const DecodedInstruction* const end = state.program + inst.run_end;
+    for (const DecodedInstruction* it = &inst; it != end; ++it) {
+        it->effect(state, *it);
     }
-
-    // Assert the the macro used all the input parameters
-    ASSERT(next_parameter_index == num_parameters);
+    return inst.run_end;
 }
 
-void MacroInterpreterImpl::Reset() {
-    registers = {};
-    pc = 0;
-    delayed_pc = {};
-    method_address.raw = 0;
-    num_parameters = 0;
-    // The next parameter index starts at 1, because $r1 already has the value of the first
-    // parameter.
-    next_parameter_index = 1;
-    carry_flag = false;
+u32 RunExit(ExecutionState& state, const DecodedInstruction& inst) {
+    inst.effect(state, inst);
+    // Exit has a delay slot, execute the next instruction
+    RunDelaySlot(state, inst.pc + 1);
+    return EXIT_PC;
 }
 
-bool MacroInterpreterImpl::Step(bool is_delay_slot) {
-    u32 base_address = pc;
-
-    Macro::Opcode opcode = GetOpcode();
-    pc += 4;
-
-    // Update the program counter if we were delayed
-    if (delayed_pc) {
-        ASSERT(is_delay_slot);
-        pc = *delayed_pc;
-        delayed_pc = {};
-    }
-
-    switch (opcode.operation) {
-    case Macro::Operation::ALU: {
-        u32 result = GetALUResult(opcode.alu_operation, GetRegister(opcode.src_a),
-                                  GetRegister(opcode.src_b));
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::AddImmediate: {
-        ProcessResult(opcode.result_operation, opcode.dst,
-                      GetRegister(opcode.src_a) + opcode.immediate);
-        break;
+u32 RunBranch(ExecutionState& state, const DecodedInstruction& inst) {
+    const bool is_zero = state.registers[inst.src_a] == 0;
+    if (is_zero == inst.branch_on_zero) {
+        // Ignore the delay slot if the branch has the annul bit, taken branches never exit
+        if (!inst.branch_annul) {
+            RunDelaySlot(state, inst.pc + 1);
+        }
+        return inst.branch_target;
     }
-    case Macro::Operation::ExtractInsert: {
-        u32 dst = GetRegister(opcode.src_a);
-        u32 src = GetRegister(opcode.src_b);
-
-        src = (src >> opcode.bf_src_bit) & opcode.GetBitfieldMask();
-        dst &= ~(opcode.GetBitfieldMask() << opcode.bf_dst_bit);
-        dst |= src << opcode.bf_dst_bit;
-        ProcessResult(opcode.result_operation, opcode.dst, dst);
-        break;
+    if (inst.is_exit) {
+        RunDelaySlot(state, inst.pc + 1);
+        return EXIT_PC;
     }
-    case Macro::Operation::ExtractShiftLeftImmediate: {
-        u32 dst = GetRegister(opcode.src_a);
-        u32 src = GetRegister(opcode.src_b);
+    return inst.pc + 1;
+}
 
-        u32 result = ((src >> dst) & opcode.GetBitfieldMask()) << opcode.bf_dst_bit;
+u32 RunEndOfProgram(ExecutionState&, const DecodedInstruction&) {
+    return EXIT_PC;
+}
 
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::ExtractShiftLeftRegister: {
-        u32 dst = GetRegister(opcode.src_a);
-        u32 src = GetRegister(opcode.src_b);
+struct DecodedOperation {
+    EffectFn effect;
+    HandlerFn handler;
+};
 
-        u32 result = ((src >> opcode.bf_src_bit) & opcode.GetBitfieldMask()) << dst;
+template <EffectFn effect>
+constexpr DecodedOperation MakeOperation() {
+    return {effect, &RunInstruction<effect>};
+}
 
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::Read: {
-        u32 result = Read(GetRegister(opcode.src_a) + opcode.immediate);
-        ProcessResult(opcode.result_operation, opcode.dst, result);
-        break;
-    }
-    case Macro::Operation::Branch: {
-        ASSERT_MSG(!is_delay_slot, "Executing a branch in a delay slot is not valid");
-        u32 value = GetRegister(opcode.src_a);
-        bool taken = EvaluateBranchCondition(opcode.branch_condition, value);
-        if (taken) {
-            // Ignore the delay slot if the branch has the annul bit.
-            if (opcode.branch_annul) {
-                pc = base_address + opcode.GetBranchTarget();
-                return true;
-            }
-
-            delayed_pc = base_address + opcode.GetBranchTarget();
-            // Execute one more instruction due to the delay slot.
-            return Step(true);
+template <ResultOperation result>
+DecodedOperation DecodeOperation(Opcode opcode) {
+    switch (opcode.operation) {
+    case Operation::ALU:
+        switch (opcode.alu_operation) {
+        case ALUOperation::Add:
+            return MakeOperation<&ExecuteALU<ALUOperation::Add, result>>();
+        case ALUOperation::AddWithCarry:
+            return MakeOperation<&ExecuteALU<ALUOperation::AddWithCarry, result>>();
+        case ALUOperation::Subtract:
+            return MakeOperation<&ExecuteALU<ALUOperation::Subtract, result>>();
+        case ALUOperation::SubtractWithBorrow:
+            return MakeOperation<&ExecuteALU<ALUOperation::SubtractWithBorrow, result>>();
+        case ALUOperation::Xor:
+            return MakeOperation<&ExecuteALU<ALUOperation::Xor, result>>();
+        case ALUOperation::Or:
+            return MakeOperation<&ExecuteALU<ALUOperation::Or, result>>();
+        case ALUOperation::And:
+            return MakeOperation<&ExecuteALU<ALUOperation::And, result>>();
+        case ALUOperation::AndNot:
+            return MakeOperation<&ExecuteALU<ALUOperation::AndNot, result>>();
+        case ALUOperation::Nand:
+            return MakeOperation<&ExecuteALU<ALUOperation::Nand, result>>();
+        default:
+            return MakeOperation<&ExecuteInvalidALU<result>>();
         }
-        break;
-    }
+    case Operation::AddImmediate:
+        return MakeOperation<&ExecuteAddImmediate<result>>();
+    case Operation::ExtractInsert:
+        return MakeOperation<&ExecuteExtractInsert<result>>();
+    case Operation::ExtractShiftLeftImmediate:
+        return MakeOperation<&ExecuteExtractShiftLeftImmediate<result>>();
+    case Operation::ExtractShiftLeftRegister:
+        return MakeOperation<&ExecuteExtractShiftLeftRegister<result>>();
+    case Operation::Read:
+        return MakeOperation<&ExecuteRead<result>>();
     default:
-        UNIMPLEMENTED_MSG("Unimplemented macro operation {}", opcode.operation.Value());
-        break;
+        return MakeOperation<&ExecuteUnused>();
     }
+}
 
-    // An instruction with the Exit flag will not actually
-    // cause an exit if it's executed inside a delay slot.
-    if (opcode.is_exit && !is_delay_slot) {
-        // Exit has a delay slot, execute the next instruction
-        Step(true);
-        return false;
+DecodedOperation DecodeOperation(Opcode opcode) {
+    switch (opcode.result_operation) {
+    case ResultOperation::IgnoreAndFetch:
+        return DecodeOperation<ResultOperation::IgnoreAndFetch>(opcode);
+    case ResultOperation::Move:
+        return DecodeOperation<ResultOperation::Move>(opcode);
+    case ResultOperation::MoveAndSetMethod:
+        return DecodeOperation<ResultOperation::MoveAndSetMethod>(opcode);
+    case ResultOperation::FetchAndSend:
+        return DecodeOperation<ResultOperation::FetchAndSend>(opcode);
+    case ResultOperation::MoveAndSend:
+        return DecodeOperation<ResultOperation::MoveAndSend>(opcode);
+    case ResultOperation::FetchAndSetMethod:
+        return DecodeOperation<ResultOperation::FetchAndSetMethod>(opcode);
+    case ResultOperation::MoveAndSetMethodFetchAndSend:
+        return DecodeOperation<ResultOperation::MoveAndSetMethodFetchAndSend>(opcode);
+    case ResultOperation::MoveAndSetMethodSend:
+        return DecodeOperation<ResultOperation::MoveAndSetMethodSend>(opcode);
     }
-
-    return true;
+    UNREACHABLE();
 }
+} // Anonymous namespace
 
-u32 MacroInterpreterImpl::GetALUResult(Macro::ALUOperation operation, u32 src_a, u32 src_b) {
-    switch (operation) {
-    case Macro::ALUOperation::Add: {
-        const u64 result{static_cast<u64>(src_a) + src_b};
-        carry_flag = result > 0xffffffff;
-        return static_cast<u32>(result);
-    }
-    case Macro::ALUOperation::AddWithCarry: {
-        const u64 result{static_cast<u64>(src_a) + src_b + (carry_flag ? 1ULL : 0ULL)};
-        carry_flag = result > 0xffffffff;
-        return static_cast<u32>(result);
-    }
-    case Macro::ALUOperation::Subtract: {
-        const u64 result{static_cast<u64>(src_a) - src_b};
-        carry_flag = result < 0x100000000;
-        return static_cast<u32>(result);
-    }
-    case Macro::ALUOperation::SubtractWithBorrow: {
-        const u64 result{static_cast<u64>(src_a) - src_b - (carry_flag ? 0ULL : 1ULL)};
-        carry_flag = result < 0x100000000;
-        return static_cast<u32>(result);
+ThreadedProgram::ThreadedProgram(std::span<const u32> code) {
+    // One extra instruction past the end catches fallthroughs and out of range branches
+    const u32 end_pc = static_cast<u32>(code.size());
+    instructions.resize(code.size() + 1);
+    for (u32 pc = 0; pc < end_pc; ++pc) {
+        const Opcode opcode{code[pc]};
+        DecodedInstruction& inst = instructions[pc];
+        inst.raw = opcode.raw;
+        inst.pc = pc;
+        inst.immediate = static_cast<u32>(opcode.immediate.Value());
+        inst.bitfield_mask = opcode.GetBitfieldMask();
+        inst.src_bit = opcode.bf_src_bit;
+        inst.dst_bit = opcode.bf_dst_bit;
+        inst.dst = opcode.dst == 0 ? ZERO_REGISTER_SINK : opcode.dst.Value();
+        inst.src_a = opcode.src_a;
+        inst.src_b = opcode.src_b;
+        inst.is_exit = opcode.is_exit != 0;
+        if (opcode.operation == Operation::Branch) {
+            const s64 target = static_cast<s64>(pc) + opcode.immediate;
+            inst.branch_target = target >= 0 && target < end_pc ? static_cast<u32>(target) : end_pc;
+            inst.branch_annul = opcode.branch_annul != 0;
+            inst.branch_on_zero = opcode.branch_condition == BranchCondition::Zero;
+            inst.effect = &ExecuteBranchInDelaySlot;
+            inst.handler = &RunBranch;
+            continue;
+        }
+        const DecodedOperation operation = DecodeOperation(opcode);
+        inst.effect = operation.effect;
+        inst.handler = inst.is_exit ? &RunExit : operation.handler;
     }
-    case Macro::ALUOperation::Xor:
-        return src_a ^ src_b;
-    case Macro::ALUOperation::Or:
-        return src_a | src_b;
-    case Macro::ALUOperation::And:
-        return src_a & src_b;
-    case Macro::ALUOperation::AndNot:
-        return src_a & ~src_b;
-    case Macro::ALUOperation::Nand:
-        return ~(src_a & src_b);
-
-    default:
-        UNIMPLEMENTED_MSG("Unimplemented ALU operation {}", operation);
-        return 0;
+    DecodedInstruction& end = instructions[end_pc];
+    end.pc = end_pc;
+    end.effect = &ExecuteNothing;
+    end.handler = &RunEndOfProgram;
+
+    // Instructions followed by more straight-line code run their whole run in one dispatch
+    u32 run_end = end_pc;
+    for (u32 pc = end_pc; pc-- > 0;) {
+        DecodedInstruction& inst = instructions[pc];
+        if (inst.is_exit || inst.handler == &RunBranch) {
+            run_end = pc;
+            inst.run_end = pc + 1;
+            continue;
+        }
+        inst.run_end = run_end;
+        if (run_end - pc > 1) {
+            inst.handler = &RunStraightLine;
+        }
     }
 }
 
-void MacroInterpreterImpl::ProcessResult(Macro::ResultOperation operation, u32 reg, u32 result) {
-    switch (operation) {
-    case Macro::ResultOperation::IgnoreAndFetch:
-        // Fetch parameter and ignore result.
-        SetRegister(reg, FetchParameter());
-        break;
-    case Macro::ResultOperation::Move:
-        // Move result.
-        SetRegister(reg, result);
-        break;
-    case Macro::ResultOperation::MoveAndSetMethod:
-        // Move result and use as Method Address.
-        SetRegister(reg, result);
-        SetMethodAddress(result);
-        break;
-    case Macro::ResultOperation::FetchAndSend:
-        // Fetch parameter and send result.
-        SetRegister(reg, FetchParameter());
-        Send(result);
-        break;
-    case Macro::ResultOperation::MoveAndSend:
-        // Move and send result.
-        SetRegister(reg, result);
-        Send(result);
-        break;
-    case Macro::ResultOperation::FetchAndSetMethod:
-        // Fetch parameter and use result as Method Address.
-        SetRegister(reg, FetchParameter());
-        SetMethodAddress(result);
-        break;
-    case Macro::ResultOperation::MoveAndSetMethodFetchAndSend:
-        // Move result and use as Method Address, then fetch and send parameter.
-        SetRegister(reg, result);
-        SetMethodAddress(result);
-        Send(FetchParameter());
-        break;
-    case Macro::ResultOperation::MoveAndSetMethodSend:
-        // Move result and use as Method Address, then send bits 12:17 of result.
-        SetRegister(reg, result);
-        SetMethodAddress(result);
-        Send((result >> 12) & 0b111111);
-        break;
-    default:
-        UNIMPLEMENTED_MSG("Unimplemented result operation {}", operation);
-        break;
-    }
-}
+ThreadedProgram::~ThreadedProgram() = default;
 
-bool MacroInterpreterImpl::EvaluateBranchCondition(Macro::BranchCondition cond, u32 value) const {
-    switch (cond) {
-    case Macro::BranchCondition::Zero:
-        return value == 0;
-    case Macro::BranchCondition::NotZero:
-        return value != 0;
+void ThreadedProgram::Execute(ExecutionTarget& target, std::span<const u32> parameters) const {
+    ExecutionState state{.parameters = parameters, .target = target};
+    state.program = instructions.data();
+    // The next parameter index starts at 1, because $r1 already has the value of the first
+    // parameter.
+    if (!parameters.empty()) {
+        state.registers[1] = parameters[0];
+        state.next_parameter = 1;
     }
-    UNREACHABLE();
+    for (u32 pc = 0; pc != EXIT_PC;) {
+        const DecodedInstruction& inst = instructions[pc];
+        pc = inst.handler(state, inst);
+    }
+    // Assert the the macro used all the input parameters
+    ASSERT(state.next_parameter == parameters.size());
 }
 
-Macro::Opcode MacroInterpreterImpl::GetOpcode() const {
-    ASSERT((pc % sizeof(u32)) == 0);
-    ASSERT(pc < code.size() * sizeof(u32));
-    return {code[pc / sizeof(u32)]};
-}
+} // namespace Macro
 
-u32 MacroInterpreterImpl::GetRegister(u32 register_id) const {
-    return registers.at(register_id);
-}
+namespace {
+class MacroInterpreterImpl final : public CachedMacro, public Macro::ExecutionTarget {
+public:
+    explicit MacroInterpreterImpl(Engines::Maxwell3D& maxwell3d_, const std::vector<u32>& code)
+        : maxwell3d{maxwell3d_}, program{code} {}
 
-void MacroInterpreterImpl::SetRegister(u32 register_id, u32 value) {
-    // Register 0 is hardwired as the zero register.
-    // Ensure no writes to it actually occur.
-    if (register_id == 0) {
-        return;
+    void Execute(const std::vector<u32>& params, u32 method) override {
+        MICROPROFILE_SCOPE(MacroInterp);
+        program.Execute(*this, params);
     }
 
-    registers.at(register_id) = value;
-}
-
-void MacroInterpreterImpl::SetMethodAddress(u32 address) {
-    method_address.raw = address;
-}
-
-void MacroInterpreterImpl::Send(u32 value) {
-    maxwell3d.CallMethod(method_address.address, value, true);
-    // Increment the method address by the method increment.
-    method_address.address.Assign(method_address.address.Value() +
-                                  method_address.increment.Value());
-}
+    void Send(u32 method, u32 value) override {
+        maxwell3d.CallMethod(method, value, true);
+    }
 
-u32 MacroInterpreterImpl::Read(u32 method) const {
-    return maxwell3d.GetRegisterValue(method);
-}
+    u32 Read(u32 method) const override {
+        return maxwell3d.GetRegisterValue(method);
+    }
 
-u32 MacroInterpreterImpl::FetchParameter() {
-    ASSERT(next_parameter_index < num_parameters);
-    return parameters[next_parameter_index++];
-}
+private:
+    Engines::Maxwell3D& maxwell3d;
+    Macro::ThreadedProgram program;
+};
 } // Anonymous namespace
 
 MacroInterpreter::MacroInterpreter(Engines::Maxwell3D& maxwell3d_)
@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <span>
 #include <vector>
 
 #include "common/common_types.h"
@@ -13,6 +14,39 @@ namespace Engines {
 class Maxwell3D;
 }
 
+namespace Macro {
+
+/// Receives the methods sent by an interpreted macro and serves its register reads.
+class ExecutionTarget {
+public:
+    virtual ~ExecutionTarget() = default;
+
+    virtual void Send(u32 method, u32 value) = 0;
+
+    [[nodiscard]] virtual u32 Read(u32 method) const = 0;
+};
+
+struct DecodedInstruction;
+
+/**
+ * Macro program decoded once into threaded code. Every instruction gets a handler specialized for
+ * its operation and result operation, so an ALU operation and the fetch or send that follows it
+ * run as a single step, and straight-line runs of instructions are executed without going back to
+ * the dispatch loop.
+ */
+class ThreadedProgram {
+public:
+    explicit ThreadedProgram(std::span<const u32> code);
+    ~ThreadedProgram();
+
+    void Execute(ExecutionTarget& target, std::span<const u32> parameters) const;
+
+private:
+    std::vector<DecodedInstruction> instructions;
+};
+
+} // namespace Macro
+
 class MacroInterpreter final : public MacroEngine {
 public:
     explicit MacroInterpreter(Engines::Maxwell3D& maxwell3d_);
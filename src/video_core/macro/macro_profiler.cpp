@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+
+#include <fmt/format.h>
+
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "video_core/macro/macro_profiler.h"
+
+namespace Tegra {
+namespace {
+double ToMilliseconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration<double, std::milli>(time).count();
+}
+
+double Percentage(double part, double total) {
+    return total > 0.0 ? part * 100.0 / total : 0.0;
+}
+
+void WriteWord(std::ofstream& file, u32 value) {
+    file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void WriteWords(std::ofstream& file, std::span<const u32> values) {
+    WriteWord(file, static_cast<u32>(values.size()));
+    file.write(reinterpret_cast<const char*>(values.data()),
+               static_cast<std::streamsize>(values.size_bytes()));
+}
+
+bool ReadWords(std::ifstream& file, std::vector<u32>& values) {
+    u32 size{};
+    if (!file.read(reinterpret_cast<char*>(&size), sizeof(size))) {
+        return false;
+    }
+    values.resize(size);
+    return static_cast<bool>(file.read(reinterpret_cast<char*>(values.data()),
+                                       static_cast<std::streamsize>(size * sizeof(u32))));
+}
+} // Anonymous namespace
+
+MacroProfiler::MacroProfiler(bool is_recording_) : is_recording{is_recording_} {}
+
+MacroProfiler::~MacroProfiler() = default;
+
+void MacroProfiler::Record(u64 hash, bool is_hle, u64 method_calls,
+                           std::chrono::nanoseconds time) {
+    std::scoped_lock lock{mutex};
+    Entry& entry = entries[hash];
+    entry.hash = hash;
+    entry.is_hle = is_hle;
+    ++entry.invocations;
+    entry.method_calls += method_calls;
+    entry.time += time;
+}
+
+void MacroProfiler::RecordInvocation(u64 hash, std::span<const u32> code,
+                                     std::span<const u32> parameters) {
+    if (!is_recording) {
+        return;
+    }
+    std::scoped_lock lock{mutex};
+    MacroRecording& recording = recordings[hash];
+    if (recording.code.empty()) {
+        recording.hash = hash;
+        recording.code.assign(code.begin(), code.end());
+    }
+    if (recording.invocations.size() < MAX_RECORDED_INVOCATIONS) {
+        recording.invocations.emplace_back(parameters.begin(), parameters.end());
+    }
+}
+
+std::vector<MacroProfiler::Entry> MacroProfiler::GetEntries() const {
+    std::vector<Entry> result;
+    {
+        std::scoped_lock lock{mutex};
+        result.reserve(entries.size());
+        for (const auto& [hash, entry] : entries) {
+            result.push_back(entry);
+        }
+    }
+    std::ranges::sort(result, [](const Entry& lhs, const Entry& rhs) {
+        return lhs.time != rhs.time ? lhs.time > rhs.time : lhs.hash < rhs.hash;
+    });
+    return result;
+}
+
+std::string MacroProfiler::GetReport() const {
+    const std::vector<Entry> sorted = GetEntries();
+    u64 total_invocations{};
+    u64 hle_invocations{};
+    std::chrono::nanoseconds total_time{};
+    std::chrono::nanoseconds hle_time{};
+    for (const Entry& entry : sorted) {
+        total_invocations += entry.invocations;
+        total_time += entry.time;
+        if (entry.is_hle) {
+            hle_invocations += entry.invocations;
+            hle_time += entry.time;
+        }
+    }
+    const double total_ms = ToMilliseconds(total_time);
+
+    std::string report = fmt::format(
+        "Macro profile: {} programs, {} invocations, {:.3f} ms\n"
+        "HLE coverage: {:.1f}% of invocations, {:.1f}% of execution time\n"
+        "{:>4}  {:<16}  {:<4}  {:>12}  {:>12}  {:>10}  {:>12}  {:>6}\n",
+        sorted.size(), total_invocations, total_ms,
+        Percentage(static_cast<double>(hle_invocations), static_cast<double>(total_invocations)),
+        Percentage(ToMilliseconds(hle_time), total_ms), "Rank", "Hash", "Kind", "Invocations",
+        "Total ms", "Average us", "Method calls", "Time %");
+    auto out = std::back_inserter(report);
+    for (size_t rank = 0; rank < sorted.size(); ++rank) {
+        const Entry& entry = sorted[rank];
+        const double entry_ms = ToMilliseconds(entry.time);
+        fmt::format_to(out,
+                       "{:>4}  {:016x}  {:<4}  {:>12}  {:>12.3f}  {:>10.3f}  {:>12}  {:>6.2f}\n",
+                       rank + 1, entry.hash, entry.is_hle ? "HLE" : "LLE", entry.invocations,
+                       entry_ms, entry_ms * 1000.0 / static_cast<double>(entry.invocations),
+                       entry.method_calls, Percentage(entry_ms, total_ms));
+    }
+    return report;
+}
+
+void MacroProfiler::Dump() const {
+    const std::string report = GetReport();
+    LOG_INFO(HW_GPU, "{}", report);
+
+    const auto base_dir{Common::FS::GetCitronPath(Common::FS::CitronPath::DumpDir)};
+    const auto macro_dir{base_dir / "macros"};
+    if (!Common::FS::CreateDir(base_dir) || !Common::FS::CreateDir(macro_dir)) {
+        LOG_ERROR(Common_Filesystem, "Failed to create macro dump directories");
+        return;
+    }
+    std::ofstream report_file(macro_dir / "profile.txt", std::ios::out | std::ios::trunc);
+    if (!report_file) {
+        LOG_ERROR(Common_Filesystem, "Unable to write the macro profile");
+        return;
+    }
+    report_file << report;
+
+    std::scoped_lock lock{mutex};
+    for (const auto& [hash, recording] : recordings) {
+        const auto path{macro_dir / fmt::format("{:016x}.mrec", hash)};
+        if (!WriteRecording(path, recording)) {
+            LOG_ERROR(Common_Filesystem, "Unable to write macro recording {}",
+                      Common::FS::PathToUTF8String(path));
+        }
+    }
+}
+
+bool MacroProfiler::WriteRecording(const std::filesystem::path& path,
+                                   const MacroRecording& recording) {
+    std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!file) {
+        return false;
+    }
+    WriteWords(file, recording.code);
+    for (const std::vector<u32>& parameters : recording.invocations) {
+        WriteWords(file, parameters);
+    }
+    return static_cast<bool>(file);
+}
+
+std::optional<MacroRecording> MacroProfiler::ReadRecording(const std::filesystem::path& path) {
+    std::ifstream file(path, std::ios::in | std::ios::binary);
+    MacroRecording recording;
+    if (!file || !ReadWords(file, recording.code)) {
+        return std::nullopt;
+    }
+    const std::string stem = path.stem().string();
+    recording.hash = std::strtoull(stem.c_str(), nullptr, 16);
+
+    std::vector<u32> parameters;
+    while (ReadWords(file, parameters)) {
+        recording.invocations.push_back(std::move(parameters));
+    }
+    return recording;
+}
+
+} // namespace Tegra
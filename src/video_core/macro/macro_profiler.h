@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace Tegra {
+
+/// Macro code and the parameters it was invoked with, as saved by the recording mode.
+struct MacroRecording {
+    u64 hash{};
+    std::vector<u32> code;
+    std::vector<std::vector<u32>> invocations;
+};
+
+/**
+ * Collects per hash statistics of the macros executed by every Maxwell3D engine and optionally
+ * records their code and parameters, so HLE replacements can be validated offline against the
+ * interpreter.
+ *
+ * Recordings are stored as "<hash>.mrec" in the macros dump directory: a u32 code size, the code,
+ * and then for each invocation a u32 parameter count followed by the parameters.
+ */
+class MacroProfiler {
+public:
+    struct Entry {
+        u64 hash{};
+        bool is_hle{};
+        u64 invocations{};
+        u64 method_calls{};
+        std::chrono::nanoseconds time{};
+    };
+
+    explicit MacroProfiler(bool is_recording_);
+    ~MacroProfiler();
+
+    /// Accounts one execution of the macro with the given hash.
+    void Record(u64 hash, bool is_hle, u64 method_calls, std::chrono::nanoseconds time);
+
+    /// Keeps the invocation when recording, up to a limit of invocations per hash.
+    void RecordInvocation(u64 hash, std::span<const u32> code, std::span<const u32> parameters);
+
+    /// Returns the collected entries, sorted by cumulative execution time.
+    [[nodiscard]] std::vector<Entry> GetEntries() const;
+
+    /// Returns a human readable report of the entries, ranked by cumulative execution time.
+    [[nodiscard]] std::string GetReport() const;
+
+    /// Logs the report and writes it to "profile.txt" in the macros dump directory, along with
+    /// the recordings.
+    void Dump() const;
+
+    /// Writes a recording in the format read by ReadRecording.
+    static bool WriteRecording(const std::filesystem::path& path, const MacroRecording& recording);
+
+    /// Reads a recording written by Dump.
+    [[nodiscard]] static std::optional<MacroRecording> ReadRecording(
+        const std::filesystem::path& path);
+
+private:
+    static constexpr size_t MAX_RECORDED_INVOCATIONS = 256;
+
+    bool is_recording;
+    mutable std::mutex mutex;
+    std::unordered_map<u64, Entry> entries;
+    std::unordered_map<u64, MacroRecording> recordings;
+};
+
+} // namespace Tegra
@@ -15,6 +15,7 @@
 #include "video_core/memory_manager.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_base.h"
+#include "video_core/segment_write_tracker.h"
 
 namespace Tegra {
 using Tegra::Memory::GuestMemoryFlags;
@@ -129,6 +130,7 @@ GPUVAddr MemoryManager::PageTableOp(GPUVAddr gpu_addr, [[maybe_unused]] DAddr de
         remaining_size -= page_size;
     }
     kind_map.Map(gpu_addr, gpu_addr + size, kind);
+    translation_generation.fetch_add(1, std::memory_order_release);
     return gpu_addr;
 }
 
@@ -172,6 +174,7 @@ GPUVAddr MemoryManager::BigPageTableOp(GPUVAddr gpu_addr, [[maybe_unused]] DAddr
         std::unique_lock<std::mutex> lock(guard);
         kind_map.Map(gpu_addr, gpu_addr + size, kind);
     }
+    translation_generation.fetch_add(1, std::memory_order_release);
     return gpu_addr;
 }
 
@@ -179,6 +182,18 @@ void MemoryManager::BindRasterizer(VideoCore::RasterizerInterface* rasterizer_)
     rasterizer = rasterizer_;
 }
 
+void MemoryManager::BindSegmentWriteTracker(SegmentWriteTracker* segment_write_tracker_) {
+    segment_write_tracker = segment_write_tracker_;
+}
+
+void MemoryManager::InvalidateWrittenRegion(DAddr dev_addr, size_t size,
+                                            VideoCommon::CacheType which) const {
+    rasterizer->InvalidateRegion(dev_addr, size, which);
+    if (segment_write_tracker) {
+        segment_write_tracker->OnWrite(dev_addr, size);
+    }
+}
+
 GPUVAddr MemoryManager::Map(GPUVAddr gpu_addr, DAddr dev_addr, std::size_t size, PTEKind kind,
                             bool is_big_pages) {
     if (is_big_pages) [[likely]] {
@@ -209,6 +224,86 @@ void MemoryManager::Unmap(GPUVAddr gpu_addr, std::size_t size) {
     PageTableOp<EntryType::Free>(gpu_addr, 0, size, PTEKind::INVALID);
 }
 
+std::array<MemoryManager::TranslationCacheEntry, MemoryManager::translation_cache_size>&
+MemoryManager::ThreadTranslationCache() {
+    thread_local std::array<TranslationCacheEntry, translation_cache_size> cache{};
+    return cache;
+}
+
+MemoryManager::TranslationRun MemoryManager::FindRun(GPUVAddr gpu_addr, GPUVAddr gpu_end) const {
+    if (!IsWithinGPUAddressRange(gpu_addr)) [[unlikely]] {
+        return {gpu_addr, std::numeric_limits<GPUVAddr>::max(), 0, false, false};
+    }
+    if (gpu_end - gpu_addr <= big_page_size * uncached_walk_pages) {
+        // Walking a few pages is cheaper than going through the cache
+        return WalkRun(gpu_addr, gpu_end);
+    }
+    // Load the generation before walking, so a concurrent update invalidates the walked run
+    const u64 generation = translation_generation.load(std::memory_order_acquire);
+    TranslationCacheEntry& entry =
+        ThreadTranslationCache()[(gpu_addr >> big_page_bits) % translation_cache_size];
+    TranslationRun& cached = entry.run;
+    if (entry.manager_id == unique_identifier && entry.generation == generation &&
+        cached.begin <= gpu_addr && gpu_addr < cached.end) [[likely]] {
+        if (cached.end < gpu_end && cached.is_extendable) {
+            // Grow the cached run instead of chaining runs walked from other slots
+            const TranslationRun tail = WalkRun(cached.end, gpu_end);
+            cached.is_extendable = false;
+            const DAddr cached_dev_end = cached.dev_begin + (cached.end - cached.begin);
+            if (tail.is_mapped && tail.dev_begin == cached_dev_end) {
+                cached.end = tail.end;
+                cached.is_extendable = tail.is_extendable;
+            }
+        }
+        return cached;
+    }
+    const TranslationRun run = WalkRun(gpu_addr, gpu_end);
+    if (run.is_mapped) {
+        entry = {unique_identifier, generation, run};
+    }
+    return run;
+}
+
+inline bool MemoryManager::TranslatePage(GPUVAddr gpu_addr, DAddr& dev_addr, u64& step) const {
+    if (GetEntry<true>(gpu_addr) == EntryType::Mapped) [[likely]] {
+        const u64 offset = gpu_addr & big_page_mask;
+        dev_addr = (static_cast<DAddr>(big_page_table_dev[PageEntryIndex<true>(gpu_addr)])
+                    << cpu_page_bits) +
+                   offset;
+        step = big_page_size - offset;
+        return true;
+    }
+    const u64 offset = gpu_addr & page_mask;
+    step = page_size - offset;
+    if (GetEntry<false>(gpu_addr) != EntryType::Mapped) {
+        return false;
+    }
+    dev_addr =
+        (static_cast<DAddr>(page_table[PageEntryIndex<false>(gpu_addr)]) << cpu_page_bits) + offset;
+    return true;
+}
+
+MemoryManager::TranslationRun MemoryManager::WalkRun(GPUVAddr gpu_addr, GPUVAddr gpu_end) const {
+    DAddr dev_addr{};
+    u64 step{};
+    if (!TranslatePage(gpu_addr, dev_addr, step)) {
+        // Unmapped runs are not extended, they only stop the walks of the callers
+        return {gpu_addr, gpu_addr + step, 0, false, false};
+    }
+    const DAddr dev_begin = dev_addr;
+    const GPUVAddr walk_end = std::min(gpu_end, address_space_size);
+    GPUVAddr current = gpu_addr + step;
+    DAddr expected_dev_addr = dev_addr + step;
+    while (current < walk_end) {
+        if (!TranslatePage(current, dev_addr, step) || dev_addr != expected_dev_addr) {
+            return {gpu_addr, current, dev_begin, true, false};
+        }
+        current += step;
+        expected_dev_addr += step;
+    }
+    return {gpu_addr, current, dev_begin, true, current < address_space_size};
+}
+
 std::optional<DAddr> MemoryManager::GpuToCpuAddress(GPUVAddr gpu_addr) const {
     if (!IsWithinGPUAddressRange(gpu_addr)) [[unlikely]] {
         return std::nullopt;
@@ -368,41 +463,27 @@ inline void MemoryManager::MemoryOperation(GPUVAddr gpu_src_addr, std::size_t si
 template <bool is_safe>
 void MemoryManager::ReadBlockImpl(GPUVAddr gpu_src_addr, void* dest_buffer, std::size_t size,
                                   [[maybe_unused]] VideoCommon::CacheType which) const {
-    auto set_to_zero = [&]([[maybe_unused]] std::size_t page_index,
-                           [[maybe_unused]] std::size_t offset, std::size_t copy_amount) {
-        std::memset(dest_buffer, 0, copy_amount);
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-    };
-    auto mapped_normal = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(page_table[page_index]) << cpu_page_bits) + offset;
-        if constexpr (is_safe) {
-            rasterizer->FlushRegion(dev_addr_base, copy_amount, which);
-        }
-        u8* physical = memory.GetPointer<u8>(dev_addr_base);
-        std::memcpy(dest_buffer, physical, copy_amount);
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-    };
-    auto mapped_big = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
-        if constexpr (is_safe) {
-            rasterizer->FlushRegion(dev_addr_base, copy_amount, which);
-        }
-        if (!IsBigPageContinuous(page_index)) [[unlikely]] {
-            memory.ReadBlockUnsafe(dev_addr_base, dest_buffer, copy_amount);
+    u8* dest = static_cast<u8*>(dest_buffer);
+    const GPUVAddr gpu_src_end = gpu_src_addr + size;
+    for (GPUVAddr current = gpu_src_addr; current < gpu_src_end;) {
+        const TranslationRun run = FindRun(current, gpu_src_end);
+        const std::size_t copy_amount = std::min(run.end, gpu_src_end) - current;
+        if (!run.is_mapped) {
+            std::memset(dest, 0, copy_amount);
         } else {
-            u8* physical = memory.GetPointer<u8>(dev_addr_base);
-            std::memcpy(dest_buffer, physical, copy_amount);
+            const DAddr dev_addr = run.dev_begin + (current - run.begin);
+            if constexpr (is_safe) {
+                rasterizer->FlushRegion(dev_addr, copy_amount, which);
+            }
+            if (const u8* const physical = memory.GetSpan(dev_addr, copy_amount)) [[likely]] {
+                std::memcpy(dest, physical, copy_amount);
+            } else {
+                memory.ReadBlockUnsafe(dev_addr, dest, copy_amount);
+            }
         }
-        dest_buffer = static_cast<u8*>(dest_buffer) + copy_amount;
-    };
-    auto read_short_pages = [&](std::size_t page_index, std::size_t offset,
-                                std::size_t copy_amount) {
-        GPUVAddr base = (page_index << big_page_bits) + offset;
-        MemoryOperation<false>(base, copy_amount, mapped_normal, set_to_zero, set_to_zero);
-    };
-    MemoryOperation<true>(gpu_src_addr, size, mapped_big, set_to_zero, read_short_pages);
+        dest += copy_amount;
+        current += copy_amount;
+    }
 }
 
 void MemoryManager::ReadBlock(GPUVAddr gpu_src_addr, void* dest_buffer, std::size_t size,
@@ -418,40 +499,25 @@ void MemoryManager::ReadBlockUnsafe(GPUVAddr gpu_src_addr, void* dest_buffer,
 template <bool is_safe>
 void MemoryManager::WriteBlockImpl(GPUVAddr gpu_dest_addr, const void* src_buffer, std::size_t size,
                                    [[maybe_unused]] VideoCommon::CacheType which) {
-    auto just_advance = [&]([[maybe_unused]] std::size_t page_index,
-                            [[maybe_unused]] std::size_t offset, std::size_t copy_amount) {
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-    };
-    auto mapped_normal = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(page_table[page_index]) << cpu_page_bits) + offset;
-        if constexpr (is_safe) {
-            rasterizer->InvalidateRegion(dev_addr_base, copy_amount, which);
-        }
-        u8* physical = memory.GetPointer<u8>(dev_addr_base);
-        std::memcpy(physical, src_buffer, copy_amount);
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-    };
-    auto mapped_big = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
-        if constexpr (is_safe) {
-            rasterizer->InvalidateRegion(dev_addr_base, copy_amount, which);
-        }
-        if (!IsBigPageContinuous(page_index)) [[unlikely]] {
-            memory.WriteBlockUnsafe(dev_addr_base, src_buffer, copy_amount);
-        } else {
-            u8* physical = memory.GetPointer<u8>(dev_addr_base);
-            std::memcpy(physical, src_buffer, copy_amount);
+    const u8* src = static_cast<const u8*>(src_buffer);
+    const GPUVAddr gpu_dest_end = gpu_dest_addr + size;
+    for (GPUVAddr current = gpu_dest_addr; current < gpu_dest_end;) {
+        const TranslationRun run = FindRun(current, gpu_dest_end);
+        const std::size_t copy_amount = std::min(run.end, gpu_dest_end) - current;
+        if (run.is_mapped) {
+            const DAddr dev_addr = run.dev_begin + (current - run.begin);
+            if constexpr (is_safe) {
+                InvalidateWrittenRegion(dev_addr, copy_amount, which);
+            }
+            if (u8* const physical = memory.GetSpan(dev_addr, copy_amount)) [[likely]] {
+                std::memcpy(physical, src, copy_amount);
+            } else {
+                memory.WriteBlockUnsafe(dev_addr, src, copy_amount);
+            }
         }
-        src_buffer = static_cast<const u8*>(src_buffer) + copy_amount;
-    };
-    auto write_short_pages = [&](std::size_t page_index, std::size_t offset,
-                                 std::size_t copy_amount) {
-        GPUVAddr base = (page_index << big_page_bits) + offset;
-        MemoryOperation<false>(base, copy_amount, mapped_normal, just_advance, just_advance);
-    };
-    MemoryOperation<true>(gpu_dest_addr, size, mapped_big, just_advance, write_short_pages);
+        src += copy_amount;
+        current += copy_amount;
+    }
 }
 
 void MemoryManager::WriteBlock(GPUVAddr gpu_dest_addr, const void* src_buffer, std::size_t size,
@@ -524,43 +590,21 @@ bool MemoryManager::IsMemoryDirty(GPUVAddr gpu_addr, size_t size,
 }
 
 size_t MemoryManager::MaxContinuousRange(GPUVAddr gpu_addr, size_t size) const {
-    std::optional<DAddr> old_page_addr{};
-    size_t range_so_far = 0;
-    bool result{false};
-    auto fail = [&]([[maybe_unused]] std::size_t page_index, [[maybe_unused]] std::size_t offset,
-                    std::size_t copy_amount) {
-        result = true;
-        return true;
-    };
-    auto short_check = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(page_table[page_index]) << cpu_page_bits) + offset;
-        if (old_page_addr && *old_page_addr != dev_addr_base) {
-            result = true;
-            return true;
-        }
-        range_so_far += copy_amount;
-        old_page_addr = {dev_addr_base + copy_amount};
-        return false;
-    };
-    auto big_check = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
-        if (old_page_addr && *old_page_addr != dev_addr_base) {
-            return true;
+    const GPUVAddr gpu_end = gpu_addr + size;
+    TranslationRun run = FindRun(gpu_addr, gpu_end);
+    if (!run.is_mapped) {
+        return 0;
+    }
+    while (run.end < gpu_end) {
+        const TranslationRun next = FindRun(run.end, gpu_end);
+        // Cached runs may start before the end of the previous one
+        if (!next.is_mapped || next.dev_begin + (run.end - next.begin) !=
+                                   run.dev_begin + (run.end - run.begin)) {
+            break;
         }
-        range_so_far += copy_amount;
-        old_page_addr = {dev_addr_base + copy_amount};
-        return false;
-    };
-    auto check_short_pages = [&](std::size_t page_index, std::size_t offset,
-                                 std::size_t copy_amount) {
-        GPUVAddr base = (page_index << big_page_bits) + offset;
-        MemoryOperation<false>(base, copy_amount, short_check, fail, fail);
-        return result;
-    };
-    MemoryOperation<true>(gpu_addr, size, big_check, fail, check_short_pages);
-    return range_so_far;
+        run = next;
+    }
+    return std::min(run.end, gpu_end) - gpu_addr;
 }
 
 size_t MemoryManager::GetMemoryLayoutSize(GPUVAddr gpu_addr, size_t max_size) const {
@@ -577,12 +621,12 @@ void MemoryManager::InvalidateRegion(GPUVAddr gpu_addr, size_t size,
     auto mapped_normal = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
         const DAddr dev_addr_base =
             (static_cast<DAddr>(page_table[page_index]) << cpu_page_bits) + offset;
-        rasterizer->InvalidateRegion(dev_addr_base, copy_amount, which);
+        InvalidateWrittenRegion(dev_addr_base, copy_amount, which);
     };
     auto mapped_big = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
         const DAddr dev_addr_base =
             (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
-        rasterizer->InvalidateRegion(dev_addr_base, copy_amount, which);
+        InvalidateWrittenRegion(dev_addr_base, copy_amount, which);
     };
     auto invalidate_short_pages = [&](std::size_t page_index, std::size_t offset,
                                       std::size_t copy_amount) {
@@ -618,41 +662,22 @@ bool MemoryManager::IsGranularRange(GPUVAddr gpu_addr, std::size_t size) const {
 }
 
 bool MemoryManager::IsContinuousRange(GPUVAddr gpu_addr, std::size_t size) const {
-    std::optional<DAddr> old_page_addr{};
-    bool result{true};
-    auto fail = [&]([[maybe_unused]] std::size_t page_index, [[maybe_unused]] std::size_t offset,
-                    std::size_t copy_amount) {
-        result = false;
-        return true;
-    };
-    auto short_check = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(page_table[page_index]) << cpu_page_bits) + offset;
-        if (old_page_addr && *old_page_addr != dev_addr_base) {
-            result = false;
-            return true;
-        }
-        old_page_addr = {dev_addr_base + copy_amount};
-        return false;
-    };
-    auto big_check = [&](std::size_t page_index, std::size_t offset, std::size_t copy_amount) {
-        const DAddr dev_addr_base =
-            (static_cast<DAddr>(big_page_table_dev[page_index]) << cpu_page_bits) + offset;
-        if (old_page_addr && *old_page_addr != dev_addr_base) {
-            result = false;
-            return true;
+    if (size > big_page_size * uncached_walk_pages) {
+        return MaxContinuousRange(gpu_addr, size) == size;
+    }
+    const GPUVAddr gpu_end = gpu_addr + size;
+    DAddr expected_dev_addr{};
+    for (GPUVAddr current = gpu_addr; current < gpu_end;) {
+        DAddr dev_addr;
+        u64 step;
+        if (!TranslatePage(current, dev_addr, step) ||
+            (current != gpu_addr && dev_addr != expected_dev_addr)) {
+            return false;
         }
-        old_page_addr = {dev_addr_base + copy_amount};
-        return false;
-    };
-    auto check_short_pages = [&](std::size_t page_index, std::size_t offset,
-                                 std::size_t copy_amount) {
-        GPUVAddr base = (page_index << big_page_bits) + offset;
-        MemoryOperation<false>(base, copy_amount, short_check, fail, fail);
-        return !result;
-    };
-    MemoryOperation<true>(gpu_addr, size, big_check, fail, check_short_pages);
-    return result;
+        expected_dev_addr = dev_addr + step;
+        current += step;
+    }
+    return true;
 }
 
 bool MemoryManager::IsFullyMappedRange(GPUVAddr gpu_addr, std::size_t size) const {
@@ -681,6 +706,48 @@ MemoryManager::GetSubmappedRange(GPUVAddr gpu_addr, std::size_t size) const {
     return result;
 }
 
+boost::container::small_vector<std::pair<GPUVAddr, std::span<u8>>, 32>
+MemoryManager::GetHostSpans(GPUVAddr gpu_addr, std::size_t size) {
+    boost::container::small_vector<std::pair<GPUVAddr, std::span<u8>>, 32> result{};
+    const auto push = [&result](GPUVAddr piece_addr, u8* pointer, std::size_t length) {
+        if (!result.empty()) {
+            auto& [last_addr, last_span] = result.back();
+            if (last_addr + last_span.size() == piece_addr &&
+                last_span.data() + last_span.size() == pointer) {
+                last_span = std::span<u8>(last_span.data(), last_span.size() + length);
+                return;
+            }
+        }
+        result.emplace_back(piece_addr, std::span<u8>(pointer, length));
+    };
+    const GPUVAddr gpu_end = gpu_addr + size;
+    for (GPUVAddr current = gpu_addr; current < gpu_end;) {
+        const TranslationRun run = FindRun(current, gpu_end);
+        const GPUVAddr run_end = std::min(run.end, gpu_end);
+        if (run.is_mapped) {
+            DAddr dev_addr = run.dev_begin + (current - run.begin);
+            std::size_t remaining = run_end - current;
+            if (u8* const span = memory.GetSpan(dev_addr, remaining)) [[likely]] {
+                push(current, span, remaining);
+            } else {
+                // Split the run in device pages, the host backing is not contiguous
+                for (GPUVAddr piece_addr = current; remaining > 0;) {
+                    const std::size_t length = std::min<std::size_t>(
+                        Core::DEVICE_PAGESIZE - (dev_addr & Core::DEVICE_PAGEMASK), remaining);
+                    if (u8* const pointer = memory.GetPointer<u8>(dev_addr)) {
+                        push(piece_addr, pointer, length);
+                    }
+                    piece_addr += length;
+                    dev_addr += length;
+                    remaining -= length;
+                }
+            }
+        }
+        current = run_end;
+    }
+    return result;
+}
+
 template <bool is_gpu_address>
 void MemoryManager::GetSubmappedRangeImpl(
     GPUVAddr gpu_addr, std::size_t size,
@@ -758,6 +825,11 @@ void MemoryManager::FlushCaching() {
         GetSubmappedRangeImpl<false>(addr, size, page_stash2);
     });
     rasterizer->InnerInvalidation(page_stash2);
+    if (segment_write_tracker) {
+        for (const auto& [dev_addr, size] : page_stash2) {
+            segment_write_tracker->OnWrite(dev_addr, size);
+        }
+    }
     page_stash2.clear();
     accumulator->Clear();
 }
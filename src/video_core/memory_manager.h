@@ -3,10 +3,13 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
+#include <limits>
 #include <map>
 #include <mutex>
 #include <optional>
+#include <span>
 #include <vector>
 #include <boost/container/small_vector.hpp>
 
@@ -33,6 +36,8 @@ class System;
 
 namespace Tegra {
 
+class SegmentWriteTracker;
+
 class MemoryManager final {
 public:
     explicit MemoryManager(Core::System& system_, u64 address_space_bits_ = 40,
@@ -50,6 +55,14 @@ public:
     /// Binds a renderer to the memory manager.
     void BindRasterizer(VideoCore::RasterizerInterface* rasterizer);
 
+    /// Binds the tracker notified of the writes to the memory, along with the rasterizer.
+    void BindSegmentWriteTracker(SegmentWriteTracker* segment_write_tracker);
+
+    /// Returns a value changing whenever the page table is updated.
+    [[nodiscard]] u64 TranslationGeneration() const {
+        return translation_generation.load(std::memory_order_acquire);
+    }
+
     [[nodiscard]] std::optional<DAddr> GpuToCpuAddress(GPUVAddr addr) const;
 
     [[nodiscard]] std::optional<DAddr> GpuToCpuAddress(GPUVAddr addr, std::size_t size) const;
@@ -127,6 +140,14 @@ public:
     boost::container::small_vector<std::pair<GPUVAddr, std::size_t>, 32> GetSubmappedRange(
         GPUVAddr gpu_addr, std::size_t size) const;
 
+    /**
+     * Returns the host memory backing a gpu region in a single walk, as pairs of the gpu address
+     * of each piece and its host span. Pieces contiguous in host memory are merged and unmapped
+     * pieces are skipped.
+     */
+    boost::container::small_vector<std::pair<GPUVAddr, std::span<u8>>, 32> GetHostSpans(
+        GPUVAddr gpu_addr, std::size_t size);
+
     GPUVAddr Map(GPUVAddr gpu_addr, DAddr dev_addr, std::size_t size,
                  PTEKind kind = PTEKind::INVALID, bool is_big_pages = true);
     GPUVAddr MapSparse(GPUVAddr gpu_addr, std::size_t size, bool is_big_pages = true);
@@ -170,6 +191,41 @@ private:
     void WriteBlockImpl(GPUVAddr gpu_dest_addr, const void* src_buffer, std::size_t size,
                         VideoCommon::CacheType which);
 
+    /// Range of gpu addresses that is either unmapped or mapped to contiguous device addresses.
+    struct TranslationRun {
+        GPUVAddr begin;
+        GPUVAddr end;
+        DAddr dev_begin;
+        bool is_mapped;
+        /// Set when the walk stopped before the mapping stopped being contiguous.
+        bool is_extendable;
+    };
+
+    struct TranslationCacheEntry {
+        size_t manager_id = std::numeric_limits<size_t>::max();
+        u64 generation{};
+        TranslationRun run{};
+    };
+
+    static constexpr size_t translation_cache_size = 256;
+    /// Ranges spanning up to this many big pages are walked without the cache.
+    static constexpr u64 uncached_walk_pages = 4;
+
+    /// Returns a run containing gpu_addr from the cache of the calling thread, or walks one that
+    /// starts at gpu_addr and extends up to gpu_end when mapped.
+    [[nodiscard]] TranslationRun FindRun(GPUVAddr gpu_addr, GPUVAddr gpu_end) const;
+
+    /// Translates the page containing gpu_addr, returning false when it is not mapped. The step
+    /// is the distance to the end of the page.
+    inline bool TranslatePage(GPUVAddr gpu_addr, DAddr& dev_addr, u64& step) const;
+
+    /// Walks the page tables from gpu_addr until the mapping stops being contiguous or gpu_end
+    /// is reached.
+    [[nodiscard]] TranslationRun WalkRun(GPUVAddr gpu_addr, GPUVAddr gpu_end) const;
+
+    /// Cache of recent translations, shared by the memory managers used by a thread.
+    static std::array<TranslationCacheEntry, translation_cache_size>& ThreadTranslationCache();
+
     template <bool is_big_page>
     [[nodiscard]] std::size_t PageEntryIndex(GPUVAddr gpu_addr) const {
         if constexpr (is_big_page) {
@@ -207,6 +263,10 @@ private:
     u64 big_page_table_mask;
 
     VideoCore::RasterizerInterface* rasterizer = nullptr;
+    SegmentWriteTracker* segment_write_tracker = nullptr;
+
+    /// Invalidates the caches of the rasterizer and the segments over a written range.
+    void InvalidateWrittenRegion(DAddr dev_addr, size_t size, VideoCommon::CacheType which) const;
 
     enum class EntryType : u64 {
         Free = 0,
@@ -244,6 +304,9 @@ private:
     static constexpr size_t continuous_bits = 64;
 
     const size_t unique_identifier;
+
+    /// Incremented on every page table update, invalidating the cached translations.
+    std::atomic<u64> translation_generation{};
     std::unique_ptr<VideoCommon::InvalidationAccumulator> accumulator;
 
     static std::atomic<size_t> unique_identifier_generator;
@@ -0,0 +1,691 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <istream>
+#include <optional>
+#include <sstream>
+#include <streambuf>
+#include <unordered_map>
+#include <utility>
+
+#include "common/binary_buffer.h"
+#include "common/cityhash.h"
+#include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "video_core/pipeline_cache_file.h"
+
+namespace VideoCommon {
+
+using namespace Common::Literals;
+
+namespace {
+/// Header of the sequential format written before the indexed one
+constexpr std::array<char, 8> LEGACY_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'c', 'a', 'c', 'h'};
+constexpr std::array<char, 8> MAGIC_NUMBER{'c', 'i', 't', 'r', 'o', 'n', 'p', 'c'};
+constexpr u32 FORMAT_VERSION = 2;
+
+/// Environments needed in a file before a compression dictionary is trained for it
+constexpr size_t MIN_DICTIONARY_ENVIRONMENTS = 128;
+constexpr size_t MAX_DICTIONARY_SIZE = 64_KiB;
+constexpr size_t MAX_DICTIONARY_SAMPLES_SIZE = 16_MiB;
+
+struct FileHeader {
+    std::array<char, 8> magic;
+    u32 format_version;
+    u32 cache_version;
+    u32 num_environments;
+    u32 num_pipelines;
+    u32 num_environment_indices;
+    u32 dictionary_size;
+    /// End of the indexed section, pipelines appended later start here
+    u64 journal_offset;
+};
+static_assert(sizeof(FileHeader) == 40);
+
+struct EnvironmentEntry {
+    u128 hash;
+    u64 offset;
+    u32 compressed_size;
+    u32 size;
+};
+static_assert(sizeof(EnvironmentEntry) == 32);
+
+struct PipelineEntry {
+    u64 key_offset;
+    u32 key_size;
+    u32 stage_mask;
+    u32 first_environment;
+    u32 num_environments;
+};
+static_assert(sizeof(PipelineEntry) == 24);
+
+enum class RecordType : u32 {
+    Environment,
+    Pipeline,
+};
+
+/// Header of the records appended after the indexed section
+struct RecordHeader {
+    RecordType type;
+    u32 size;
+};
+static_assert(sizeof(RecordHeader) == 8);
+
+/// Input stream over a region of memory
+class MemoryStreamBuffer : public std::streambuf {
+public:
+    explicit MemoryStreamBuffer(std::span<const u8> data) {
+        // The get area is never written to
+        char* const begin = const_cast<char*>(reinterpret_cast<const char*>(data.data()));
+        setg(begin, begin, begin + data.size());
+    }
+
+protected:
+    pos_type seekoff(off_type offset, std::ios_base::seekdir direction,
+                     std::ios_base::openmode which) override {
+        if ((which & std::ios_base::in) == 0) {
+            return pos_type(off_type(-1));
+        }
+        off_type base = 0;
+        if (direction == std::ios_base::cur) {
+            base = gptr() - eback();
+        } else if (direction == std::ios_base::end) {
+            base = egptr() - eback();
+        }
+        const off_type position = base + offset;
+        if (position < 0 || position > egptr() - eback()) {
+            return pos_type(off_type(-1));
+        }
+        setg(eback(), eback() + position, egptr());
+        return pos_type(position);
+    }
+
+    pos_type seekpos(pos_type position, std::ios_base::openmode which) override {
+        return seekoff(off_type(position), std::ios_base::beg, which);
+    }
+};
+
+struct EnvironmentRecord {
+    u128 hash;
+    u32 size;
+    std::span<const u8> data;
+    /// Environments of legacy files are not compressed
+    bool is_compressed;
+};
+
+struct PipelineRecord {
+    std::span<const u8> key;
+    u32 stage_mask;
+    boost::container::small_vector<u32, 5> environments;
+};
+
+/// Pipelines of a file, pointing to its memory
+struct FileContents {
+    std::span<const u8> dictionary;
+    std::vector<EnvironmentRecord> environments;
+    std::vector<PipelineRecord> pipelines;
+    /// True when the file has to be written again in the current format with a single index
+    bool needs_rewrite{};
+};
+
+u128 HashEnvironment(std::span<const u8> data) {
+    return Common::CityHash128(reinterpret_cast<const char*>(data.data()), data.size());
+}
+
+u32 StageBit(Shader::Stage stage) {
+    return 1U << static_cast<u32>(stage);
+}
+
+bool IsComputeStageMask(u32 stage_mask) {
+    return stage_mask == StageBit(Shader::Stage::Compute);
+}
+
+std::vector<u8> CompressEnvironment(const Common::Compression::ZSTDDictionary* dictionary,
+                                    std::span<const u8> data) {
+    if (dictionary) {
+        return dictionary->Compress(data.data(), data.size());
+    }
+    return Common::Compression::CompressDataZSTDDefault(data.data(), data.size());
+}
+
+std::vector<u8> DecompressEnvironment(const Common::Compression::ZSTDDictionary* dictionary,
+                                      const EnvironmentRecord& environment) {
+    if (!environment.is_compressed) {
+        return std::vector<u8>(environment.data.begin(), environment.data.end());
+    }
+    if (dictionary) {
+        return dictionary->Decompress(environment.data, environment.size);
+    }
+    std::vector<u8> data = Common::Compression::DecompressDataZSTD(environment.data);
+    if (data.size() != environment.size) {
+        return {};
+    }
+    return data;
+}
+
+std::optional<FileContents> ParseLegacyFile(std::span<const u8> data, size_t compute_key_size,
+                                            size_t graphics_key_size) {
+    FileContents contents;
+    contents.needs_rewrite = true;
+    std::unordered_map<u128, u32, EnvironmentHash> environment_indices;
+
+    MemoryStreamBuffer buffer{data};
+    std::istream stream{&buffer};
+    stream.exceptions(std::ios_base::failbit);
+    stream.seekg(LEGACY_MAGIC_NUMBER.size() + sizeof(u32));
+    try {
+        while (static_cast<size_t>(stream.tellg()) != data.size()) {
+            u32 num_envs{};
+            stream.read(reinterpret_cast<char*>(&num_envs), sizeof(num_envs));
+            PipelineRecord pipeline{};
+            for (u32 index = 0; index < num_envs; ++index) {
+                const size_t begin = static_cast<size_t>(stream.tellg());
+                FileEnvironment env;
+                env.Deserialize(stream);
+                const size_t end = static_cast<size_t>(stream.tellg());
+
+                const std::span<const u8> env_data = data.subspan(begin, end - begin);
+                const u128 hash = HashEnvironment(env_data);
+                const auto [it, is_new] = environment_indices.try_emplace(
+                    hash, static_cast<u32>(contents.environments.size()));
+                if (is_new) {
+                    contents.environments.push_back({
+                        .hash = hash,
+                        .size = static_cast<u32>(env_data.size()),
+                        .data = env_data,
+                        .is_compressed = false,
+                    });
+                }
+                pipeline.environments.push_back(it->second);
+                pipeline.stage_mask |= StageBit(env.ShaderStage());
+            }
+            const size_t key_size =
+                IsComputeStageMask(pipeline.stage_mask) ? compute_key_size : graphics_key_size;
+            const size_t key_offset = static_cast<size_t>(stream.tellg());
+            if (num_envs == 0 || data.size() - key_offset < key_size) {
+                throw std::ios_base::failure("Truncated pipeline");
+            }
+            pipeline.key = data.subspan(key_offset, key_size);
+            stream.seekg(static_cast<std::streamoff>(key_offset + key_size));
+            contents.pipelines.push_back(std::move(pipeline));
+        }
+    } catch (const std::ios_base::failure& e) {
+        // Keep the pipelines written before the corrupted one
+        LOG_ERROR(Common_Filesystem, "Pipeline cache file is truncated: {}", e.what());
+    }
+    return contents;
+}
+
+/// Reads the pipelines appended after the indexed section of a file
+void ParseJournal(std::span<const u8> data, size_t journal_offset, FileContents& contents) {
+    std::unordered_map<u128, u32, EnvironmentHash> environment_indices;
+    for (u32 index = 0; index < contents.environments.size(); ++index) {
+        environment_indices.emplace(contents.environments[index].hash, index);
+    }
+    Common::BinaryReader reader{data, journal_offset};
+    while (!reader.IsEnd()) {
+        RecordHeader header{};
+        std::span<const u8> body;
+        if (!reader.Pop(header) || !reader.PopBytes(header.size, body)) {
+            // Emulation stopped while the record was written
+            LOG_WARNING(Common_Filesystem, "Pipeline cache file ends with a partial record");
+            break;
+        }
+        contents.needs_rewrite = true;
+
+        Common::BinaryReader record{body};
+        if (header.type == RecordType::Environment) {
+            EnvironmentRecord environment{};
+            environment.is_compressed = true;
+            if (!record.Pop(environment.hash) || !record.Pop(environment.size)) {
+                continue;
+            }
+            record.PopBytes(body.size() - record.Offset(), environment.data);
+            if (environment_indices.try_emplace(environment.hash, contents.environments.size())
+                    .second) {
+                contents.environments.push_back(environment);
+            }
+            continue;
+        }
+        PipelineRecord pipeline{};
+        u32 num_environments{};
+        if (!record.Pop(pipeline.stage_mask) || !record.Pop(num_environments)) {
+            continue;
+        }
+        bool is_complete = num_environments != 0;
+        for (u32 index = 0; index < num_environments && is_complete; ++index) {
+            u128 hash{};
+            const auto it = record.Pop(hash) ? environment_indices.find(hash)
+                                             : environment_indices.end();
+            is_complete = it != environment_indices.end();
+            if (is_complete) {
+                pipeline.environments.push_back(it->second);
+            }
+        }
+        if (is_complete) {
+            record.PopBytes(body.size() - record.Offset(), pipeline.key);
+            contents.pipelines.push_back(std::move(pipeline));
+        }
+    }
+}
+
+std::optional<FileContents> ParseFile(std::span<const u8> data) {
+    FileHeader header{};
+    Common::BinaryReader reader{data};
+    if (!reader.Pop(header) || header.journal_offset > data.size() ||
+        header.journal_offset < reader.Offset()) {
+        return std::nullopt;
+    }
+    const std::span<const u8> indexed = data.first(header.journal_offset);
+    // Check the counts fit in the indexed section before allocating the tables
+    const u64 tables_size = u64{header.dictionary_size} +
+                            u64{header.num_environments} * sizeof(EnvironmentEntry) +
+                            u64{header.num_pipelines} * sizeof(PipelineEntry) +
+                            u64{header.num_environment_indices} * sizeof(u32);
+    if (tables_size > indexed.size() - reader.Offset()) {
+        return std::nullopt;
+    }
+    FileContents contents;
+    std::vector<EnvironmentEntry> environment_entries(header.num_environments);
+    std::vector<PipelineEntry> pipeline_entries(header.num_pipelines);
+    std::vector<u32> environment_indices(header.num_environment_indices);
+    Common::BinaryReader index{indexed, reader.Offset()};
+    if (!index.PopBytes(header.dictionary_size, contents.dictionary)) {
+        return std::nullopt;
+    }
+    const auto pop_entries = [&index](auto& entries) {
+        std::span<const u8> bytes;
+        if (!index.PopBytes(entries.size() * sizeof(entries[0]), bytes)) {
+            return false;
+        }
+        std::memcpy(entries.data(), bytes.data(), bytes.size());
+        return true;
+    };
+    if (!pop_entries(environment_entries) || !pop_entries(pipeline_entries) ||
+        !pop_entries(environment_indices)) {
+        return std::nullopt;
+    }
+    const auto is_in_bounds{[&](size_t offset, size_t size) {
+        return offset <= indexed.size() && indexed.size() - offset >= size;
+    }};
+    for (const EnvironmentEntry& entry : environment_entries) {
+        if (!is_in_bounds(entry.offset, entry.compressed_size)) {
+            return std::nullopt;
+        }
+        contents.environments.push_back({
+            .hash = entry.hash,
+            .size = entry.size,
+            .data = indexed.subspan(entry.offset, entry.compressed_size),
+            .is_compressed = true,
+        });
+    }
+    for (const PipelineEntry& entry : pipeline_entries) {
+        if (!is_in_bounds(entry.key_offset, entry.key_size) ||
+            entry.first_environment > environment_indices.size() ||
+            environment_indices.size() - entry.first_environment < entry.num_environments) {
+            return std::nullopt;
+        }
+        PipelineRecord& pipeline = contents.pipelines.emplace_back();
+        pipeline.key = indexed.subspan(entry.key_offset, entry.key_size);
+        pipeline.stage_mask = entry.stage_mask;
+        for (u32 index_offset = 0; index_offset < entry.num_environments; ++index_offset) {
+            const u32 environment = environment_indices[entry.first_environment + index_offset];
+            if (environment >= contents.environments.size()) {
+                return std::nullopt;
+            }
+            pipeline.environments.push_back(environment);
+        }
+    }
+    ParseJournal(data, header.journal_offset, contents);
+    return contents;
+}
+
+/// Trains a dictionary on the environments of a file that does not have one yet
+std::vector<u8> TrainDictionary(const FileContents& contents) {
+    if (!contents.dictionary.empty() ||
+        contents.environments.size() < MIN_DICTIONARY_ENVIRONMENTS) {
+        return {};
+    }
+    std::vector<std::vector<u8>> samples;
+    size_t samples_size = 0;
+    for (const EnvironmentRecord& environment : contents.environments) {
+        if (samples_size >= MAX_DICTIONARY_SAMPLES_SIZE) {
+            break;
+        }
+        std::vector<u8> sample = DecompressEnvironment(nullptr, environment);
+        samples_size += sample.size();
+        samples.push_back(std::move(sample));
+    }
+    return Common::Compression::TrainDictionaryZSTD(samples, MAX_DICTIONARY_SIZE);
+}
+
+/// Writes the contents of a file in the current format, with every pipeline in the index
+std::vector<u8> BuildFile(const FileContents& contents, u32 cache_version) {
+    std::vector<u8> new_dictionary = TrainDictionary(contents);
+    const bool recompress = !new_dictionary.empty();
+    const std::span<const u8> dictionary_data = recompress ? new_dictionary : contents.dictionary;
+    std::optional<Common::Compression::ZSTDDictionary> dictionary;
+    if (!dictionary_data.empty()) {
+        dictionary.emplace(std::vector<u8>(dictionary_data.begin(), dictionary_data.end()));
+    }
+    std::vector<u32> environment_indices;
+    for (const PipelineRecord& pipeline : contents.pipelines) {
+        environment_indices.insert(environment_indices.end(), pipeline.environments.begin(),
+                                   pipeline.environments.end());
+    }
+    Common::BinaryWriter writer;
+    writer.Push(FileHeader{
+        .magic = MAGIC_NUMBER,
+        .format_version = FORMAT_VERSION,
+        .cache_version = cache_version,
+        .num_environments = static_cast<u32>(contents.environments.size()),
+        .num_pipelines = static_cast<u32>(contents.pipelines.size()),
+        .num_environment_indices = static_cast<u32>(environment_indices.size()),
+        .dictionary_size = static_cast<u32>(dictionary_data.size()),
+        .journal_offset = 0,
+    });
+    writer.PushBytes(dictionary_data);
+
+    // Reserve the index, it is filled once the payloads are placed
+    const size_t environments_offset = writer.Size();
+    const size_t pipelines_offset =
+        environments_offset + contents.environments.size() * sizeof(EnvironmentEntry);
+    const size_t indices_offset =
+        pipelines_offset + contents.pipelines.size() * sizeof(PipelineEntry);
+    writer.Buffer().resize(indices_offset + environment_indices.size() * sizeof(u32));
+    std::memcpy(writer.Buffer().data() + indices_offset, environment_indices.data(),
+                environment_indices.size() * sizeof(u32));
+
+    for (size_t index = 0; index < contents.environments.size(); ++index) {
+        const EnvironmentRecord& environment = contents.environments[index];
+        std::vector<u8> recompressed;
+        std::span<const u8> payload = environment.data;
+        if (recompress || !environment.is_compressed) {
+            const std::vector<u8> data = DecompressEnvironment(nullptr, environment);
+            recompressed = CompressEnvironment(dictionary ? &*dictionary : nullptr, data);
+            payload = recompressed;
+        }
+        writer.Overwrite(environments_offset + index * sizeof(EnvironmentEntry),
+                         EnvironmentEntry{
+                             .hash = environment.hash,
+                             .offset = writer.Size(),
+                             .compressed_size = static_cast<u32>(payload.size()),
+                             .size = environment.size,
+                         });
+        writer.PushBytes(payload);
+    }
+    u32 first_environment = 0;
+    for (size_t index = 0; index < contents.pipelines.size(); ++index) {
+        const PipelineRecord& pipeline = contents.pipelines[index];
+        const u32 num_environments = static_cast<u32>(pipeline.environments.size());
+        writer.Overwrite(pipelines_offset + index * sizeof(PipelineEntry),
+                         PipelineEntry{
+                             .key_offset = writer.Size(),
+                             .key_size = static_cast<u32>(pipeline.key.size()),
+                             .stage_mask = pipeline.stage_mask,
+                             .first_environment = first_environment,
+                             .num_environments = num_environments,
+                         });
+        writer.PushBytes(pipeline.key);
+        first_environment += num_environments;
+    }
+    writer.Overwrite(offsetof(FileHeader, journal_offset), static_cast<u64>(writer.Size()));
+    return std::move(writer.Buffer());
+}
+
+bool WriteFile(const std::filesystem::path& filename, std::span<const u8> data) {
+    std::filesystem::path temporary = filename;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temporary, filename, ec);
+    return !ec;
+}
+
+void RemoveFile(const std::filesystem::path& filename) {
+    if (!Common::FS::RemoveFile(filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+    }
+}
+} // Anonymous namespace
+
+/// Memory of a loaded cache file, kept alive until every pipeline read from it is loaded
+struct PipelineCacheStorage {
+    std::unique_ptr<Common::FS::MappedFile> file;
+    std::vector<u8> image;
+    std::shared_ptr<const Common::Compression::ZSTDDictionary> dictionary;
+    std::vector<EnvironmentRecord> environments;
+};
+
+std::vector<FileEnvironment> CachedPipeline::LoadEnvironments() const {
+    std::vector<FileEnvironment> envs(environments.size());
+    for (size_t index = 0; index < environments.size(); ++index) {
+        const EnvironmentRecord& environment = storage->environments[environments[index]];
+        const std::vector<u8> data = DecompressEnvironment(storage->dictionary.get(), environment);
+        if (data.size() != environment.size || HashEnvironment(data) != environment.hash) {
+            LOG_ERROR(Common_Filesystem, "Corrupted shader environment in the pipeline cache");
+            return {};
+        }
+        MemoryStreamBuffer buffer{data};
+        std::istream stream{&buffer};
+        stream.exceptions(std::ios_base::failbit);
+        try {
+            envs[index].Deserialize(stream);
+        } catch (const std::ios_base::failure& e) {
+            LOG_ERROR(Common_Filesystem, "Invalid shader environment in the pipeline cache: {}",
+                      e.what());
+            return {};
+        }
+    }
+    return envs;
+}
+
+PipelineCacheFile::PipelineCacheFile() = default;
+
+PipelineCacheFile::~PipelineCacheFile() = default;
+
+void PipelineCacheFile::Load(const std::filesystem::path& filename_, u32 cache_version_,
+                             size_t compute_key_size, size_t graphics_key_size,
+                             std::stop_token stop_loading, LoadFunction load_compute,
+                             LoadFunction load_graphics) {
+    {
+        std::scoped_lock lock{mutex};
+        filename = filename_;
+        cache_version = cache_version_;
+        dictionary.reset();
+        stored_environments.clear();
+    }
+    auto storage = std::make_shared<PipelineCacheStorage>();
+    storage->file = std::make_unique<Common::FS::MappedFile>(filename);
+    const std::span<const u8> file_data = storage->file->Data();
+    if (file_data.empty()) {
+        return;
+    }
+
+    std::array<char, 8> magic_number{};
+    u32 format_cache_version{};
+    Common::BinaryReader reader{file_data};
+    reader.Pop(magic_number);
+    if (magic_number == MAGIC_NUMBER) {
+        reader.Pop(format_cache_version);
+        if (format_cache_version != FORMAT_VERSION) {
+            format_cache_version = 0;
+        } else {
+            reader.Pop(format_cache_version);
+        }
+    } else if (magic_number == LEGACY_MAGIC_NUMBER) {
+        reader.Pop(format_cache_version);
+    } else {
+        storage.reset();
+        LOG_ERROR(Common_Filesystem, "Invalid pipeline cache file");
+        RemoveFile(filename);
+        return;
+    }
+    if (format_cache_version != cache_version) {
+        storage.reset();
+        LOG_INFO(Common_Filesystem, "Deleting old pipeline cache");
+        RemoveFile(filename);
+        return;
+    }
+
+    std::optional<FileContents> contents =
+        magic_number == LEGACY_MAGIC_NUMBER
+            ? ParseLegacyFile(file_data, compute_key_size, graphics_key_size)
+            : ParseFile(file_data);
+    if (!contents) {
+        storage.reset();
+        LOG_ERROR(Common_Filesystem, "Invalid pipeline cache file");
+        RemoveFile(filename);
+        return;
+    }
+    bool is_file_valid = true;
+    if (contents->needs_rewrite) {
+        if (magic_number == LEGACY_MAGIC_NUMBER) {
+            LOG_INFO(Common_Filesystem, "Migrating the pipeline cache to the indexed format");
+        }
+        // Release the mapping before the file is replaced, the new contents stay in memory
+        storage->image = BuildFile(*contents, cache_version);
+        storage->file.reset();
+        is_file_valid = WriteFile(filename, storage->image);
+        if (!is_file_valid) {
+            LOG_ERROR(Common_Filesystem, "Failed to write pipeline cache file {}",
+                      Common::FS::PathToUTF8String(filename));
+            RemoveFile(filename);
+        }
+        contents = ParseFile(storage->image);
+    }
+    if (!contents->dictionary.empty()) {
+        storage->dictionary = std::make_shared<const Common::Compression::ZSTDDictionary>(
+            std::vector<u8>(contents->dictionary.begin(), contents->dictionary.end()));
+    }
+    storage->environments = std::move(contents->environments);
+    if (is_file_valid) {
+        // Pipelines built from now on are appended with the same dictionary
+        std::scoped_lock lock{mutex};
+        dictionary = storage->dictionary;
+        for (const EnvironmentRecord& environment : storage->environments) {
+            stored_environments.insert(environment.hash);
+        }
+    }
+    LOG_INFO(Common_Filesystem, "Pipeline cache has {} pipelines using {} shader environments",
+             contents->pipelines.size(), storage->environments.size());
+
+    for (PipelineRecord& record : contents->pipelines) {
+        if (stop_loading.stop_requested()) {
+            return;
+        }
+        CachedPipeline pipeline;
+        pipeline.storage = storage;
+        pipeline.key_data = record.key;
+        pipeline.environments = std::move(record.environments);
+        pipeline.stage_mask = record.stage_mask;
+        if (IsComputeStageMask(pipeline.stage_mask)) {
+            load_compute(std::move(pipeline));
+        } else {
+            load_graphics(std::move(pipeline));
+        }
+    }
+}
+
+void PipelineCacheFile::SerializePipeline(std::span<const char> key,
+                                          std::span<const GenericEnvironment* const> envs) {
+    if (!std::ranges::all_of(envs, &GenericEnvironment::CanBeSerialized)) {
+        return;
+    }
+    std::vector<std::vector<u8>> environments;
+    u32 stage_mask = 0;
+    for (const GenericEnvironment* const env : envs) {
+        std::ostringstream stream;
+        env->Serialize(stream);
+        const std::string data = std::move(stream).str();
+        environments.emplace_back(data.begin(), data.end());
+        stage_mask |= StageBit(env->ShaderStage());
+    }
+    AppendPipeline(key, environments, stage_mask);
+}
+
+void PipelineCacheFile::AppendPipeline(std::span<const char> key,
+                                       std::span<const std::vector<u8>> environments,
+                                       u32 stage_mask) try {
+    std::scoped_lock lock{mutex};
+    if (filename.empty()) {
+        return;
+    }
+    std::ofstream file(filename, std::ios::binary | std::ios::ate | std::ios::app);
+    file.exceptions(std::ifstream::failbit);
+    if (!file.is_open()) {
+        LOG_ERROR(Common_Filesystem, "Failed to open pipeline cache file {}",
+                  Common::FS::PathToUTF8String(filename));
+        return;
+    }
+    Common::BinaryWriter writer;
+    if (file.tellp() == 0) {
+        // The file was deleted or never existed, start over without a dictionary
+        dictionary.reset();
+        stored_environments.clear();
+        writer.Push(FileHeader{
+            .magic = MAGIC_NUMBER,
+            .format_version = FORMAT_VERSION,
+            .cache_version = cache_version,
+            .num_environments = 0,
+            .num_pipelines = 0,
+            .num_environment_indices = 0,
+            .dictionary_size = 0,
+            .journal_offset = sizeof(FileHeader),
+        });
+    }
+    std::vector<u128> hashes;
+    for (const std::vector<u8>& environment : environments) {
+        const u128 hash = HashEnvironment(environment);
+        hashes.push_back(hash);
+        if (!stored_environments.insert(hash).second) {
+            continue;
+        }
+        const std::vector<u8> compressed = CompressEnvironment(dictionary.get(), environment);
+        const u32 size = static_cast<u32>(environment.size());
+        writer.Push(RecordHeader{
+            .type = RecordType::Environment,
+            .size = static_cast<u32>(sizeof(hash) + sizeof(size) + compressed.size()),
+        });
+        writer.Push(hash);
+        writer.Push(size);
+        writer.PushBytes(compressed);
+    }
+    const u32 num_environments = static_cast<u32>(hashes.size());
+    writer.Push(RecordHeader{
+        .type = RecordType::Pipeline,
+        .size = static_cast<u32>(sizeof(stage_mask) + sizeof(num_environments) +
+                                 hashes.size() * sizeof(u128) + key.size()),
+    });
+    writer.Push(stage_mask);
+    writer.Push(num_environments);
+    for (const u128& hash : hashes) {
+        writer.Push(hash);
+    }
+    writer.PushBytes(std::span(reinterpret_cast<const u8*>(key.data()), key.size()));
+
+    // Records are written at once so a partial write can only affect the last one
+    file.write(reinterpret_cast<const char*>(writer.Buffer().data()),
+               static_cast<std::streamsize>(writer.Size()));
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    RemoveFile(filename);
+}
+
+} // namespace VideoCommon
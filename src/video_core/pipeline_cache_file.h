@@ -0,0 +1,141 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/unique_function.h"
+#include "video_core/shader_environment.h"
+
+namespace Common::Compression {
+class ZSTDDictionary;
+}
+
+namespace VideoCommon {
+
+struct PipelineCacheStorage;
+
+/// Hasher for the 128-bit hashes identifying shader environments
+struct EnvironmentHash {
+    size_t operator()(const u128& hash) const noexcept {
+        return static_cast<size_t>(hash[0]);
+    }
+};
+
+/// Pipeline read from a cache file, its environments are only decompressed when loaded.
+class CachedPipeline {
+public:
+    /// Copies the key of the pipeline, returns false when the stored key has another size.
+    template <typename Key>
+    [[nodiscard]] bool ReadKey(Key& key) const {
+        static_assert(std::is_trivially_copyable_v<Key>);
+        if (key_data.size() != sizeof(Key)) {
+            return false;
+        }
+        std::memcpy(&key, key_data.data(), sizeof(Key));
+        return true;
+    }
+
+    /// Returns the shader stages of the pipeline, one bit per Shader::Stage.
+    [[nodiscard]] u32 StageMask() const noexcept {
+        return stage_mask;
+    }
+
+    /// Decompresses and deserializes the environments of the pipeline, in stage order.
+    /// Returns an empty vector when they are corrupted.
+    [[nodiscard]] std::vector<FileEnvironment> LoadEnvironments() const;
+
+private:
+    friend class PipelineCacheFile;
+
+    std::shared_ptr<const PipelineCacheStorage> storage;
+    std::span<const u8> key_data;
+    boost::container::small_vector<u32, 5> environments;
+    u32 stage_mask{};
+};
+
+/**
+ * Disk cache of the pipelines built by a renderer, with the environments needed to build them
+ * again.
+ *
+ * The file starts with an index of the shader environments and of the pipelines, so it can be
+ * memory mapped and every pipeline handed to the workers without reading the rest of the file.
+ * Environments are stored once no matter how many pipelines use them, each compressed on its own
+ * with a dictionary shared by the whole file. Pipelines built while playing are appended after
+ * the indexed section, and they are merged into the index the next time the file is loaded.
+ *
+ * Files written in the previous sequential format are migrated when loaded, files of another
+ * cache version are deleted.
+ */
+class PipelineCacheFile {
+public:
+    using LoadFunction = Common::UniqueFunction<void, CachedPipeline>;
+
+    PipelineCacheFile();
+    ~PipelineCacheFile();
+
+    /**
+     * Reads the pipelines of a cache file and passes each one to load_compute or load_graphics.
+     * Pipelines serialized afterwards are appended to this file.
+     *
+     * @param filename_      Path of the cache file, it does not have to exist
+     * @param cache_version_ Version of the keys and environments of the renderer
+     * @param stop_loading   Stops passing pipelines when requested
+     * @param load_compute   Called for each compute pipeline
+     * @param load_graphics  Called for each graphics pipeline
+     */
+    template <typename ComputeKey, typename GraphicsKey>
+    void Load(const std::filesystem::path& filename_, u32 cache_version_,
+              std::stop_token stop_loading, LoadFunction load_compute,
+              LoadFunction load_graphics) {
+        Load(filename_, cache_version_, sizeof(ComputeKey), sizeof(GraphicsKey), stop_loading,
+             std::move(load_compute), std::move(load_graphics));
+    }
+
+    /// Returns true when pipelines can be serialized, once a file has been loaded.
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return !filename.empty();
+    }
+
+    /// Appends a pipeline to the file, environments already in the file are not written again.
+    void SerializePipeline(std::span<const char> key,
+                           std::span<const GenericEnvironment* const> envs);
+
+    template <typename Key, typename Envs>
+    void SerializePipeline(const Key& key, const Envs& envs) {
+        static_assert(std::is_trivially_copyable_v<Key>);
+        static_assert(std::has_unique_object_representations_v<Key>);
+        SerializePipeline(std::span(reinterpret_cast<const char*>(&key), sizeof(key)),
+                          std::span(envs.data(), envs.size()));
+    }
+
+    /// Appends a pipeline with environments that are already serialized.
+    void AppendPipeline(std::span<const char> key, std::span<const std::vector<u8>> environments,
+                        u32 stage_mask);
+
+private:
+    void Load(const std::filesystem::path& filename_, u32 cache_version_, size_t compute_key_size,
+              size_t graphics_key_size, std::stop_token stop_loading, LoadFunction load_compute,
+              LoadFunction load_graphics);
+
+    std::filesystem::path filename;
+    u32 cache_version{};
+
+    std::mutex mutex;
+    std::shared_ptr<const Common::Compression::ZSTDDictionary> dictionary;
+    std::unordered_set<u128, EnvironmentHash> stored_environments;
+};
+
+} // namespace VideoCommon
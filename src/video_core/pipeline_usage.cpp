@@ -0,0 +1,158 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <limits>
+#include <tuple>
+
+#include "common/binary_buffer.h"
+#include "common/fs/fs.h"
+#include "common/fs/mapped_file.h"
+#include "common/fs/path_util.h"
+#include "common/logging/log.h"
+#include "video_core/pipeline_usage.h"
+
+namespace VideoCommon {
+
+namespace {
+constexpr std::array<char, 8> MAGIC_NUMBER{'c', 'i', 't', 'r', 'o', 'n', 'p', 'u'};
+constexpr u32 FORMAT_VERSION = 1;
+
+struct FileEntry {
+    u64 key_hash;
+    u32 first_use_ms;
+    u32 hits;
+};
+static_assert(sizeof(FileEntry) == 16);
+} // Anonymous namespace
+
+void PipelineUsage::Load(const std::filesystem::path& filename_) {
+    filename = filename_;
+    previous_usage.clear();
+    usage.clear();
+
+    const Common::FS::MappedFile file{filename};
+    const std::span<const u8> data = file.Data();
+    if (data.empty()) {
+        return;
+    }
+    std::array<char, 8> magic_number{};
+    u32 format_version{};
+    std::vector<FileEntry> entries;
+    Common::BinaryReader reader{data};
+    if (!reader.Pop(magic_number) || magic_number != MAGIC_NUMBER ||
+        !reader.Pop(format_version) || format_version != FORMAT_VERSION) {
+        LOG_INFO(Common_Filesystem, "Ignoring invalid pipeline usage file");
+        return;
+    }
+    // Counts larger than the rest of the file are rejected before allocating the entries
+    if (!reader.PopArray(entries) || reader.Offset() != data.size()) {
+        LOG_ERROR(Common_Filesystem, "Invalid pipeline usage file");
+        return;
+    }
+    for (const FileEntry& entry : entries) {
+        previous_usage.insert_or_assign(entry.key_hash, Entry{entry.first_use_ms, entry.hits});
+    }
+}
+
+void PipelineUsage::Save() const try {
+    const Statistics statistics{GetStatistics()};
+    if (statistics.hits + statistics.misses != 0) {
+        LOG_INFO(Render, "Pipeline cache: {} hits, {} misses, {} pipelines used", statistics.hits,
+                 statistics.misses, usage.size());
+    }
+    if (filename.empty() || usage.empty()) {
+        return;
+    }
+    // Pipelines not used in this session keep the usage of the session that last used them
+    std::vector<FileEntry> entries;
+    entries.reserve(usage.size() + previous_usage.size());
+    const auto push_entry{[&entries](u64 key_hash, const Entry& entry) {
+        entries.push_back({
+            .key_hash = key_hash,
+            .first_use_ms = entry.first_use_ms,
+            .hits = entry.hits,
+        });
+    }};
+    for (const auto& [key_hash, entry] : usage) {
+        push_entry(key_hash, entry);
+    }
+    for (const auto& [key_hash, entry] : previous_usage) {
+        if (!usage.contains(key_hash)) {
+            push_entry(key_hash, entry);
+        }
+    }
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    file.exceptions(std::ifstream::failbit);
+    const u32 num_entries = static_cast<u32>(entries.size());
+    file.write(MAGIC_NUMBER.data(), MAGIC_NUMBER.size())
+        .write(reinterpret_cast<const char*>(&FORMAT_VERSION), sizeof(FORMAT_VERSION))
+        .write(reinterpret_cast<const char*>(&num_entries), sizeof(num_entries))
+        .write(reinterpret_cast<const char*>(entries.data()),
+               static_cast<std::streamsize>(entries.size() * sizeof(FileEntry)));
+
+} catch (const std::ios_base::failure& e) {
+    LOG_ERROR(Common_Filesystem, "{}", e.what());
+    if (!Common::FS::RemoveFile(filename)) {
+        LOG_ERROR(Common_Filesystem, "Failed to delete pipeline usage file {}",
+                  Common::FS::PathToUTF8String(filename));
+    }
+}
+
+PipelineUsage::WarmupOrder PipelineUsage::Prioritize(std::span<const u64> key_hashes) const {
+    WarmupOrder order;
+    std::vector<std::tuple<u32, u32, size_t>> used;
+    std::vector<size_t> unused;
+    for (size_t index = 0; index < key_hashes.size(); ++index) {
+        const auto it = previous_usage.find(key_hashes[index]);
+        if (it == previous_usage.end()) {
+            unused.push_back(index);
+            continue;
+        }
+        // Sort by first use, then by the most looked up pipelines
+        const u32 inverse_hits = std::numeric_limits<u32>::max() - it->second.hits;
+        used.emplace_back(it->second.first_use_ms, inverse_hits, index);
+    }
+    if (used.empty()) {
+        // Nothing is known about these pipelines, build them all before the title starts
+        order.synchronous = std::move(unused);
+        return order;
+    }
+    std::ranges::sort(used);
+    constexpr u32 synchronous_time_ms = static_cast<u32>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(SYNCHRONOUS_WARMUP_TIME).count());
+    for (const auto& [first_use_ms, inverse_hits, index] : used) {
+        if (first_use_ms < synchronous_time_ms) {
+            order.synchronous.push_back(index);
+        } else {
+            order.background.push_back(index);
+        }
+    }
+    order.background.insert(order.background.end(), unused.begin(), unused.end());
+    return order;
+}
+
+void PipelineUsage::StartSession() {
+    session_start = std::chrono::steady_clock::now();
+}
+
+void PipelineUsage::RecordLookup(u64 key_hash, bool is_hit) {
+    (is_hit ? hits : misses).fetch_add(1, std::memory_order_relaxed);
+    const auto it = usage.find(key_hash);
+    if (it != usage.end()) {
+        it->second.hits = std::min(it->second.hits, std::numeric_limits<u32>::max() - 1) + 1;
+        return;
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - session_start);
+    usage.emplace(key_hash,
+                  Entry{
+                      .first_use_ms = static_cast<u32>(std::min<s64>(
+                          elapsed.count(), std::numeric_limits<u32>::max())),
+                      .hits = 1,
+                  });
+}
+
+} // namespace VideoCommon
@@ -0,0 +1,90 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+
+namespace VideoCommon {
+
+/**
+ * Records when the pipelines of a title are first needed in a session and how many times they
+ * are looked up, so the next boot builds the pipelines needed in the first seconds of gameplay
+ * before the title starts and leaves the rest to background workers.
+ *
+ * Pipelines are identified by the hash of their key. Lookups are recorded by the thread using
+ * the pipelines, statistics can be read from any thread.
+ */
+class PipelineUsage {
+public:
+    /// Pipelines gameplay needs within this time of the start of a session are built at boot
+    static constexpr std::chrono::seconds SYNCHRONOUS_WARMUP_TIME{10};
+
+    /// Indices of the cached pipelines in the order they have to be built
+    struct WarmupOrder {
+        /// Built before the title starts
+        std::vector<size_t> synchronous;
+        /// Built by background workers while the title runs
+        std::vector<size_t> background;
+    };
+
+    struct Statistics {
+        /// Lookups of pipelines that were already built
+        u64 hits{};
+        /// Lookups of pipelines that had to be built
+        u64 misses{};
+    };
+
+    /// Reads the usage recorded by previous sessions. Missing and invalid files load as no usage.
+    void Load(const std::filesystem::path& filename_);
+
+    /// Writes the usage of this session, merged with the pipelines it did not use.
+    void Save() const;
+
+    /**
+     * Orders cached pipelines by their first use in previous sessions. Pipelines that were not
+     * used are built last in the background, when there is no usage at all every pipeline is
+     * built at boot.
+     *
+     * @param key_hashes  Hash of the key of each cached pipeline, in the order of the cache
+     */
+    [[nodiscard]] WarmupOrder Prioritize(std::span<const u64> key_hashes) const;
+
+    /// Starts timing the first uses of pipelines, called once the title is about to run.
+    void StartSession();
+
+    /// Records a lookup of a pipeline, is_hit is false when it had to be built.
+    void RecordLookup(u64 key_hash, bool is_hit);
+
+    [[nodiscard]] Statistics GetStatistics() const noexcept {
+        return {
+            .hits = hits.load(std::memory_order_relaxed),
+            .misses = misses.load(std::memory_order_relaxed),
+        };
+    }
+
+private:
+    struct Entry {
+        /// Milliseconds from the start of the session to the first lookup
+        u32 first_use_ms;
+        /// Lookups during the session
+        u32 hits;
+    };
+
+    std::filesystem::path filename;
+    std::unordered_map<u64, Entry> previous_usage;
+    std::unordered_map<u64, Entry> usage;
+    std::chrono::steady_clock::time_point session_start{std::chrono::steady_clock::now()};
+
+    std::atomic<u64> hits{};
+    std::atomic<u64> misses{};
+};
+
+} // namespace VideoCommon
@@ -254,6 +254,9 @@ struct BufferCacheParams {
 
     // TODO: Investigate why OpenGL seems to perform worse with persistently mapped buffer uploads
     static constexpr bool USE_MEMORY_MAPS_FOR_UPLOADS = false;
+
+    // Stream buffer regions can be overwritten once the buffer wraps around, while still bound
+    static constexpr bool CAN_REBIND_MAPPED_UNIFORM_BUFFERS = false;
 };
 
 using BufferCache = VideoCommon::BufferCache<BufferCacheParams>;
@@ -83,7 +83,9 @@ RasterizerOpenGL::RasterizerOpenGL(Core::Frontend::EmuWindow& emu_window_, Tegra
                    program_manager, state_tracker, gpu.ShaderNotify()),
       query_cache(*this, device_memory_), accelerate_dma(buffer_cache, texture_cache),
       fence_manager(*this, gpu, texture_cache, buffer_cache, query_cache),
-      blit_image(program_manager_) {}
+      blit_image(program_manager_) {
+    buffer_cache.SetUniformUploadStats(&gpu.UniformUploadStats());
+}
 
 RasterizerOpenGL::~RasterizerOpenGL() = default;
 
@@ -152,6 +154,7 @@ void RasterizerOpenGL::SyncVertexInstances() {
 
 void RasterizerOpenGL::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
                                          const VideoCore::DiskResourceLoadCallback& callback) {
+    texture_cache.LoadDiskResources(title_id);
     shader_cache.LoadDiskResources(title_id, stop_loading, callback);
 }
 
@@ -1,10 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2018 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <atomic>
 #include <fstream>
 #include <functional>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
 
@@ -12,6 +14,7 @@
 #include "common/assert.h"
 #include "common/fs/fs.h"
 #include "common/fs/path_util.h"
+#include "common/literals.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
 #include "common/thread_worker.h"
@@ -21,6 +24,7 @@
 #include "shader_recompiler/frontend/ir/program.h"
 #include "shader_recompiler/frontend/maxwell/control_flow.h"
 #include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "shader_recompiler/ir_opt/passes.h"
 #include "shader_recompiler/profile.h"
 #include "video_core/engines/draw_manager.h"
 #include "video_core/engines/kepler_compute.h"
@@ -43,15 +47,16 @@ using Shader::Maxwell::ConvertLegacyToGeneric;
 using Shader::Maxwell::GenerateGeometryPassthrough;
 using Shader::Maxwell::MergeDualVertexPrograms;
 using Shader::Maxwell::TranslateProgram;
+using VideoCommon::CachedPipeline;
 using VideoCommon::ComputeEnvironment;
 using VideoCommon::FileEnvironment;
 using VideoCommon::GenericEnvironment;
 using VideoCommon::GraphicsEnvironment;
-using VideoCommon::LoadPipelines;
-using VideoCommon::SerializePipeline;
 using Context = ShaderContext::Context;
+using namespace Common::Literals;
 
 constexpr u32 CACHE_VERSION = 10;
+constexpr size_t STAGE_CACHE_SIZE = 64_MiB;
 
 template <typename Container>
 auto MakeSpan(Container& container) {
@@ -69,6 +74,34 @@ Shader::OutputTopology MaxwellToOutputTopology(Maxwell::PrimitiveTopology topolo
     }
 }
 
+/// Builds the key of the shaders and the pipeline state the emitted code of a stage depends on
+u64 StageCacheKey(const GraphicsPipelineKey& key, size_t index) {
+    // Previous stages define the inputs and the bindings of the stage
+    GraphicsPipelineKey stage_key{};
+    std::copy_n(key.unique_hashes.begin(), index + 1, stage_key.unique_hashes.begin());
+    stage_key.gs_input_topology.Assign(key.gs_input_topology);
+    switch (static_cast<Maxwell::ShaderType>(index)) {
+    case Maxwell::ShaderType::VertexB:
+    case Maxwell::ShaderType::Geometry:
+        if (key.xfb_enabled != 0) {
+            stage_key.xfb_enabled.Assign(1);
+            stage_key.xfb_state = key.xfb_state;
+        }
+        break;
+    case Maxwell::ShaderType::Tessellation:
+        stage_key.tessellation_primitive.Assign(key.tessellation_primitive);
+        stage_key.tessellation_spacing.Assign(key.tessellation_spacing);
+        stage_key.tessellation_clockwise.Assign(key.tessellation_clockwise);
+        break;
+    case Maxwell::ShaderType::Pixel:
+        stage_key.early_z.Assign(key.early_z);
+        break;
+    default:
+        break;
+    }
+    return stage_key.Hash();
+}
+
 Shader::RuntimeInfo MakeRuntimeInfo(const GraphicsPipelineKey& key,
                                     const Shader::IR::Program& program,
                                     const Shader::IR::Program* previous_program,
@@ -247,7 +280,8 @@ ShaderCache::ShaderCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
           .min_ssbo_alignment = static_cast<u32>(device.GetShaderStorageBufferAlignment()),
           .support_geometry_shader_passthrough = device.HasGeometryShaderPassthrough(),
           .support_conditional_barrier = device.SupportsConditionalBarriers(),
-      } {
+      },
+      stage_cache{STAGE_CACHE_SIZE} {
     if (use_asynchronous_shaders) {
         workers = CreateWorkers();
     }
@@ -266,8 +300,6 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         LOG_ERROR(Common_Filesystem, "Failed to create shader cache directories");
         return;
     }
-    shader_cache_filename = base_dir / "opengl.bin";
-
     if (!workers && !strict_context_required) {
         workers = CreateWorkers();
     }
@@ -290,12 +322,19 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
             workers->QueueWork(std::move(work));
         }
     }};
-    const auto load_compute{[&](std::ifstream& file, FileEnvironment env) {
+    const auto load_compute{[&](CachedPipeline cached) {
         ComputePipelineKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-        queue_work([this, key, env_ = std::move(env), &state, &callback](Context* ctx) mutable {
+        if (!cached.ReadKey(key)) {
+            return;
+        }
+        queue_work([this, key, cached_ = std::move(cached), &state,
+                    &callback](Context* ctx) mutable {
+            std::vector<FileEnvironment> envs{cached_.LoadEnvironments()};
             ctx->pools.ReleaseContents();
-            auto pipeline{CreateComputePipeline(ctx->pools, key, env_, true)};
+            std::unique_ptr<ComputePipeline> pipeline;
+            if (!envs.empty()) {
+                pipeline = CreateComputePipeline(ctx->pools, key, envs.front(), true);
+            }
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 compute_cache.emplace(key, std::move(pipeline));
@@ -307,16 +346,23 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         });
         ++state.total;
     }};
-    const auto load_graphics{[&](std::ifstream& file, std::vector<FileEnvironment> envs) {
+    const auto load_graphics{[&](CachedPipeline cached) {
         GraphicsPipelineKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-        queue_work([this, key, envs_ = std::move(envs), &state, &callback](Context* ctx) mutable {
+        if (!cached.ReadKey(key)) {
+            return;
+        }
+        queue_work([this, key, cached_ = std::move(cached), &state,
+                    &callback](Context* ctx) mutable {
+            std::vector<FileEnvironment> envs{cached_.LoadEnvironments()};
             boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
-            for (auto& env : envs_) {
+            for (auto& env : envs) {
                 env_ptrs.push_back(&env);
             }
             ctx->pools.ReleaseContents();
-            auto pipeline{CreateGraphicsPipeline(ctx->pools, key, MakeSpan(env_ptrs), false, true)};
+            std::unique_ptr<GraphicsPipeline> pipeline;
+            if (!env_ptrs.empty()) {
+                pipeline = CreateGraphicsPipeline(ctx->pools, key, MakeSpan(env_ptrs), false, true);
+            }
             std::scoped_lock lock{state.mutex};
             if (pipeline) {
                 graphics_cache.emplace(key, std::move(pipeline));
@@ -328,7 +374,8 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         });
         ++state.total;
     }};
-    LoadPipelines(stop_loading, shader_cache_filename, CACHE_VERSION, load_compute, load_graphics);
+    shader_cache_file.Load<ComputePipelineKey, GraphicsPipelineKey>(
+        base_dir / "opengl.bin", CACHE_VERSION, stop_loading, load_compute, load_graphics);
 
     LOG_INFO(Render_OpenGL, "Total Pipeline Count: {}", state.total);
 
@@ -341,6 +388,12 @@ void ShaderCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
         return;
     }
     workers->WaitForRequests(stop_loading);
+    const auto gvn_statistics{Shader::Optimization::GetAndResetValueNumberingStatistics()};
+    if (gvn_statistics.shaders != 0) {
+        LOG_INFO(Render_OpenGL, "Value numbering reduced {} shaders from {} to {} instructions",
+                 gvn_statistics.shaders, gvn_statistics.instructions_before,
+                 gvn_statistics.instructions_after);
+    }
     if (!use_asynchronous_shaders) {
         workers.reset();
     }
@@ -433,7 +486,7 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline() {
     main_pools.ReleaseContents();
     auto pipeline{CreateGraphicsPipeline(main_pools, graphics_key, environments.Span(),
                                          use_asynchronous_shaders)};
-    if (!pipeline || shader_cache_filename.empty()) {
+    if (!pipeline || !shader_cache_file.IsOpen()) {
         return pipeline;
     }
     boost::container::static_vector<const GenericEnvironment*, Maxwell::MaxShaderProgram> env_ptrs;
@@ -442,7 +495,7 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline() {
             env_ptrs.push_back(&environments.envs[index]);
         }
     }
-    SerializePipeline(graphics_key, env_ptrs, shader_cache_filename, CACHE_VERSION);
+    shader_cache_file.SerializePipeline(graphics_key, env_ptrs);
     return pipeline;
 }
 
@@ -458,9 +511,17 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline(
     const bool uses_vertex_a{key.unique_hashes[0] != 0};
     const bool uses_vertex_b{key.unique_hashes[1] != 0};
 
+    const bool use_glasm{device.UseAssemblyShaders()};
+
     // Layer passthrough generation for devices without GL_ARB_shader_viewport_layer_array
     Shader::IR::Program* layer_source_program{};
 
+    // Stages reused from other pipelines, and the reads of the stages translated for this one
+    std::array<std::optional<u64>, Maxwell::MaxShaderProgram> stage_keys{};
+    std::array<std::shared_ptr<const VideoCommon::TranslatedStage>, Maxwell::MaxShaderProgram>
+        cached_stages{};
+    std::array<VideoCommon::EnvironmentReads, Maxwell::MaxShaderProgram> stage_reads{};
+
     for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
         const bool is_emulated_stage = layer_source_program != nullptr &&
                                        index == static_cast<u32>(Maxwell::ShaderType::Geometry);
@@ -476,26 +537,44 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline(
         Shader::Environment& env{*envs[env_index]};
         ++env_index;
 
-        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
-        Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, index == 0);
+        // GLASM stages depend on the storage buffers of the whole pipeline, merged vertex
+        // programs and stages after an emulated layer are always translated
+        if (!use_glasm && !uses_vertex_a && layer_source_program == nullptr) {
+            stage_keys[index] = StageCacheKey(key, index);
+            cached_stages[index] = stage_cache.Find(*stage_keys[index], env);
+        }
 
         if (Settings::values.dump_shaders) {
             env.Dump(hash, key.unique_hashes[index]);
         }
 
-        if (!uses_vertex_a || index != 1) {
-            // Normal path
-            programs[index] = TranslateProgram(pools.inst, pools.block, env, cfg, host_info);
-
+        if (cached_stages[index]) {
+            programs[index] = cached_stages[index]->program;
             total_storage_buffers +=
                 Shader::NumDescriptors(programs[index].info.storage_buffers_descriptors);
         } else {
-            // VertexB path when VertexA is present.
-            auto& program_va{programs[0]};
-            auto program_vb{TranslateProgram(pools.inst, pools.block, env, cfg, host_info)};
-            total_storage_buffers +=
-                Shader::NumDescriptors(program_vb.info.storage_buffers_descriptors);
-            programs[index] = MergeDualVertexPrograms(program_va, program_vb, env);
+            VideoCommon::RecordingEnvironment recording_env{env};
+            const u32 cfg_offset{
+                static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+            Shader::Maxwell::Flow::CFG cfg(recording_env, pools.flow_block, cfg_offset,
+                                           index == 0);
+            if (!uses_vertex_a || index != 1) {
+                // Normal path
+                programs[index] =
+                    TranslateProgram(pools.inst, pools.block, recording_env, cfg, host_info);
+
+                total_storage_buffers +=
+                    Shader::NumDescriptors(programs[index].info.storage_buffers_descriptors);
+            } else {
+                // VertexB path when VertexA is present.
+                auto& program_va{programs[0]};
+                auto program_vb{
+                    TranslateProgram(pools.inst, pools.block, recording_env, cfg, host_info)};
+                total_storage_buffers +=
+                    Shader::NumDescriptors(program_vb.info.storage_buffers_descriptors);
+                programs[index] = MergeDualVertexPrograms(program_va, program_vb, recording_env);
+            }
+            stage_reads[index] = recording_env.TakeReads();
         }
 
         if (programs[index].info.requires_layer_emulation) {
@@ -511,7 +590,6 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline(
     std::array<std::vector<u32>, 5> sources_spirv;
     Shader::Backend::Bindings binding;
     Shader::IR::Program* previous_program{};
-    const bool use_glasm{device.UseAssemblyShaders()};
     const size_t first_index = uses_vertex_a && uses_vertex_b ? 1 : 0;
     for (size_t index = first_index; index < Maxwell::MaxShaderProgram; ++index) {
         const bool is_emulated_stage = layer_source_program != nullptr &&
@@ -525,6 +603,13 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline(
         const size_t stage_index{index - 1};
         infos[stage_index] = &program.info;
 
+        if (const auto& cached_stage{cached_stages[index]}) {
+            sources[stage_index] = cached_stage->source;
+            sources_spirv[stage_index] = cached_stage->spirv;
+            binding = cached_stage->bindings;
+            previous_program = &program;
+            continue;
+        }
         const auto runtime_info{
             MakeRuntimeInfo(key, program, previous_program, glasm_use_storage_buffers, use_glasm)};
         switch (device.GetShaderBackend()) {
@@ -540,6 +625,11 @@ std::unique_ptr<GraphicsPipeline> ShaderCache::CreateGraphicsPipeline(
             sources_spirv[stage_index] = EmitSPIRV(profile, runtime_info, program, binding);
             break;
         }
+        // Stages emulating layers are needed in full to generate the geometry passthrough
+        if (stage_keys[index] && !program.info.requires_layer_emulation) {
+            stage_cache.Insert(*stage_keys[index], std::move(stage_reads[index]), program,
+                               binding, sources_spirv[stage_index], sources[stage_index]);
+        }
         previous_program = &program;
     }
     auto* const thread_worker{use_shader_workers ? workers.get() : nullptr};
@@ -561,11 +651,10 @@ std::unique_ptr<ComputePipeline> ShaderCache::CreateComputePipeline(
 
     main_pools.ReleaseContents();
     auto pipeline{CreateComputePipeline(main_pools, key, env)};
-    if (!pipeline || shader_cache_filename.empty()) {
+    if (!pipeline || !shader_cache_file.IsOpen()) {
         return pipeline;
     }
-    SerializePipeline(key, std::array<const GenericEnvironment*, 1>{&env}, shader_cache_filename,
-                      CACHE_VERSION);
+    shader_cache_file.SerializePipeline(key, std::array<const GenericEnvironment*, 1>{&env});
     return pipeline;
 }
 
@@ -10,10 +10,12 @@
 #include "common/thread_worker.h"
 #include "shader_recompiler/host_translate_info.h"
 #include "shader_recompiler/profile.h"
+#include "video_core/pipeline_cache_file.h"
 #include "video_core/renderer_opengl/gl_compute_pipeline.h"
 #include "video_core/renderer_opengl/gl_graphics_pipeline.h"
 #include "video_core/renderer_opengl/gl_shader_context.h"
 #include "video_core/shader_cache.h"
+#include "video_core/translated_stage_cache.h"
 
 namespace Tegra {
 class MemoryManager;
@@ -84,7 +86,10 @@ private:
     Shader::Profile profile;
     Shader::HostTranslateInfo host_info;
 
-    std::filesystem::path shader_cache_filename;
+    /// Stages emitted for previous pipelines, reused by pipelines sharing their shaders
+    VideoCommon::TranslatedStageCache stage_cache;
+
+    VideoCommon::PipelineCacheFile shader_cache_file;
     std::unique_ptr<ShaderWorker> workers;
 };
 
@@ -124,13 +124,30 @@ public:
 
     void BindTransformFeedbackBuffers(VideoCommon::HostBindings<Buffer>& bindings);
 
-    std::span<u8> BindMappedUniformBuffer([[maybe_unused]] size_t stage,
-                                          [[maybe_unused]] u32 binding_index, u32 size) {
+    std::span<u8> BindMappedUniformBuffer(size_t stage, u32 binding_index, u32 size) {
         const StagingBufferRef ref = staging_pool.Request(size, MemoryUsage::Upload);
-        BindBuffer(ref.buffer, static_cast<u32>(ref.offset), size);
+        const u32 offset = static_cast<u32>(ref.offset);
+        mapped_uniform_buffers[stage][binding_index] = {
+            .buffer = ref.buffer,
+            .offset = offset,
+            .size = size,
+            .tick = scheduler.CurrentTick(),
+        };
+        BindBuffer(ref.buffer, offset, size);
         return ref.mapped_span;
     }
 
+    /// Binds the last mapped uniform buffer of the binding again, it holds the same data.
+    /// Returns false when its memory may have been reused since the current tick started.
+    bool RebindMappedUniformBuffer(size_t stage, u32 binding_index, u32 size) {
+        const MappedUniformBuffer& mapped = mapped_uniform_buffers[stage][binding_index];
+        if (mapped.tick != scheduler.CurrentTick() || mapped.size != size) {
+            return false;
+        }
+        BindBuffer(mapped.buffer, mapped.offset, size);
+        return true;
+    }
+
     void BindUniformBuffer(VkBuffer buffer, u32 offset, u32 size) {
         BindBuffer(buffer, offset, size);
     }
@@ -146,6 +163,13 @@ public:
     }
 
 private:
+    struct MappedUniformBuffer {
+        VkBuffer buffer{};
+        u32 offset{};
+        u32 size{};
+        u64 tick{};
+    };
+
     void BindBuffer(VkBuffer buffer, u32 offset, u32 size) {
         guest_descriptor_queue.AddBuffer(buffer, offset, size);
     }
@@ -164,6 +188,11 @@ private:
 
     vk::Buffer null_buffer;
 
+    /// Stream allocations of the uniform buffers, valid until the tick they were made ends
+    std::array<std::array<MappedUniformBuffer, VideoCommon::NUM_GRAPHICS_UNIFORM_BUFFERS>,
+               VideoCommon::NUM_STAGES>
+        mapped_uniform_buffers{};
+
     std::unique_ptr<Uint8Pass> uint8_pass;
     QuadIndexedPass quad_index_pass;
 };
@@ -182,6 +211,7 @@ struct BufferCacheParams {
     static constexpr bool USE_MEMORY_MAPS = true;
     static constexpr bool SEPARATE_IMAGE_BUFFER_BINDINGS = false;
     static constexpr bool USE_MEMORY_MAPS_FOR_UPLOADS = true;
+    static constexpr bool CAN_REBIND_MAPPED_UNIFORM_BUFFERS = true;
 };
 
 using BufferCache = VideoCommon::BufferCache<BufferCacheParams>;
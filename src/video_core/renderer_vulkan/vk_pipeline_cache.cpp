@@ -5,20 +5,26 @@
 #include <cstddef>
 #include <fstream>
 #include <memory>
+#include <optional>
+#include <span>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "common/bit_cast.h"
 #include "common/cityhash.h"
 #include "common/fs/fs.h"
 #include "common/fs/path_util.h"
+#include "common/literals.h"
 #include "common/microprofile.h"
+#include "common/thread.h"
 #include "common/thread_worker.h"
 #include "core/core.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/environment.h"
 #include "shader_recompiler/frontend/maxwell/control_flow.h"
 #include "shader_recompiler/frontend/maxwell/translate_program.h"
+#include "shader_recompiler/ir_opt/passes.h"
 #include "shader_recompiler/program_header.h"
 #include "video_core/engines/kepler_compute.h"
 #include "video_core/engines/maxwell_3d.h"
@@ -48,12 +54,15 @@ using Shader::Maxwell::ConvertLegacyToGeneric;
 using Shader::Maxwell::GenerateGeometryPassthrough;
 using Shader::Maxwell::MergeDualVertexPrograms;
 using Shader::Maxwell::TranslateProgram;
+using VideoCommon::CachedPipeline;
 using VideoCommon::ComputeEnvironment;
 using VideoCommon::FileEnvironment;
 using VideoCommon::GenericEnvironment;
 using VideoCommon::GraphicsEnvironment;
+using namespace Common::Literals;
 
 constexpr u32 CACHE_VERSION = 11;
+constexpr size_t STAGE_CACHE_SIZE = 64_MiB;
 constexpr std::array<char, 8> VULKAN_CACHE_MAGIC_NUMBER{'y', 'u', 'z', 'u', 'v', 'k', 'c', 'h'};
 
 template <typename Container>
@@ -141,6 +150,74 @@ Shader::AttributeType AttributeType(const FixedPipelineState& state, size_t inde
     return Shader::AttributeType::Disabled;
 }
 
+std::array<Shader::AttributeType, 32> GenericInputTypes(const FixedPipelineState& state) {
+    std::array<Shader::AttributeType, 32> types{};
+    if (state.dynamic_vertex_input) {
+        for (size_t index = 0; index < Maxwell::NumVertexAttributes; ++index) {
+            types[index] = AttributeType(state, index);
+        }
+    } else {
+        std::ranges::transform(state.attributes, types.begin(), &CastAttributeType);
+    }
+    return types;
+}
+
+/// Hashes the shaders and the pipeline state the emitted code of a stage depends on
+u64 StageCacheKey(const GraphicsPipelineCacheKey& key, size_t index) {
+    struct StageState {
+        std::array<u64, Maxwell::MaxShaderProgram> unique_hashes{};
+        std::array<Shader::AttributeType, 32> generic_input_types{};
+        u32 index{};
+        u32 topology{};
+        u32 early_z{};
+        u32 y_negate{};
+        u32 point_size{};
+        u32 ndc_minus_one_to_one{};
+        u32 xfb_enabled{};
+        u32 tessellation{};
+        u32 alpha_test_func{};
+        u32 alpha_test_ref{};
+    };
+    static_assert(std::has_unique_object_representations_v<StageState>);
+
+    // Previous stages define the inputs and the bindings of the stage
+    StageState state;
+    std::copy_n(key.unique_hashes.begin(), index + 1, state.unique_hashes.begin());
+    state.index = static_cast<u32>(index);
+    state.topology = static_cast<u32>(key.state.topology.Value());
+    state.early_z = key.state.early_z;
+    state.y_negate = key.state.y_negate;
+    switch (static_cast<Maxwell::ShaderType>(index)) {
+    case Maxwell::ShaderType::VertexB:
+        // Fixed state is applied on vertex shaders when there is no geometry shader
+        state.unique_hashes[4] = key.unique_hashes[4];
+        state.generic_input_types = GenericInputTypes(key.state);
+        [[fallthrough]];
+    case Maxwell::ShaderType::Geometry:
+        state.point_size = key.state.point_size;
+        state.ndc_minus_one_to_one = key.state.ndc_minus_one_to_one;
+        state.xfb_enabled = key.state.xfb_enabled;
+        break;
+    case Maxwell::ShaderType::Tessellation:
+        state.tessellation = key.state.tessellation_primitive |
+                             (key.state.tessellation_spacing << 2) |
+                             (key.state.tessellation_clockwise << 4);
+        break;
+    case Maxwell::ShaderType::Pixel:
+        state.alpha_test_func = key.state.alpha_test_func;
+        state.alpha_test_ref = key.state.alpha_test_ref;
+        break;
+    default:
+        break;
+    }
+    const u64 hash{Common::CityHash64(reinterpret_cast<const char*>(&state), sizeof(state))};
+    if (state.xfb_enabled == 0) {
+        return hash;
+    }
+    return Common::CityHash64WithSeed(reinterpret_cast<const char*>(&key.state.xfb_state),
+                                      sizeof(key.state.xfb_state), hash);
+}
+
 Shader::RuntimeInfo MakeRuntimeInfo(std::span<const Shader::IR::Program> programs,
                                     const GraphicsPipelineCacheKey& key,
                                     const Shader::IR::Program& program,
@@ -173,14 +250,7 @@ Shader::RuntimeInfo MakeRuntimeInfo(std::span<const Shader::IR::Program> program
             }
             info.convert_depth_mode = gl_ndc;
         }
-        if (key.state.dynamic_vertex_input) {
-            for (size_t index = 0; index < Maxwell::NumVertexAttributes; ++index) {
-                info.generic_input_types[index] = AttributeType(key.state, index);
-            }
-        } else {
-            std::ranges::transform(key.state.attributes, info.generic_input_types.begin(),
-                                   &CastAttributeType);
-        }
+        info.generic_input_types = GenericInputTypes(key.state);
         break;
     case Shader::Stage::TessellationEval:
         info.tess_clockwise = key.state.tessellation_clockwise != 0;
@@ -310,9 +380,15 @@ PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
       texture_cache{texture_cache_}, shader_notify{shader_notify_},
       use_asynchronous_shaders{Settings::values.use_asynchronous_shaders.GetValue()},
       use_vulkan_pipeline_cache{Settings::values.use_vulkan_driver_pipeline_cache.GetValue()},
+      stage_cache{STAGE_CACHE_SIZE},
       workers(device.HasBrokenParallelShaderCompiling() ? 1ULL : GetTotalPipelineWorkers(),
               "VkPipelineBuilder"),
-      serialization_thread(1, "VkPipelineSerialization") {
+      serialization_thread(1, "VkPipelineSerialization"),
+      warmup_workers(std::max<size_t>(GetTotalPipelineWorkers() / 2, 1), "VkPipelineWarmup",
+                     [] {
+                         Common::SetCurrentThreadPriority(Common::ThreadPriority::Low);
+                         return ShaderPools{};
+                     }) {
     const auto& float_control{device.FloatControlProperties()};
     const VkDriverId driver_id{device.GetDriverID()};
     profile = Shader::Profile{
@@ -412,6 +488,7 @@ PipelineCache::PipelineCache(Tegra::MaxwellDeviceMemoryManager& device_memory_,
 }
 
 PipelineCache::~PipelineCache() {
+    pipeline_usage.Save();
     if (use_vulkan_pipeline_cache && !vulkan_pipeline_cache_filename.empty()) {
         SerializeVulkanPipelineCache(vulkan_pipeline_cache_filename, vulkan_pipeline_cache,
                                      CACHE_VERSION);
@@ -450,8 +527,11 @@ ComputePipeline* PipelineCache::CurrentComputePipeline() {
         .shared_memory_size = qmd.shared_alloc,
         .workgroup_size{qmd.block_dim_x, qmd.block_dim_y, qmd.block_dim_z},
     };
+    std::unique_lock lock{cache_mutex};
     const auto [pair, is_new]{compute_cache.try_emplace(key)};
     auto& pipeline{pair->second};
+    lock.unlock();
+    pipeline_usage.RecordLookup(key.Hash(), !is_new);
     if (!is_new) {
         return pipeline.get();
     }
@@ -470,8 +550,6 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
         LOG_ERROR(Common_Filesystem, "Failed to create pipeline cache directories");
         return;
     }
-    pipeline_cache_filename = base_dir / "vulkan.bin";
-
     if (use_vulkan_pipeline_cache) {
         vulkan_pipeline_cache_filename = base_dir / "vulkan_pipelines.bin";
         vulkan_pipeline_cache =
@@ -489,27 +567,20 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     if (device.IsKhrPipelineExecutablePropertiesEnabled()) {
         state.statistics = std::make_unique<PipelineStatistics>(device);
     }
-    const auto load_compute{[&](std::ifstream& file, FileEnvironment env) {
+    std::vector<std::pair<ComputePipelineCacheKey, CachedPipeline>> compute_pipelines;
+    std::vector<std::pair<GraphicsPipelineCacheKey, CachedPipeline>> graphics_pipelines;
+    const auto load_compute{[&](CachedPipeline cached) {
         ComputePipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
-
-        workers.QueueWork([this, key, env_ = std::move(env), &state, &callback]() mutable {
-            ShaderPools pools;
-            auto pipeline{CreateComputePipeline(pools, key, env_, state.statistics.get(), false)};
-            std::scoped_lock lock{state.mutex};
-            if (pipeline) {
-                compute_cache.emplace(key, std::move(pipeline));
-            }
-            ++state.built;
-            if (state.has_loaded) {
-                callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
-            }
-        });
-        ++state.total;
+        if (!cached.ReadKey(key)) {
+            return;
+        }
+        compute_pipelines.emplace_back(key, std::move(cached));
     }};
-    const auto load_graphics{[&](std::ifstream& file, std::vector<FileEnvironment> envs) {
+    const auto load_graphics{[&](CachedPipeline cached) {
         GraphicsPipelineCacheKey key;
-        file.read(reinterpret_cast<char*>(&key), sizeof(key));
+        if (!cached.ReadKey(key)) {
+            return;
+        }
 
         if ((key.state.extended_dynamic_state != 0) !=
                 dynamic_features.has_extended_dynamic_state ||
@@ -524,30 +595,61 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
             (key.state.dynamic_vertex_input != 0) != dynamic_features.has_dynamic_vertex_input) {
             return;
         }
-        workers.QueueWork([this, key, envs_ = std::move(envs), &state, &callback]() mutable {
-            ShaderPools pools;
-            boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
-            for (auto& env : envs_) {
-                env_ptrs.push_back(&env);
-            }
-            auto pipeline{CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs),
-                                                 state.statistics.get(), false)};
-
-            std::scoped_lock lock{state.mutex};
-            if (pipeline) {
-                graphics_cache.emplace(key, std::move(pipeline));
-            }
-            ++state.built;
-            if (state.has_loaded) {
-                callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
-            }
-        });
-        ++state.total;
+        graphics_pipelines.emplace_back(key, std::move(cached));
     }};
-    VideoCommon::LoadPipelines(stop_loading, pipeline_cache_filename, CACHE_VERSION, load_compute,
-                               load_graphics);
+    pipeline_cache_file.Load<ComputePipelineCacheKey, GraphicsPipelineCacheKey>(
+        base_dir / "vulkan.bin", CACHE_VERSION, stop_loading, load_compute, load_graphics);
+    pipeline_usage.Load(base_dir / "vulkan_usage.bin");
+
+    // Compute pipelines are indexed first, graphics pipelines after them
+    std::vector<u64> key_hashes;
+    key_hashes.reserve(compute_pipelines.size() + graphics_pipelines.size());
+    for (const auto& pipeline : compute_pipelines) {
+        key_hashes.push_back(pipeline.first.Hash());
+    }
+    for (const auto& pipeline : graphics_pipelines) {
+        key_hashes.push_back(pipeline.first.Hash());
+    }
+    const VideoCommon::PipelineUsage::WarmupOrder order{pipeline_usage.Prioritize(key_hashes)};
+
+    for (const size_t index : order.synchronous) {
+        if (index < compute_pipelines.size()) {
+            const ComputePipelineCacheKey& key{compute_pipelines[index].first};
+            CachedPipeline& cached{compute_pipelines[index].second};
+            workers.QueueWork([this, key, cached_ = std::move(cached), &state, &callback] {
+                ShaderPools pools;
+                auto pipeline{LoadComputePipeline(pools, key, cached_, state.statistics.get())};
+                std::scoped_lock lock{state.mutex};
+                if (pipeline) {
+                    compute_cache.emplace(key, std::move(pipeline));
+                }
+                ++state.built;
+                if (state.has_loaded) {
+                    callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
+                }
+            });
+        } else {
+            const size_t graphics_index{index - compute_pipelines.size()};
+            const GraphicsPipelineCacheKey& key{graphics_pipelines[graphics_index].first};
+            CachedPipeline& cached{graphics_pipelines[graphics_index].second};
+            workers.QueueWork([this, key, cached_ = std::move(cached), &state, &callback] {
+                ShaderPools pools;
+                auto pipeline{LoadGraphicsPipeline(pools, key, cached_, state.statistics.get())};
+                std::scoped_lock lock{state.mutex};
+                if (pipeline) {
+                    graphics_cache.emplace(key, std::move(pipeline));
+                }
+                ++state.built;
+                if (state.has_loaded) {
+                    callback(VideoCore::LoadCallbackStage::Build, state.built, state.total);
+                }
+            });
+        }
+        ++state.total;
+    }
 
-    LOG_INFO(Render_Vulkan, "Total Pipeline Count: {}", state.total);
+    LOG_INFO(Render_Vulkan, "Total Pipeline Count: {}, {} built in the background",
+             state.total + order.background.size(), order.background.size());
 
     std::unique_lock lock{state.mutex};
     callback(VideoCore::LoadCallbackStage::Build, 0, state.total);
@@ -564,11 +666,71 @@ void PipelineCache::LoadDiskResources(u64 title_id, std::stop_token stop_loading
     if (state.statistics) {
         state.statistics->Report();
     }
+    const auto gvn_statistics{Shader::Optimization::GetAndResetValueNumberingStatistics()};
+    if (gvn_statistics.shaders != 0) {
+        LOG_INFO(Render_Vulkan, "Value numbering reduced {} shaders from {} to {} instructions",
+                 gvn_statistics.shaders, gvn_statistics.instructions_before,
+                 gvn_statistics.instructions_after);
+    }
+    if (stop_loading.stop_requested()) {
+        return;
+    }
+    pipeline_usage.StartSession();
+
+    // The remaining pipelines are built while the title runs, pipelines it needs earlier are
+    // built on demand and the ones from the background are dropped
+    warmup_start = std::chrono::steady_clock::now();
+    num_warmup_pipelines = order.background.size();
+    for (const size_t index : order.background) {
+        shader_notify.MarkShaderBuilding();
+        if (index < compute_pipelines.size()) {
+            const ComputePipelineCacheKey& key{compute_pipelines[index].first};
+            CachedPipeline& cached{compute_pipelines[index].second};
+            warmup_workers.QueueWork([this, key, cached_ = std::move(cached)](ShaderPools* pools) {
+                pools->ReleaseContents();
+                auto pipeline{LoadComputePipeline(*pools, key, cached_, nullptr)};
+                if (pipeline) {
+                    std::scoped_lock cache_lock{cache_mutex};
+                    compute_cache.try_emplace(key, std::move(pipeline));
+                }
+                FinishWarmupPipeline();
+            });
+        } else {
+            const size_t graphics_index{index - compute_pipelines.size()};
+            const GraphicsPipelineCacheKey& key{graphics_pipelines[graphics_index].first};
+            CachedPipeline& cached{graphics_pipelines[graphics_index].second};
+            warmup_workers.QueueWork([this, key, cached_ = std::move(cached)](ShaderPools* pools) {
+                pools->ReleaseContents();
+                auto pipeline{LoadGraphicsPipeline(*pools, key, cached_, nullptr)};
+                if (pipeline) {
+                    std::scoped_lock cache_lock{cache_mutex};
+                    graphics_cache.try_emplace(key, std::move(pipeline));
+                }
+                FinishWarmupPipeline();
+            });
+        }
+    }
+}
+
+void PipelineCache::FinishWarmupPipeline() {
+    shader_notify.MarkShaderComplete();
+    if (num_warmup_pipelines.fetch_sub(1) != 1) {
+        return;
+    }
+    const auto warmup_time{std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - warmup_start)};
+    const VideoCommon::PipelineUsage::Statistics statistics{pipeline_usage.GetStatistics()};
+    LOG_INFO(Render_Vulkan,
+             "Background pipeline warmup finished in {} ms, {} hits and {} misses meanwhile",
+             warmup_time.count(), statistics.hits, statistics.misses);
 }
 
 GraphicsPipeline* PipelineCache::CurrentGraphicsPipelineSlowPath() {
+    std::unique_lock lock{cache_mutex};
     const auto [pair, is_new]{graphics_cache.try_emplace(graphics_key)};
     auto& pipeline{pair->second};
+    lock.unlock();
+    pipeline_usage.RecordLookup(graphics_key.Hash(), !is_new);
     if (is_new) {
         pipeline = CreateGraphicsPipeline();
     }
@@ -618,6 +780,12 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
     // Layer passthrough generation for devices without VK_EXT_shader_viewport_index_layer
     Shader::IR::Program* layer_source_program{};
 
+    // Stages reused from other pipelines, and the reads of the stages translated for this one
+    std::array<std::optional<u64>, Maxwell::MaxShaderProgram> stage_keys{};
+    std::array<std::shared_ptr<const VideoCommon::TranslatedStage>, Maxwell::MaxShaderProgram>
+        cached_stages{};
+    std::array<VideoCommon::EnvironmentReads, Maxwell::MaxShaderProgram> stage_reads{};
+
     for (size_t index = 0; index < Maxwell::MaxShaderProgram; ++index) {
         const bool is_emulated_stage = layer_source_program != nullptr &&
                                        index == static_cast<u32>(Maxwell::ShaderType::Geometry);
@@ -633,16 +801,31 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
         Shader::Environment& env{*envs[env_index]};
         ++env_index;
 
-        const u32 cfg_offset{static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
-        Shader::Maxwell::Flow::CFG cfg(env, pools.flow_block, cfg_offset, index == 0);
-        if (!uses_vertex_a || index != 1) {
-            // Normal path
-            programs[index] = TranslateProgram(pools.inst, pools.block, env, cfg, host_info);
+        // Merged vertex programs and stages after an emulated layer are always translated
+        if (!uses_vertex_a && layer_source_program == nullptr) {
+            stage_keys[index] = StageCacheKey(key, index);
+            cached_stages[index] = stage_cache.Find(*stage_keys[index], env);
+        }
+        if (cached_stages[index]) {
+            programs[index] = cached_stages[index]->program;
         } else {
-            // VertexB path when VertexA is present.
-            auto& program_va{programs[0]};
-            auto program_vb{TranslateProgram(pools.inst, pools.block, env, cfg, host_info)};
-            programs[index] = MergeDualVertexPrograms(program_va, program_vb, env);
+            VideoCommon::RecordingEnvironment recording_env{env};
+            const u32 cfg_offset{
+                static_cast<u32>(env.StartAddress() + sizeof(Shader::ProgramHeader))};
+            Shader::Maxwell::Flow::CFG cfg(recording_env, pools.flow_block, cfg_offset,
+                                           index == 0);
+            if (!uses_vertex_a || index != 1) {
+                // Normal path
+                programs[index] =
+                    TranslateProgram(pools.inst, pools.block, recording_env, cfg, host_info);
+            } else {
+                // VertexB path when VertexA is present.
+                auto& program_va{programs[0]};
+                auto program_vb{
+                    TranslateProgram(pools.inst, pools.block, recording_env, cfg, host_info)};
+                programs[index] = MergeDualVertexPrograms(program_va, program_vb, recording_env);
+            }
+            stage_reads[index] = recording_env.TakeReads();
         }
 
         if (Settings::values.dump_shaders) {
@@ -671,9 +854,22 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline(
         const size_t stage_index{index - 1};
         infos[stage_index] = &program.info;
 
-        const auto runtime_info{MakeRuntimeInfo(programs, key, program, previous_stage)};
-        ConvertLegacyToGeneric(program, runtime_info);
-        const std::vector<u32> code{EmitSPIRV(profile, runtime_info, program, binding)};
+        std::vector<u32> emitted_code;
+        std::span<const u32> code;
+        if (const auto& cached_stage{cached_stages[index]}) {
+            code = cached_stage->spirv;
+            binding = cached_stage->bindings;
+        } else {
+            const auto runtime_info{MakeRuntimeInfo(programs, key, program, previous_stage)};
+            ConvertLegacyToGeneric(program, runtime_info);
+            emitted_code = EmitSPIRV(profile, runtime_info, program, binding);
+            code = emitted_code;
+            // Stages emulating layers are needed in full to generate the geometry passthrough
+            if (stage_keys[index] && !program.info.requires_layer_emulation) {
+                stage_cache.Insert(*stage_keys[index], std::move(stage_reads[index]), program,
+                                   binding, emitted_code);
+            }
+        }
         device.SaveShader(code);
         modules[stage_index] = BuildShader(device, code);
         if (device.HasDebuggingToolAttached()) {
@@ -713,7 +909,7 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline() {
     main_pools.ReleaseContents();
     auto pipeline{
         CreateGraphicsPipeline(main_pools, graphics_key, environments.Span(), nullptr, true)};
-    if (!pipeline || pipeline_cache_filename.empty()) {
+    if (!pipeline || !pipeline_cache_file.IsOpen()) {
         return pipeline;
     }
     serialization_thread.QueueWork([this, key = graphics_key, envs = std::move(environments.envs)] {
@@ -724,7 +920,7 @@ std::unique_ptr<GraphicsPipeline> PipelineCache::CreateGraphicsPipeline() {
                 env_ptrs.push_back(&envs[index]);
             }
         }
-        SerializePipeline(key, env_ptrs, pipeline_cache_filename, CACHE_VERSION);
+        pipeline_cache_file.SerializePipeline(key, env_ptrs);
     });
     return pipeline;
 }
@@ -738,12 +934,12 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
 
     main_pools.ReleaseContents();
     auto pipeline{CreateComputePipeline(main_pools, key, env, nullptr, true)};
-    if (!pipeline || pipeline_cache_filename.empty()) {
+    if (!pipeline || !pipeline_cache_file.IsOpen()) {
         return pipeline;
     }
     serialization_thread.QueueWork([this, key, env_ = std::move(env)] {
-        SerializePipeline(key, std::array<const GenericEnvironment*, 1>{&env_},
-                          pipeline_cache_filename, CACHE_VERSION);
+        pipeline_cache_file.SerializePipeline(key,
+                                              std::array<const GenericEnvironment*, 1>{&env_});
     });
     return pipeline;
 }
@@ -784,6 +980,30 @@ std::unique_ptr<ComputePipeline> PipelineCache::CreateComputePipeline(
     return nullptr;
 }
 
+std::unique_ptr<GraphicsPipeline> PipelineCache::LoadGraphicsPipeline(
+    ShaderPools& pools, const GraphicsPipelineCacheKey& key, const CachedPipeline& cached,
+    PipelineStatistics* statistics) {
+    std::vector<FileEnvironment> envs{cached.LoadEnvironments()};
+    if (envs.empty()) {
+        return nullptr;
+    }
+    boost::container::static_vector<Shader::Environment*, 5> env_ptrs;
+    for (auto& env : envs) {
+        env_ptrs.push_back(&env);
+    }
+    return CreateGraphicsPipeline(pools, key, MakeSpan(env_ptrs), statistics, false);
+}
+
+std::unique_ptr<ComputePipeline> PipelineCache::LoadComputePipeline(
+    ShaderPools& pools, const ComputePipelineCacheKey& key, const CachedPipeline& cached,
+    PipelineStatistics* statistics) {
+    std::vector<FileEnvironment> envs{cached.LoadEnvironments()};
+    if (envs.empty()) {
+        return nullptr;
+    }
+    return CreateComputePipeline(pools, key, envs.front(), statistics, false);
+}
+
 void PipelineCache::SerializeVulkanPipelineCache(const std::filesystem::path& filename,
                                                  const vk::PipelineCache& pipeline_cache,
                                                  u32 cache_version) try {
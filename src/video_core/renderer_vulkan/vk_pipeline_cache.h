@@ -4,9 +4,12 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
 #include <memory>
+#include <mutex>
 #include <type_traits>
 #include <unordered_map>
 #include <vector>
@@ -25,8 +28,11 @@
 #include "video_core/renderer_vulkan/vk_buffer_cache.h"
 #include "video_core/renderer_vulkan/vk_compute_pipeline.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
+#include "video_core/pipeline_cache_file.h"
+#include "video_core/pipeline_usage.h"
 #include "video_core/renderer_vulkan/vk_texture_cache.h"
 #include "video_core/shader_cache.h"
+#include "video_core/translated_stage_cache.h"
 
 namespace Core {
 class System;
@@ -134,6 +140,19 @@ private:
                                                            PipelineStatistics* statistics,
                                                            bool build_in_parallel);
 
+    /// Builds a pipeline read from the disk cache, returns null when it cannot be built.
+    std::unique_ptr<GraphicsPipeline> LoadGraphicsPipeline(
+        ShaderPools& pools, const GraphicsPipelineCacheKey& key,
+        const VideoCommon::CachedPipeline& cached, PipelineStatistics* statistics);
+
+    std::unique_ptr<ComputePipeline> LoadComputePipeline(ShaderPools& pools,
+                                                         const ComputePipelineCacheKey& key,
+                                                         const VideoCommon::CachedPipeline& cached,
+                                                         PipelineStatistics* statistics);
+
+    /// Called by the warmup workers after each pipeline built in the background.
+    void FinishWarmupPipeline();
+
     void SerializeVulkanPipelineCache(const std::filesystem::path& filename,
                                       const vk::PipelineCache& pipeline_cache, u32 cache_version);
 
@@ -154,6 +173,8 @@ private:
     GraphicsPipelineCacheKey graphics_key{};
     GraphicsPipeline* current_pipeline{};
 
+    /// Guards the insertions in the pipeline maps, pipelines are warmed up in the background
+    std::mutex cache_mutex;
     std::unordered_map<ComputePipelineCacheKey, std::unique_ptr<ComputePipeline>> compute_cache;
     std::unordered_map<GraphicsPipelineCacheKey, std::unique_ptr<GraphicsPipeline>> graphics_cache;
 
@@ -162,7 +183,11 @@ private:
     Shader::Profile profile;
     Shader::HostTranslateInfo host_info;
 
-    std::filesystem::path pipeline_cache_filename;
+    /// Stages emitted for previous pipelines, reused by pipelines sharing their shaders
+    VideoCommon::TranslatedStageCache stage_cache;
+
+    VideoCommon::PipelineCacheFile pipeline_cache_file;
+    VideoCommon::PipelineUsage pipeline_usage;
 
     std::filesystem::path vulkan_pipeline_cache_filename;
     vk::PipelineCache vulkan_pipeline_cache;
@@ -170,6 +195,11 @@ private:
     Common::ThreadWorker workers;
     Common::ThreadWorker serialization_thread;
     DynamicFeatures dynamic_features;
+
+    std::chrono::steady_clock::time_point warmup_start;
+    std::atomic<size_t> num_warmup_pipelines{};
+    /// Low priority threads building cached pipelines while the title runs, stopped first
+    Common::StatefulThreadWorker<ShaderPools> warmup_workers;
 };
 
 } // namespace Vulkan
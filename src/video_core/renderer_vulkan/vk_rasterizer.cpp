@@ -200,6 +200,7 @@ RasterizerVulkan::RasterizerVulkan(Core::Frontend::EmuWindow& emu_window_, Tegra
       fence_manager(*this, gpu, texture_cache, buffer_cache, query_cache, device, scheduler),
       wfi_event(device.GetLogical().CreateEvent()) {
     scheduler.SetQueryCache(query_cache);
+    buffer_cache.SetUniformUploadStats(&gpu.UniformUploadStats());
 }
 
 RasterizerVulkan::~RasterizerVulkan() = default;
@@ -841,6 +842,7 @@ std::optional<FramebufferTextureInfo> RasterizerVulkan::AccelerateDisplay(
 
 void RasterizerVulkan::LoadDiskResources(u64 title_id, std::stop_token stop_loading,
                                          const VideoCore::DiskResourceLoadCallback& callback) {
+    texture_cache.LoadDiskResources(title_id);
     pipeline_cache.LoadDiskResources(title_id, stop_loading, callback);
 }
 
@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include "common/assert.h"
+#include "core/memory.h"
+#include "video_core/segment_write_tracker.h"
+
+namespace Tegra {
+namespace {
+constexpr u64 PageBegin(DAddr address) {
+    return address >> Core::Memory::CITRON_PAGEBITS;
+}
+
+constexpr u64 PageEnd(DAddr address, size_t size) {
+    return (address + size + Core::Memory::CITRON_PAGEMASK) >> Core::Memory::CITRON_PAGEBITS;
+}
+} // Anonymous namespace
+
+SegmentWriteTracker::SegmentWriteTracker(MaxwellDeviceMemoryManager& device_memory_)
+    : device_memory{device_memory_} {}
+
+SegmentWriteTracker::~SegmentWriteTracker() = default;
+
+u64 SegmentWriteTracker::Track(DAddr address, size_t size) {
+    std::scoped_lock lock{mutex};
+    for (u64 page = PageBegin(address); page < PageEnd(address, size); ++page) {
+        Page& entry = pages.try_emplace(page, Page{0, 0}).first->second;
+        if (entry.num_tracks++ == 0) {
+            device_memory.UpdatePagesCachedCount(page << Core::Memory::CITRON_PAGEBITS,
+                                                 Core::Memory::CITRON_PAGESIZE, 1);
+        }
+    }
+    return write_counter;
+}
+
+void SegmentWriteTracker::Untrack(DAddr address, size_t size) {
+    std::scoped_lock lock{mutex};
+    for (u64 page = PageBegin(address); page < PageEnd(address, size); ++page) {
+        const auto it = pages.find(page);
+        ASSERT(it != pages.end());
+        if (--it->second.num_tracks == 0) {
+            device_memory.UpdatePagesCachedCount(page << Core::Memory::CITRON_PAGEBITS,
+                                                 Core::Memory::CITRON_PAGESIZE, -1);
+            pages.erase(it);
+        }
+    }
+}
+
+void SegmentWriteTracker::OnWrite(DAddr address, size_t size) {
+    std::scoped_lock lock{mutex};
+    const u64 page_begin = PageBegin(address);
+    const u64 page_end = PageEnd(address, size);
+    if (page_end - page_begin > pages.size()) {
+        // Large invalidations walk the few tracked pages instead of the range
+        for (auto& [page, entry] : pages) {
+            if (page >= page_begin && page < page_end) {
+                entry.last_write = ++write_counter;
+            }
+        }
+        return;
+    }
+    for (u64 page = page_begin; page < page_end; ++page) {
+        if (const auto it = pages.find(page); it != pages.end()) {
+            it->second.last_write = ++write_counter;
+        }
+    }
+}
+
+bool SegmentWriteTracker::IsWritten(DAddr address, size_t size, u64 track_counter) const {
+    std::scoped_lock lock{mutex};
+    for (u64 page = PageBegin(address); page < PageEnd(address, size); ++page) {
+        const auto it = pages.find(page);
+        if (it == pages.end() || it->second.last_write > track_counter) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace Tegra
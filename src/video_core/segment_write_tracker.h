@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <mutex>
+#include <unordered_map>
+
+#include "common/common_types.h"
+#include "video_core/host1x/gpu_device_memory_manager.h"
+
+namespace Tegra {
+
+/**
+ * Tracks the writes to the pages of the command list segments cached by the DMA pushers, so
+ * segments whose memory was not written since they were decoded are replayed without reading
+ * them again. Tracked pages are marked as cached in the device memory, which sends the CPU writes
+ * to them through the GPU like the writes to the memory of the rasterizer caches.
+ */
+class SegmentWriteTracker {
+public:
+    explicit SegmentWriteTracker(MaxwellDeviceMemoryManager& device_memory_);
+    ~SegmentWriteTracker();
+
+    /// Starts tracking the writes to the pages of a range. Returns the write counter, which is
+    /// passed to IsWritten to check whether the range was written after this call.
+    u64 Track(DAddr address, size_t size);
+
+    /// Stops tracking a range passed to Track.
+    void Untrack(DAddr address, size_t size);
+
+    /// Notifies a write to the memory, from the CPU or the GPU.
+    void OnWrite(DAddr address, size_t size);
+
+    /// Returns true when a tracked page of the range was written after the write counter was
+    /// returned by Track.
+    [[nodiscard]] bool IsWritten(DAddr address, size_t size, u64 track_counter) const;
+
+private:
+    struct Page {
+        u32 num_tracks;  ///< Number of tracked ranges on the page
+        u64 last_write;  ///< Write counter of the last write to the page
+    };
+
+    MaxwellDeviceMemoryManager& device_memory;
+    mutable std::mutex mutex;
+    std::unordered_map<u64, Page> pages;
+    u64 write_counter{};
+};
+
+} // namespace Tegra
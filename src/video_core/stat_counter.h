@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+
+#include "common/common_types.h"
+
+namespace VideoCommon {
+
+/// Statistic added to from any thread, read back and cleared periodically by the frontend
+class StatCounter {
+public:
+    void Add(u64 value) {
+        count.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    /// Returns the sum since the last call
+    [[nodiscard]] u64 GetAndReset() {
+        return count.exchange(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<u64> count{};
+};
+
+} // namespace VideoCommon
@@ -3,32 +3,36 @@
 
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
 #include <span>
-#include <bc_decoder.h>
+
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#endif
 
 #include "common/common_types.h"
+#include "common/div_ceil.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
 #include "video_core/texture_cache/decode_bc.h"
+#include "video_core/textures/workers.h"
 
 namespace VideoCommon {
 
 namespace {
+using namespace Common::Literals;
+
 constexpr u32 BLOCK_SIZE = 4;
 
-using VideoCore::Surface::PixelFormat;
+/// Decodes below this size are done on the calling thread
+constexpr size_t PARALLEL_DECODE_THRESHOLD = 256_KiB;
+/// Approximate amount of decoded bytes produced by each worker task
+constexpr size_t DECODE_TASK_SIZE = 128_KiB;
 
-constexpr bool IsSigned(PixelFormat pixel_format) {
-    switch (pixel_format) {
-    case PixelFormat::BC4_SNORM:
-    case PixelFormat::BC4_UNORM:
-    case PixelFormat::BC5_SNORM:
-    case PixelFormat::BC5_UNORM:
-    case PixelFormat::BC6H_SFLOAT:
-    case PixelFormat::BC6H_UFLOAT:
-        return true;
-    default:
-        return false;
-    }
-}
+using VideoCore::Surface::PixelFormat;
 
 constexpr u32 BlockSize(PixelFormat pixel_format) {
     switch (pixel_format) {
@@ -41,95 +45,751 @@ constexpr u32 BlockSize(PixelFormat pixel_format) {
         return 16;
     }
 }
-} // Anonymous namespace
 
-u32 ConvertedBytesPerBlock(VideoCore::Surface::PixelFormat pixel_format) {
-    switch (pixel_format) {
-    case PixelFormat::BC4_SNORM:
-    case PixelFormat::BC4_UNORM:
-        return 1;
-    case PixelFormat::BC5_SNORM:
-    case PixelFormat::BC5_UNORM:
-        return 2;
-    case PixelFormat::BC6H_SFLOAT:
-    case PixelFormat::BC6H_UFLOAT:
-        return 8;
+/// Decodes a whole 4x4 block to dst, whose rows are pitch bytes apart
+using BlockDecoder = void (*)(const u8* src, u8* dst, size_t pitch, bool is_signed);
+
+/// Returns the address of the i-th texel of a block in raster order
+[[nodiscard]] u8* TexelAddress(u8* dst, size_t pitch, u32 bpp, u32 i) {
+    return dst + (i / BLOCK_SIZE) * pitch + (i % BLOCK_SIZE) * bpp;
+}
+
+[[nodiscard]] u64 LoadU64(const u8* src) {
+    u64 value;
+    std::memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+[[nodiscard]] std::array<u8, 4> Expand565(u16 color) {
+    const u32 r = (color >> 11) & 0x1f;
+    const u32 g = (color >> 5) & 0x3f;
+    const u32 b = color & 0x1f;
+    return {static_cast<u8>((r << 3) | (r >> 2)), static_cast<u8>((g << 2) | (g >> 4)),
+            static_cast<u8>((b << 3) | (b >> 2)), 255};
+}
+
+/// Decodes a BC1 style color block to RGBA8, three color mode is only honored for BC1
+template <bool ThreeColorMode>
+void DecodeColorBlock(const u8* src, u8* dst, size_t pitch) {
+    u16 c0;
+    u16 c1;
+    u32 indices;
+    std::memcpy(&c0, src, sizeof(c0));
+    std::memcpy(&c1, src + 2, sizeof(c1));
+    std::memcpy(&indices, src + 4, sizeof(indices));
+
+    std::array<std::array<u8, 4>, 4> palette{Expand565(c0), Expand565(c1)};
+    if (!ThreeColorMode || c0 > c1) {
+        for (u32 c = 0; c < 3; ++c) {
+            palette[2][c] = static_cast<u8>((2 * palette[0][c] + palette[1][c]) / 3);
+            palette[3][c] = static_cast<u8>((palette[0][c] + 2 * palette[1][c]) / 3);
+        }
+        palette[2][3] = 255;
+        palette[3][3] = 255;
+    } else {
+        for (u32 c = 0; c < 3; ++c) {
+            palette[2][c] = static_cast<u8>((palette[0][c] + palette[1][c]) >> 1);
+        }
+        palette[2][3] = 255;
+        palette[3] = {0, 0, 0, 0};
+    }
+    for (u32 i = 0; i < 16; ++i) {
+        std::memcpy(TexelAddress(dst, pitch, 4, i), palette[(indices >> (i * 2)) & 3].data(), 4);
+    }
+}
+
+/// Decodes a BC4 style channel block into the first byte of texels bpp bytes wide
+template <bool Signed>
+void DecodeChannelBlock(const u8* src, u8* dst, size_t pitch, u32 bpp) {
+    const u64 data = LoadU64(src);
+    std::array<s32, 8> palette{};
+    if constexpr (Signed) {
+        palette[0] = static_cast<s8>(data & 0xff);
+        palette[1] = static_cast<s8>((data >> 8) & 0xff);
+    } else {
+        palette[0] = static_cast<u8>(data & 0xff);
+        palette[1] = static_cast<u8>((data >> 8) & 0xff);
+    }
+    if (palette[0] > palette[1]) {
+        for (s32 i = 2; i < 8; ++i) {
+            palette[i] = ((8 - i) * palette[0] + (i - 1) * palette[1]) / 7;
+        }
+    } else {
+        for (s32 i = 2; i < 6; ++i) {
+            palette[i] = ((6 - i) * palette[0] + (i - 1) * palette[1]) / 5;
+        }
+        palette[6] = Signed ? -128 : 0;
+        palette[7] = Signed ? 127 : 255;
+    }
+    for (u32 i = 0; i < 16; ++i) {
+        *TexelAddress(dst, pitch, bpp, i) = static_cast<u8>(palette[(data >> (16 + i * 3)) & 7]);
+    }
+}
+
+void DecodeBC1Block(const u8* src, u8* dst, size_t pitch, bool) {
+    DecodeColorBlock<true>(src, dst, pitch);
+}
+
+void DecodeBC2Block(const u8* src, u8* dst, size_t pitch, bool) {
+    DecodeColorBlock<false>(src + 8, dst, pitch);
+    const u64 alpha = LoadU64(src);
+    for (u32 i = 0; i < 16; ++i) {
+        const u32 value = static_cast<u32>(alpha >> (i * 4)) & 0xf;
+        TexelAddress(dst, pitch, 4, i)[3] = static_cast<u8>(value | (value << 4));
+    }
+}
+
+void DecodeBC3Block(const u8* src, u8* dst, size_t pitch, bool) {
+    DecodeColorBlock<false>(src + 8, dst, pitch);
+    DecodeChannelBlock<false>(src, dst + 3, pitch, 4);
+}
+
+void DecodeBC4Block(const u8* src, u8* dst, size_t pitch, bool is_signed) {
+    if (is_signed) {
+        DecodeChannelBlock<true>(src, dst, pitch, 1);
+    } else {
+        DecodeChannelBlock<false>(src, dst, pitch, 1);
+    }
+}
+
+void DecodeBC5Block(const u8* src, u8* dst, size_t pitch, bool is_signed) {
+    if (is_signed) {
+        DecodeChannelBlock<true>(src, dst, pitch, 2);
+        DecodeChannelBlock<true>(src + 8, dst + 1, pitch, 2);
+    } else {
+        DecodeChannelBlock<false>(src, dst, pitch, 2);
+        DecodeChannelBlock<false>(src + 8, dst + 1, pitch, 2);
+    }
+}
+
+namespace BC7 {
+// https://registry.khronos.org/OpenGL/extensions/ARB/ARB_texture_compression_bptc.txt
+
+struct ModeInfo {
+    u8 num_subsets;
+    u8 partition_bits;
+    u8 rotation_bits;
+    u8 index_selection_bits;
+    u8 color_bits;
+    u8 alpha_bits;
+    u8 endpoint_pbits;
+    u8 shared_pbits;
+    u8 index_bits;
+    u8 index_bits2;
+};
+
+constexpr std::array<ModeInfo, 8> MODES{{
+    {3, 4, 0, 0, 4, 0, 1, 0, 3, 0},
+    {2, 6, 0, 0, 6, 0, 0, 1, 3, 0},
+    {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+    {2, 6, 0, 0, 7, 0, 1, 0, 2, 0},
+    {1, 0, 2, 1, 5, 6, 0, 0, 2, 3},
+    {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+    {1, 0, 0, 0, 7, 7, 1, 0, 4, 0},
+    {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+}};
+
+/// Subset of each texel, packed as two bits per texel
+constexpr std::array<u32, 64> PARTITIONS_2{
+    0x50505050, 0x40404040, 0x54545454, 0x54505040, 0x50404000, 0x55545450, 0x55545040,
+    0x54504000, 0x50400000, 0x55555450, 0x55544000, 0x54400000, 0x55555440, 0x55550000,
+    0x55555500, 0x55000000, 0x55150100, 0x00004054, 0x15010000, 0x00405054, 0x00004050,
+    0x15050100, 0x05010000, 0x40505054, 0x00404050, 0x05010100, 0x14141414, 0x05141450,
+    0x01155440, 0x00555500, 0x15014054, 0x05414150, 0x44444444, 0x55005500, 0x11441144,
+    0x05055050, 0x05500550, 0x11114444, 0x41144114, 0x44111144, 0x15055054, 0x01055040,
+    0x05041050, 0x05455150, 0x14414114, 0x50050550, 0x41411414, 0x00141400, 0x00041504,
+    0x00105410, 0x10541000, 0x04150400, 0x50410514, 0x41051450, 0x05415014, 0x14054150,
+    0x41050514, 0x41505014, 0x40011554, 0x54150140, 0x50505500, 0x00555050, 0x15151010,
+    0x54540404,
+};
+
+constexpr std::array<u32, 64> PARTITIONS_3{
+    0xaa685050, 0x6a5a5040, 0x5a5a4200, 0x5450a0a8, 0xa5a50000, 0xa0a05050, 0x5555a0a0,
+    0x5a5a5050, 0xaa550000, 0xaa555500, 0xaaaa5500, 0x90909090, 0x94949494, 0xa4a4a4a4,
+    0xa9a59450, 0x2a0a4250, 0xa5945040, 0x0a425054, 0xa5a5a500, 0x55a0a0a0, 0xa8a85454,
+    0x6a6a4040, 0xa4a45000, 0x1a1a0500, 0x0050a4a4, 0xaaa59090, 0x14696914, 0x69691400,
+    0xa08585a0, 0xaa821414, 0x50a4a450, 0x6a5a0200, 0xa9a58000, 0x5090a0a8, 0xa8a09050,
+    0x24242424, 0x00aa5500, 0x24924924, 0x24499224, 0x50a50a50, 0x500aa550, 0xaaaa4444,
+    0x66660000, 0xa5a0a5a0, 0x50a050a0, 0x69286928, 0x44aaaa44, 0x66666600, 0xaa444444,
+    0x54a854a8, 0x95809580, 0x96969600, 0xa85454a8, 0x80959580, 0xaa141414, 0x96960000,
+    0xaaaa1414, 0xa05050a0, 0xa0a5a5a0, 0x96000000, 0x40804080, 0xa9a8a9a8, 0xaaaaaa44,
+    0x2a4a5254,
+};
+
+constexpr std::array<u8, 64> ANCHORS_2{
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 2,  8,  2,  2,  8,
+    8,  15, 2,  8,  2,  2,  8,  8,  2,  2,  15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,
+    2,  15, 15, 6,  6,  2,  6,  8,  15, 15, 2,  2,  15, 15, 15, 15, 15, 2,  2,  15,
+};
+
+constexpr std::array<u8, 64> ANCHORS_3A{
+    3,  3,  15, 15, 8,  3,  15, 15, 8,  8,  6,  6,  6,  5,  3,  3, 3, 3,  8,  15, 3,  3,
+    6,  10, 5,  8,  8,  6,  8,  5,  15, 15, 8,  15, 3,  5,  6,  10, 8, 15, 15, 3,  15, 5,
+    15, 15, 15, 15, 3,  15, 5,  5,  5,  8,  5,  10, 5,  10, 8,  13, 15, 12, 3,  3,
+};
+
+constexpr std::array<u8, 64> ANCHORS_3B{
+    15, 8,  8,  3,  15, 15, 3,  8,  15, 15, 15, 15, 15, 15, 15, 8,  15, 8,  15, 3,  15, 8,
+    15, 8,  3,  15, 6,  10, 15, 15, 10, 8,  15, 3,  15, 10, 10, 8,  9,  10, 6,  15, 8,  15,
+    3,  6,  6,  8,  15, 3,  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3,  15, 15, 8,
+};
+
+constexpr std::array<u8, 4> WEIGHTS_2{0, 21, 43, 64};
+constexpr std::array<u8, 8> WEIGHTS_3{0, 9, 18, 27, 37, 46, 55, 64};
+constexpr std::array<u8, 16> WEIGHTS_4{0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+[[nodiscard]] constexpr const u8* Weights(u32 index_bits) {
+    switch (index_bits) {
+    case 2:
+        return WEIGHTS_2.data();
+    case 3:
+        return WEIGHTS_3.data();
     default:
-        return 4;
+        return WEIGHTS_4.data();
     }
 }
 
-template <auto decompress, PixelFormat pixel_format>
-void DecompressBlocks(std::span<const u8> input, std::span<u8> output, BufferImageCopy& copy,
-                      bool is_signed = false) {
-    const u32 out_bpp = ConvertedBytesPerBlock(pixel_format);
-    const u32 block_size = BlockSize(pixel_format);
-    const u32 width = copy.image_extent.width;
-    const u32 height = copy.image_extent.height * copy.image_subresource.num_layers;
-    const u32 depth = copy.image_extent.depth;
-    const u32 block_width = std::min(width, BLOCK_SIZE);
-    const u32 block_height = std::min(height, BLOCK_SIZE);
-    const u32 pitch = width * out_bpp;
-    size_t input_offset = 0;
-    size_t output_offset = 0;
-    for (u32 slice = 0; slice < depth; ++slice) {
-        for (u32 y = 0; y < height; y += block_height) {
-            size_t src_offset = input_offset;
-            size_t dst_offset = output_offset;
-            for (u32 x = 0; x < width; x += block_width) {
-                const u8* src = input.data() + src_offset;
-                u8* const dst = output.data() + dst_offset;
-                if constexpr (IsSigned(pixel_format)) {
-                    decompress(src, dst, x, y, width, height, is_signed);
-                } else {
-                    decompress(src, dst, x, y, width, height);
+/// Reads the fields of a 128-bit block from its least significant bit onwards
+class BitReader {
+public:
+    explicit BitReader(const u8* block) : low{LoadU64(block)}, high{LoadU64(block + 8)} {}
+
+    u32 Read(u32 count) {
+        if (count == 0) {
+            return 0;
+        }
+        const u32 value = static_cast<u32>(low & ((u64{1} << count) - 1));
+        low = (low >> count) | (high << (64 - count));
+        high >>= count;
+        return value;
+    }
+
+private:
+    u64 low;
+    u64 high;
+};
+
+/// Blends the endpoint pair of each texel with 6-bit weights, per channel
+[[maybe_unused]] void InterpolateScalar(const u8 (*ep0)[4], const u8 (*ep1)[4],
+                                         const u16 (*weights)[4], u8* dst, size_t pitch) {
+    for (u32 i = 0; i < 16; ++i) {
+        u8* const texel = TexelAddress(dst, pitch, 4, i);
+        for (u32 c = 0; c < 4; ++c) {
+            const u32 w = weights[i][c];
+            texel[c] = static_cast<u8>(((64 - w) * ep0[i][c] + w * ep1[i][c] + 32) >> 6);
+        }
+    }
+}
+
+#if defined(ARCHITECTURE_x86_64)
+void InterpolateSSE2(const u8 (*ep0)[4], const u8 (*ep1)[4], const u16 (*weights)[4],
+                     u8* dst, size_t pitch) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i sixty_four = _mm_set1_epi16(64);
+    const __m128i round = _mm_set1_epi16(32);
+    for (u32 i = 0; i < 16; i += 4) {
+        __m128i halves[2];
+        for (u32 half = 0; half < 2; ++half) {
+            const u32 texel = i + half * 2;
+            const __m128i e0 = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ep0[texel])), zero);
+            const __m128i e1 = _mm_unpacklo_epi8(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(ep1[texel])), zero);
+            const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(weights[texel]));
+            const __m128i sum = _mm_add_epi16(
+                _mm_add_epi16(_mm_mullo_epi16(e0, _mm_sub_epi16(sixty_four, w)),
+                              _mm_mullo_epi16(e1, w)),
+                round);
+            halves[half] = _mm_srli_epi16(sum, 6);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + (i / BLOCK_SIZE) * pitch),
+                         _mm_packus_epi16(halves[0], halves[1]));
+    }
+}
+#endif
+
+void DecodeBlock(const u8* src, u8* dst, size_t pitch) {
+    if (src[0] == 0) {
+        // Reserved mode
+        for (u32 row = 0; row < BLOCK_SIZE; ++row) {
+            std::memset(dst + row * pitch, 0, BLOCK_SIZE * 4);
+        }
+        return;
+    }
+    const u32 mode_index = static_cast<u32>(std::countr_zero(src[0]));
+    const ModeInfo& mode = MODES[mode_index];
+    BitReader bits(src);
+    bits.Read(mode_index + 1);
+    const u32 partition = bits.Read(mode.partition_bits);
+    const u32 rotation = bits.Read(mode.rotation_bits);
+    const u32 index_selection = bits.Read(mode.index_selection_bits);
+
+    const u32 num_endpoints = mode.num_subsets * 2u;
+    u8 endpoints[6][4];
+    for (u32 c = 0; c < 3; ++c) {
+        for (u32 e = 0; e < num_endpoints; ++e) {
+            endpoints[e][c] = static_cast<u8>(bits.Read(mode.color_bits));
+        }
+    }
+    for (u32 e = 0; e < num_endpoints; ++e) {
+        endpoints[e][3] = static_cast<u8>(mode.alpha_bits != 0 ? bits.Read(mode.alpha_bits) : 255);
+    }
+    const u32 num_channels = mode.alpha_bits != 0 ? 4 : 3;
+    if (mode.endpoint_pbits != 0) {
+        for (u32 e = 0; e < num_endpoints; ++e) {
+            const u32 pbit = bits.Read(1);
+            for (u32 c = 0; c < num_channels; ++c) {
+                endpoints[e][c] = static_cast<u8>((endpoints[e][c] << 1) | pbit);
+            }
+        }
+    }
+    if (mode.shared_pbits != 0) {
+        for (u32 subset = 0; subset < mode.num_subsets; ++subset) {
+            const u32 pbit = bits.Read(1);
+            for (u32 e = subset * 2; e < subset * 2 + 2; ++e) {
+                for (u32 c = 0; c < 3; ++c) {
+                    endpoints[e][c] = static_cast<u8>((endpoints[e][c] << 1) | pbit);
                 }
-                src_offset += block_size;
-                dst_offset += block_width * out_bpp;
             }
-            input_offset += copy.buffer_row_length * block_size / block_width;
-            output_offset += block_height * pitch;
         }
     }
+    const u32 extra_bits = mode.endpoint_pbits + mode.shared_pbits;
+    const u32 color_precision = mode.color_bits + extra_bits;
+    const u32 alpha_precision = mode.alpha_bits + extra_bits;
+    for (u32 e = 0; e < num_endpoints; ++e) {
+        for (u32 c = 0; c < num_channels; ++c) {
+            const u32 precision = c < 3 ? color_precision : alpha_precision;
+            const u32 value = static_cast<u32>(endpoints[e][c]) << (8 - precision);
+            endpoints[e][c] = static_cast<u8>(value | (value >> precision));
+        }
+    }
+
+    u32 subsets = 0;
+    std::array<u32, 3> anchors{0, 16, 16};
+    if (mode.num_subsets == 2) {
+        subsets = PARTITIONS_2[partition];
+        anchors[1] = ANCHORS_2[partition];
+    } else if (mode.num_subsets == 3) {
+        subsets = PARTITIONS_3[partition];
+        anchors[1] = ANCHORS_3A[partition];
+        anchors[2] = ANCHORS_3B[partition];
+    }
+    std::array<u8, 16> primary;
+    for (u32 i = 0; i < 16; ++i) {
+        const u32 subset = (subsets >> (i * 2)) & 3;
+        primary[i] = static_cast<u8>(bits.Read(mode.index_bits - (anchors[subset] == i ? 1 : 0)));
+    }
+    std::array<u8, 16> secondary;
+    if (mode.index_bits2 != 0) {
+        for (u32 i = 0; i < 16; ++i) {
+            secondary[i] = static_cast<u8>(bits.Read(mode.index_bits2 - (i == 0 ? 1 : 0)));
+        }
+    } else {
+        secondary = primary;
+    }
+    // The index selection bit swaps which index set drives color and alpha
+    const bool swap_indices = index_selection != 0;
+    const std::array<u8, 16>& color_indices = swap_indices ? secondary : primary;
+    const std::array<u8, 16>& alpha_indices = swap_indices ? primary : secondary;
+    const u32 secondary_bits = mode.index_bits2 != 0 ? mode.index_bits2 : mode.index_bits;
+    const u32 color_index_bits = swap_indices ? secondary_bits : mode.index_bits;
+    const u32 alpha_index_bits = swap_indices ? mode.index_bits : secondary_bits;
+    const u8* const color_weights = Weights(color_index_bits);
+    const u8* const alpha_weights = Weights(alpha_index_bits);
+
+    alignas(16) u8 ep0[16][4];
+    alignas(16) u8 ep1[16][4];
+    alignas(16) u16 weights[16][4];
+    for (u32 i = 0; i < 16; ++i) {
+        const u32 subset = (subsets >> (i * 2)) & 3;
+        std::memcpy(ep0[i], endpoints[subset * 2], 4);
+        std::memcpy(ep1[i], endpoints[subset * 2 + 1], 4);
+        const u16 color_weight = color_weights[color_indices[i]];
+        weights[i][0] = color_weight;
+        weights[i][1] = color_weight;
+        weights[i][2] = color_weight;
+        weights[i][3] = alpha_weights[alpha_indices[i]];
+    }
+#if defined(ARCHITECTURE_x86_64)
+    InterpolateSSE2(ep0, ep1, weights, dst, pitch);
+#else
+    InterpolateScalar(ep0, ep1, weights, dst, pitch);
+#endif
+    if (rotation != 0) {
+        // Rotation 1, 2 and 3 swap alpha with red, green and blue respectively
+        for (u32 i = 0; i < 16; ++i) {
+            u8* const texel = TexelAddress(dst, pitch, 4, i);
+            std::swap(texel[3], texel[rotation - 1]);
+        }
+    }
+}
+
+} // namespace BC7
+
+void DecodeBC7Block(const u8* src, u8* dst, size_t pitch, bool) {
+    BC7::DecodeBlock(src, dst, pitch);
+}
+
+namespace BC6H {
+// https://registry.khronos.org/OpenGL/extensions/ARB/ARB_texture_compression_bptc.txt
+
+constexpr u32 R = 0;
+constexpr u32 G = 1;
+constexpr u32 B = 2;
+
+/// Alpha of every decoded texel, 1.0 as a half float
+constexpr u16 ALPHA_ONE = 0x3c00;
+
+/// A run of header bits landing in an endpoint channel, stored reversed when msb < lsb
+struct Field {
+    u8 endpoint;
+    u8 channel;
+    u8 shift;
+    u8 count;
+    bool reversed;
+};
+
+[[nodiscard]] constexpr Field F(u32 endpoint, u32 channel, u32 msb, u32 lsb) {
+    const u32 low = std::min(msb, lsb);
+    const u32 high = std::max(msb, lsb);
+    return {static_cast<u8>(endpoint), static_cast<u8>(channel), static_cast<u8>(low),
+            static_cast<u8>(high - low + 1), msb < lsb};
+}
+
+constexpr size_t MAX_FIELDS = 23;
+
+struct ModeInfo {
+    u8 num_subsets;
+    bool transformed;
+    u8 endpoint_bits;
+    std::array<u8, 3> delta_bits;
+    u8 num_fields;
+    std::array<Field, MAX_FIELDS> fields;
+};
+
+[[nodiscard]] constexpr ModeInfo MakeMode(u32 num_subsets, bool transformed, u32 endpoint_bits,
+                                          std::array<u8, 3> delta_bits,
+                                          std::initializer_list<Field> fields) {
+    ModeInfo mode{};
+    mode.num_subsets = static_cast<u8>(num_subsets);
+    mode.transformed = transformed;
+    mode.endpoint_bits = static_cast<u8>(endpoint_bits);
+    mode.delta_bits = delta_bits;
+    for (const Field& field : fields) {
+        mode.fields[mode.num_fields++] = field;
+    }
+    return mode;
+}
+
+/// Header layout of each mode after the mode bits, in the order the fields are stored
+constexpr std::array<ModeInfo, 14> MODES{
+    MakeMode(2, true, 10, {5, 5, 5},
+             {F(2, G, 4, 4), F(2, B, 4, 4), F(3, B, 4, 4), F(0, R, 9, 0), F(0, G, 9, 0),
+              F(0, B, 9, 0), F(1, R, 4, 0), F(3, G, 4, 4), F(2, G, 3, 0), F(1, G, 4, 0),
+              F(3, B, 0, 0), F(3, G, 3, 0), F(1, B, 4, 0), F(3, B, 1, 1), F(2, B, 3, 0),
+              F(2, R, 4, 0), F(3, B, 2, 2), F(3, R, 4, 0), F(3, B, 3, 3)}),
+    MakeMode(2, true, 7, {6, 6, 6},
+             {F(2, G, 5, 5), F(3, G, 5, 4), F(0, R, 6, 0), F(3, B, 1, 0), F(2, B, 4, 4),
+              F(0, G, 6, 0), F(2, B, 5, 5), F(3, B, 2, 2), F(2, G, 4, 4), F(0, B, 6, 0),
+              F(3, B, 3, 3), F(3, B, 5, 5), F(3, B, 4, 4), F(1, R, 5, 0), F(2, G, 3, 0),
+              F(1, G, 5, 0), F(3, G, 3, 0), F(1, B, 5, 0), F(2, B, 3, 0), F(2, R, 5, 0),
+              F(3, R, 5, 0)}),
+    MakeMode(2, true, 11, {5, 4, 4},
+             {F(0, R, 9, 0), F(0, G, 9, 0), F(0, B, 9, 0), F(1, R, 4, 0), F(0, R, 10, 10),
+              F(2, G, 3, 0), F(1, G, 3, 0), F(0, G, 10, 10), F(3, B, 0, 0), F(3, G, 3, 0),
+              F(1, B, 3, 0), F(0, B, 10, 10), F(3, B, 1, 1), F(2, B, 3, 0), F(2, R, 4, 0),
+              F(3, B, 2, 2), F(3, R, 4, 0), F(3, B, 3, 3)}),
+    MakeMode(1, false, 10, {},
+             {F(0, R, 9, 0), F(0, G, 9, 0), F(0, B, 9, 0), F(1, R, 9, 0), F(1, G, 9, 0),
+              F(1, B, 9, 0)}),
+    MakeMode(2, true, 11, {4, 5, 4},
+             {F(0, R, 9, 0), F(0, G, 9, 0), F(0, B, 9, 0), F(1, R, 3, 0), F(0, R, 10, 10),
+              F(3, G, 4, 4), F(2, G, 3, 0), F(1, G, 4, 0), F(0, G, 10, 10), F(3, G, 3, 0),
+              F(1, B, 3, 0), F(0, B, 10, 10), F(3, B, 1, 1), F(2, B, 3, 0), F(2, R, 3, 0),
+              F(3, B, 0, 0), F(3, B, 2, 2), F(3, R, 3, 0), F(2, G, 4, 4), F(3, B, 3, 3)}),
+    MakeMode(1, true, 11, {9, 9, 9},
+             {F(0, R, 9, 0), F(0, G, 9, 0), F(0, B, 9, 0), F(1, R, 8, 0), F(0, R, 10, 10),
+              F(1, G, 8, 0), F(0, G, 10, 10), F(1, B, 8, 0), F(0, B, 10, 10)}),
+    MakeMode(2, true, 11, {4, 4, 5},
+             {F(0, R, 9, 0), F(0, G, 9, 0), F(0, B, 9, 0), F(1, R, 3, 0), F(0, R, 10, 10),
+              F(2, B, 4, 4), F(2, G, 3, 0), F(1, G, 3, 0), F(0, G, 10, 10), F(3, B, 0, 0),
+              F(3, G, 3, 0), F(1, B, 4, 0), F(0, B, 10, 10), F(2, B, 3, 0), F(2, R, 3, 0),
+              F(3, B, 1, 1), F(3, B, 2, 2), F(3, R, 3, 0), F(3, B, 4, 4), F(3, B, 3, 3)}),
+    MakeMode(1, true, 12, {8, 8, 8},
+             {F(0, R, 9, 0), F(0, G, 9, 0), F(0, B, 9, 0), F(1, R, 7, 0), F(0, R, 10, 11),
+              F(1, G, 7, 0), F(0, G, 10, 11), F(1, B, 7, 0), F(0, B, 10, 11)}),
+    MakeMode(2, true, 9, {5, 5, 5},
+             {F(0, R, 8, 0), F(2, B, 4, 4), F(0, G, 8, 0), F(2, G, 4, 4), F(0, B, 8, 0),
+              F(3, B, 4, 4), F(1, R, 4, 0), F(3, G, 4, 4), F(2, G, 3, 0), F(1, G, 4, 0),
+              F(3, B, 0, 0), F(3, G, 3, 0), F(1, B, 4, 0), F(3, B, 1, 1), F(2, B, 3, 0),
+              F(2, R, 4, 0), F(3, B, 2, 2), F(3, R, 4, 0), F(3, B, 3, 3)}),
+    MakeMode(1, true, 16, {4, 4, 4},
+             {F(0, R, 9, 0), F(0, G, 9, 0), F(0, B, 9, 0), F(1, R, 3, 0), F(0, R, 10, 15),
+              F(1, G, 3, 0), F(0, G, 10, 15), F(1, B, 3, 0), F(0, B, 10, 15)}),
+    MakeMode(2, true, 8, {6, 5, 5},
+             {F(0, R, 7, 0), F(3, G, 4, 4), F(2, B, 4, 4), F(0, G, 7, 0), F(3, B, 2, 2),
+              F(2, G, 4, 4), F(0, B, 7, 0), F(3, B, 3, 3), F(3, B, 4, 4), F(1, R, 5, 0),
+              F(2, G, 3, 0), F(1, G, 4, 0), F(3, B, 0, 0), F(3, G, 3, 0), F(1, B, 4, 0),
+              F(3, B, 1, 1), F(2, B, 3, 0), F(2, R, 5, 0), F(3, R, 5, 0)}),
+    MakeMode(2, true, 8, {5, 6, 5},
+             {F(0, R, 7, 0), F(3, B, 0, 0), F(2, B, 4, 4), F(0, G, 7, 0), F(2, G, 5, 5),
+              F(2, G, 4, 4), F(0, B, 7, 0), F(3, G, 5, 5), F(3, B, 4, 4), F(1, R, 4, 0),
+              F(3, G, 4, 4), F(2, G, 3, 0), F(1, G, 5, 0), F(3, G, 3, 0), F(1, B, 4, 0),
+              F(3, B, 1, 1), F(2, B, 3, 0), F(2, R, 4, 0), F(3, B, 2, 2), F(3, R, 4, 0),
+              F(3, B, 3, 3)}),
+    MakeMode(2, true, 8, {5, 5, 6},
+             {F(0, R, 7, 0), F(3, B, 1, 1), F(2, B, 4, 4), F(0, G, 7, 0), F(2, B, 5, 5),
+              F(2, G, 4, 4), F(0, B, 7, 0), F(3, B, 5, 5), F(3, B, 4, 4), F(1, R, 4, 0),
+              F(3, G, 4, 4), F(2, G, 3, 0), F(1, G, 4, 0), F(3, B, 0, 0), F(3, G, 3, 0),
+              F(1, B, 5, 0), F(2, B, 3, 0), F(2, R, 4, 0), F(3, B, 2, 2), F(3, R, 4, 0),
+              F(3, B, 3, 3)}),
+    MakeMode(2, false, 6, {},
+             {F(0, R, 5, 0), F(3, G, 4, 4), F(3, B, 0, 0), F(3, B, 1, 1), F(2, B, 4, 4),
+              F(0, G, 5, 0), F(2, G, 5, 5), F(2, B, 5, 5), F(3, B, 2, 2), F(2, G, 4, 4),
+              F(0, B, 5, 0), F(3, G, 5, 5), F(3, B, 3, 3), F(3, B, 5, 5), F(3, B, 4, 4),
+              F(1, R, 5, 0), F(2, G, 3, 0), F(1, G, 5, 0), F(3, G, 3, 0), F(1, B, 5, 0),
+              F(2, B, 3, 0), F(2, R, 5, 0), F(3, R, 5, 0)}),
+};
+
+/// Index into MODES of every five bit mode value, the two bit modes 0 and 1 included
+constexpr std::array<s8, 32> MODE_INDICES{
+    0,  1,  2,  3,  -1, -1, 4,  5,  -1, -1, 6,  7,  -1, -1, 8,  9,
+    -1, -1, 10, -1, -1, -1, 11, -1, -1, -1, 12, -1, -1, -1, 13, -1,
+};
+
+[[nodiscard]] u32 ReverseBits(u32 value, u32 count) {
+    u32 result = 0;
+    for (u32 i = 0; i < count; ++i) {
+        result = (result << 1) | ((value >> i) & 1);
+    }
+    return result;
+}
+
+[[nodiscard]] s32 SignExtend(s32 value, u32 bits) {
+    const s32 sign = 1 << (bits - 1);
+    return ((value & ((1 << bits) - 1)) ^ sign) - sign;
+}
+
+/// Expands an endpoint channel of the given precision to the 16-bit interpolation range
+[[nodiscard]] s32 Unquantize(s32 value, u32 bits, bool is_signed) {
+    if (is_signed) {
+        if (bits >= 16 || value == 0) {
+            return value;
+        }
+        const s32 magnitude = std::abs(value);
+        const s32 result = magnitude >= (1 << (bits - 1)) - 1
+                               ? 0x7fff
+                               : ((magnitude << 15) + 0x4000) >> (bits - 1);
+        return value < 0 ? -result : result;
+    }
+    if (bits >= 15 || value == 0) {
+        return value;
+    }
+    if (value == (1 << bits) - 1) {
+        return 0xffff;
+    }
+    return ((value << 16) + 0x8000) >> bits;
+}
+
+/// Blends two unquantized endpoints and scales the result into the finite half float range
+[[nodiscard]] u16 Interpolate(s32 e0, s32 e1, u32 weight, bool is_signed) {
+    const s32 w = static_cast<s32>(weight);
+    const s32 value = ((64 - w) * e0 + w * e1 + 32) >> 6;
+    if (!is_signed) {
+        return static_cast<u16>((value * 31) >> 6);
+    }
+    if (value >= 0) {
+        return static_cast<u16>((value * 31) >> 5);
+    }
+    // Negative zero is flushed to positive zero
+    const s32 magnitude = (-value * 31) >> 5;
+    return static_cast<u16>(magnitude == 0 ? 0 : magnitude | 0x8000);
+}
+
+void DecodeBlock(const u8* src, u8* dst, size_t pitch, bool is_signed) {
+    BC7::BitReader bits(src);
+    const s32 mode_index = MODE_INDICES[bits.Read((src[0] & 2) != 0 ? 5 : 2)];
+    if (mode_index < 0) {
+        // Reserved modes decode to opaque black
+        constexpr std::array<u16, 4> black{0, 0, 0, ALPHA_ONE};
+        for (u32 i = 0; i < 16; ++i) {
+            std::memcpy(TexelAddress(dst, pitch, 8, i), black.data(), sizeof(black));
+        }
+        return;
+    }
+    const ModeInfo& mode = MODES[mode_index];
+    std::array<std::array<s32, 3>, 4> endpoints{};
+    for (u32 f = 0; f < mode.num_fields; ++f) {
+        const Field& field = mode.fields[f];
+        u32 value = bits.Read(field.count);
+        if (field.reversed) {
+            value = ReverseBits(value, field.count);
+        }
+        endpoints[field.endpoint][field.channel] |= static_cast<s32>(value << field.shift);
+    }
+    const u32 partition = mode.num_subsets == 2 ? bits.Read(5) : 0;
+
+    // Endpoints past the first are deltas from it in transformed modes
+    const u32 num_endpoints = mode.num_subsets * 2u;
+    const u32 base_bits = mode.endpoint_bits;
+    for (u32 c = 0; c < 3; ++c) {
+        if (is_signed) {
+            endpoints[0][c] = SignExtend(endpoints[0][c], base_bits);
+        }
+        for (u32 e = 1; e < num_endpoints; ++e) {
+            s32& value = endpoints[e][c];
+            if (mode.transformed) {
+                value = SignExtend(value, mode.delta_bits[c]) + endpoints[0][c];
+                value &= (1 << base_bits) - 1;
+            }
+            if (is_signed) {
+                value = SignExtend(value, base_bits);
+            }
+        }
+        for (u32 e = 0; e < num_endpoints; ++e) {
+            endpoints[e][c] = Unquantize(endpoints[e][c], base_bits, is_signed);
+        }
+    }
+
+    // Every subset gets its own palette, indexed by subset and then by texel index
+    const u32 index_bits = mode.num_subsets == 2 ? 3 : 4;
+    const u8* const weights = index_bits == 3 ? BC7::WEIGHTS_3.data() : BC7::WEIGHTS_4.data();
+    const u32 palette_size = 1u << index_bits;
+    std::array<std::array<u16, 4>, 16> palette;
+    for (u32 subset = 0; subset < mode.num_subsets; ++subset) {
+        const auto& e0 = endpoints[subset * 2];
+        const auto& e1 = endpoints[subset * 2 + 1];
+        for (u32 index = 0; index < palette_size; ++index) {
+            std::array<u16, 4>& color = palette[subset * palette_size + index];
+            for (u32 c = 0; c < 3; ++c) {
+                color[c] = Interpolate(e0[c], e1[c], weights[index], is_signed);
+            }
+            color[3] = ALPHA_ONE;
+        }
+    }
+    const u32 subsets = mode.num_subsets == 2 ? BC7::PARTITIONS_2[partition] : 0;
+    const u32 anchor = mode.num_subsets == 2 ? BC7::ANCHORS_2[partition] : 0;
+    for (u32 i = 0; i < 16; ++i) {
+        const bool is_anchor = i == 0 || i == anchor;
+        const u32 index = bits.Read(index_bits - (is_anchor ? 1 : 0));
+        const u32 subset = (subsets >> (i * 2)) & 3;
+        std::memcpy(TexelAddress(dst, pitch, 8, i), palette[subset * palette_size + index].data(),
+                    8);
+    }
 }
 
-void DecompressBCn(std::span<const u8> input, std::span<u8> output, BufferImageCopy& copy,
-                   VideoCore::Surface::PixelFormat pixel_format) {
+} // namespace BC6H
+
+void DecodeBC6Block(const u8* src, u8* dst, size_t pitch, bool is_signed) {
+    BC6H::DecodeBlock(src, dst, pitch, is_signed);
+}
+
+[[nodiscard]] BlockDecoder GetBlockDecoder(PixelFormat pixel_format) {
     switch (pixel_format) {
     case PixelFormat::BC1_RGBA_UNORM:
     case PixelFormat::BC1_RGBA_SRGB:
-        DecompressBlocks<bcn::DecodeBc1, PixelFormat::BC1_RGBA_UNORM>(input, output, copy);
-        break;
+        return DecodeBC1Block;
     case PixelFormat::BC2_UNORM:
     case PixelFormat::BC2_SRGB:
-        DecompressBlocks<bcn::DecodeBc2, PixelFormat::BC2_UNORM>(input, output, copy);
-        break;
+        return DecodeBC2Block;
     case PixelFormat::BC3_UNORM:
     case PixelFormat::BC3_SRGB:
-        DecompressBlocks<bcn::DecodeBc3, PixelFormat::BC3_UNORM>(input, output, copy);
-        break;
+        return DecodeBC3Block;
     case PixelFormat::BC4_SNORM:
     case PixelFormat::BC4_UNORM:
-        DecompressBlocks<bcn::DecodeBc4, PixelFormat::BC4_UNORM>(
-            input, output, copy, pixel_format == PixelFormat::BC4_SNORM);
-        break;
+        return DecodeBC4Block;
     case PixelFormat::BC5_SNORM:
     case PixelFormat::BC5_UNORM:
-        DecompressBlocks<bcn::DecodeBc5, PixelFormat::BC5_UNORM>(
-            input, output, copy, pixel_format == PixelFormat::BC5_SNORM);
-        break;
+        return DecodeBC5Block;
     case PixelFormat::BC6H_SFLOAT:
     case PixelFormat::BC6H_UFLOAT:
-        DecompressBlocks<bcn::DecodeBc6, PixelFormat::BC6H_UFLOAT>(
-            input, output, copy, pixel_format == PixelFormat::BC6H_SFLOAT);
-        break;
+        return DecodeBC6Block;
     case PixelFormat::BC7_SRGB:
     case PixelFormat::BC7_UNORM:
-        DecompressBlocks<bcn::DecodeBc7, PixelFormat::BC7_UNORM>(input, output, copy);
-        break;
+        return DecodeBC7Block;
+    default:
+        return nullptr;
+    }
+}
+
+} // Anonymous namespace
+
+u32 ConvertedBytesPerBlock(VideoCore::Surface::PixelFormat pixel_format) {
+    switch (pixel_format) {
+    case PixelFormat::BC4_SNORM:
+    case PixelFormat::BC4_UNORM:
+        return 1;
+    case PixelFormat::BC5_SNORM:
+    case PixelFormat::BC5_UNORM:
+        return 2;
+    case PixelFormat::BC6H_SFLOAT:
+    case PixelFormat::BC6H_UFLOAT:
+        return 8;
     default:
+        return 4;
+    }
+}
+
+void DecompressBCn(std::span<const u8> input, std::span<u8> output, BufferImageCopy& copy,
+                   VideoCore::Surface::PixelFormat pixel_format) {
+    const BlockDecoder decode = GetBlockDecoder(pixel_format);
+    if (!decode) {
         LOG_WARNING(HW_GPU, "Unimplemented BCn decompression {}", pixel_format);
+        return;
+    }
+    const bool is_signed = pixel_format == PixelFormat::BC4_SNORM ||
+                           pixel_format == PixelFormat::BC5_SNORM ||
+                           pixel_format == PixelFormat::BC6H_SFLOAT;
+    const u32 out_bpp = ConvertedBytesPerBlock(pixel_format);
+    const u32 block_size = BlockSize(pixel_format);
+    const u32 width = copy.image_extent.width;
+    const u32 height = copy.image_extent.height;
+    const u32 num_planes = copy.image_extent.depth * copy.image_subresource.num_layers;
+    const u32 blocks_x = Common::DivCeil(copy.buffer_row_length, BLOCK_SIZE);
+    const u32 blocks_y = Common::DivCeil(height, BLOCK_SIZE);
+    const u32 pitch = width * out_bpp;
+    const size_t input_plane_size = size_t{blocks_x} * blocks_y * block_size;
+    const size_t output_plane_size = size_t{pitch} * height;
+    const u32 total_rows = blocks_y * num_planes;
+
+    const auto decode_rows = [&](u32 row_begin, u32 row_end) {
+        alignas(16) std::array<u8, 16 * 8> texels;
+        for (u32 row = row_begin; row < row_end; ++row) {
+            const u32 plane = row / blocks_y;
+            const u32 y = (row % blocks_y) * BLOCK_SIZE;
+            const u32 rows_visible = std::min(BLOCK_SIZE, height - y);
+            const u8* src = input.data() + plane * input_plane_size +
+                            size_t{row % blocks_y} * blocks_x * block_size;
+            u8* const dst_row = output.data() + plane * output_plane_size + size_t{y} * pitch;
+            for (u32 x = 0; x < width; x += BLOCK_SIZE, src += block_size) {
+                u8* const dst = dst_row + size_t{x} * out_bpp;
+                const u32 columns_visible = std::min(BLOCK_SIZE, width - x);
+                if (rows_visible == BLOCK_SIZE && columns_visible == BLOCK_SIZE) {
+                    decode(src, dst, pitch, is_signed);
+                    continue;
+                }
+                // Edge blocks are decoded aside and only their visible texels copied
+                const u32 block_pitch = BLOCK_SIZE * out_bpp;
+                decode(src, texels.data(), block_pitch, is_signed);
+                for (u32 j = 0; j < rows_visible; ++j) {
+                    std::memcpy(dst + size_t{j} * pitch, texels.data() + j * block_pitch,
+                                columns_visible * out_bpp);
+                }
+            }
+        }
+    };
+    const size_t total_bytes = output_plane_size * num_planes;
+    if (total_bytes < PARALLEL_DECODE_THRESHOLD || total_rows < 2) {
+        decode_rows(0, total_rows);
+        return;
     }
+    const size_t bytes_per_row = size_t{pitch} * BLOCK_SIZE;
+    const u32 rows_per_task = std::max(static_cast<u32>(DECODE_TASK_SIZE / bytes_per_row), 1U);
+    const u32 num_tasks = Common::DivCeil(total_rows, rows_per_task);
+    Tegra::Texture::ParallelFor(num_tasks, [&](size_t task) {
+        const u32 row_begin = static_cast<u32>(task) * rows_per_task;
+        decode_rows(row_begin, std::min(row_begin + rows_per_task, total_rows));
+    });
 }
 
 } // namespace VideoCommon
@@ -142,6 +142,15 @@ void TextureCache<P>::RunGarbageCollector() {
     }
 }
 
+template <class P>
+void TextureCache<P>::LoadDiskResources(u64 title_id) {
+    if (!Settings::values.use_disk_texture_cache.GetValue()) {
+        return;
+    }
+    const u64 max_size = u64{Settings::values.disk_texture_cache_size.GetValue()} << 20;
+    transcode_cache.Open(title_id, max_size);
+}
+
 template <class P>
 void TextureCache<P>::TickFrame() {
     // If we can obtain the memory info, use it instead of the estimate.
@@ -1090,7 +1099,8 @@ void TextureCache<P>::UploadImageContents(Image& image, StagingBuffer& staging)
         unswizzle_data_buffer.resize_destructive(image.unswizzled_size_bytes);
         auto copies =
             UnswizzleImage(*gpu_memory, gpu_addr, image.info, swizzle_data, unswizzle_data_buffer);
-        ConvertImage(unswizzle_data_buffer, image.info, mapped_span, copies);
+        ConvertImage(unswizzle_data_buffer, image.info, mapped_span, copies,
+                     transcode_cache.IsOpen() ? &transcode_cache : nullptr);
         image.UploadMemory(staging, copies);
     } else {
         const auto copies =
@@ -1296,12 +1306,13 @@ void TextureCache<P>::QueueAsyncDecode(Image& image, ImageId image_id) {
                                  local_unswizzle_data_buffer);
     const size_t out_size = MapSizeBytes(image);
 
+    auto* const cache = transcode_cache.IsOpen() ? &transcode_cache : nullptr;
     auto func = [out_size, copies, info = image.info,
-                 input = std::move(local_unswizzle_data_buffer),
-                 async_decode = decode_ptr]() mutable {
+                 input = std::move(local_unswizzle_data_buffer), async_decode = decode_ptr,
+                 cache]() mutable {
         async_decode->decoded_data.resize_destructive(out_size);
         std::span copies_span{copies.data(), copies.size()};
-        ConvertImage(input, info, async_decode->decoded_data, copies_span);
+        ConvertImage(input, info, async_decode->decoded_data, copies_span, cache);
 
         // TODO: Do we need this lock?
         std::unique_lock lock{async_decode->mutex};
@@ -33,6 +33,7 @@
 #include "video_core/texture_cache/image_info.h"
 #include "video_core/texture_cache/image_view_base.h"
 #include "video_core/texture_cache/render_targets.h"
+#include "video_core/texture_cache/transcode_cache.h"
 #include "video_core/texture_cache/types.h"
 #include "video_core/textures/texture.h"
 
@@ -134,6 +135,9 @@ public:
     /// Notify the cache that a new frame has been queued
     void TickFrame();
 
+    /// Open the on-disk cache of transcoded textures of the given title
+    void LoadDiskResources(u64 title_id);
+
     /// Return a constant reference to the given image view id
     [[nodiscard]] const ImageView& GetImageView(ImageViewId id) const noexcept;
 
@@ -489,6 +493,7 @@ private:
     u64 modification_tick = 0;
     u64 frame_tick = 0;
 
+    TranscodeCache transcode_cache;
     Common::ThreadWorker texture_decode_worker{1, "TextureDecoder"};
     std::vector<std::unique_ptr<AsyncDecodeContext>> async_decodes;
 
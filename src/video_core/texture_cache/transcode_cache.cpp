@@ -0,0 +1,318 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <optional>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "common/cityhash.h"
+#include "common/fs/file.h"
+#include "common/fs/fs.h"
+#include "common/fs/path_util.h"
+#include "common/literals.h"
+#include "common/logging/log.h"
+#include "common/zstd_compression.h"
+#include "video_core/texture_cache/transcode_cache.h"
+
+namespace VideoCommon {
+namespace {
+using namespace Common::Literals;
+
+constexpr u32 TRANSCODE_CACHE_MAGIC = 0x43545843; // "CXTC"
+constexpr u32 TRANSCODE_CACHE_VERSION = 1;
+
+/// Compressed entries kept in memory, read from the disk after the cache is opened
+constexpr u64 MAX_MEMORY_SIZE = 256_MiB;
+
+struct EntryHeader {
+    u32 magic;
+    u32 version;
+    u64 key;
+    u64 size;
+};
+static_assert(std::is_trivially_copyable_v<EntryHeader>);
+
+[[nodiscard]] std::optional<u64> ParseEntryName(const std::filesystem::path& path) {
+    if (path.extension() != ".bin") {
+        return std::nullopt;
+    }
+    const std::string stem = path.stem().string();
+    if (stem.size() != 16) {
+        return std::nullopt;
+    }
+    u64 key = 0;
+    for (const char c : stem) {
+        u64 digit;
+        if (c >= '0' && c <= '9') {
+            digit = static_cast<u64>(c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<u64>(c - 'a' + 10);
+        } else {
+            return std::nullopt;
+        }
+        key = (key << 4) | digit;
+    }
+    return key;
+}
+
+} // Anonymous namespace
+
+TranscodeCache::TranscodeCache()
+    : reader{1, "TranscodeCacheReader"}, writer{1, "TranscodeCacheWriter"} {}
+
+TranscodeCache::~TranscodeCache() {
+    ++open_generation;
+    reader.WaitForRequests();
+    writer.WaitForRequests();
+}
+
+void TranscodeCache::Open(u64 title_id, u64 max_size_bytes) {
+    const u64 generation{++open_generation};
+    reader.WaitForRequests();
+    writer.WaitForRequests();
+
+    std::scoped_lock lock{mutex};
+    is_open = false;
+    entries.clear();
+    pending.clear();
+    lru.clear();
+    total_size = 0;
+    max_size = max_size_bytes;
+    memory_size = 0;
+
+    if (title_id == 0) {
+        return;
+    }
+    const auto shader_dir{Common::FS::GetCitronPath(Common::FS::CitronPath::ShaderDir)};
+    const auto title_dir{shader_dir / fmt::format("{:016x}", title_id)};
+    base_dir = title_dir / "transcoded";
+    if (!Common::FS::CreateDirs(base_dir)) {
+        LOG_ERROR(Common_Filesystem, "Failed to create texture transcode cache directory");
+        return;
+    }
+
+    // Seed the recency order from the last time each entry was written or used
+    struct Found {
+        std::filesystem::file_time_type time;
+        u64 key;
+        u64 size;
+    };
+    std::vector<Found> found;
+    Common::FS::IterateDirEntries(
+        base_dir,
+        [&found](const std::filesystem::directory_entry& entry) {
+            std::error_code ec;
+            const auto& path = entry.path();
+            if (path.extension() == ".tmp") {
+                // Leftover of an interrupted write
+                std::filesystem::remove(path, ec);
+                return true;
+            }
+            const std::optional<u64> key = ParseEntryName(path);
+            if (!key) {
+                return true;
+            }
+            const auto time = entry.last_write_time(ec);
+            const u64 size = entry.file_size(ec);
+            if (!ec) {
+                found.push_back({time, *key, size});
+            }
+            return true;
+        },
+        Common::FS::DirEntryFilter::File);
+
+    std::ranges::sort(found, {}, &Found::time);
+    for (const Found& entry : found) {
+        Insert(entry.key, entry.size);
+    }
+    EvictLocked();
+    is_open = true;
+
+    LOG_INFO(HW_GPU, "Found {} transcoded textures ({} MiB) in the disk cache", entries.size(),
+             total_size >> 20);
+    reader.QueueWork([this, generation] { Preload(generation); });
+}
+
+u64 TranscodeCache::MakeKey(std::span<const u8> input, std::span<const u32> params) {
+    std::array<u64, 3> key_data{
+        Common::CityHash64(reinterpret_cast<const char*>(input.data()), input.size_bytes()),
+        Common::CityHash64(reinterpret_cast<const char*>(params.data()), params.size_bytes()),
+        TRANSCODE_CACHE_VERSION,
+    };
+    return Common::CityHash64(reinterpret_cast<const char*>(key_data.data()),
+                              sizeof(key_data));
+}
+
+bool TranscodeCache::Load(u64 key, std::span<u8> output) {
+    std::shared_ptr<const std::vector<u8>> compressed;
+    {
+        std::scoped_lock lock{mutex};
+        if (!is_open) {
+            return false;
+        }
+        const auto it = entries.find(key);
+        if (it == entries.end() || !it->second.compressed ||
+            it->second.decompressed_size != output.size()) {
+            return false;
+        }
+        compressed = it->second.compressed;
+    }
+    const std::vector<u8> decompressed = Common::Compression::DecompressDataZSTD(*compressed);
+    const bool valid = decompressed.size() == output.size();
+    if (valid) {
+        std::memcpy(output.data(), decompressed.data(), output.size());
+    }
+
+    std::scoped_lock lock{mutex};
+    if (!valid) {
+        LOG_WARNING(HW_GPU, "Dropping invalid transcode cache entry {:016x}", key);
+        writer.QueueWork([this, key] {
+            std::scoped_lock writer_lock{mutex};
+            Remove(key);
+        });
+        return false;
+    }
+    const auto it = entries.find(key);
+    if (it != entries.end()) {
+        lru.splice(lru.end(), lru, it->second.lru_it);
+    }
+    // Keep the recency order across boots
+    writer.QueueWork([path = EntryPath(key)] {
+        std::error_code ec;
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+    });
+    return true;
+}
+
+void TranscodeCache::Store(u64 key, std::span<const u8> data) {
+    {
+        std::scoped_lock lock{mutex};
+        if (!is_open || entries.contains(key) || !pending.insert(key).second) {
+            return;
+        }
+    }
+    writer.QueueWork([this, key, data = std::vector<u8>(data.begin(), data.end())] {
+        const std::vector<u8> compressed =
+            Common::Compression::CompressDataZSTDDefault(data.data(), data.size());
+        const EntryHeader header{
+            .magic = TRANSCODE_CACHE_MAGIC,
+            .version = TRANSCODE_CACHE_VERSION,
+            .key = key,
+            .size = data.size(),
+        };
+        const std::filesystem::path path = EntryPath(key);
+        auto temp_path = path;
+        temp_path.replace_extension(".tmp");
+        bool written = false;
+        {
+            Common::FS::IOFile file(temp_path, Common::FS::FileAccessMode::Write,
+                                    Common::FS::FileType::BinaryFile);
+            written = file.IsOpen() && file.WriteObject(header) &&
+                      file.WriteSpan(std::span<const u8>(compressed)) == compressed.size();
+        }
+        written = written && Common::FS::RenameFile(temp_path, path);
+
+        std::scoped_lock lock{mutex};
+        pending.erase(key);
+        if (!written) {
+            LOG_ERROR(Common_Filesystem, "Failed to write transcode cache entry {:016x}", key);
+            Common::FS::RemoveFile(temp_path);
+            return;
+        }
+        Insert(key, sizeof(header) + compressed.size());
+        KeepInMemoryLocked(key, std::move(compressed), header.size);
+        EvictLocked();
+    });
+}
+
+std::filesystem::path TranscodeCache::EntryPath(u64 key) const {
+    return base_dir / fmt::format("{:016x}.bin", key);
+}
+
+void TranscodeCache::Insert(u64 key, u64 size) {
+    if (entries.contains(key)) {
+        return;
+    }
+    lru.push_back(key);
+    entries.insert_or_assign(key, Entry{size, std::prev(lru.end())});
+    total_size += size;
+}
+
+void TranscodeCache::Remove(u64 key) {
+    const auto it = entries.find(key);
+    if (it == entries.end()) {
+        return;
+    }
+    Common::FS::RemoveFile(EntryPath(key));
+    total_size -= it->second.size;
+    if (it->second.compressed) {
+        memory_size -= it->second.compressed->size();
+    }
+    lru.erase(it->second.lru_it);
+    entries.erase(it);
+}
+
+void TranscodeCache::Preload(u64 generation) {
+    std::vector<u64> keys;
+    {
+        std::scoped_lock lock{mutex};
+        keys.assign(lru.rbegin(), lru.rend());
+    }
+    u64 num_loaded = 0;
+    for (const u64 key : keys) {
+        if (open_generation != generation) {
+            return;
+        }
+        const std::filesystem::path path = EntryPath(key);
+        std::vector<u8> compressed;
+        EntryHeader header{};
+        {
+            Common::FS::IOFile file(path, Common::FS::FileAccessMode::Read,
+                                    Common::FS::FileType::BinaryFile);
+            const u64 file_size = file.IsOpen() ? file.GetSize() : 0;
+            if (file_size <= sizeof(header) || !file.ReadObject(header) ||
+                header.magic != TRANSCODE_CACHE_MAGIC ||
+                header.version != TRANSCODE_CACHE_VERSION || header.key != key) {
+                continue;
+            }
+            compressed.resize(file_size - sizeof(header));
+            if (file.ReadSpan(std::span<u8>(compressed)) != compressed.size()) {
+                continue;
+            }
+        }
+        std::scoped_lock lock{mutex};
+        if (memory_size + compressed.size() > MAX_MEMORY_SIZE) {
+            break;
+        }
+        KeepInMemoryLocked(key, std::move(compressed), header.size);
+        ++num_loaded;
+    }
+    LOG_INFO(HW_GPU, "Read {} transcoded textures ({} MiB) from the disk cache", num_loaded,
+             memory_size >> 20);
+}
+
+void TranscodeCache::KeepInMemoryLocked(u64 key, std::vector<u8> compressed,
+                                        u64 decompressed_size) {
+    const auto it = entries.find(key);
+    if (it == entries.end() || it->second.compressed ||
+        memory_size + compressed.size() > MAX_MEMORY_SIZE) {
+        return;
+    }
+    memory_size += compressed.size();
+    it->second.compressed = std::make_shared<const std::vector<u8>>(std::move(compressed));
+    it->second.decompressed_size = decompressed_size;
+}
+
+void TranscodeCache::EvictLocked() {
+    while (total_size > max_size && !lru.empty()) {
+        Remove(lru.front());
+    }
+}
+
+} // namespace VideoCommon
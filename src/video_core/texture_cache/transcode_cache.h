@@ -0,0 +1,98 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "common/common_types.h"
+#include "common/thread_worker.h"
+
+namespace VideoCommon {
+
+/**
+ * Persistent, content addressed cache of texture data transcoded on the CPU (ASTC decodes and
+ * their BC1/BC3 recompressions). Entries are zstd compressed files stored per title next to the
+ * pipeline cache, evicted in least recently used order once the cache exceeds its size limit.
+ *
+ * Lookups and stores are thread safe. The most recently used entries are read into memory on a
+ * reader thread once the cache is opened, lookups only use those and never wait on the disk.
+ * Compression and disk writes happen on a writer thread.
+ */
+class TranscodeCache {
+public:
+    explicit TranscodeCache();
+    ~TranscodeCache();
+
+    TranscodeCache(const TranscodeCache&) = delete;
+    TranscodeCache& operator=(const TranscodeCache&) = delete;
+
+    /// Opens the cache of the given title, closing the previously opened one
+    void Open(u64 title_id, u64 max_size_bytes);
+
+    /// Returns true when a title's cache is open
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return is_open;
+    }
+
+    /**
+     * Builds the key of a transcode
+     *
+     * @param input  Guest texel data being transcoded
+     * @param params Format, extent and transcode mode, anything that changes the output
+     */
+    [[nodiscard]] static u64 MakeKey(std::span<const u8> input, std::span<const u32> params);
+
+    /// Fills output with the cached transcode of key, returns false on a miss or when the entry
+    /// has not been read from the disk yet
+    [[nodiscard]] bool Load(u64 key, std::span<u8> output);
+
+    /// Queues the transcoded data of key to be written to disk
+    void Store(u64 key, std::span<const u8> data);
+
+private:
+    struct Entry {
+        u64 size;
+        std::list<u64>::iterator lru_it;
+        std::shared_ptr<const std::vector<u8>> compressed{}; ///< Contents read into memory
+        u64 decompressed_size = 0;
+    };
+
+    [[nodiscard]] std::filesystem::path EntryPath(u64 key) const;
+
+    void Insert(u64 key, u64 size);
+
+    void Remove(u64 key);
+
+    /// Reads the most recently used entries into memory, stops when the cache is opened again
+    void Preload(u64 generation);
+
+    /// Keeps the compressed contents of an entry in memory if they fit in the preload budget
+    void KeepInMemoryLocked(u64 key, std::vector<u8> compressed, u64 decompressed_size);
+
+    void EvictLocked();
+
+    std::mutex mutex;
+    std::filesystem::path base_dir;
+    std::unordered_map<u64, Entry> entries;
+    std::unordered_set<u64> pending;
+    std::list<u64> lru; ///< Keys ordered from least to most recently used
+    u64 total_size = 0;
+    u64 max_size = 0;
+    u64 memory_size = 0; ///< Size of the compressed contents kept in memory
+    std::atomic_bool is_open{false};
+    std::atomic<u64> open_generation{0};
+
+    Common::ThreadWorker reader;
+    Common::ThreadWorker writer;
+};
+
+} // namespace VideoCommon
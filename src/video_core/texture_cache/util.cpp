@@ -18,6 +18,7 @@
 #include "common/bit_util.h"
 #include "common/common_types.h"
 #include "common/div_ceil.h"
+#include "common/literals.h"
 #include "common/scratch_buffer.h"
 #include "common/settings.h"
 #include "video_core/compatible_formats.h"
@@ -29,15 +30,19 @@
 #include "video_core/texture_cache/format_lookup_table.h"
 #include "video_core/texture_cache/formatter.h"
 #include "video_core/texture_cache/samples_helper.h"
+#include "video_core/texture_cache/transcode_cache.h"
 #include "video_core/texture_cache/util.h"
 #include "video_core/textures/astc.h"
 #include "video_core/textures/bcn.h"
 #include "video_core/textures/decoders.h"
+#include "video_core/textures/workers.h"
 
 namespace VideoCommon {
 
 namespace {
 
+using namespace Common::Literals;
+
 using Tegra::Texture::GOB_SIZE;
 using Tegra::Texture::GOB_SIZE_SHIFT;
 using Tegra::Texture::GOB_SIZE_X;
@@ -47,11 +52,11 @@ using Tegra::Texture::GOB_SIZE_Y_SHIFT;
 using Tegra::Texture::GOB_SIZE_Z;
 using Tegra::Texture::GOB_SIZE_Z_SHIFT;
 using Tegra::Texture::MsaaMode;
-using Tegra::Texture::SwizzleTexture;
+using Tegra::Texture::SwizzleTextureLines;
 using Tegra::Texture::TextureFormat;
 using Tegra::Texture::TextureType;
 using Tegra::Texture::TICEntry;
-using Tegra::Texture::UnswizzleTexture;
+using Tegra::Texture::UnswizzleTextureLines;
 using VideoCore::Surface::BytesPerBlock;
 using VideoCore::Surface::DefaultBlockHeight;
 using VideoCore::Surface::DefaultBlockWidth;
@@ -517,6 +522,80 @@ void SwizzlePitchLinearImage(Tegra::MemoryManager& gpu_memory, GPUVAddr gpu_addr
     }
 }
 
+/// Block linear (un)swizzles below this size are done on the calling thread
+constexpr size_t PARALLEL_SWIZZLE_THRESHOLD = 256_KiB;
+/// Approximate amount of linear bytes (un)swizzled by each worker task
+constexpr size_t SWIZZLE_TASK_SIZE = 128_KiB;
+
+/// Transcodes smaller than this are cheaper to redo than to read back from the disk cache
+constexpr size_t MIN_TRANSCODE_CACHE_SIZE = 64_KiB;
+
+/// Block linear (un)swizzle of a band of lines of a subresource
+struct SwizzleTask {
+    std::span<u8> dst;
+    std::span<const u8> src;
+    u32 bytes_per_block;
+    Extent3D num_tiles;
+    Extent3D block;
+    u32 stride_alignment;
+    u32 line_begin;
+    u32 line_end;
+};
+
+using SwizzleTaskList = boost::container::small_vector<SwizzleTask, 16>;
+
+/// Splits a subresource in bands of whole blocks and appends them to the task list
+size_t AppendSwizzleTasks(SwizzleTaskList& tasks, std::span<u8> dst, std::span<const u8> src,
+                          u32 bytes_per_block, Extent3D num_tiles, Extent3D block,
+                          u32 stride_alignment) {
+    const size_t bytes_per_line =
+        static_cast<size_t>(num_tiles.width) * num_tiles.depth * bytes_per_block;
+    const u32 block_lines = GOB_SIZE_Y << block.height;
+    const u32 lines_per_task = Common::AlignUp(
+        static_cast<u32>(std::max<size_t>(SWIZZLE_TASK_SIZE / std::max<size_t>(bytes_per_line, 1),
+                                          1)),
+        block_lines);
+    for (u32 line = 0; line < num_tiles.height; line += lines_per_task) {
+        tasks.push_back(SwizzleTask{
+            .dst = dst,
+            .src = src,
+            .bytes_per_block = bytes_per_block,
+            .num_tiles = num_tiles,
+            .block = block,
+            .stride_alignment = stride_alignment,
+            .line_begin = line,
+            .line_end = std::min(num_tiles.height, line + lines_per_task),
+        });
+    }
+    return bytes_per_line * num_tiles.height;
+}
+
+/// Runs the tasks on the transcode workers when there is enough work to amortize the handoff
+template <bool UNSWIZZLE>
+void RunSwizzleTasks(const SwizzleTaskList& tasks, size_t total_bytes) {
+    const auto run = [&tasks](size_t index) {
+        const SwizzleTask& task = tasks[index];
+        if constexpr (UNSWIZZLE) {
+            UnswizzleTextureLines(task.dst, task.src, task.bytes_per_block, task.num_tiles.width,
+                                  task.num_tiles.height, task.num_tiles.depth, task.block.height,
+                                  task.block.depth, task.stride_alignment, task.line_begin,
+                                  task.line_end);
+        } else {
+            SwizzleTextureLines(task.dst, task.src, task.bytes_per_block, task.num_tiles.width,
+                                task.num_tiles.height, task.num_tiles.depth, task.block.height,
+                                task.block.depth, task.stride_alignment, task.line_begin,
+                                task.line_end);
+        }
+    };
+    if (total_bytes < PARALLEL_SWIZZLE_THRESHOLD || tasks.size() == 1) {
+        for (size_t index = 0; index < tasks.size(); ++index) {
+            run(index);
+        }
+        return;
+    }
+    Tegra::Texture::ParallelFor(tasks.size(), run);
+}
+
 void SwizzleBlockLinearImage(Tegra::MemoryManager& gpu_memory, GPUVAddr gpu_addr,
                              const ImageInfo& info, const BufferImageCopy& copy,
                              std::span<const u8> input, Common::ScratchBuffer<u8>& tmp_buffer) {
@@ -556,8 +635,10 @@ void SwizzleBlockLinearImage(Tegra::MemoryManager& gpu_memory, GPUVAddr gpu_addr
                                                 Tegra::Memory::GuestMemoryFlags::UnsafeReadWrite>
                 dst(gpu_memory, gpu_addr + guest_offset, subresource_size, &tmp_buffer);
 
-            SwizzleTexture(dst, src, bytes_per_block, num_tiles.width, num_tiles.height,
-                           num_tiles.depth, block.height, block.depth);
+            SwizzleTaskList tasks;
+            const size_t total_bytes = AppendSwizzleTasks(tasks, dst, src, bytes_per_block,
+                                                          num_tiles, block, 1);
+            RunSwizzleTasks<false>(tasks, total_bytes);
         }
 
         host_offset += host_bytes_per_layer;
@@ -566,6 +647,17 @@ void SwizzleBlockLinearImage(Tegra::MemoryManager& gpu_memory, GPUVAddr gpu_addr
     ASSERT(host_offset - copy.buffer_offset == copy.buffer_size);
 }
 
+[[nodiscard]] Tegra::Texture::BCN::Quality RecompressionQuality() {
+    switch (Settings::values.astc_recompression_quality.GetValue()) {
+    case Settings::AstcRecompressionQuality::Fast:
+        return Tegra::Texture::BCN::Quality::Fast;
+    case Settings::AstcRecompressionQuality::High:
+        return Tegra::Texture::BCN::Quality::High;
+    default:
+        return Tegra::Texture::BCN::Quality::Normal;
+    }
+}
+
 } // Anonymous namespace
 
 u32 CalculateGuestSizeInBytes(const ImageInfo& info) noexcept {
@@ -872,6 +964,8 @@ boost::container::small_vector<BufferImageCopy, 16> UnswizzleImage(Tegra::Memory
     size_t guest_offset = 0;
     u32 host_offset = 0;
     boost::container::small_vector<BufferImageCopy, 16> copies(num_levels);
+    SwizzleTaskList tasks;
+    size_t total_bytes = 0;
 
     for (s32 level = 0; level < num_levels; ++level) {
         const Extent3D level_size = AdjustMipSize(size, level);
@@ -900,18 +994,19 @@ boost::container::small_vector<BufferImageCopy, 16> UnswizzleImage(Tegra::Memory
         for (s32 layer = 0; layer < info.resources.layers; ++layer) {
             const std::span<u8> dst = output.subspan(host_offset);
             const std::span<const u8> src = input.subspan(guest_offset + guest_layer_offset);
-            UnswizzleTexture(dst, src, 1U << bpp_log2, num_tiles.width, num_tiles.height,
-                             num_tiles.depth, block.height, block.depth, stride_alignment);
+            total_bytes += AppendSwizzleTasks(tasks, dst, src, 1U << bpp_log2, num_tiles, block,
+                                              stride_alignment);
             guest_layer_offset += layer_stride;
             host_offset += host_bytes_per_layer;
         }
         guest_offset += level_sizes[level];
     }
+    RunSwizzleTasks<true>(tasks, total_bytes);
     return copies;
 }
 
 void ConvertImage(std::span<const u8> input, const ImageInfo& info, std::span<u8> output,
-                  std::span<BufferImageCopy> copies) {
+                  std::span<BufferImageCopy> copies, TranscodeCache* transcode_cache) {
     u32 output_offset = 0;
     Common::ScratchBuffer<u8> decode_scratch;
 
@@ -931,49 +1026,67 @@ void ConvertImage(std::span<const u8> input, const ImageInfo& info, std::span<u8
         const auto recompression_setting = Settings::values.astc_recompression.GetValue();
         const bool astc = IsPixelFormatASTC(info.format);
 
-        if (astc && recompression_setting == Settings::AstcRecompression::Uncompressed) {
-            Tegra::Texture::ASTC::Decompress(
-                input_offset, copy.image_extent.width, copy.image_extent.height,
-                copy.image_subresource.num_layers * copy.image_extent.depth, tile_size.width,
-                tile_size.height, output.subspan(output_offset));
-
-            output_offset += copy.image_extent.width * copy.image_extent.height *
-                             copy.image_subresource.num_layers *
-                             BytesPerBlock(PixelFormat::A8B8G8R8_UNORM);
-        } else if (astc) {
-            // BC1 uses 0.5 bytes per texel
-            // BC3 uses 1 byte per texel
-            const auto compress = recompression_setting == Settings::AstcRecompression::Bc1
-                                      ? Tegra::Texture::BCN::CompressBC1
-                                      : Tegra::Texture::BCN::CompressBC3;
-            const auto bpp_div = recompression_setting == Settings::AstcRecompression::Bc1 ? 2 : 1;
-
-            const u32 plane_dim = copy.image_extent.width * copy.image_extent.height;
-            const u32 level_size = plane_dim * copy.image_extent.depth *
-                                   copy.image_subresource.num_layers *
-                                   BytesPerBlock(PixelFormat::A8B8G8R8_UNORM);
-            decode_scratch.resize_destructive(level_size);
-
-            Tegra::Texture::ASTC::Decompress(
-                input_offset, copy.image_extent.width, copy.image_extent.height,
-                copy.image_subresource.num_layers * copy.image_extent.depth, tile_size.width,
-                tile_size.height, decode_scratch);
-
-            compress(decode_scratch, copy.image_extent.width, copy.image_extent.height,
-                     copy.image_subresource.num_layers * copy.image_extent.depth,
-                     output.subspan(output_offset));
-
-            const u32 aligned_plane_dim = Common::AlignUp(copy.image_extent.width, 4) *
-                                          Common::AlignUp(copy.image_extent.height, 4);
-
-            copy.buffer_size =
-                (aligned_plane_dim * copy.image_extent.depth * copy.image_subresource.num_layers) /
-                bpp_div;
-            output_offset += static_cast<u32>(copy.buffer_size);
+        if (astc) {
+            const u32 width = copy.image_extent.width;
+            const u32 height = copy.image_extent.height;
+            const u32 depth = copy.image_subresource.num_layers * copy.image_extent.depth;
+            const bool recompress =
+                recompression_setting != Settings::AstcRecompression::Uncompressed;
+            const u32 bpp_div = recompression_setting == Settings::AstcRecompression::Bc1 ? 2 : 1;
+            const auto quality = RecompressionQuality();
+            const u32 output_size =
+                recompress
+                    ? (Common::AlignUp(width, 4) * Common::AlignUp(height, 4) * depth) / bpp_div
+                    : width * height * depth * BytesPerBlock(PixelFormat::A8B8G8R8_UNORM);
+            const std::span<u8> level_output = output.subspan(output_offset, output_size);
+
+            u64 cache_key = 0;
+            const bool use_cache =
+                transcode_cache != nullptr && output_size >= MIN_TRANSCODE_CACHE_SIZE;
+            if (use_cache) {
+                const u32 input_size = Common::DivCeil(width, tile_size.width) *
+                                       Common::DivCeil(height, tile_size.height) * depth * 16;
+                const std::array<u32, 7> params{
+                    static_cast<u32>(info.format),
+                    width,
+                    height,
+                    depth,
+                    static_cast<u32>(recompression_setting),
+                    static_cast<u32>(quality),
+                    output_size,
+                };
+                cache_key = TranscodeCache::MakeKey(input_offset.first(input_size), params);
+            }
+            if (!use_cache || !transcode_cache->Load(cache_key, level_output)) {
+                if (!recompress) {
+                    Tegra::Texture::ASTC::Decompress(input_offset, width, height, depth,
+                                                     tile_size.width, tile_size.height,
+                                                     level_output);
+                } else {
+                    // BC1 uses 0.5 bytes per texel
+                    // BC3 uses 1 byte per texel
+                    const auto compress = recompression_setting == Settings::AstcRecompression::Bc1
+                                              ? Tegra::Texture::BCN::CompressBC1
+                                              : Tegra::Texture::BCN::CompressBC3;
+                    decode_scratch.resize_destructive(width * height * depth *
+                                                      BytesPerBlock(PixelFormat::A8B8G8R8_UNORM));
+                    Tegra::Texture::ASTC::Decompress(input_offset, width, height, depth,
+                                                     tile_size.width, tile_size.height,
+                                                     decode_scratch);
+                    compress(decode_scratch, width, height, depth, level_output, quality);
+                }
+                if (use_cache) {
+                    transcode_cache->Store(cache_key, level_output);
+                }
+            }
+            if (recompress) {
+                copy.buffer_size = output_size;
+            }
+            output_offset += output_size;
         } else {
             DecompressBCn(input_offset, output.subspan(output_offset), copy, info.format);
             output_offset += copy.image_extent.width * copy.image_extent.height *
-                             copy.image_subresource.num_layers *
+                             copy.image_extent.depth * copy.image_subresource.num_layers *
                              ConvertedBytesPerBlock(info.format);
         }
 
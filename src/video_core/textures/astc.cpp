@@ -5,6 +5,7 @@
 // <http://gamma.cs.unc.edu/FasTC/>
 
 #include <algorithm>
+#include <array>
 #include <bit>
 #include <cassert>
 #include <cstring>
@@ -19,6 +20,19 @@
 #include "video_core/textures/astc.h"
 #include "video_core/textures/workers.h"
 
+#if defined(ARCHITECTURE_x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+#if defined(ARCHITECTURE_x86_64) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_SSE41 __attribute__((target("sse4.1")))
+#else
+#define TARGET_SSE41
+#endif
+
 class InputBitStream {
 public:
     constexpr explicit InputBitStream(std::span<const u8> data, size_t start_offset = 0)
@@ -42,21 +56,31 @@ public:
         return bit;
     }
 
+    // Reads up to 32 bits at once, bits past the end of the stream are read as zero
     constexpr u32 ReadBits(std::size_t nBits) {
-        u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
+        assert(nBits <= 32);
+        const size_t remaining = bits_read < total_bits * 8 ? total_bits * 8 - bits_read : 0;
+        const size_t count = std::min(nBits, remaining);
+        if (count == 0) {
+            return 0;
         }
-        return ret;
+        u64 value = 0;
+        const size_t num_bytes = (next_bit + count + 7) / 8;
+        for (size_t i = 0; i < num_bytes; ++i) {
+            value |= static_cast<u64>(cur_byte[i]) << (i * 8);
+        }
+        value = (value >> next_bit) & ((u64{1} << count) - 1);
+
+        next_bit += count;
+        cur_byte += next_bit / 8;
+        next_bit %= 8;
+        bits_read += count;
+        return static_cast<u32>(value);
     }
 
     template <std::size_t nBits>
     constexpr u32 ReadBits() {
-        u32 ret = 0;
-        for (std::size_t i = 0; i < nBits; ++i) {
-            ret |= (ReadBit() & 1) << i;
-        }
-        return ret;
+        return ReadBits(nBits);
     }
 
 private:
@@ -453,8 +477,11 @@ static TexelWeightParams DecodeBlockInfo(InputBitStream& strm) {
         if (modeBits & 0x100) {
             // layout is in [7-9]
             if (modeBits & 0x80) {
-                // layout is in [7-8]
-                assert((modeBits & 0x40) == 0U);
+                // layout is in [7-8], bit 6 set is reserved
+                if (modeBits & 0x40) {
+                    params.m_bError = true;
+                    return params;
+                }
                 if (modeBits & 0x20) {
                     layout = 8;
                 } else {
@@ -584,6 +611,31 @@ static TexelWeightParams DecodeBlockInfo(InputBitStream& strm) {
     return params;
 }
 
+// The block mode only depends on the first 11 bits of a block, decode all of them once.
+// Void extent modes are decoded as if the bit following the mode was set.
+static const std::array<TexelWeightParams, 2048>& GetBlockModeTable() {
+    static const auto table = [] {
+        std::array<TexelWeightParams, 2048> result{};
+        for (u32 mode = 0; mode < result.size(); ++mode) {
+            const std::array<u8, 2> bytes{static_cast<u8>(mode),
+                                          static_cast<u8>((mode >> 8) | 0x8)};
+            InputBitStream strm(bytes);
+            result[mode] = DecodeBlockInfo(strm);
+        }
+        return result;
+    }();
+    return table;
+}
+
+static TexelWeightParams LookupBlockInfo(InputBitStream& strm) {
+    TexelWeightParams params = GetBlockModeTable()[strm.ReadBits<11>()];
+    if ((params.m_bVoidExtentLDR || params.m_bVoidExtentHDR) && !params.m_bError &&
+        !strm.ReadBit()) {
+        params.m_bError = true;
+    }
+    return params;
+}
+
 // Replicates low num_bits such that [(to_bit - 1):(to_bit - 1 - from_bit)]
 // is the same as [(num_bits - 1):0] and repeats all the way down.
 template <typename IntType>
@@ -1075,9 +1127,54 @@ static u32 UnquantizeTexelWeight(const IntegerEncodedValue& val) {
     return result;
 }
 
+// Bilinear infill of a texel from the weight grid (Section C.2.18)
+struct InfillTexel {
+    std::array<u8, 4> index;
+    std::array<u8, 4> weight;
+};
+
+static void MakeInfillTable(std::span<InfillTexel> out, u32 gridWidth, u32 gridHeight,
+                            u32 blockWidth, u32 blockHeight) {
+    u32 Ds = (1024 + (blockWidth / 2)) / (blockWidth - 1);
+    u32 Dt = (1024 + (blockHeight / 2)) / (blockHeight - 1);
+
+    for (u32 t = 0; t < blockHeight; t++)
+        for (u32 s = 0; s < blockWidth; s++) {
+            u32 cs = Ds * s;
+            u32 ct = Dt * t;
+
+            u32 gs = (cs * (gridWidth - 1) + 32) >> 6;
+            u32 gt = (ct * (gridHeight - 1) + 32) >> 6;
+
+            u32 js = gs >> 4;
+            u32 fs = gs & 0xF;
+
+            u32 jt = gt >> 4;
+            u32 ft = gt & 0x0F;
+
+            u32 w11 = (fs * ft + 8) >> 4;
+            u32 w10 = ft - w11;
+            u32 w01 = fs - w11;
+            u32 w00 = 16 - fs - ft + w11;
+
+            u32 v0 = js + jt * gridWidth;
+
+            const std::array<u32, 4> indices{v0, v0 + 1, v0 + gridWidth, v0 + gridWidth + 1};
+            const std::array<u32, 4> weights{w00, w01, w10, w11};
+
+            // Texels outside of the grid don't contribute
+            InfillTexel& texel = out[t * blockWidth + s];
+            for (u32 i = 0; i < 4; i++) {
+                const bool inside = indices[i] < gridWidth * gridHeight;
+                texel.index[i] = static_cast<u8>(inside ? indices[i] : 0);
+                texel.weight[i] = static_cast<u8>(inside ? weights[i] : 0);
+            }
+        }
+}
+
 static void UnquantizeTexelWeights(u32 out[2][144], const IntegerEncodedVector& weights,
-                                   const TexelWeightParams& params, const u32 blockWidth,
-                                   const u32 blockHeight) {
+                                   const TexelWeightParams& params,
+                                   std::span<const InfillTexel> infill) {
     u32 weightIdx = 0;
     u32 unquantized[2][144];
 
@@ -1096,51 +1193,18 @@ static void UnquantizeTexelWeights(u32 out[2][144], const IntegerEncodedVector&
             break;
     }
 
-    // Do infill if necessary (Section C.2.18) ...
-    u32 Ds = (1024 + (blockWidth / 2)) / (blockWidth - 1);
-    u32 Dt = (1024 + (blockHeight / 2)) / (blockHeight - 1);
-
     const u32 kPlaneScale = params.m_bDualPlane ? 2U : 1U;
-    for (u32 plane = 0; plane < kPlaneScale; plane++)
-        for (u32 t = 0; t < blockHeight; t++)
-            for (u32 s = 0; s < blockWidth; s++) {
-                u32 cs = Ds * s;
-                u32 ct = Dt * t;
-
-                u32 gs = (cs * (params.m_Width - 1) + 32) >> 6;
-                u32 gt = (ct * (params.m_Height - 1) + 32) >> 6;
-
-                u32 js = gs >> 4;
-                u32 fs = gs & 0xF;
-
-                u32 jt = gt >> 4;
-                u32 ft = gt & 0x0F;
-
-                u32 w11 = (fs * ft + 8) >> 4;
-                u32 w10 = ft - w11;
-                u32 w01 = fs - w11;
-                u32 w00 = 16 - fs - ft + w11;
-
-                u32 v0 = js + jt * params.m_Width;
-
-#define FIND_TEXEL(tidx, bidx)                                                                     \
-    u32 p##bidx = 0;                                                                               \
-    do {                                                                                           \
-        if ((tidx) < (params.m_Width * params.m_Height)) {                                         \
-            p##bidx = unquantized[plane][(tidx)];                                                  \
-        }                                                                                          \
-    } while (0)
-
-                FIND_TEXEL(v0, 00);
-                FIND_TEXEL(v0 + 1, 01);
-                FIND_TEXEL(v0 + params.m_Width, 10);
-                FIND_TEXEL(v0 + params.m_Width + 1, 11);
-
-#undef FIND_TEXEL
-
-                out[plane][t * blockWidth + s] =
-                    (p00 * w00 + p01 * w01 + p10 * w10 + p11 * w11 + 8) >> 4;
-            }
+    for (u32 plane = 0; plane < kPlaneScale; plane++) {
+        const u32* const grid = unquantized[plane];
+        for (size_t i = 0; i < infill.size(); i++) {
+            const InfillTexel& texel = infill[i];
+            out[plane][i] = (grid[texel.index[0]] * texel.weight[0] +
+                             grid[texel.index[1]] * texel.weight[1] +
+                             grid[texel.index[2]] * texel.weight[2] +
+                             grid[texel.index[3]] * texel.weight[3] + 8) >>
+                            4;
+        }
+    }
 }
 
 // Transfers a bit as described in C.2.14
@@ -1388,6 +1452,176 @@ static void ComputeEndpoints(Pixel& ep1, Pixel& ep2, const u32*& colorValues,
 #undef READ_INT_VALUES
 }
 
+static void ComputePartitions(std::span<u8> out, u32 seed, u32 nPartitions, u32 blockWidth,
+                              u32 blockHeight) {
+    const bool smallBlock = blockWidth * blockHeight < 32;
+    for (u32 j = 0; j < blockHeight; j++) {
+        for (u32 i = 0; i < blockWidth; i++) {
+            out[j * blockWidth + i] =
+                static_cast<u8>(Select2DPartition(seed, i, j, nPartitions, smallBlock));
+        }
+    }
+}
+
+// Partition and weight infill lookups shared by every block of a texture, built before any block
+// is decoded. Partitions are only cached for seeds used by more than one block.
+class BlockTables {
+public:
+    explicit BlockTables(std::span<const u8> data, u32 blockWidth_, u32 blockHeight_,
+                         size_t numBlocks)
+        : blockWidth{blockWidth_}, blockHeight{blockHeight_}, numTexels{blockWidth *
+                                                                        blockHeight} {
+        partitionOffsets.fill(INVALID_OFFSET);
+        infillOffsets.fill(INVALID_OFFSET);
+
+        std::array<u8, 3 * 1024> seedUses{};
+        const auto& modes = GetBlockModeTable();
+        for (size_t block = 0; block < numBlocks; ++block) {
+            const std::span<const u8> blockData = data.subspan(block * 16, 16);
+            InputBitStream strm(blockData);
+            const TexelWeightParams& params = modes[strm.ReadBits<11>()];
+            if (params.m_bError || params.m_bVoidExtentLDR || params.m_bVoidExtentHDR ||
+                params.m_Width > blockWidth || params.m_Height > blockHeight) {
+                continue;
+            }
+            const u32 nPartitions = strm.ReadBits<2>() + 1;
+            if (nPartitions > 1) {
+                const u32 index = (nPartitions - 2) * 1024 + strm.ReadBits<10>();
+                if (seedUses[index] < 2 && ++seedUses[index] == 2) {
+                    AddPartitions(index);
+                }
+            }
+            AddInfill(params.m_Width, params.m_Height);
+        }
+    }
+
+    // Partition of each texel, null when it is not cached
+    const u8* Partitions(u32 nPartitions, u32 seed) const {
+        const u32 offset = partitionOffsets[(nPartitions - 2) * 1024 + seed];
+        return offset != INVALID_OFFSET ? &partitions[offset] : nullptr;
+    }
+
+    std::span<const InfillTexel> Infill(u32 gridWidth, u32 gridHeight) const {
+        return std::span(infills).subspan(infillOffsets[gridHeight * 16 + gridWidth], numTexels);
+    }
+
+private:
+    static constexpr u32 INVALID_OFFSET = UINT32_MAX;
+
+    void AddPartitions(u32 index) {
+        const u32 offset = static_cast<u32>(partitions.size());
+        partitionOffsets[index] = offset;
+        partitions.resize(partitions.size() + numTexels);
+        ComputePartitions(std::span(partitions).subspan(offset), index % 1024, index / 1024 + 2,
+                          blockWidth, blockHeight);
+    }
+
+    void AddInfill(u32 gridWidth, u32 gridHeight) {
+        u32& offset = infillOffsets[gridHeight * 16 + gridWidth];
+        if (offset != INVALID_OFFSET) {
+            return;
+        }
+        offset = static_cast<u32>(infills.size());
+        infills.resize(infills.size() + numTexels);
+        MakeInfillTable(std::span(infills).subspan(offset), gridWidth, gridHeight, blockWidth,
+                        blockHeight);
+    }
+
+    u32 blockWidth;
+    u32 blockHeight;
+    u32 numTexels;
+    std::array<u32, 3 * 1024> partitionOffsets;
+    std::array<u32, 16 * 16> infillOffsets;
+    std::vector<u8> partitions;
+    std::vector<InfillTexel> infills;
+};
+
+// Endpoints of a partition expanded to 16 bits, channels in output byte order (RGBA)
+using ExpandedEndpoints = std::array<std::array<u32, 4>, 2>;
+
+// Interpolates the endpoints of every texel and packs them as RGBA8.
+// The weight of the channel selected by planeMask comes from the second plane.
+using InterpolateFunction = void (*)(u32* out, const ExpandedEndpoints* endpoints,
+                                     const u8* partitions, const u32* weights0,
+                                     const u32* weights1, const std::array<u32, 4>& planeMask,
+                                     u32 numTexels);
+
+// The unorm conversion 255 * (C / 65536) + 0.5 is done in integers as (255 * C + 32768) >> 16,
+// which is exact and maps 65535 to 255.
+static void InterpolateTexelsScalar(u32* out, const ExpandedEndpoints* endpoints,
+                                    const u8* partitions, const u32* weights0, const u32* weights1,
+                                    const std::array<u32, 4>& planeMask, u32 numTexels) {
+    for (u32 i = 0; i < numTexels; i++) {
+        const ExpandedEndpoints& ep = endpoints[partitions ? partitions[i] : 0];
+        u32 texel = 0;
+        for (u32 c = 0; c < 4; c++) {
+            const u32 weight = planeMask[c] ? weights1[i] : weights0[i];
+            const u32 C = (ep[0][c] * (64 - weight) + ep[1][c] * weight + 32) >> 6;
+            texel |= ((255 * C + 32768) >> 16) << (c * 8);
+        }
+        out[i] = texel;
+    }
+}
+
+#if defined(ARCHITECTURE_x86_64)
+TARGET_SSE41 static void InterpolateTexelsSSE41(u32* out, const ExpandedEndpoints* endpoints,
+                                                const u8* partitions, const u32* weights0,
+                                                const u32* weights1,
+                                                const std::array<u32, 4>& planeMask,
+                                                u32 numTexels) {
+    const __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(planeMask.data()));
+    const __m128i v64 = _mm_set1_epi32(64);
+    const __m128i v32 = _mm_set1_epi32(32);
+    const __m128i v255 = _mm_set1_epi32(255);
+    const __m128i v32768 = _mm_set1_epi32(32768);
+    for (u32 i = 0; i < numTexels; i++) {
+        const ExpandedEndpoints& ep = endpoints[partitions ? partitions[i] : 0];
+        const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ep[0].data()));
+        const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ep[1].data()));
+        const __m128i w = _mm_blendv_epi8(_mm_set1_epi32(static_cast<int>(weights0[i])),
+                                          _mm_set1_epi32(static_cast<int>(weights1[i])), mask);
+        __m128i c = _mm_add_epi32(_mm_mullo_epi32(c0, _mm_sub_epi32(v64, w)),
+                                  _mm_mullo_epi32(c1, w));
+        c = _mm_srli_epi32(_mm_add_epi32(c, v32), 6);
+        c = _mm_srli_epi32(_mm_add_epi32(_mm_mullo_epi32(c, v255), v32768), 16);
+        c = _mm_packus_epi32(c, c);
+        c = _mm_packus_epi16(c, c);
+        out[i] = static_cast<u32>(_mm_cvtsi128_si32(c));
+    }
+}
+#elif defined(ARCHITECTURE_arm64)
+static void InterpolateTexelsNEON(u32* out, const ExpandedEndpoints* endpoints,
+                                  const u8* partitions, const u32* weights0, const u32* weights1,
+                                  const std::array<u32, 4>& planeMask, u32 numTexels) {
+    const uint32x4_t mask = vld1q_u32(planeMask.data());
+    const uint32x4_t v64 = vdupq_n_u32(64);
+    const uint32x4_t v255 = vdupq_n_u32(255);
+    for (u32 i = 0; i < numTexels; i++) {
+        const ExpandedEndpoints& ep = endpoints[partitions ? partitions[i] : 0];
+        const uint32x4_t c0 = vld1q_u32(ep[0].data());
+        const uint32x4_t c1 = vld1q_u32(ep[1].data());
+        const uint32x4_t w = vbslq_u32(mask, vdupq_n_u32(weights1[i]), vdupq_n_u32(weights0[i]));
+        uint32x4_t c = vmlaq_u32(vmulq_u32(c1, w), c0, vsubq_u32(v64, w));
+        c = vrshrq_n_u32(c, 6);
+        c = vshrq_n_u32(vmlaq_u32(vdupq_n_u32(32768), c, v255), 16);
+        const uint16x4_t c16 = vmovn_u32(c);
+        const uint8x8_t c8 = vmovn_u16(vcombine_u16(c16, c16));
+        out[i] = vget_lane_u32(vreinterpret_u32_u8(c8), 0);
+    }
+}
+#endif
+
+static InterpolateFunction GetInterpolateFunction() {
+#if defined(ARCHITECTURE_x86_64)
+    if (Common::GetCPUCaps().sse4_1) {
+        return &InterpolateTexelsSSE41;
+    }
+#elif defined(ARCHITECTURE_arm64)
+    return &InterpolateTexelsNEON;
+#endif
+    return &InterpolateTexelsScalar;
+}
+
 static void FillVoidExtentLDR(InputBitStream& strm, std::span<u32> outBuf, u32 blockWidth,
                               u32 blockHeight) {
     // Don't actually care about the void extent, just read the bits...
@@ -1420,13 +1654,13 @@ static void FillError(std::span<u32> outBuf, u32 blockWidth, u32 blockHeight) {
 }
 
 static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
-                            const u32 blockHeight, std::span<u32, 12 * 12> outBuf) {
+                            const u32 blockHeight, const BlockTables& tables,
+                            std::span<u32, 12 * 12> outBuf) {
     InputBitStream strm(inBuf);
-    TexelWeightParams weightParams = DecodeBlockInfo(strm);
+    TexelWeightParams weightParams = LookupBlockInfo(strm);
 
     // Was there an error?
     if (weightParams.m_bError) {
-        assert(false && "Invalid block mode");
         FillError(outBuf, blockWidth, blockHeight);
         return;
     }
@@ -1615,40 +1849,37 @@ static void DecompressBlock(std::span<const u8, 16> inBuf, const u32 blockWidth,
 
     // Blocks can be at most 12x12, so we can have as many as 144 weights
     u32 weights[2][144];
-    UnquantizeTexelWeights(weights, texelWeightValues, weightParams, blockWidth, blockHeight);
+    UnquantizeTexelWeights(weights, texelWeightValues, weightParams,
+                           tables.Infill(weightParams.m_Width, weightParams.m_Height));
 
     // Now that we have endpoints and weights, we can interpolate and generate
     // the proper decoding...
-    for (u32 j = 0; j < blockHeight; j++)
-        for (u32 i = 0; i < blockWidth; i++) {
-            u32 partition = Select2DPartition(partitionIndex, i, j, nPartitions,
-                                              (blockHeight * blockWidth) < 32);
-            assert(partition < nPartitions);
-
-            Pixel p;
-            for (u32 c = 0; c < 4; c++) {
-                u32 C0 = endpoints[partition][0].Component(c);
-                C0 = ReplicateByteTo16(C0);
-                u32 C1 = endpoints[partition][1].Component(c);
-                C1 = ReplicateByteTo16(C1);
-
-                u32 plane = 0;
-                if (weightParams.m_bDualPlane && (((planeIdx + 1) & 3) == c)) {
-                    plane = 1;
-                }
-
-                u32 weight = weights[plane][j * blockWidth + i];
-                u32 C = (C0 * (64 - weight) + C1 * weight + 32) / 64;
-                if (C == 65535) {
-                    p.Component(c) = 255;
-                } else {
-                    double Cf = static_cast<double>(C);
-                    p.Component(c) = static_cast<u16>(255.0 * (Cf / 65536.0) + 0.5);
-                }
-            }
-
-            outBuf[j * blockWidth + i] = p.Pack();
+    ExpandedEndpoints expanded[4];
+    for (u32 i = 0; i < nPartitions; i++) {
+        for (u32 c = 0; c < 4; c++) {
+            // Endpoint channels are stored as ARGB, output texels are packed as RGBA
+            const u32 channel = (c + 3) % 4;
+            expanded[i][0][channel] = ReplicateByteTo16(endpoints[i][0].Component(c));
+            expanded[i][1][channel] = ReplicateByteTo16(endpoints[i][1].Component(c));
+        }
+    }
+    std::array<u32, 4> planeMask{};
+    if (weightParams.m_bDualPlane) {
+        planeMask[(((planeIdx + 1) & 3) + 3) % 4] = UINT32_MAX;
+    }
+    const u8* partitions = nullptr;
+    std::array<u8, 144> blockPartitions;
+    if (nPartitions > 1) {
+        partitions = tables.Partitions(nPartitions, partitionIndex);
+        if (!partitions) {
+            ComputePartitions(blockPartitions, partitionIndex, nPartitions, blockWidth,
+                              blockHeight);
+            partitions = blockPartitions.data();
         }
+    }
+    static const InterpolateFunction interpolate = GetInterpolateFunction();
+    interpolate(outBuf.data(), expanded, partitions, weights[0], weights[1], planeMask,
+                blockWidth * blockHeight);
 }
 
 void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
@@ -1656,13 +1887,15 @@ void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height,
     const u32 rows = Common::DivideUp(height, block_height);
     const u32 cols = Common::DivideUp(width, block_width);
 
+    const BlockTables tables(data, block_width, block_height, size_t{rows} * cols * depth);
+
     Common::ThreadWorker& workers{GetThreadWorkers()};
 
     for (u32 z = 0; z < depth; ++z) {
         const u32 depth_offset = z * height * width * 4;
         for (u32 y_index = 0; y_index < rows; ++y_index) {
             auto decompress_stride = [data, width, height, block_width, block_height, output, rows,
-                                      cols, z, depth_offset, y_index] {
+                                      cols, z, depth_offset, y_index, tables = &tables] {
                 const u32 y = y_index * block_height;
                 for (u32 x_index = 0; x_index < cols; ++x_index) {
                     const u32 block_index = (z * rows * cols) + (y_index * cols) + x_index;
@@ -1672,7 +1905,7 @@ void Decompress(std::span<const uint8_t> data, uint32_t width, uint32_t height,
 
                     // Blocks can be at most 12x12
                     std::array<u32, 12 * 12> uncompData;
-                    DecompressBlock(blockPtr, block_width, block_height, uncompData);
+                    DecompressBlock(blockPtr, block_width, block_height, *tables, uncompData);
 
                     u32 decompWidth = std::min(block_width, width - x);
                     u32 decompHeight = std::min(block_height, height - y);
@@ -1,86 +1,308 @@
 // SPDX-FileCopyrightText: Copyright 2023 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <utility>
 #include <stb_dxt.h>
 #include <string.h>
+
+#if defined(ARCHITECTURE_x86_64)
+#include <emmintrin.h>
+#endif
+
 #include "common/alignment.h"
 #include "video_core/textures/bcn.h"
 #include "video_core/textures/workers.h"
 
 namespace Tegra::Texture::BCN {
 
+namespace {
+
 using BCNCompressor = void(u8* block_output, const u8* block_input, bool any_alpha);
 
-template <u32 BytesPerBlock, bool ThresholdAlpha = false>
-void CompressBCN(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
-                 std::span<uint8_t> output, BCNCompressor f) {
-    constexpr u8 alpha_threshold = 128;
-    constexpr u32 bytes_per_px = 4;
+constexpr u8 ALPHA_THRESHOLD = 128;
+constexpr u32 BYTES_PER_PX = 4;
+
+/// Minimum number of blocks encoded by each worker task
+constexpr u32 MIN_BLOCKS_PER_TASK = 256;
+
+/// Maps the position of a texel between the endpoints (0 = color 1, 3 = color 0) to its index
+constexpr std::array<u32, 4> COLOR_LEVEL_TO_INDEX{1, 3, 2, 0};
+
+[[nodiscard]] u16 To565(s32 r, s32 g, s32 b) {
+    return static_cast<u16>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 |
+                            ((b * 31 + 127) / 255));
+}
+
+[[nodiscard]] std::array<s32, 3> Expand565(u16 color) {
+    const s32 r = (color >> 11) & 31;
+    const s32 g = (color >> 5) & 63;
+    const s32 b = color & 31;
+    return {(r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)};
+}
+
+/// Counts, for each texel, how many of the three palette midpoints its projection is past
+[[maybe_unused]] void ComputeColorLevelsScalar(const u8* texels, const std::array<s32, 3>& axis,
+                                               s32 base, s32 axis_length,
+                                               std::array<u8, 16>& levels) {
+    for (u32 i = 0; i < 16; ++i) {
+        const u8* const texel = texels + i * BYTES_PER_PX;
+        const s32 t =
+            6 * (texel[0] * axis[0] + texel[1] * axis[1] + texel[2] * axis[2] - base);
+        levels[i] = static_cast<u8>(static_cast<u32>(t > axis_length) +
+                                    static_cast<u32>(t > 3 * axis_length) +
+                                    static_cast<u32>(t > 5 * axis_length));
+    }
+}
+
+#if defined(ARCHITECTURE_x86_64)
+void ComputeColorLevelsSSE2(const u8* texels, const std::array<s32, 3>& axis, s32 base,
+                            s32 axis_length, std::array<u8, 16>& levels) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i axis_pair =
+        _mm_setr_epi16(static_cast<s16>(axis[0]), static_cast<s16>(axis[1]),
+                       static_cast<s16>(axis[2]), 0, static_cast<s16>(axis[0]),
+                       static_cast<s16>(axis[1]), static_cast<s16>(axis[2]), 0);
+    const __m128i base_v = _mm_set1_epi32(base);
+    const __m128i mid0 = _mm_set1_epi32(axis_length);
+    const __m128i mid1 = _mm_set1_epi32(3 * axis_length);
+    const __m128i mid2 = _mm_set1_epi32(5 * axis_length);
+
+    __m128i row_levels[4];
+    for (u32 row = 0; row < 4; ++row) {
+        const __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(texels + row * 16));
+        // Per texel partial dot products: {r*ar + g*ag, b*ab} for two texels per register
+        const __m128i lo = _mm_madd_epi16(_mm_unpacklo_epi8(px, zero), axis_pair);
+        const __m128i hi = _mm_madd_epi16(_mm_unpackhi_epi8(px, zero), axis_pair);
+        const __m128i even = _mm_castps_si128(
+            _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(2, 0, 2, 0)));
+        const __m128i odd = _mm_castps_si128(
+            _mm_shuffle_ps(_mm_castsi128_ps(lo), _mm_castsi128_ps(hi), _MM_SHUFFLE(3, 1, 3, 1)));
+        const __m128i dot = _mm_sub_epi32(_mm_add_epi32(even, odd), base_v);
+        // 6 * t, computed as (t << 2) + (t << 1)
+        const __m128i t = _mm_add_epi32(_mm_slli_epi32(dot, 2), _mm_slli_epi32(dot, 1));
+        // Comparison masks are -1 when true, so subtracting them counts the passed midpoints
+        __m128i level = _mm_sub_epi32(zero, _mm_cmpgt_epi32(t, mid0));
+        level = _mm_sub_epi32(level, _mm_cmpgt_epi32(t, mid1));
+        row_levels[row] = _mm_sub_epi32(level, _mm_cmpgt_epi32(t, mid2));
+    }
+    const __m128i words_lo = _mm_packs_epi32(row_levels[0], row_levels[1]);
+    const __m128i words_hi = _mm_packs_epi32(row_levels[2], row_levels[3]);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(levels.data()),
+                     _mm_packus_epi16(words_lo, words_hi));
+}
+#endif
+
+/// Picks the endpoints along the bounding box diagonal that best follows the texel colors
+void EncodeColorFast(u8* output, const u8* texels) {
+    std::array<s32, 3> min{255, 255, 255};
+    std::array<s32, 3> max{0, 0, 0};
+    for (u32 i = 0; i < 16; ++i) {
+        for (u32 c = 0; c < 3; ++c) {
+            min[c] = std::min<s32>(min[c], texels[i * BYTES_PER_PX + c]);
+            max[c] = std::max<s32>(max[c], texels[i * BYTES_PER_PX + c]);
+        }
+    }
+    // Orient the red and blue extents following their correlation with green
+    s32 cov_rg = 0;
+    s32 cov_bg = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        const u8* const texel = texels + i * BYTES_PER_PX;
+        const s32 g = 2 * texel[1] - (min[1] + max[1]);
+        cov_rg += (2 * texel[0] - (min[0] + max[0])) * g;
+        cov_bg += (2 * texel[2] - (min[2] + max[2])) * g;
+    }
+    // Inset the box slightly, its corners are usually outliers
+    for (u32 c = 0; c < 3; ++c) {
+        const s32 inset = (max[c] - min[c]) >> 4;
+        min[c] += inset;
+        max[c] -= inset;
+    }
+    if (cov_rg < 0) {
+        std::swap(min[0], max[0]);
+    }
+    if (cov_bg < 0) {
+        std::swap(min[2], max[2]);
+    }
+    u16 color0 = To565(max[0], max[1], max[2]);
+    u16 color1 = To565(min[0], min[1], min[2]);
+    if (color0 < color1) {
+        std::swap(color0, color1);
+    }
+    u32 indices = 0;
+    if (color0 != color1) {
+        const std::array<s32, 3> end0 = Expand565(color0);
+        const std::array<s32, 3> end1 = Expand565(color1);
+        const std::array<s32, 3> axis{end0[0] - end1[0], end0[1] - end1[1], end0[2] - end1[2]};
+        const s32 base = end1[0] * axis[0] + end1[1] * axis[1] + end1[2] * axis[2];
+        const s32 axis_length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+        std::array<u8, 16> levels;
+#if defined(ARCHITECTURE_x86_64)
+        ComputeColorLevelsSSE2(texels, axis, base, axis_length, levels);
+#else
+        ComputeColorLevelsScalar(texels, axis, base, axis_length, levels);
+#endif
+        for (u32 i = 0; i < 16; ++i) {
+            indices |= COLOR_LEVEL_TO_INDEX[levels[i]] << (i * 2);
+        }
+    }
+    memcpy(output, &color0, sizeof(color0));
+    memcpy(output + 2, &color1, sizeof(color1));
+    memcpy(output + 4, &indices, sizeof(indices));
+}
+
+/// Encodes the alpha channel with its extents as endpoints in eight value mode
+void EncodeAlphaFast(u8* output, const u8* texels) {
+    s32 min = 255;
+    s32 max = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        min = std::min<s32>(min, texels[i * BYTES_PER_PX + 3]);
+        max = std::max<s32>(max, texels[i * BYTES_PER_PX + 3]);
+    }
+    u64 indices = 0;
+    if (max != min) {
+        const s32 range = max - min;
+        for (u32 i = 0; i < 16; ++i) {
+            const s32 t = 14 * (texels[i * BYTES_PER_PX + 3] - min);
+            u32 level = 0;
+            for (s32 k = 1; k < 8; ++k) {
+                level += static_cast<u32>(t > (2 * k - 1) * range);
+            }
+            // Level 7 is alpha 0, level 0 is alpha 1, the rest are interpolated in reverse order
+            const u64 index = level == 7 ? 0 : (level == 0 ? 1 : 8 - level);
+            indices |= index << (i * 3);
+        }
+    }
+    output[0] = static_cast<u8>(max);
+    output[1] = static_cast<u8>(min);
+    for (u32 i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<u8>(indices >> (i * 8));
+    }
+}
+
+template <bool ThresholdAlpha>
+bool GatherBlock(std::span<const u8> data, u32 x, u32 y, u32 z, u32 width, u32 height,
+                 u8 (&input_colors)[4][4][4]) {
     const u32 plane_dim = width * height;
+    bool any_alpha = false;
+    for (u32 j = 0; j < 4; j++) {
+        for (u32 i = 0; i < 4; i++) {
+            const size_t coord = (z * plane_dim + (y + j) * width + (x + i)) * BYTES_PER_PX;
 
-    Common::ThreadWorker& workers{GetThreadWorkers()};
-
-    for (u32 z = 0; z < depth; z++) {
-        for (u32 y = 0; y < height; y += 4) {
-            auto compress_row = [z, y, width, height, plane_dim, f, data, output]() {
-                for (u32 x = 0; x < width; x += 4) {
-                    // Gather 4x4 block of RGBA texels
-                    u8 input_colors[4][4][4];
-                    bool any_alpha = false;
-
-                    for (u32 j = 0; j < 4; j++) {
-                        for (u32 i = 0; i < 4; i++) {
-                            const size_t coord =
-                                (z * plane_dim + (y + j) * width + (x + i)) * bytes_per_px;
-
-                            if ((x + i < width) && (y + j < height)) {
-                                if constexpr (ThresholdAlpha) {
-                                    if (data[coord + 3] >= alpha_threshold) {
-                                        input_colors[j][i][0] = data[coord + 0];
-                                        input_colors[j][i][1] = data[coord + 1];
-                                        input_colors[j][i][2] = data[coord + 2];
-                                        input_colors[j][i][3] = 255;
-                                    } else {
-                                        any_alpha = true;
-                                        memset(input_colors[j][i], 0, bytes_per_px);
-                                    }
-                                } else {
-                                    memcpy(input_colors[j][i], &data[coord], bytes_per_px);
-                                }
-                            } else {
-                                memset(input_colors[j][i], 0, bytes_per_px);
-                            }
-                        }
+            if ((x + i < width) && (y + j < height)) {
+                if constexpr (ThresholdAlpha) {
+                    if (data[coord + 3] >= ALPHA_THRESHOLD) {
+                        input_colors[j][i][0] = data[coord + 0];
+                        input_colors[j][i][1] = data[coord + 1];
+                        input_colors[j][i][2] = data[coord + 2];
+                        input_colors[j][i][3] = 255;
+                    } else {
+                        any_alpha = true;
+                        memset(input_colors[j][i], 0, BYTES_PER_PX);
                     }
-
-                    const u32 bytes_per_row = BytesPerBlock * Common::DivideUp(width, 4U);
-                    const u32 bytes_per_plane = bytes_per_row * Common::DivideUp(height, 4U);
-                    f(output.data() + z * bytes_per_plane + (y / 4) * bytes_per_row +
-                          (x / 4) * BytesPerBlock,
-                      reinterpret_cast<u8*>(input_colors), any_alpha);
+                } else {
+                    memcpy(input_colors[j][i], &data[coord], BYTES_PER_PX);
                 }
-            };
-            workers.QueueWork(std::move(compress_row));
+            } else {
+                memset(input_colors[j][i], 0, BYTES_PER_PX);
+            }
         }
-        workers.WaitForRequests();
     }
+    return any_alpha;
 }
 
+template <u32 BytesPerBlock, bool ThresholdAlpha = false>
+void CompressBCN(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
+                 std::span<uint8_t> output, BCNCompressor f) {
+    const u32 blocks_per_row = Common::DivideUp(width, 4U);
+    const u32 rows_per_plane = Common::DivideUp(height, 4U);
+    const u32 bytes_per_row = BytesPerBlock * blocks_per_row;
+    const u32 bytes_per_plane = bytes_per_row * rows_per_plane;
+    const u32 total_rows = rows_per_plane * depth;
+    if (total_rows == 0) {
+        return;
+    }
+    // Hand out bands of block rows, a few per worker so uneven blocks still balance out
+    const u32 target_tasks = static_cast<u32>(GetThreadWorkerCount() + 1) * 4;
+    const u32 rows_per_task = std::max(Common::DivideUp(MIN_BLOCKS_PER_TASK, blocks_per_row),
+                                       Common::DivideUp(total_rows, target_tasks));
+    const u32 num_tasks = Common::DivideUp(total_rows, rows_per_task);
+
+    ParallelFor(num_tasks, [&](size_t task) {
+        const u32 row_begin = static_cast<u32>(task) * rows_per_task;
+        const u32 row_end = std::min(row_begin + rows_per_task, total_rows);
+        for (u32 row = row_begin; row < row_end; ++row) {
+            const u32 z = row / rows_per_plane;
+            const u32 y = (row % rows_per_plane) * 4;
+            u8* const row_output =
+                output.data() + z * bytes_per_plane + (y / 4) * bytes_per_row;
+            for (u32 x = 0; x < width; x += 4) {
+                // Gather 4x4 block of RGBA texels
+                u8 input_colors[4][4][4];
+                const bool any_alpha =
+                    GatherBlock<ThresholdAlpha>(data, x, y, z, width, height, input_colors);
+                f(row_output + (x / 4) * BytesPerBlock, reinterpret_cast<u8*>(input_colors),
+                  any_alpha);
+            }
+        }
+    });
+}
+
+} // Anonymous namespace
+
 void CompressBC1(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
-                 std::span<uint8_t> output) {
-    CompressBCN<8, true>(data, width, height, depth, output,
-                         [](u8* block_output, const u8* block_input, bool any_alpha) {
-                             stb_compress_bc1_block(block_output, block_input, any_alpha,
-                                                    STB_DXT_NORMAL);
-                         });
+                 std::span<uint8_t> output, Quality quality) {
+    switch (quality) {
+    case Quality::Fast:
+        return CompressBCN<8, true>(
+            data, width, height, depth, output,
+            [](u8* block_output, const u8* block_input, bool any_alpha) {
+                if (any_alpha) {
+                    // Punch-through alpha needs the three color mode
+                    stb_compress_bc1_block(block_output, block_input, 1, STB_DXT_NORMAL);
+                } else {
+                    EncodeColorFast(block_output, block_input);
+                }
+            });
+    case Quality::Normal:
+        return CompressBCN<8, true>(data, width, height, depth, output,
+                                    [](u8* block_output, const u8* block_input, bool any_alpha) {
+                                        stb_compress_bc1_block(block_output, block_input,
+                                                               any_alpha, STB_DXT_NORMAL);
+                                    });
+    case Quality::High:
+        return CompressBCN<8, true>(data, width, height, depth, output,
+                                    [](u8* block_output, const u8* block_input, bool any_alpha) {
+                                        stb_compress_bc1_block(block_output, block_input,
+                                                               any_alpha, STB_DXT_HIGHQUAL);
+                                    });
+    }
 }
 
 void CompressBC3(std::span<const uint8_t> data, uint32_t width, uint32_t height, uint32_t depth,
-                 std::span<uint8_t> output) {
-    CompressBCN<16, false>(data, width, height, depth, output,
-                           [](u8* block_output, const u8* block_input, bool any_alpha) {
-                               stb_compress_bc3_block(block_output, block_input, STB_DXT_NORMAL);
-                           });
+                 std::span<uint8_t> output, Quality quality) {
+    switch (quality) {
+    case Quality::Fast:
+        return CompressBCN<16, false>(data, width, height, depth, output,
+                                      [](u8* block_output, const u8* block_input, bool) {
+                                          EncodeAlphaFast(block_output, block_input);
+                                          EncodeColorFast(block_output + 8, block_input);
+                                      });
+    case Quality::Normal:
+        return CompressBCN<16, false>(data, width, height, depth, output,
+                                      [](u8* block_output, const u8* block_input, bool) {
+                                          stb_compress_bc3_block(block_output, block_input,
+                                                                 STB_DXT_NORMAL);
+                                      });
+    case Quality::High:
+        return CompressBCN<16, false>(data, width, height, depth, output,
+                                      [](u8* block_output, const u8* block_input, bool) {
+                                          stb_compress_bc3_block(block_output, block_input,
+                                                                 STB_DXT_HIGHQUAL);
+                                      });
+    }
 }
 
 } // namespace Tegra::Texture::BCN
@@ -9,8 +9,17 @@
 
 namespace Tegra::Texture::BCN {
 
-void CompressBC1(std::span<const u8> data, u32 width, u32 height, u32 depth, std::span<u8> output);
+/// Trade-off between encoding speed and image quality
+enum class Quality : u32 {
+    Fast,   ///< Bounding box endpoints with vectorized index selection
+    Normal, ///< Principal axis endpoints refined once
+    High,   ///< Principal axis endpoints refined twice
+};
 
-void CompressBC3(std::span<const u8> data, u32 width, u32 height, u32 depth, std::span<u8> output);
+void CompressBC1(std::span<const u8> data, u32 width, u32 height, u32 depth, std::span<u8> output,
+                 Quality quality = Quality::Normal);
+
+void CompressBC3(std::span<const u8> data, u32 width, u32 height, u32 depth, std::span<u8> output,
+                 Quality quality = Quality::Normal);
 
 } // namespace Tegra::Texture::BCN
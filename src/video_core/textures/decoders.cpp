@@ -1,7 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2018 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <bit>
 #include <cmath>
 #include <cstring>
 #include <span>
@@ -13,8 +16,300 @@
 #include "video_core/gpu.h"
 #include "video_core/textures/decoders.h"
 
+#if defined(ARCHITECTURE_x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif defined(ARCHITECTURE_arm64)
+#include <arm_neon.h>
+#endif
+
+#if defined(ARCHITECTURE_x86_64) && (defined(__GNUC__) || defined(__clang__))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
 namespace Tegra::Texture {
 namespace {
+constexpr SwizzleTable SWIZZLE_TABLE = MakeSwizzleTable();
+
+/// Copies a whole GOB between its swizzled layout and a linear surface with the given pitch.
+/// Arguments are (destination, source, pitch) in the direction of the copy.
+using GobKernel = void (*)(u8*, const u8*, u32);
+
+// Every 64 bytes of a GOB hold 32 bytes of two consecutive lines, interleaved in 16-byte sectors:
+// [line y, x 0-15][line y+1, x 0-15][line y, x 16-31][line y+1, x 16-31]
+// The second 256 bytes of the GOB repeat the pattern for x 32-63.
+
+void UnswizzleGobGeneric(u8* linear, const u8* gob, u32 pitch) {
+    for (u32 y = 0; y < GOB_SIZE_Y; ++y) {
+        for (u32 x = 0; x < GOB_SIZE_X; x += 16) {
+            std::memcpy(linear + y * pitch + x, gob + SWIZZLE_TABLE[y][x], 16);
+        }
+    }
+}
+
+void SwizzleGobGeneric(u8* gob, const u8* linear, u32 pitch) {
+    for (u32 y = 0; y < GOB_SIZE_Y; ++y) {
+        for (u32 x = 0; x < GOB_SIZE_X; x += 16) {
+            std::memcpy(gob + SWIZZLE_TABLE[y][x], linear + y * pitch + x, 16);
+        }
+    }
+}
+
+#if defined(ARCHITECTURE_x86_64)
+void UnswizzleGobSSE2(u8* linear, const u8* gob, u32 pitch) {
+    for (u32 half = 0; half < 2; ++half) {
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            const u8* const src = gob + half * 256 + y * 32;
+            u8* const line0 = linear + y * pitch + half * 32;
+            u8* const line1 = line0 + pitch;
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 32));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 48));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line0), a);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line0 + 16), c);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line1), b);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(line1 + 16), d);
+        }
+    }
+}
+
+void SwizzleGobSSE2(u8* gob, const u8* linear, u32 pitch) {
+    for (u32 half = 0; half < 2; ++half) {
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            u8* const dst = gob + half * 256 + y * 32;
+            const u8* const line0 = linear + y * pitch + half * 32;
+            const u8* const line1 = line0 + pitch;
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line0));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line1));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line0 + 16));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(line1 + 16));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), a);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 16), b);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 32), c);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + 48), d);
+        }
+    }
+}
+
+TARGET_AVX2 void UnswizzleGobAVX2(u8* linear, const u8* gob, u32 pitch) {
+    for (u32 half = 0; half < 2; ++half) {
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            const u8* const src = gob + half * 256 + y * 32;
+            u8* const line0 = linear + y * pitch + half * 32;
+            const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src));
+            const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + 32));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(line0),
+                                _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(line0 + pitch),
+                                _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+    }
+}
+
+TARGET_AVX2 void SwizzleGobAVX2(u8* gob, const u8* linear, u32 pitch) {
+    for (u32 half = 0; half < 2; ++half) {
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            u8* const dst = gob + half * 256 + y * 32;
+            const u8* const line0 = linear + y * pitch + half * 32;
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(line0));
+            const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(line0 + pitch));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst),
+                                _mm256_permute2x128_si256(a, b, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + 32),
+                                _mm256_permute2x128_si256(a, b, 0x31));
+        }
+    }
+}
+#elif defined(ARCHITECTURE_arm64)
+void UnswizzleGobNEON(u8* linear, const u8* gob, u32 pitch) {
+    for (u32 half = 0; half < 2; ++half) {
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            const u8* const src = gob + half * 256 + y * 32;
+            u8* const line0 = linear + y * pitch + half * 32;
+            u8* const line1 = line0 + pitch;
+            const uint8x16_t a = vld1q_u8(src);
+            const uint8x16_t b = vld1q_u8(src + 16);
+            const uint8x16_t c = vld1q_u8(src + 32);
+            const uint8x16_t d = vld1q_u8(src + 48);
+            vst1q_u8(line0, a);
+            vst1q_u8(line0 + 16, c);
+            vst1q_u8(line1, b);
+            vst1q_u8(line1 + 16, d);
+        }
+    }
+}
+
+void SwizzleGobNEON(u8* gob, const u8* linear, u32 pitch) {
+    for (u32 half = 0; half < 2; ++half) {
+        for (u32 y = 0; y < GOB_SIZE_Y; y += 2) {
+            u8* const dst = gob + half * 256 + y * 32;
+            const u8* const line0 = linear + y * pitch + half * 32;
+            const u8* const line1 = line0 + pitch;
+            const uint8x16_t a = vld1q_u8(line0);
+            const uint8x16_t b = vld1q_u8(line1);
+            const uint8x16_t c = vld1q_u8(line0 + 16);
+            const uint8x16_t d = vld1q_u8(line1 + 16);
+            vst1q_u8(dst, a);
+            vst1q_u8(dst + 16, b);
+            vst1q_u8(dst + 32, c);
+            vst1q_u8(dst + 48, d);
+        }
+    }
+}
+#endif
+
+std::atomic<SwizzleKernel>& ActiveSwizzleKernel() {
+    static std::atomic<SwizzleKernel> kernel{GetBestSwizzleKernel()};
+    return kernel;
+}
+
+/// Returns the GOB kernel for the active swizzle kernel, or null to use the scalar path.
+template <bool TO_LINEAR>
+GobKernel GetGobKernel() {
+    switch (ActiveSwizzleKernel().load(std::memory_order_relaxed)) {
+    case SwizzleKernel::Generic:
+        return TO_LINEAR ? &SwizzleGobGeneric : &UnswizzleGobGeneric;
+#if defined(ARCHITECTURE_x86_64)
+    case SwizzleKernel::SSE2:
+        return TO_LINEAR ? &SwizzleGobSSE2 : &UnswizzleGobSSE2;
+    case SwizzleKernel::AVX2:
+        return TO_LINEAR ? &SwizzleGobAVX2 : &UnswizzleGobAVX2;
+#elif defined(ARCHITECTURE_arm64)
+    case SwizzleKernel::NEON:
+        return TO_LINEAR ? &SwizzleGobNEON : &UnswizzleGobNEON;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+/// Block linear addressing parameters shared by every GOB of a surface.
+struct BlockLinearLayout {
+    explicit BlockLinearLayout(u32 stride, u32 height, u32 block_height_, u32 block_depth_)
+        : block_height{block_height_}, block_depth{block_depth_} {
+        const u32 gobs_in_x = Common::DivCeilLog2(stride, GOB_SIZE_X_SHIFT);
+        block_size = gobs_in_x << (GOB_SIZE_SHIFT + block_height + block_depth);
+        slice_size = Common::DivCeilLog2(height, block_height + GOB_SIZE_Y_SHIFT) * block_size;
+        x_shift = GOB_SIZE_SHIFT + block_height + block_depth;
+    }
+
+    [[nodiscard]] u32 SliceOffset(u32 z) const {
+        const u32 block_depth_mask = (1U << block_depth) - 1;
+        return (z >> block_depth) * slice_size +
+               ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
+    }
+
+    [[nodiscard]] u32 GobOffset(u32 gob_x, u32 gob_y) const {
+        const u32 block_height_mask = (1U << block_height) - 1;
+        return (gob_y >> block_height) * block_size +
+               ((gob_y & block_height_mask) << GOB_SIZE_SHIFT) + (gob_x << x_shift);
+    }
+
+    u32 block_height;
+    u32 block_depth;
+    u32 block_size;
+    u32 slice_size;
+    u32 x_shift;
+};
+
+/**
+ * Copies the rectangle [x_begin, x_end) x [y_begin, y_end) of a slice a GOB at a time.
+ * Horizontal coordinates are in bytes. Fully covered GOBs go through the given kernel, partially
+ * covered GOBs are copied line by line in runs of contiguous 16-byte sectors.
+ */
+template <bool TO_LINEAR>
+void SwizzleRectByGobs(std::span<u8> output, std::span<const u8> input, GobKernel kernel,
+                       const BlockLinearLayout& layout, u32 slice_offset,
+                       std::size_t linear_offset, u32 pitch, u32 x_begin, u32 x_end, u32 y_begin,
+                       u32 y_end) {
+    for (u32 gob_y = y_begin >> GOB_SIZE_Y_SHIFT; (gob_y << GOB_SIZE_Y_SHIFT) < y_end; ++gob_y) {
+        const u32 line_begin = std::max(y_begin, gob_y << GOB_SIZE_Y_SHIFT);
+        const u32 line_end = std::min(y_end, (gob_y + 1) << GOB_SIZE_Y_SHIFT);
+        for (u32 gob_x = x_begin >> GOB_SIZE_X_SHIFT; (gob_x << GOB_SIZE_X_SHIFT) < x_end;
+             ++gob_x) {
+            const u32 column_begin = std::max(x_begin, gob_x << GOB_SIZE_X_SHIFT);
+            const u32 column_end = std::min(x_end, (gob_x + 1) << GOB_SIZE_X_SHIFT);
+            const u32 gob_offset = slice_offset + layout.GobOffset(gob_x, gob_y);
+            if (line_end - line_begin == GOB_SIZE_Y && column_end - column_begin == GOB_SIZE_X) {
+                const std::size_t unswizzled_offset = linear_offset +
+                                                      std::size_t{line_begin - y_begin} * pitch +
+                                                      (column_begin - x_begin);
+                u8* const dst = &output[TO_LINEAR ? gob_offset : unswizzled_offset];
+                const u8* const src = &input[TO_LINEAR ? unswizzled_offset : gob_offset];
+                kernel(dst, src, pitch);
+                continue;
+            }
+            for (u32 line = line_begin; line < line_end; ++line) {
+                const auto& table_row = SWIZZLE_TABLE[line % GOB_SIZE_Y];
+                const std::size_t line_offset =
+                    linear_offset + std::size_t{line - y_begin} * pitch - x_begin;
+                for (u32 column = column_begin; column < column_end;) {
+                    const u32 run_end = std::min(column_end, (column | 15) + 1);
+                    const u32 swizzled_offset = gob_offset + table_row[column % GOB_SIZE_X];
+                    const std::size_t unswizzled_offset = line_offset + column;
+
+                    u8* const dst = &output[TO_LINEAR ? swizzled_offset : unswizzled_offset];
+                    const u8* const src = &input[TO_LINEAR ? unswizzled_offset : swizzled_offset];
+
+                    std::memcpy(dst, src, run_end - column);
+                    column = run_end;
+                }
+            }
+        }
+    }
+}
+
+template <bool TO_LINEAR>
+void SwizzleByGobs(std::span<u8> output, std::span<const u8> input, GobKernel kernel,
+                   u32 bytes_per_pixel, u32 width, u32 height, u32 depth, u32 block_height,
+                   u32 block_depth, u32 stride, u32 line_begin, u32 line_end) {
+    const u32 pitch = width * bytes_per_pixel;
+    const BlockLinearLayout layout(stride, height, block_height, block_depth);
+    for (u32 slice = 0; slice < depth; ++slice) {
+        const std::size_t linear_offset =
+            (std::size_t{slice} * height + line_begin) * pitch;
+        SwizzleRectByGobs<TO_LINEAR>(output, input, kernel, layout, layout.SliceOffset(slice),
+                                     linear_offset, pitch, 0, pitch, line_begin, line_end);
+    }
+}
+
+template <bool TO_LINEAR>
+bool TrySwizzleSubrectByGobs(std::span<u8> output, std::span<const u8> input,
+                             u32 bytes_per_pixel, u32 width, u32 height, u32 depth, u32 origin_x,
+                             u32 origin_y, u32 extent_x, u32 num_lines, u32 block_height,
+                             u32 block_depth, u32 pitch_linear) {
+    const GobKernel kernel = GetGobKernel<TO_LINEAR>();
+    if (!kernel || !std::has_single_bit(bytes_per_pixel)) {
+        // The scalar path copies non power of two pixels as a whole, even across sectors
+        return false;
+    }
+    const u32 stride = Common::AlignUpLog2(width * bytes_per_pixel, GOB_SIZE_X_SHIFT);
+    const u32 x_begin = origin_x * bytes_per_pixel;
+    const u32 x_end = x_begin + extent_x * bytes_per_pixel;
+    if (origin_y > height || x_end > stride || x_end - x_begin > pitch_linear) {
+        // Overlapping copies depend on the order of the scalar path
+        return false;
+    }
+    const BlockLinearLayout layout(stride, height, block_height, block_depth);
+
+    u32 unprocessed_lines = num_lines;
+    const u32 extent_y = std::min(num_lines, height - origin_y);
+    for (u32 slice = 0; slice < depth; ++slice) {
+        const u32 lines_in_y = std::min(unprocessed_lines, extent_y);
+        SwizzleRectByGobs<TO_LINEAR>(output, input, kernel, layout, layout.SliceOffset(slice),
+                                     std::size_t{slice} * pitch_linear * height, pitch_linear,
+                                     x_begin, x_end, origin_y, origin_y + lines_in_y);
+        unprocessed_lines -= lines_in_y;
+        if (unprocessed_lines == 0) {
+            break;
+        }
+    }
+    return true;
+}
+
 template <u32 mask>
 constexpr u32 pdep(u32 value) {
     u32 result = 0;
@@ -35,7 +330,7 @@ void incrpdep(u32& value) {
 
 template <bool TO_LINEAR, u32 BYTES_PER_PIXEL>
 void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32 height, u32 depth,
-                 u32 block_height, u32 block_depth, u32 stride) {
+                 u32 block_height, u32 block_depth, u32 stride, u32 line_begin, u32 line_end) {
     // The origin of the transformation can be configured here, leave it as zero as the current API
     // doesn't expose it.
     static constexpr u32 origin_x = 0;
@@ -59,7 +354,7 @@ void SwizzleImpl(std::span<u8> output, std::span<const u8> input, u32 width, u32
         const u32 z = slice + origin_z;
         const u32 offset_z = (z >> block_depth) * slice_size +
                              ((z & block_depth_mask) << (GOB_SIZE_SHIFT + block_height));
-        for (u32 line = 0; line < height; ++line) {
+        for (u32 line = line_begin; line < line_end; ++line) {
             const u32 y = line + origin_y;
             const u32 swizzled_y = pdep<SWIZZLE_Y_BITS>(y);
 
@@ -153,12 +448,18 @@ void SwizzleSubrectImpl(std::span<u8> output, std::span<const u8> input, u32 wid
 
 template <bool TO_LINEAR>
 void Swizzle(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel, u32 width,
-             u32 height, u32 depth, u32 block_height, u32 block_depth, u32 stride_alignment) {
+             u32 height, u32 depth, u32 block_height, u32 block_depth, u32 stride_alignment,
+             u32 line_begin, u32 line_end) {
+    if (const GobKernel kernel = GetGobKernel<TO_LINEAR>()) {
+        return SwizzleByGobs<TO_LINEAR>(output, input, kernel, bytes_per_pixel, width, height,
+                                        depth, block_height, block_depth, stride_alignment,
+                                        line_begin, line_end);
+    }
     switch (bytes_per_pixel) {
 #define BPP_CASE(x)                                                                                \
     case x:                                                                                        \
         return SwizzleImpl<TO_LINEAR, x>(output, input, width, height, depth, block_height,        \
-                                         block_depth, stride_alignment);
+                                         block_depth, stride_alignment, line_begin, line_end);
         BPP_CASE(1)
         BPP_CASE(2)
         BPP_CASE(3)
@@ -176,31 +477,91 @@ void Swizzle(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixe
 
 } // Anonymous namespace
 
+bool IsSwizzleKernelSupported(SwizzleKernel kernel) {
+    switch (kernel) {
+    case SwizzleKernel::Scalar:
+    case SwizzleKernel::Generic:
+        return true;
+#if defined(ARCHITECTURE_x86_64)
+    case SwizzleKernel::SSE2:
+        return true;
+    case SwizzleKernel::AVX2:
+        return Common::GetCPUCaps().avx2;
+#elif defined(ARCHITECTURE_arm64)
+    case SwizzleKernel::NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+SwizzleKernel GetBestSwizzleKernel() {
+#if defined(ARCHITECTURE_x86_64)
+    return Common::GetCPUCaps().avx2 ? SwizzleKernel::AVX2 : SwizzleKernel::SSE2;
+#elif defined(ARCHITECTURE_arm64)
+    return SwizzleKernel::NEON;
+#else
+    return SwizzleKernel::Generic;
+#endif
+}
+
+SwizzleKernel GetSwizzleKernel() {
+    return ActiveSwizzleKernel().load(std::memory_order_relaxed);
+}
+
+void SetSwizzleKernel(SwizzleKernel kernel) {
+    if (!IsSwizzleKernelSupported(kernel)) {
+        ASSERT_MSG(false, "Unsupported swizzle kernel={}", static_cast<u32>(kernel));
+        return;
+    }
+    ActiveSwizzleKernel().store(kernel, std::memory_order_relaxed);
+}
+
 void UnswizzleTexture(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
                       u32 width, u32 height, u32 depth, u32 block_height, u32 block_depth,
                       u32 stride_alignment) {
+    UnswizzleTextureLines(output, input, bytes_per_pixel, width, height, depth, block_height,
+                          block_depth, stride_alignment, 0, height);
+}
+
+void SwizzleTexture(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel, u32 width,
+                    u32 height, u32 depth, u32 block_height, u32 block_depth,
+                    u32 stride_alignment) {
+    SwizzleTextureLines(output, input, bytes_per_pixel, width, height, depth, block_height,
+                        block_depth, stride_alignment, 0, height);
+}
+
+void UnswizzleTextureLines(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
+                           u32 width, u32 height, u32 depth, u32 block_height, u32 block_depth,
+                           u32 stride_alignment, u32 line_begin, u32 line_end) {
     const u32 stride = Common::AlignUpLog2(width, stride_alignment) * bytes_per_pixel;
     const u32 new_bpp = std::min(4U, static_cast<u32>(std::countr_zero(width * bytes_per_pixel)));
     width = (width * bytes_per_pixel) >> new_bpp;
     bytes_per_pixel = 1U << new_bpp;
     Swizzle<false>(output, input, bytes_per_pixel, width, height, depth, block_height, block_depth,
-                   stride);
+                   stride, line_begin, line_end);
 }
 
-void SwizzleTexture(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel, u32 width,
-                    u32 height, u32 depth, u32 block_height, u32 block_depth,
-                    u32 stride_alignment) {
+void SwizzleTextureLines(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
+                         u32 width, u32 height, u32 depth, u32 block_height, u32 block_depth,
+                         u32 stride_alignment, u32 line_begin, u32 line_end) {
     const u32 stride = Common::AlignUpLog2(width, stride_alignment) * bytes_per_pixel;
     const u32 new_bpp = std::min(4U, static_cast<u32>(std::countr_zero(width * bytes_per_pixel)));
     width = (width * bytes_per_pixel) >> new_bpp;
     bytes_per_pixel = 1U << new_bpp;
     Swizzle<true>(output, input, bytes_per_pixel, width, height, depth, block_height, block_depth,
-                  stride);
+                  stride, line_begin, line_end);
 }
 
 void SwizzleSubrect(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel, u32 width,
                     u32 height, u32 depth, u32 origin_x, u32 origin_y, u32 extent_x, u32 extent_y,
                     u32 block_height, u32 block_depth, u32 pitch_linear) {
+    if (TrySwizzleSubrectByGobs<true>(output, input, bytes_per_pixel, width, height, depth,
+                                      origin_x, origin_y, extent_x, extent_y, block_height,
+                                      block_depth, pitch_linear)) {
+        return;
+    }
     switch (bytes_per_pixel) {
 #define BPP_CASE(x)                                                                                \
     case x:                                                                                        \
@@ -225,6 +586,11 @@ void SwizzleSubrect(std::span<u8> output, std::span<const u8> input, u32 bytes_p
 void UnswizzleSubrect(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
                       u32 width, u32 height, u32 depth, u32 origin_x, u32 origin_y, u32 extent_x,
                       u32 extent_y, u32 block_height, u32 block_depth, u32 pitch_linear) {
+    if (TrySwizzleSubrectByGobs<false>(output, input, bytes_per_pixel, width, height, depth,
+                                       origin_x, origin_y, extent_x, extent_y, block_height,
+                                       block_depth, pitch_linear)) {
+        return;
+    }
     switch (bytes_per_pixel) {
 #define BPP_CASE(x)                                                                                \
     case x:                                                                                        \
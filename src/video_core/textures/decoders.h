@@ -41,6 +41,27 @@ constexpr SwizzleTable MakeSwizzleTable() {
     return table;
 }
 
+/// Host code paths available to the block linear (un)swizzle functions.
+enum class SwizzleKernel : u32 {
+    Scalar,  ///< Per-pixel reference implementation.
+    Generic, ///< GOB at a time using portable 16-byte copies.
+    SSE2,    ///< GOB at a time using SSE2 loads and stores.
+    AVX2,    ///< GOB at a time using AVX2 loads, stores and lane permutes.
+    NEON,    ///< GOB at a time using NEON loads and stores.
+};
+
+/// Returns true when the host CPU is able to run the given kernel.
+bool IsSwizzleKernelSupported(SwizzleKernel kernel);
+
+/// Returns the fastest kernel supported by the host CPU.
+SwizzleKernel GetBestSwizzleKernel();
+
+/// Returns the kernel currently used by the (un)swizzle functions.
+SwizzleKernel GetSwizzleKernel();
+
+/// Overrides the kernel used by the (un)swizzle functions. Intended for testing and benchmarking.
+void SetSwizzleKernel(SwizzleKernel kernel);
+
 /// Unswizzles a block linear texture into linear memory.
 void UnswizzleTexture(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
                       u32 width, u32 height, u32 depth, u32 block_height, u32 block_depth,
@@ -51,6 +72,18 @@ void SwizzleTexture(std::span<u8> output, std::span<const u8> input, u32 bytes_p
                     u32 height, u32 depth, u32 block_height, u32 block_depth,
                     u32 stride_alignment = 1);
 
+/// Unswizzles the lines [line_begin, line_end) of every slice of a block linear texture.
+/// Disjoint line ranges of the same texture can be processed concurrently.
+void UnswizzleTextureLines(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
+                           u32 width, u32 height, u32 depth, u32 block_height, u32 block_depth,
+                           u32 stride_alignment, u32 line_begin, u32 line_end);
+
+/// Swizzles the lines [line_begin, line_end) of every slice of linear memory into a block linear
+/// texture. Disjoint line ranges of the same texture can be processed concurrently.
+void SwizzleTextureLines(std::span<u8> output, std::span<const u8> input, u32 bytes_per_pixel,
+                         u32 width, u32 height, u32 depth, u32 block_height, u32 block_depth,
+                         u32 stride_alignment, u32 line_begin, u32 line_end);
+
 /// This function calculates the correct size of a texture depending if it's tiled or not.
 std::size_t CalculateSize(bool tiled, u32 bytes_per_pixel, u32 width, u32 height, u32 depth,
                           u32 block_height, u32 block_depth);
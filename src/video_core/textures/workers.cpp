@@ -1,15 +1,67 @@
 // SPDX-FileCopyrightText: Copyright 2023 citron Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <utility>
+
 #include "video_core/textures/workers.h"
 
 namespace Tegra::Texture {
 
 Common::ThreadWorker& GetThreadWorkers() {
-    static Common::ThreadWorker workers{std::max(std::thread::hardware_concurrency(), 2U) / 2,
-                                        "ImageTranscode"};
+    static Common::ThreadWorker workers{GetThreadWorkerCount(), "ImageTranscode"};
 
     return workers;
 }
 
+size_t GetThreadWorkerCount() {
+    return std::max(std::thread::hardware_concurrency(), 2U) / 2;
+}
+
+void ParallelFor(size_t num_tasks, const std::function<void(size_t)>& func) {
+    struct State {
+        std::atomic<size_t> next_task{};
+        size_t num_completed{};
+        std::mutex mutex;
+        std::condition_variable completed;
+    };
+    const auto state = std::make_shared<State>();
+
+    // Helpers that start after every task has been claimed return without touching func, so it is
+    // only referenced while the calling thread is still waiting below
+    const auto run_tasks = [state, num_tasks, func_ptr = &func] {
+        size_t num_done = 0;
+        for (size_t index = state->next_task.fetch_add(1, std::memory_order_relaxed);
+             index < num_tasks; index = state->next_task.fetch_add(1, std::memory_order_relaxed)) {
+            (*func_ptr)(index);
+            ++num_done;
+        }
+        if (num_done == 0) {
+            return;
+        }
+        std::scoped_lock lock{state->mutex};
+        state->num_completed += num_done;
+        if (state->num_completed == num_tasks) {
+            state->completed.notify_all();
+        }
+    };
+    if (num_tasks > 1) {
+        Common::ThreadWorker& workers{GetThreadWorkers()};
+        const size_t num_helpers = std::min(num_tasks - 1, GetThreadWorkerCount());
+        for (size_t i = 0; i < num_helpers; ++i) {
+            // Hand over a copy, the task wrapper keeps a reference when given an lvalue
+            auto helper = run_tasks;
+            workers.QueueWork(std::move(helper));
+        }
+    }
+    run_tasks();
+
+    std::unique_lock lock{state->mutex};
+    state->completed.wait(lock, [&] { return state->num_completed == num_tasks; });
+}
+
 } // namespace Tegra::Texture
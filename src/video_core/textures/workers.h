@@ -3,10 +3,23 @@
 
 #pragma once
 
+#include <cstddef>
+#include <functional>
+
 #include "common/thread_worker.h"
 
 namespace Tegra::Texture {
 
 Common::ThreadWorker& GetThreadWorkers();
 
-}
+/// Returns the number of threads in the transcode worker pool.
+size_t GetThreadWorkerCount();
+
+/**
+ * Runs func(index) for every index in [0, num_tasks) on the transcode workers and the calling
+ * thread, returning once all of them have finished. Tasks are claimed dynamically, so the call
+ * makes progress on its own even when the workers are busy with unrelated work.
+ */
+void ParallelFor(size_t num_tasks, const std::function<void(size_t)>& func);
+
+} // namespace Tegra::Texture
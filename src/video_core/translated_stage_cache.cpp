@@ -0,0 +1,220 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <utility>
+
+#include "shader_recompiler/exception.h"
+#include "video_core/translated_stage_cache.h"
+
+namespace VideoCommon {
+
+namespace {
+u64 MakeReadKey(u32 first, u32 second) {
+    return (static_cast<u64>(first) << 32) | second;
+}
+
+template <typename Map>
+size_t MapSizeBytes(const Map& map) {
+    return map.size() * (sizeof(typename Map::value_type) + sizeof(void*) * 2);
+}
+
+/// Copies the program without its blocks, they belong to the pools of the pipeline
+Shader::IR::Program CopyProgramInfo(const Shader::IR::Program& program) {
+    Shader::IR::Program copy;
+    copy.info = program.info;
+    copy.stage = program.stage;
+    copy.workgroup_size = program.workgroup_size;
+    copy.output_topology = program.output_topology;
+    copy.output_vertices = program.output_vertices;
+    copy.invocations = program.invocations;
+    copy.local_memory_size = program.local_memory_size;
+    copy.shared_memory_size = program.shared_memory_size;
+    copy.is_geometry_passthrough = program.is_geometry_passthrough;
+    return copy;
+}
+} // Anonymous namespace
+
+bool EnvironmentReads::Replay(Shader::Environment& env) const try {
+    if (lowest_instruction <= highest_instruction) {
+        // Reading the bounds records the same code range in the environment
+        static_cast<void>(env.ReadInstruction(lowest_instruction));
+        static_cast<void>(env.ReadInstruction(highest_instruction));
+    }
+    const auto matches{[](const auto& values, auto&& read) {
+        return std::ranges::all_of(values, [&read](const auto& pair) {
+            return read(pair.first) == pair.second;
+        });
+    }};
+    return (!texture_bound || env.TextureBoundBuffer() == *texture_bound) &&
+           (!has_hle_macro_state || env.HasHLEMacroState() == *has_hle_macro_state) &&
+           (!viewport_transform_state ||
+            env.ReadViewportTransformState() == *viewport_transform_state) &&
+           matches(cbuf_values,
+                   [&env](u64 read_key) {
+                       return env.ReadCbufValue(static_cast<u32>(read_key >> 32),
+                                                static_cast<u32>(read_key));
+                   }) &&
+           matches(texture_types, [&env](u32 handle) { return env.ReadTextureType(handle); }) &&
+           matches(texture_pixel_formats,
+                   [&env](u32 handle) { return env.ReadTexturePixelFormat(handle); }) &&
+           matches(texture_pixel_format_integers,
+                   [&env](u32 handle) { return env.IsTexturePixelFormatInteger(handle); }) &&
+           matches(replace_constants, [&env](u64 read_key) {
+               return env.GetReplaceConstBuffer(static_cast<u32>(read_key >> 32),
+                                                static_cast<u32>(read_key));
+           });
+
+} catch (const Shader::Exception&) {
+    // Environments loaded from disk throw on values they do not have
+    return false;
+}
+
+size_t EnvironmentReads::SizeBytes() const noexcept {
+    return sizeof(*this) + MapSizeBytes(cbuf_values) + MapSizeBytes(texture_types) +
+           MapSizeBytes(texture_pixel_formats) + MapSizeBytes(texture_pixel_format_integers) +
+           MapSizeBytes(replace_constants);
+}
+
+RecordingEnvironment::RecordingEnvironment(Shader::Environment& env_) : env{env_} {
+    sph = env.SPH();
+    gp_passthrough_mask = env.GpPassthroughMask();
+    stage = env.ShaderStage();
+    start_address = env.StartAddress();
+    is_proprietary_driver = env.IsProprietaryDriver();
+}
+
+RecordingEnvironment::~RecordingEnvironment() = default;
+
+u64 RecordingEnvironment::ReadInstruction(u32 address) {
+    reads.lowest_instruction = std::min(reads.lowest_instruction, address);
+    reads.highest_instruction = std::max(reads.highest_instruction, address);
+    return env.ReadInstruction(address);
+}
+
+u32 RecordingEnvironment::ReadCbufValue(u32 cbuf_index, u32 cbuf_offset) {
+    const u32 value{env.ReadCbufValue(cbuf_index, cbuf_offset)};
+    reads.cbuf_values.emplace(MakeReadKey(cbuf_index, cbuf_offset), value);
+    return value;
+}
+
+Shader::TextureType RecordingEnvironment::ReadTextureType(u32 raw_handle) {
+    const Shader::TextureType type{env.ReadTextureType(raw_handle)};
+    reads.texture_types.emplace(raw_handle, type);
+    return type;
+}
+
+Shader::TexturePixelFormat RecordingEnvironment::ReadTexturePixelFormat(u32 raw_handle) {
+    const Shader::TexturePixelFormat format{env.ReadTexturePixelFormat(raw_handle)};
+    reads.texture_pixel_formats.emplace(raw_handle, format);
+    return format;
+}
+
+bool RecordingEnvironment::IsTexturePixelFormatInteger(u32 raw_handle) {
+    const bool is_integer{env.IsTexturePixelFormatInteger(raw_handle)};
+    reads.texture_pixel_format_integers.emplace(raw_handle, is_integer);
+    return is_integer;
+}
+
+u32 RecordingEnvironment::ReadViewportTransformState() {
+    reads.viewport_transform_state = env.ReadViewportTransformState();
+    return *reads.viewport_transform_state;
+}
+
+u32 RecordingEnvironment::TextureBoundBuffer() const {
+    reads.texture_bound = env.TextureBoundBuffer();
+    return *reads.texture_bound;
+}
+
+u32 RecordingEnvironment::LocalMemorySize() const {
+    return env.LocalMemorySize();
+}
+
+u32 RecordingEnvironment::SharedMemorySize() const {
+    return env.SharedMemorySize();
+}
+
+std::array<u32, 3> RecordingEnvironment::WorkgroupSize() const {
+    return env.WorkgroupSize();
+}
+
+bool RecordingEnvironment::HasHLEMacroState() const {
+    reads.has_hle_macro_state = env.HasHLEMacroState();
+    return *reads.has_hle_macro_state;
+}
+
+std::optional<Shader::ReplaceConstant> RecordingEnvironment::GetReplaceConstBuffer(u32 bank,
+                                                                                   u32 offset) {
+    const std::optional<Shader::ReplaceConstant> replace{env.GetReplaceConstBuffer(bank, offset)};
+    reads.replace_constants.emplace(MakeReadKey(bank, offset), replace);
+    return replace;
+}
+
+void RecordingEnvironment::Dump(u64 pipeline_hash, u64 shader_hash) {
+    env.Dump(pipeline_hash, shader_hash);
+}
+
+TranslatedStageCache::TranslatedStageCache(size_t max_size_bytes_) : max_size{max_size_bytes_} {}
+
+TranslatedStageCache::~TranslatedStageCache() = default;
+
+std::shared_ptr<const TranslatedStage> TranslatedStageCache::Find(u64 key,
+                                                                  Shader::Environment& env) {
+    std::shared_ptr<const TranslatedStage> stage;
+    {
+        std::scoped_lock lock{mutex};
+        const auto it = entries.find(key);
+        if (it == entries.end()) {
+            return nullptr;
+        }
+        lru.splice(lru.end(), lru, it->second.lru_it);
+        stage = it->second.stage;
+    }
+    if (!stage->reads.Replay(env)) {
+        return nullptr;
+    }
+    return stage;
+}
+
+void TranslatedStageCache::Insert(u64 key, EnvironmentReads reads,
+                                  const Shader::IR::Program& program,
+                                  const Shader::Backend::Bindings& bindings,
+                                  std::vector<u32> spirv, std::string source) {
+    const size_t size{sizeof(TranslatedStage) + reads.SizeBytes() + spirv.size() * sizeof(u32) +
+                      source.size()};
+    auto stage{std::make_shared<const TranslatedStage>(TranslatedStage{
+        .reads = std::move(reads),
+        .program = CopyProgramInfo(program),
+        .bindings = bindings,
+        .spirv = std::move(spirv),
+        .source = std::move(source),
+    })};
+    std::scoped_lock lock{mutex};
+    const auto it = entries.find(key);
+    if (it != entries.end()) {
+        // Another pipeline translated the stage with different environment values
+        total_size -= it->second.size;
+        lru.erase(it->second.lru_it);
+        entries.erase(it);
+    }
+    lru.push_back(key);
+    entries.insert_or_assign(key, Entry{std::move(stage), size, std::prev(lru.end())});
+    total_size += size;
+    EvictLocked();
+}
+
+size_t TranslatedStageCache::SizeBytes() const {
+    std::scoped_lock lock{mutex};
+    return total_size;
+}
+
+void TranslatedStageCache::EvictLocked() {
+    while (total_size > max_size && !lru.empty()) {
+        const auto it = entries.find(lru.front());
+        total_size -= it->second.size;
+        entries.erase(it);
+        lru.pop_front();
+    }
+}
+
+} // namespace VideoCommon
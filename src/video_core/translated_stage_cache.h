@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: Copyright 2025 citron Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/common_types.h"
+#include "shader_recompiler/backend/bindings.h"
+#include "shader_recompiler/environment.h"
+#include "shader_recompiler/frontend/ir/program.h"
+
+namespace VideoCommon {
+
+/// Values a shader translation read from its environment besides the shader code
+struct EnvironmentReads {
+    /**
+     * Reads the same values from another environment of the shader, which also records them in
+     * environments that are serialized.
+     *
+     * @returns True when the environment returns the values the translation was made with
+     */
+    [[nodiscard]] bool Replay(Shader::Environment& env) const;
+
+    /// Approximate memory used by the reads
+    [[nodiscard]] size_t SizeBytes() const noexcept;
+
+    std::unordered_map<u64, u32> cbuf_values;
+    std::unordered_map<u32, Shader::TextureType> texture_types;
+    std::unordered_map<u32, Shader::TexturePixelFormat> texture_pixel_formats;
+    std::unordered_map<u32, bool> texture_pixel_format_integers;
+    std::unordered_map<u64, std::optional<Shader::ReplaceConstant>> replace_constants;
+    std::optional<u32> viewport_transform_state;
+    std::optional<u32> texture_bound;
+    std::optional<bool> has_hle_macro_state;
+    u32 lowest_instruction{~0U};
+    u32 highest_instruction{};
+};
+
+/// Shader environment forwarding to another one, recording what a translation reads from it
+class RecordingEnvironment final : public Shader::Environment {
+public:
+    explicit RecordingEnvironment(Shader::Environment& env_);
+    ~RecordingEnvironment() override;
+
+    [[nodiscard]] u64 ReadInstruction(u32 address) override;
+
+    [[nodiscard]] u32 ReadCbufValue(u32 cbuf_index, u32 cbuf_offset) override;
+
+    [[nodiscard]] Shader::TextureType ReadTextureType(u32 raw_handle) override;
+
+    [[nodiscard]] Shader::TexturePixelFormat ReadTexturePixelFormat(u32 raw_handle) override;
+
+    [[nodiscard]] bool IsTexturePixelFormatInteger(u32 raw_handle) override;
+
+    [[nodiscard]] u32 ReadViewportTransformState() override;
+
+    [[nodiscard]] u32 TextureBoundBuffer() const override;
+
+    [[nodiscard]] u32 LocalMemorySize() const override;
+
+    [[nodiscard]] u32 SharedMemorySize() const override;
+
+    [[nodiscard]] std::array<u32, 3> WorkgroupSize() const override;
+
+    [[nodiscard]] bool HasHLEMacroState() const override;
+
+    [[nodiscard]] std::optional<Shader::ReplaceConstant> GetReplaceConstBuffer(
+        u32 bank, u32 offset) override;
+
+    void Dump(u64 pipeline_hash, u64 shader_hash) override;
+
+    /// Returns the values read so far
+    [[nodiscard]] EnvironmentReads TakeReads() noexcept {
+        return std::move(reads);
+    }
+
+private:
+    Shader::Environment& env;
+    mutable EnvironmentReads reads;
+};
+
+/// Shader stage translated and emitted for a pipeline
+struct TranslatedStage {
+    /// Reads the translation depends on
+    EnvironmentReads reads;
+    /// Program without its blocks, with the information needed by the pipeline and later stages
+    Shader::IR::Program program;
+    /// Bindings after the stage was emitted
+    Shader::Backend::Bindings bindings;
+    /// Emitted SPIR-V code
+    std::vector<u32> spirv;
+    /// Emitted GLSL or GLASM code
+    std::string source;
+};
+
+/**
+ * In-memory cache of the shader stages emitted for graphics pipelines, so pipelines sharing a
+ * shader with one that was already built skip its decoding, optimization and emission when the
+ * pipeline state affecting the stage is the same.
+ *
+ * Stages are looked up by a key built by the renderer from the hashes of the shaders the stage
+ * depends on and the state bits its runtime information uses. The reads of the translation are
+ * replayed on the environment of the new pipeline before a stage is reused, so environments
+ * giving different values translate the stage again. Least recently used stages are evicted once
+ * the cache exceeds its size limit.
+ *
+ * Lookups and insertions are thread safe.
+ */
+class TranslatedStageCache {
+public:
+    explicit TranslatedStageCache(size_t max_size_bytes_);
+    ~TranslatedStageCache();
+
+    TranslatedStageCache(const TranslatedStageCache&) = delete;
+    TranslatedStageCache& operator=(const TranslatedStageCache&) = delete;
+
+    /// Returns the stage of key when env reads the same values, nullptr otherwise
+    [[nodiscard]] std::shared_ptr<const TranslatedStage> Find(u64 key, Shader::Environment& env);
+
+    /**
+     * Stores an emitted stage
+     *
+     * @param key      Key of the stage
+     * @param reads    Reads of the translation, taken from its recording environment
+     * @param program  Translated program, after it was emitted
+     * @param bindings Bindings after the stage was emitted
+     * @param spirv    Emitted SPIR-V code, if any
+     * @param source   Emitted source code, if any
+     */
+    void Insert(u64 key, EnvironmentReads reads, const Shader::IR::Program& program,
+                const Shader::Backend::Bindings& bindings, std::vector<u32> spirv = {},
+                std::string source = {});
+
+    /// Returns the approximate memory used by the stored stages
+    [[nodiscard]] size_t SizeBytes() const;
+
+private:
+    struct Entry {
+        std::shared_ptr<const TranslatedStage> stage;
+        size_t size;
+        std::list<u64>::iterator lru_it;
+    };
+
+    void EvictLocked();
+
+    mutable std::mutex mutex;
+    std::unordered_map<u64, Entry> entries;
+    std::list<u64> lru; ///< Keys ordered from least to most recently used
+    size_t total_size = 0;
+    size_t max_size = 0;
+};
+
+} // namespace VideoCommon